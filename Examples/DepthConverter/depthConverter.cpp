@@ -45,6 +45,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ofxMultiThread.h"
 
 #include "../include/ofxUtilities.H" // example support utils
+#include "../../Support/include/ofxsPixelConverter.H" // depth conversion engine
 
 #if defined __APPLE__ || defined linux || defined __FreeBSD__
 #  define EXPORT __attribute__((visibility("default")))
@@ -169,66 +170,40 @@ isIdentity(OfxImageEffectHandle  effect,
 
 ////////////////////////////////////////////////////////////////////////////////
 // rendering routines
-template <class T> inline T 
-Clamp(T v, int min, int max)
-{
-  if(v < T(min)) return T(min);
-  if(v > T(max)) return T(max);
-  return v;
-}
 
-// look up a pixel in the image, does bounds checking to see if it is in the image rectangle
-template <class PIX> inline PIX *
-pixelAddress(PIX *img, OfxRectI rect, int x, int y, int bytesPerLine)
-{  
-  if(x < rect.x1 || x >= rect.x2 || y < rect.y1 || y > rect.y2)
-    return 0;
-  PIX *pix = (PIX *) (((char *) img) + (y - rect.y1) * bytesPerLine);
-  pix += x - rect.x1;  
-  return pix;
+// map the bit depths ofxuGetImage gives us to the pixel converter's
+static OFX::PixelConverter::DepthEnum
+mapDepth(int bitDepth)
+{
+  switch(bitDepth) {
+  case 8  : return OFX::PixelConverter::eDepthByte;
+  case 16 : return OFX::PixelConverter::eDepthShort;
+  case 32 : return OFX::PixelConverter::eDepthFloat;
+  }
+  return OFX::PixelConverter::eDepthNone;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// base class to process images with
+// class to convert images with, the pixel converter does the work on each thread's slice of the window
 class Processor {
 protected :
   OfxImageEffectHandle instance;
-  int nComponents;
-  void *srcV, *dstV; 
-  OfxRectI srcRect, dstRect;
-  int srcBytesPerLine, dstBytesPerLine;
+  OFX::PixelConverter::Buffer src, dst;
   OfxRectI  window;
 
 public :
-  Processor(const Processor &p)
-    : instance(p.instance)
-    , nComponents(p.nComponents)
-    , srcV(p.srcV)
-    , dstV(p.dstV)
-    , srcRect(p.srcRect)
-    , dstRect(p.dstRect)
-    , srcBytesPerLine(p.srcBytesPerLine)
-    , dstBytesPerLine(p.dstBytesPerLine)
-    , window(p.window)
-  {}  
-
-  Processor(OfxImageEffectHandle inst, int nComps,
-            void *src, OfxRectI sRect, int sBytesPerLine,
-            void *dst, OfxRectI dRect, int dBytesPerLine,
+  Processor(OfxImageEffectHandle inst,
+            const OFX::PixelConverter::Buffer &s,
+            const OFX::PixelConverter::Buffer &d,
             OfxRectI  win)
     : instance(inst)
-    , nComponents(nComps)
-    , srcV(src)
-    , dstV(dst)
-    , srcRect(sRect)
-    , dstRect(dRect)
-    , srcBytesPerLine(sBytesPerLine)
-    , dstBytesPerLine(dBytesPerLine)
+    , src(s)
+    , dst(d)
     , window(win)
   {}  
 
   static void multiThreadProcessing(unsigned int threadId, unsigned int nThreads, void *arg);
-  virtual void doProcessing(OfxRectI window);
+  void doProcessing(OfxRectI window);
   void process(void);
 };
 
@@ -259,62 +234,19 @@ Processor::process(void)
   gThreadHost->multiThread(multiThreadProcessing, nThreads, (void *) this);
 }
 
+// change the depth of the rows in our slice, a few at a time so we notice an abort
 void 
-Processor::doProcessing(OfxRectI /*window*/)
+Processor::doProcessing(OfxRectI procWindow)
 {
-}
+  for(int y = procWindow.y1; y < procWindow.y2; y += 16) {
+    if(gEffectHost->abort(instance)) break;
 
-// template to do the RGBA processing
-template <class SRCPIX, int kSrcMax, int srcIsFloat,
-	  class DSTPIX, int kDstMax, int dstIsFloat>
-class ProcessPix : public Processor {
- public :
-  ProcessPix(const Processor &p)
-    : Processor(p)
-  {
-    process();
+    OfxRectI rows = procWindow;
+    rows.y1 = y;
+    rows.y2 = Minimum(y + 16, procWindow.y2);
+    OFX::PixelConverter::convert(src, dst, rows);
   }
-
-  void doProcessing(OfxRectI procWindow)
-  {
-    SRCPIX *src = (SRCPIX *) srcV;
-    DSTPIX *dst = (DSTPIX *) dstV;
-
-    float scaleF;
-    scaleF = float(kDstMax)/float(kSrcMax);
-
-    for(int y = procWindow.y1; y < procWindow.y2; y++) {
-      if(gEffectHost->abort(instance)) break;
-
-      DSTPIX *dstPix = pixelAddress(dst, dstRect, procWindow.x1, y, dstBytesPerLine);
-
-      for(int x = procWindow.x1; x < procWindow.x2; x++) {
-        
-        // if a generator, we have no source
-        SRCPIX *srcPix = pixelAddress(src, srcRect, x, y, srcBytesPerLine);        
-        
-        // change my pixel depths
-        if(srcPix) {
-          for(int c = 0; c < nComponents; c++) {
-            if(dstIsFloat)
-              dstPix[c] = srcPix[c] * scaleF;
-            else if (srcIsFloat) 
-              dstPix[c] = Clamp(srcPix[c] * scaleF, 0, kDstMax);
-            else
-              dstPix[c] = Clamp(srcPix[c] * kDstMax/kSrcMax, 0, kDstMax);	    
-          }
-          srcPix += nComponents;
-        }
-        else {
-          for(int c = 0; c < nComponents; c++)
-            dstPix[c] = 0;
-        }
-        dstPix += nComponents;
-      }
-    }
-  }
-
-};
+}
 
 // the process code  that the host sees
 static OfxStatus render(OfxImageEffectHandle effect,
@@ -347,43 +279,13 @@ static OfxStatus render(OfxImageEffectHandle effect,
     sourceImg = ofxuGetImage(myData->sourceClip, time, srcRowBytes, srcBitDepth, srcIsAlpha, srcRect, src);
     if(sourceImg == NULL) throw OfxuNoImageException();
     
-    int nComponents = dstIsAlpha ? 1 : 4;
+    // describe the two images to the pixel converter, which handles all 9 combinations of depths
+    OFX::PixelConverter::Buffer srcBuffer = {src, srcRect, srcRowBytes, mapDepth(srcBitDepth), srcIsAlpha ? 1 : 4};
+    OFX::PixelConverter::Buffer dstBuffer = {dst, dstRect, dstRowBytes, mapDepth(dstBitDepth), dstIsAlpha ? 1 : 4};
     
-    // set up the processor that we pass to the individual constructors
-    Processor proc(effect, nComponents,
-                   src, srcRect, srcRowBytes,
-                   dst, dstRect, dstRowBytes,
-                   renderWindow);
-    
-    // now instantiate the templated processor depending on src and dest pixel types, 9 cases in all
-    switch(dstBitDepth) {
-    case 8 : {
-      switch(srcBitDepth) {
-      case 8 :  {ProcessPix<unsigned char,  255,   0, unsigned char, 255, 0> pixProc(proc); break;}
-      case 16 : {ProcessPix<unsigned short, 65535, 0, unsigned char, 255, 0> pixProc(proc); break;}
-      case 32 : {ProcessPix<float,          1,     1, unsigned char, 255, 0> pixProc(proc); break;}
-      }
-    }
-      break;
-
-    case 16 : {
-      switch(srcBitDepth) {
-      case 8 :  {ProcessPix<unsigned char,  255,   0, unsigned short, 65535, 0> pixProc(proc); break;}
-      case 16 : {ProcessPix<unsigned short, 65535, 0, unsigned short, 65535, 0> pixProc(proc); break;}
-      case 32 : {ProcessPix<float,          1,     1, unsigned short, 65535, 0> pixProc(proc); break;}
-      }
-    }
-      break;
-
-    case 32 : {
-      switch(srcBitDepth) {
-      case 8 :  {ProcessPix<unsigned char,  255,   0, float, 1, 1> pixProc(proc); break;}
-      case 16 : {ProcessPix<unsigned short, 65535, 0, float, 1, 1> pixProc(proc); break;}
-      case 32 : {ProcessPix<float,          1,     1, float, 1, 1> pixProc(proc); break;}
-      }
-    }                          
-      break;
-    }
+    // and convert across our CPUs
+    Processor proc(effect, srcBuffer, dstBuffer, renderWindow);
+    proc.process();
   }
   catch(OfxuNoImageException &ex) {
     // if we were interrupted, the failed fetch is fine, just return kOfxStatOK
@@ -0,0 +1,131 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+////////////////////////////////////////////////////////////////////////////////
+/// Benchmark of paramGetValueAtTime on a double param keyed in the built in
+/// animation engine, with 1, 100 and 100,000 keys. Times stepping through time
+/// in order, as a render does, which the engine's segment hint makes constant
+/// time, and times in no order, which are a binary search each.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+#if defined(WINDOWS)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// ofx
+#include "ofxCore.h"
+#include "ofxParam.h"
+
+// ofx host
+#include "ofxhPropertySuite.h"
+#include "ofxhParam.h"
+#include "ofxhAnimation.h"
+
+using namespace OFX::Host;
+
+static const int kLookups = 2000000;
+static const double kDuration = 100000;
+
+/// wall clock seconds
+static double seconds()
+{
+#if defined(WINDOWS)
+  LARGE_INTEGER now, frequency;
+  QueryPerformanceCounter(&now);
+  QueryPerformanceFrequency(&frequency);
+  return double(now.QuadPart) / double(frequency.QuadPart);
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+/// a double param that keeps its keys in the built in animation engine
+class AnimatedDouble : public Param::DoubleInstance {
+public :
+  explicit AnimatedDouble(Param::Descriptor &descriptor) : Param::DoubleInstance(descriptor) { useAnimation(1); }
+
+  OfxStatus get(double &v) { return get(0, v); }
+  OfxStatus get(OfxTime time, double &v) { readAnimation().getValue(time, &v); return kOfxStatOK; }
+  OfxStatus set(double v) { getAnimation().setValue(&v); return kOfxStatOK; }
+  OfxStatus set(OfxTime time, double v) { getAnimation().setKey(time, &v); return kOfxStatOK; }
+  OfxStatus derive(OfxTime time, double &v) { return deriveAnimation(time, &v); }
+  OfxStatus integrate(OfxTime time1, OfxTime time2, double &v) { return integrateAnimation(time1, time2, &v); }
+};
+
+/// look up each of times through the suite, returns the lookups a second
+static double timeLookups(const OfxParameterSuiteV1 *suite, OfxParamHandle handle, const std::vector<double> &times)
+{
+  double sum = 0;
+  double start = seconds();
+  for(size_t i = 0; i < times.size(); ++i) {
+    double v;
+    suite->paramGetValueAtTime(handle, times[i], &v);
+    sum += v;
+  }
+  double elapsed = seconds() - start;
+  if(sum == 42)
+    printf(" ");
+  return times.size() / elapsed;
+}
+
+int main(int argc, char **argv)
+{
+  const OfxParameterSuiteV1 *suite = (const OfxParameterSuiteV1 *) Param::GetSuite(1);
+  Param::Descriptor descriptor(kOfxParamTypeDouble, "value");
+
+  // a render steps through frames in order, the random times are spread over all of the keys
+  std::vector<double> inOrder(kLookups), random(kLookups);
+  srand(1);
+  for(int i = 0; i < kLookups; ++i) {
+    inOrder[i] = fmod(i * 0.5, kDuration);
+    random[i] = kDuration * rand() / RAND_MAX;
+  }
+
+  static const int keyCounts[] = { 1, 100, 100000 };
+  for(int k = 0; k < 3; ++k) {
+    AnimatedDouble param(descriptor);
+    int nKeys = keyCounts[k];
+    for(int i = 0; i < nKeys; ++i)
+      param.set(i * kDuration / nKeys, sin(i * 0.1));
+
+    OfxParamHandle handle = (OfxParamHandle) static_cast<Param::Instance *>(&param);
+    double ordered = timeLookups(suite, handle, inOrder);
+    double unordered = timeLookups(suite, handle, random);
+    printf("%6d keys : %6.1f M lookups/s in order, %6.1f M lookups/s at random\n", nKeys, ordered / 1e6, unordered / 1e6);
+  }
+  return 0;
+}
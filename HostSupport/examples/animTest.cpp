@@ -0,0 +1,241 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+////////////////////////////////////////////////////////////////////////////////
+/// Test of the animation engine's closed form integrals and derivatives against
+/// numerical ground truth. Builds random curves of two dimensions, with every
+/// interpolation, then edits them so the integral table is updated rather than
+/// built afresh. Integrals are checked against Simpson's rule applied to each
+/// stretch between keys, which is exact for the cubics the curves are made of,
+/// and derivatives against central differences away from the keys. The same
+/// checks are then made through the parameter suite.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+// ofx
+#include "ofxCore.h"
+#include "ofxParam.h"
+
+// ofx host
+#include "ofxhPropertySuite.h"
+#include "ofxhParam.h"
+#include "ofxhAnimation.h"
+
+using namespace OFX::Host;
+
+static const int kTrials = 200;
+static const int kQueries = 50;
+static const double kIntegralTolerance = 1e-9;
+static const double kDerivativeTolerance = 1e-5;
+
+/// a double param that keeps its keys in the built in animation engine
+class AnimatedDouble : public Param::DoubleInstance {
+public :
+  explicit AnimatedDouble(Param::Descriptor &descriptor) : Param::DoubleInstance(descriptor) { useAnimation(1); }
+
+  OfxStatus get(double &v) { return get(0, v); }
+  OfxStatus get(OfxTime time, double &v) { readAnimation().getValue(time, &v); return kOfxStatOK; }
+  OfxStatus set(double v) { getAnimation().setValue(&v); return kOfxStatOK; }
+  OfxStatus set(OfxTime time, double v) { getAnimation().setKey(time, &v); return kOfxStatOK; }
+};
+
+/// a random number in [lo, hi) on a grid of the given step
+static double randomIn(double lo, double hi, double step)
+{
+  return lo + step * (rand() % int((hi - lo) / step));
+}
+
+/// The integral of a dimension from time1 to time2 by Simpson's rule over each stretch between
+/// keys. The ends of each stretch are nudged inside it, so a constant key's jump is not sampled.
+static double simpson(const Param::Animation &animation, OfxTime time1, OfxTime time2, int dimension)
+{
+  double sign = 1;
+  if(time2 < time1) {
+    std::swap(time1, time2);
+    sign = -1;
+  }
+
+  std::vector<double> ends(1, time1);
+  for(int k = 0; k < animation.getNumKeys(); ++k) {
+    if(animation.getKeyTime(k) > time1 && animation.getKeyTime(k) < time2)
+      ends.push_back(animation.getKeyTime(k));
+  }
+  ends.push_back(time2);
+
+  double sum = 0;
+  for(size_t i = 0; i + 1 < ends.size(); ++i) {
+    const int n = 64;
+    double h = (ends[i + 1] - ends[i]) / n;
+    double nudge = 1e-12 * (ends[i + 1] - ends[i]);
+    double s = 0;
+    for(int j = 0; j <= n; ++j) {
+      double t = ends[i] + j * h + (j == 0 ? nudge : 0) - (j == n ? nudge : 0);
+      double weight = (j == 0 || j == n) ? 1 : (j % 2 ? 4 : 2);
+      s += weight * animation.getValue(t, dimension);
+    }
+    sum += s * h / 3;
+  }
+  return sign * sum;
+}
+
+/// is time far enough from every key for a central difference to be smooth
+static bool awayFromKeys(const Param::Animation &animation, OfxTime time)
+{
+  for(int k = 0; k < animation.getNumKeys(); ++k) {
+    if(fabs(animation.getKeyTime(k) - time) < 1e-3)
+      return false;
+  }
+  return true;
+}
+
+static double centralDifference(const Param::Animation &animation, OfxTime time, int dimension)
+{
+  const double h = 1e-5;
+  return (animation.getValue(time + h, dimension) - animation.getValue(time - h, dimension)) / (2 * h);
+}
+
+static int gFailures = 0;
+
+static void check(bool ok, const char *what, double got, double expected)
+{
+  if(!ok) {
+    if(gFailures < 10)
+      printf("FAILED %s : got %.12g, expected %.12g\n", what, got, expected);
+    ++gFailures;
+  }
+}
+
+/// a random curve, keyed and then edited
+static void randomCurve(Param::Animation &animation)
+{
+  double statics[2] = { randomIn(0, 5, 1), -1 };
+  animation.setValue(statics);
+
+  int nKeys = rand() % 12;
+  for(int i = 0; i < nKeys; ++i) {
+    double values[2] = { randomIn(-10, 10, 0.01), randomIn(0, 10, 0.1) };
+    animation.setKey(randomIn(-20, 80, 0.25), values);
+  }
+  for(int k = 0; k < animation.getNumKeys(); ++k)
+    animation.setKeyInterpolation(k, Param::InterpolationEnum(rand() % 4));
+
+  for(int e = 0; e < 5 && animation.getNumKeys() > 0; ++e) {
+    switch(rand() % 3) {
+    case 0 :
+      animation.deleteKey(animation.getKeyTime(rand() % animation.getNumKeys()));
+      break;
+    case 1 : {
+      double values[2] = { randomIn(0, 7, 1), randomIn(0, 9, 1) };
+      animation.setKey(randomIn(-20, 80, 0.25), values);
+      break;
+    }
+    default :
+      animation.setKeyInterpolation(rand() % animation.getNumKeys(), Param::InterpolationEnum(rand() % 4));
+      break;
+    }
+  }
+}
+
+static void testAnimation()
+{
+  for(int trial = 0; trial < kTrials; ++trial) {
+    Param::Animation animation(2);
+    randomCurve(animation);
+
+    for(int q = 0; q < kQueries; ++q) {
+      double time1 = randomIn(-40, 120, 0.01);
+      double time2 = randomIn(-40, 120, 0.01);
+      for(int d = 0; d < 2; ++d) {
+        double integral = animation.getIntegral(time1, time2, d);
+        double truth = simpson(animation, time1, time2, d);
+        check(fabs(integral - truth) <= kIntegralTolerance * (1 + fabs(truth)), "integral", integral, truth);
+
+        double backwards = animation.getIntegral(time2, time1, d);
+        check(backwards == -integral, "integral backwards", backwards, -integral);
+
+        if(awayFromKeys(animation, time1)) {
+          double derivative = animation.getDerivative(time1, d);
+          double difference = centralDifference(animation, time1, d);
+          check(fabs(derivative - difference) <= kDerivativeTolerance * (1 + fabs(difference)), "derivative", derivative, difference);
+        }
+      }
+    }
+  }
+}
+
+static void testSuite()
+{
+  const OfxParameterSuiteV1 *suite = (const OfxParameterSuiteV1 *) Param::GetSuite(1);
+  Param::Descriptor descriptor(kOfxParamTypeDouble, "speed");
+
+  for(int trial = 0; trial < kTrials / 10; ++trial) {
+    AnimatedDouble param(descriptor);
+    for(int i = 0; i < 20; ++i)
+      param.set(randomIn(0, 100, 0.5), randomIn(-2, 2, 0.01));
+    for(int k = 0; k < param.getAnimation().getNumKeys(); ++k)
+      param.getAnimation().setKeyInterpolation(k, Param::InterpolationEnum(rand() % 4));
+
+    OfxParamHandle handle = (OfxParamHandle) static_cast<Param::Instance *>(&param);
+    for(int q = 0; q < kQueries; ++q) {
+      double time1 = randomIn(-10, 110, 0.01);
+      double time2 = randomIn(-10, 110, 0.01);
+
+      double integral = 0;
+      OfxStatus stat = suite->paramGetIntegral(handle, time1, time2, &integral);
+      double truth = simpson(param.getAnimation(), time1, time2, 0);
+      check(stat == kOfxStatOK, "paramGetIntegral status", stat, kOfxStatOK);
+      check(fabs(integral - truth) <= kIntegralTolerance * (1 + fabs(truth)), "paramGetIntegral", integral, truth);
+
+      if(awayFromKeys(param.getAnimation(), time1)) {
+        double derivative = 0;
+        stat = suite->paramGetDerivative(handle, time1, &derivative);
+        double difference = centralDifference(param.getAnimation(), time1, 0);
+        check(stat == kOfxStatOK, "paramGetDerivative status", stat, kOfxStatOK);
+        check(fabs(derivative - difference) <= kDerivativeTolerance * (1 + fabs(difference)), "paramGetDerivative", derivative, difference);
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  srand(7);
+  testAnimation();
+  testSuite();
+  if(gFailures) {
+    printf("FAILED %d checks\n", gFailures);
+    return 1;
+  }
+  printf("PASSED\n");
+  return 0;
+}
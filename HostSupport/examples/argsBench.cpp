@@ -0,0 +1,184 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+/// Benchmark of the per frame image effect actions. Loads the example invert
+/// plugin, as hostDemo does, and times the region of definition, regions of
+/// interest, frames needed and is identity actions. It also counts the heap
+/// allocations each call makes, which is what building the in and out argument
+/// sets used to cost on every call before instances kept them pre-built.
+///
+/// Set OFX_PLUGIN_PATH so the invert plugin can be found.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <new>
+
+// ofx
+#include "ofxCore.h"
+#include "ofxImageEffect.h"
+
+// ofx host
+#include "ofxhBinary.h"
+#include "ofxhPropertySuite.h"
+#include "ofxhClip.h"
+#include "ofxhParam.h"
+#include "ofxhMemory.h"
+#include "ofxhImageEffect.h"
+#include "ofxhPluginAPICache.h"
+#include "ofxhPluginCache.h"
+#include "ofxhHost.h"
+#include "ofxhImageEffectAPI.h"
+#include "ofxhThread.h"
+
+// my host
+#include "hostDemoHostDescriptor.h"
+#include "hostDemoEffectInstance.h"
+#include "hostDemoClipInstance.h"
+
+#if __cplusplus >= 201103L
+#define NO_THROW noexcept
+#else
+#define NO_THROW throw()
+#endif
+
+/// every heap allocation the program makes
+static OFX::Host::Thread::AtomicCount gAllocations;
+
+void *operator new(size_t n)
+{
+  gAllocations.increment();
+  void *p = malloc(n ? n : 1);
+  if(!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void *p) NO_THROW
+{
+  free(p);
+}
+
+static const int kIterations = 100000;
+
+static double seconds()
+{
+  return double(clock()) / CLOCKS_PER_SEC;
+}
+
+/// runs an action kIterations times and reports what it cost
+class ActionTimer {
+  const char *_name;
+  double      _start;
+  long        _allocations;
+
+public :
+  explicit ActionTimer(const char *name)
+    : _name(name)
+    , _start(seconds())
+    , _allocations(gAllocations.get())
+  {
+  }
+
+  ~ActionTimer()
+  {
+    double elapsed = seconds() - _start;
+    long allocations = gAllocations.get() - _allocations;
+    printf("%-24s : %7.2f us a call, %5.1f allocations a call\n", _name,
+           1e6 * elapsed / kIterations, double(allocations) / kIterations);
+  }
+};
+
+int main(int argc, char **argv)
+{
+  OFX::Host::PluginCache::getPluginCache()->setCacheVersion("argsBenchV1");
+  MyHost::Host myHost;
+  OFX::Host::ImageEffect::PluginCache imageEffectPluginCache(myHost);
+  imageEffectPluginCache.registerInCache(*OFX::Host::PluginCache::getPluginCache());
+  OFX::Host::PluginCache::getPluginCache()->scanPluginFiles();
+
+  OFX::Host::ImageEffect::ImageEffectPlugin* plugin = imageEffectPluginCache.getPluginById("net.sf.openfx.invertPlugin");
+  if(!plugin) {
+    printf("could not find the invert plugin, set OFX_PLUGIN_PATH\n");
+    OFX::Host::PluginCache::clearPluginCache();
+    return 1;
+  }
+
+  {
+    OFX::Host::ImageEffect::Instance *instance = plugin->createInstance(kOfxImageEffectContextFilter, NULL);
+    OfxStatus stat = instance->createInstanceAction();
+    if((stat != kOfxStatOK && stat != kOfxStatReplyDefault) || !instance->getClipPreferences()) {
+      printf("could not create an invert instance\n");
+      delete instance;
+      OFX::Host::PluginCache::clearPluginCache();
+      return 1;
+    }
+
+    OfxPointD renderScale = {1, 1};
+    OfxRectI renderWindow = {0, 0, 720, 576};
+    OfxRectD regionOfInterest = {0, 0, 768, 576};
+
+    {
+      ActionTimer timer("region of definition");
+      for(int i = 0; i < kIterations; ++i) {
+        OfxRectD rod;
+        instance->getRegionOfDefinitionAction(i % 25, renderScale, rod);
+      }
+    }
+    {
+      ActionTimer timer("regions of interest");
+      for(int i = 0; i < kIterations; ++i) {
+        std::map<OFX::Host::ImageEffect::ClipInstance *, OfxRectD> rois;
+        instance->getRegionOfInterestAction(i % 25, renderScale, regionOfInterest, rois);
+      }
+    }
+    {
+      ActionTimer timer("frames needed");
+      for(int i = 0; i < kIterations; ++i) {
+        OFX::Host::ImageEffect::RangeMap ranges;
+        instance->getFrameNeededAction(i % 25, ranges);
+      }
+    }
+    {
+      ActionTimer timer("is identity");
+      for(int i = 0; i < kIterations; ++i) {
+        OfxTime time = i % 25;
+        std::string clip;
+        instance->isIdentityAction(time, kOfxImageFieldNone, renderWindow, renderScale, clip);
+      }
+    }
+
+    delete instance;
+  }
+
+  OFX::Host::PluginCache::clearPluginCache();
+  return 0;
+}
@@ -0,0 +1,192 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+////////////////////////////////////////////////////////////////////////////////
+/// Benchmark of the batched parameter suite, see ofxsParamBatchSuite.h. Times a
+/// motion blur's 64 samples of a double and a 2D double param across each of
+/// 500 frames, fetched with 64 paramGetValueAtTime calls a param against one
+/// paramGetValuesAtTimes call a param, after checking the two agree.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+#if defined(WINDOWS)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// ofx
+#include "ofxCore.h"
+#include "ofxParam.h"
+
+// ofx host
+#include "ofxhPropertySuite.h"
+#include "ofxhParam.h"
+#include "ofxhAnimation.h"
+
+// ofx support
+#include "ofxsParamBatchSuite.h"
+
+using namespace OFX::Host;
+
+static const int kSamples = 64;
+static const int kFrames = 500;
+static const int kKeys = 200;
+static const int kRuns = 20;
+
+/// wall clock seconds
+static double seconds()
+{
+#if defined(WINDOWS)
+  LARGE_INTEGER now, frequency;
+  QueryPerformanceCounter(&now);
+  QueryPerformanceFrequency(&frequency);
+  return double(now.QuadPart) / double(frequency.QuadPart);
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+/// a double param that keeps its keys in the built in animation engine
+class AnimatedDouble : public Param::DoubleInstance {
+public :
+  explicit AnimatedDouble(Param::Descriptor &descriptor) : Param::DoubleInstance(descriptor) { useAnimation(1); }
+
+  OfxStatus get(double &v) { return get(0, v); }
+  OfxStatus get(OfxTime time, double &v) { readAnimation().getValue(time, &v); return kOfxStatOK; }
+  OfxStatus set(double v) { getAnimation().setValue(&v); return kOfxStatOK; }
+  OfxStatus set(OfxTime time, double v) { getAnimation().setKey(time, &v); return kOfxStatOK; }
+};
+
+/// a 2D double param that keeps its keys in the built in animation engine
+class AnimatedDouble2D : public Param::Double2DInstance {
+public :
+  explicit AnimatedDouble2D(Param::Descriptor &descriptor) : Param::Double2DInstance(descriptor) { useAnimation(2); }
+
+  OfxStatus get(double &x, double &y) { return get(0, x, y); }
+  OfxStatus get(OfxTime time, double &x, double &y)
+  {
+    double v[2];
+    readAnimation().getValue(time, v);
+    x = v[0];
+    y = v[1];
+    return kOfxStatOK;
+  }
+  OfxStatus set(double x, double y) { double v[2] = {x, y}; getAnimation().setValue(v); return kOfxStatOK; }
+  OfxStatus set(OfxTime time, double x, double y) { double v[2] = {x, y}; getAnimation().setKey(time, v); return kOfxStatOK; }
+};
+
+/// the times a motion blur samples across a frame's shutter
+static void shutterTimes(int frame, double *times)
+{
+  for(int s = 0; s < kSamples; ++s)
+    times[s] = frame - 0.25 + 0.5 * s / (kSamples - 1);
+}
+
+int main(int argc, char **argv)
+{
+  const OfxParameterSuiteV1 *suite = (const OfxParameterSuiteV1 *) Param::GetSuite(1);
+  const NetSfOfxParameterBatchSuiteV1 *batch = (const NetSfOfxParameterBatchSuiteV1 *) Param::GetBatchSuite(1);
+
+  Param::Descriptor angleDescriptor(kOfxParamTypeDouble, "angle");
+  Param::Descriptor translateDescriptor(kOfxParamTypeDouble2D, "translate");
+  AnimatedDouble angle(angleDescriptor);
+  AnimatedDouble2D translate(translateDescriptor);
+  for(int k = 0; k < kKeys; ++k) {
+    double time = k * double(kFrames) / kKeys;
+    angle.set(time, 90 * sin(k * 0.3));
+    translate.set(time, k * 3.0 + (k * 7) % 10, 50 * cos(k * 0.2));
+    angle.getAnimation().setKeyInterpolation(k, Param::InterpolationEnum(k % 4));
+    translate.getAnimation().setKeyInterpolation(k, Param::InterpolationEnum((k / 3) % 4));
+  }
+  OfxParamHandle angleHandle = (OfxParamHandle) static_cast<Param::Instance *>(&angle);
+  OfxParamHandle translateHandle = (OfxParamHandle) static_cast<Param::Instance *>(&translate);
+
+  double times[kSamples], angles[kSamples], translates[2 * kSamples];
+
+  // check the batch gives what the separate calls do
+  double largestDifference = 0;
+  for(int frame = 0; frame < kFrames; ++frame) {
+    shutterTimes(frame, times);
+    if(batch->paramGetValuesAtTimes(angleHandle, times, kSamples, angles) != kOfxStatOK ||
+       batch->paramGetValuesAtTimes(translateHandle, times, kSamples, translates) != kOfxStatOK) {
+      printf("FAILED paramGetValuesAtTimes\n");
+      return 1;
+    }
+    for(int s = 0; s < kSamples; ++s) {
+      double a, x, y;
+      suite->paramGetValueAtTime(angleHandle, times[s], &a);
+      suite->paramGetValueAtTime(translateHandle, times[s], &x, &y);
+      largestDifference = std::max(largestDifference, fabs(a - angles[s]));
+      largestDifference = std::max(largestDifference, std::max(fabs(x - translates[2 * s]), fabs(y - translates[2 * s + 1])));
+    }
+  }
+  if(largestDifference > 1e-9) {
+    printf("FAILED the batch differs from paramGetValueAtTime by %g\n", largestDifference);
+    return 1;
+  }
+
+  double sum = 0;
+  double start = seconds();
+  for(int run = 0; run < kRuns; ++run) {
+    for(int frame = 0; frame < kFrames; ++frame) {
+      shutterTimes(frame, times);
+      for(int s = 0; s < kSamples; ++s) {
+        suite->paramGetValueAtTime(angleHandle, times[s], &angles[s]);
+        suite->paramGetValueAtTime(translateHandle, times[s], &translates[2 * s], &translates[2 * s + 1]);
+      }
+      sum += angles[7] + translates[9];
+    }
+  }
+  double separate = (seconds() - start) / (kRuns * kFrames);
+
+  start = seconds();
+  for(int run = 0; run < kRuns; ++run) {
+    for(int frame = 0; frame < kFrames; ++frame) {
+      shutterTimes(frame, times);
+      batch->paramGetValuesAtTimes(angleHandle, times, kSamples, angles);
+      batch->paramGetValuesAtTimes(translateHandle, times, kSamples, translates);
+      sum += angles[7] + translates[9];
+    }
+  }
+  double batched = (seconds() - start) / (kRuns * kFrames);
+
+  printf("%d samples of a double and a 2D double param, %d keys each\n", kSamples, kKeys);
+  printf("paramGetValueAtTime a sample : %7.2f us a frame\n", 1e6 * separate);
+  printf("paramGetValuesAtTimes        : %7.2f us a frame, %.1f times faster\n", 1e6 * batched, separate / batched);
+  if(sum == 42)
+    printf(" ");
+  return 0;
+}
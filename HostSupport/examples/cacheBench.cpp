@@ -0,0 +1,355 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+/// Benchmark of host startup with 1,000 plugins, reading the XML plugin cache
+/// against reading the binary one, see OFX::Host::CacheFile.
+///
+/// The example invert plugin is loaded and described for real, then 1,000
+/// synthetic bundles are made whose binaries are dummy files, along with an
+/// XML cache that gives each one the invert plugin's description under an
+/// identifier of its own. As the binaries match the cache the plugin cache
+/// never loads them. It then times, best of several runs,
+///
+///   - a cold start, the first after the cache format changed or the binary
+///     cache was lost, reading the XML cache, scanning the plugin path and
+///     writing the binary cache,
+///   - a warm start, every one after, reading the binary cache and scanning,
+///   - decoding every plugin's descriptor after a warm start, which startup
+///     leaves for when each plugin is first asked for,
+///   - of that, the time spent replaying the binary cache's stored XML events
+///     into an API handler that does nothing, that is the cost of keeping the
+///     descriptors as events rather than flat property records.
+///
+/// Set OFX_PLUGIN_PATH so the invert plugin can be found. The synthetic
+/// bundles are made in the directory given as the argument, cacheBenchPlugins
+/// by default, and removed at the end.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#if defined(WINDOWS)
+#include <windows.h>
+#include <direct.h>
+#else
+#include <time.h>
+#include <unistd.h>
+#endif
+
+// ofx
+#include "ofxCore.h"
+#include "ofxImageEffect.h"
+
+// ofx host
+#include "ofxhBinary.h"
+#include "ofxhPropertySuite.h"
+#include "ofxhClip.h"
+#include "ofxhParam.h"
+#include "ofxhMemory.h"
+#include "ofxhImageEffect.h"
+#include "ofxhPluginAPICache.h"
+#include "ofxhPluginCache.h"
+#include "ofxhPluginCacheFile.h"
+#include "ofxhHost.h"
+#include "ofxhImageEffectAPI.h"
+
+// my host
+#include "hostDemoHostDescriptor.h"
+#include "hostDemoEffectInstance.h"
+#include "hostDemoClipInstance.h"
+
+static const int kPlugins = 1000;
+static const int kRuns = 5;
+static const char *kXMLCache = "cacheBench.xml";
+static const char *kBinaryCache = "cacheBench.bin";
+
+/// wall clock seconds
+static double seconds()
+{
+#if defined(WINDOWS)
+  LARGE_INTEGER now, frequency;
+  QueryPerformanceCounter(&now);
+  QueryPerformanceFrequency(&frequency);
+  return double(now.QuadPart) / double(frequency.QuadPart);
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+static void makeDirectory(const std::string &path)
+{
+#if defined(WINDOWS)
+  _mkdir(path.c_str());
+#else
+  mkdir(path.c_str(), 0755);
+#endif
+}
+
+static void removeDirectory(const std::string &path)
+{
+#if defined(WINDOWS)
+  _rmdir(path.c_str());
+#else
+  rmdir(path.c_str());
+#endif
+}
+
+static void setPluginPath(const char *path)
+{
+#if defined(WINDOWS)
+  _putenv_s("OFX_PLUGIN_PATH", path);
+#else
+  setenv("OFX_PLUGIN_PATH", path, 1);
+#endif
+}
+
+/// an API handler that ignores everything, to time the replay of a plugin's events on its own
+class NullHandler : public OFX::Host::APICache::PluginAPICacheI {
+public :
+  NullHandler() : OFX::Host::APICache::PluginAPICacheI(kOfxImageEffectPluginApi, 1, 1) {}
+
+  void loadFromPlugin(OFX::Host::Plugin *) const {}
+  OFX::Host::Plugin *newPlugin(OFX::Host::PluginBinary *, int, OfxPlugin *) { return 0; }
+  OFX::Host::Plugin *newPlugin(OFX::Host::PluginBinary *, int, const std::string &, int, const std::string &,
+                               const std::string &, int, int) { return 0; }
+  void beginXmlParsing(OFX::Host::Plugin *) {}
+  void xmlElementBegin(const std::string &, std::map<std::string, std::string>) {}
+  void xmlCharacterHandler(const std::string &) {}
+  void xmlElementEnd(const std::string &) {}
+  void endXmlParsing() {}
+  void saveXML(OFX::Host::Plugin *, std::ostream &) const {}
+  void confirmPlugin(OFX::Host::Plugin *) {}
+  bool pluginSupported(OFX::Host::Plugin *, std::string &) const { return true; }
+};
+
+/// The invert plugin's entry in an XML cache, and where in its bundle its binary is,
+/// both empty if it could not be found.
+static void describeInvert(std::string &pluginXML, std::string &binaryDir)
+{
+  MyHost::Host myHost;
+  OFX::Host::ImageEffect::PluginCache imageEffectPluginCache(myHost);
+  OFX::Host::PluginCache::getPluginCache()->setCacheVersion("cacheBenchV1");
+  imageEffectPluginCache.registerInCache(*OFX::Host::PluginCache::getPluginCache());
+  OFX::Host::PluginCache::getPluginCache()->scanPluginFiles();
+
+  OFX::Host::ImageEffect::ImageEffectPlugin *plugin = imageEffectPluginCache.getPluginById("net.sf.openfx.invertPlugin");
+  if(plugin) {
+    std::ostringstream cache;
+    OFX::Host::PluginCache::getPluginCache()->writePluginCache(cache);
+    std::string xml = cache.str();
+    std::string::size_type begin = xml.find("  <plugin name=\"net.sf.openfx.invertPlugin\"");
+    std::string::size_type end = xml.find("</plugin>", begin);
+    if(begin != std::string::npos && end != std::string::npos)
+      pluginXML = xml.substr(begin, end + strlen("</plugin>\n") - begin);
+
+    // the binary's path inside its bundle, eg: Contents/Linux-x86-64
+    const std::string &bundle = plugin->getBinary()->getBundlePath();
+    const std::string &file = plugin->getBinary()->getFilePath();
+    binaryDir = file.substr(bundle.size() + 1, file.find_last_of("/\\") - bundle.size() - 1);
+  }
+  OFX::Host::PluginCache::clearPluginCache();
+}
+
+/// the directories of a synthetic bundle, outermost first
+static std::vector<std::string> bundleDirectories(const std::string &dir, int i, const std::string &binaryDir)
+{
+  std::ostringstream name;
+  name << dir << "/synth" << i << ".ofx.bundle";
+  std::vector<std::string> dirs(1, name.str());
+  std::string::size_type slash = 0;
+  while(slash != std::string::npos) {
+    slash = binaryDir.find_first_of("/\\", slash + 1);
+    dirs.push_back(dirs[0] + "/" + binaryDir.substr(0, slash));
+  }
+  return dirs;
+}
+
+/// the binary of a synthetic bundle
+static std::string binaryPath(const std::string &dir, int i, const std::string &binaryDir)
+{
+  std::ostringstream path;
+  path << dir << "/synth" << i << ".ofx.bundle/" << binaryDir << "/synth" << i << ".ofx";
+  return path.str();
+}
+
+/// make the synthetic bundles and an XML cache describing them
+static bool makeSyntheticPlugins(const std::string &dir, const std::string &pluginXML, const std::string &binaryDir)
+{
+  makeDirectory(dir);
+  std::ofstream cache(kXMLCache);
+  cache << "<cache version=\"cacheBenchV1\">\n";
+  for(int i = 0; i < kPlugins; ++i) {
+    std::vector<std::string> dirs = bundleDirectories(dir, i, binaryDir);
+    for(size_t d = 0; d < dirs.size(); ++d)
+      makeDirectory(dirs[d]);
+
+    std::string binary = binaryPath(dir, i, binaryDir);
+    {
+      std::ofstream dummy(binary.c_str(), std::ios::binary);
+      dummy << std::string(4096, '\0');
+    }
+    struct stat st;
+    if(stat(binary.c_str(), &st) != 0)
+      return false;
+
+    std::ostringstream identifier;
+    identifier << "net.sf.openfx.synth" << i;
+    std::string plugin = pluginXML;
+    std::string::size_type name = plugin.find("net.sf.openfx.invertPlugin");
+    plugin.replace(name, strlen("net.sf.openfx.invertPlugin"), identifier.str());
+
+    cache << "<bundle>\n"
+          << "  <binary bundle_path=\"" << dirs[0] << "\" path=\"" << binary
+          << "\" mtime=\"" << int(st.st_mtime) << "\" size=\"" << int(st.st_size) << "\" />\n"
+          << plugin
+          << "</bundle>\n";
+  }
+  cache << "</cache>\n";
+  return cache.good();
+}
+
+static void removeSyntheticPlugins(const std::string &dir, const std::string &binaryDir)
+{
+  for(int i = 0; i < kPlugins; ++i) {
+    remove(binaryPath(dir, i, binaryDir).c_str());
+    std::vector<std::string> dirs = bundleDirectories(dir, i, binaryDir);
+    for(size_t d = dirs.size(); d-- > 0; )
+      removeDirectory(dirs[d]);
+  }
+  removeDirectory(dir);
+  remove(kXMLCache);
+  remove(kBinaryCache);
+}
+
+/// what one start took, in milliseconds
+struct StartTimes {
+  double start;    ///< reading the cache and scanning the plugin path
+  double decode;   ///< then decoding every plugin's descriptor
+  int    nPlugins; ///< how many plugins the cache had
+};
+
+/// start up from the XML cache, if binary is false, or the binary one, and then decode every plugin
+static StartTimes startUp(bool binary)
+{
+  StartTimes times;
+  MyHost::Host myHost;
+  OFX::Host::ImageEffect::PluginCache imageEffectPluginCache(myHost);
+  OFX::Host::PluginCache *cache = OFX::Host::PluginCache::getPluginCache();
+  cache->setCacheVersion("cacheBenchV1");
+  imageEffectPluginCache.registerInCache(*cache);
+
+  double start = seconds();
+  if(binary) {
+    cache->readBinaryCache(kBinaryCache);
+  }
+  else {
+    std::ifstream xml(kXMLCache);
+    cache->readCache(xml);
+  }
+  cache->scanPluginFiles();
+  if(!binary)
+    cache->writeBinaryCache(kBinaryCache);
+  times.start = 1000 * (seconds() - start);
+
+  start = seconds();
+  const std::vector<OFX::Host::ImageEffect::ImageEffectPlugin *> &plugins = imageEffectPluginCache.getPlugins();
+  for(size_t i = 0; i < plugins.size(); ++i)
+    plugins[i]->getDescriptor();
+  times.decode = 1000 * (seconds() - start);
+  times.nPlugins = int(plugins.size());
+
+  OFX::Host::PluginCache::clearPluginCache();
+  return times;
+}
+
+/// milliseconds to replay every plugin's events from the binary cache into a handler that does nothing
+static double replayAlone()
+{
+  OFX::Host::CacheFile::Reader reader;
+  if(!reader.open(kBinaryCache))
+    return -1;
+  NullHandler handler;
+  double start = seconds();
+  for(unsigned int i = 0; i < reader.getNPlugins(); ++i)
+    reader.replay(reader.getPlugin(i), handler);
+  return 1000 * (seconds() - start);
+}
+
+int main(int argc, char **argv)
+{
+  std::string pluginXML, binaryDir;
+  describeInvert(pluginXML, binaryDir);
+  if(pluginXML.empty()) {
+    printf("could not find the invert plugin, set OFX_PLUGIN_PATH\n");
+    return 1;
+  }
+
+  std::string dir = argc > 1 ? argv[1] : "cacheBenchPlugins";
+  if(!makeSyntheticPlugins(dir, pluginXML, binaryDir)) {
+    printf("could not make the synthetic plugins in %s\n", dir.c_str());
+    removeSyntheticPlugins(dir, binaryDir);
+    return 1;
+  }
+  setPluginPath(dir.c_str());
+
+  double cold = 1e30, warm = 1e30, decode = 1e30, replay = 1e30;
+  int coldPlugins = 0, warmPlugins = 0;
+  for(int run = 0; run < kRuns; ++run) {
+    StartTimes fromXML = startUp(false);
+    StartTimes fromBinary = startUp(true);
+    cold = std::min(cold, fromXML.start);
+    warm = std::min(warm, fromBinary.start);
+    decode = std::min(decode, fromBinary.decode);
+    replay = std::min(replay, replayAlone());
+    coldPlugins = fromXML.nPlugins;
+    warmPlugins = fromBinary.nPlugins;
+  }
+  removeSyntheticPlugins(dir, binaryDir);
+
+  bool ok = coldPlugins == kPlugins && warmPlugins == kPlugins && replay >= 0;
+  if(!ok) {
+    printf("FAILED the caches had %d and %d plugins, not %d\n", coldPlugins, warmPlugins, kPlugins);
+    return 1;
+  }
+
+  printf("%d plugins, best of %d runs\n", kPlugins, kRuns);
+  printf("cold start, from the XML cache  : %8.2f ms\n", cold);
+  printf("warm start, from the binary one : %8.2f ms\n", warm);
+  printf("decoding every descriptor       : %8.2f ms, %.1f us each\n", decode, 1000 * decode / kPlugins);
+  printf("  of which replaying the events : %8.2f ms, %.0f%%\n", replay, 100 * replay / decode);
+  return 0;
+}
@@ -0,0 +1,138 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+////////////////////////////////////////////////////////////////////////////////
+/// Benchmark of half float against float pixels. Times the invert and blend
+/// kernels of ofxsPixelKernels.H over an HD RGBA frame of each, with the best
+/// instruction set this CPU has, along with converting a frame between the two,
+/// and reports the time a frame, the megabytes it reads and writes, and the rate
+/// that moves them at. Halves are worked on as floats, so a half frame costs the
+/// same arithmetic as a float one for half the memory traffic.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <algorithm>
+
+#if defined(WINDOWS)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "ofxsPixelKernels.H"
+
+using namespace OFX::Kernels;
+
+static const int kWidth = 1920;
+static const int kHeight = 1080;
+static const int kComponents = 4;
+static const int kRowLength = kWidth * kComponents;
+static const size_t kFrameComponents = size_t(kRowLength) * kHeight;
+static const int kRuns = 10;
+
+/// wall clock seconds
+static double seconds()
+{
+#if defined(WINDOWS)
+  LARGE_INTEGER now, frequency;
+  QueryPerformanceCounter(&now);
+  QueryPerformanceFrequency(&frequency);
+  return double(now.QuadPart) / double(frequency.QuadPart);
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+/// the frames the kernels run over, the source ones filled with values a little beyond 0..1
+struct Frames {
+  std::vector<float>     fromF, toF, dstF;
+  std::vector<OFX::Half> fromH, toH, dstH;
+
+  Frames()
+    : fromF(kFrameComponents), toF(kFrameComponents), dstF(kFrameComponents)
+    , fromH(kFrameComponents), toH(kFrameComponents), dstH(kFrameComponents)
+  {
+    for(size_t i = 0; i < kFrameComponents; ++i) {
+      fromF[i] = float(rand()) / float(RAND_MAX) * 1.2f - 0.1f;
+      toF[i] = float(rand()) / float(RAND_MAX) * 1.2f - 0.1f;
+      fromH[i] = fromF[i];
+      toH[i] = toF[i];
+    }
+  }
+};
+
+enum Job { eInvertFloat, eInvertHalf, eBlendFloat, eBlendHalf, eHalfToFloat, eFloatToHalf };
+
+/// run a job over a frame a row at a time
+static void run(Frames &f, Job job)
+{
+  for(int y = 0; y < kHeight; ++y) {
+    size_t row = size_t(y) * kRowLength;
+    switch(job) {
+      case eInvertFloat : invertRow(&f.fromF[row], &f.dstF[row], kRowLength); break;
+      case eInvertHalf  : invertRow(&f.fromH[row], &f.dstH[row], kRowLength); break;
+      case eBlendFloat  : blendRow(&f.fromF[row], &f.toF[row], &f.dstF[row], kRowLength, 0.3f); break;
+      case eBlendHalf   : blendRow(&f.fromH[row], &f.toH[row], &f.dstH[row], kRowLength, 0.3f); break;
+      case eHalfToFloat : convertRow(&f.fromH[row], &f.dstF[row], kRowLength); break;
+      case eFloatToHalf : convertRow(&f.fromF[row], &f.dstH[row], kRowLength); break;
+    }
+  }
+}
+
+/// time a job, best of several frames, and print it with the bytes it moves
+static void bench(Frames &f, Job job, const char *name, size_t bytesPerComponent)
+{
+  double fastest = 1e30;
+  for(int i = 0; i < kRuns; ++i) {
+    double start = seconds();
+    run(f, job);
+    fastest = std::min(fastest, seconds() - start);
+  }
+  double mb = kFrameComponents * bytesPerComponent / 1e6;
+  printf("%-14s : %6.2f ms a frame, %5.1f MB moved, %5.1f GB/s\n", name, fastest * 1e3, mb, mb / fastest * 1e-3);
+}
+
+int main(int argc, char **argv)
+{
+  static const char * const instructionSetNames[] = { "scalar", "SSE2", "AVX2", "AVX-512" };
+  printf("%dx%d RGBA with %s kernels, best of %d\n", kWidth, kHeight, instructionSetNames[getInstructionSet()], kRuns);
+
+  Frames f;
+  const size_t F = sizeof(float), H = sizeof(OFX::Half);
+  bench(f, eInvertFloat, "invert float", F + F);
+  bench(f, eInvertHalf,  "invert half",  H + H);
+  bench(f, eBlendFloat,  "blend float",  F + F + F);
+  bench(f, eBlendHalf,   "blend half",   H + H + H);
+  bench(f, eHalfToFloat, "half to float", H + F);
+  bench(f, eFloatToHalf, "float to half", F + H);
+  return 0;
+}
@@ -31,6 +31,7 @@ modification, are permitted provided that the following conditions are met:
 #include <iostream>
 #include <fstream>
 #include <cassert>
+#include <vector>
 
 // ofx
 #include "ofxCore.h"
@@ -48,6 +49,7 @@ modification, are permitted provided that the following conditions are met:
 #include "ofxhPluginCache.h"
 #include "ofxhHost.h"
 #include "ofxhImageEffectAPI.h"
+#include "ofxhRenderDriver.h"
 
 // my host
 #include "hostDemoHostDescriptor.h"
@@ -78,21 +80,83 @@ void exportToPPM(const std::string& fname, MyHost::MyImage* im)
   op << "P3" << "\t# FORMAT" << std::endl;
   op << rod.x2 - rod.x1 << "\t#WIDTH" << std::endl;
   op << rod.y2 - rod.y1 << "\t#HEIGHT" <<std::endl;
-  //This assumes 8-bit.
+  // the image is at whatever depth the plugin asked for, so bring it back to 8-bit RGBA
   op << "255" << std::endl;
-  for (int y = rod.y1; y< rod.y2; ++y)
+  std::vector<OfxRGBAColourB> pixels((rod.x2 - rod.x1) * (rod.y2 - rod.y1));
+  OFX::PixelConverter::Buffer rgba = {&pixels[0], rod, int((rod.x2 - rod.x1) * sizeof(OfxRGBAColourB)),
+                                      OFX::PixelConverter::eDepthByte, 4};
+  OFX::PixelConverter::convert(im->getBuffer(), rgba, rod);
+  for(size_t i = 0; i < pixels.size(); ++i)
   {
-    for (int x = rod.x1; x < rod.x2; ++x)
-    {
-      OfxRGBAColourB* pix = im->pixel(x,y);
-      if(pix)
-        op << (int)pix->r << " " << (int)pix->g << " " << (int)pix->b << " " << std::endl;
-      else
-        op << "0 0 0" << std::endl;
-    }
+    const OfxRGBAColourB &pix = pixels[i];
+    op << (int)pix.r << " " << (int)pix.g << " " << (int)pix.b << " " << std::endl;
   }
 }
 
+/// How the render driver renders a frame on our host, and makes extra instances if
+/// the plugin wants one per render thread.
+class MyRenderClient : public OFX::Host::ImageEffect::RenderDriver::Client {
+protected :
+  OfxPointD  _renderScale;
+  OfxRectI   _renderWindow;
+  OfxRectD   _regionOfInterest;
+
+public :
+  MyRenderClient(OfxPointD renderScale, const OfxRectI &renderWindow, const OfxRectD &regionOfInterest)
+    : _renderScale(renderScale)
+    , _renderWindow(renderWindow)
+    , _regionOfInterest(regionOfInterest)
+  {
+  }
+
+  virtual OFX::Host::ImageEffect::Instance *cloneInstance(OFX::Host::ImageEffect::Instance &original)
+  {
+    // our params are all at their defaults, so a fresh instance matches the original
+    OFX::Host::ImageEffect::Instance *instance = original.getPlugin()->createInstance(original.getContext(), NULL);
+    if(instance) {
+      OfxStatus stat = instance->createInstanceAction();
+      if((stat != kOfxStatOK && stat != kOfxStatReplyDefault) || !instance->getClipPreferences()) {
+        delete instance;
+        return NULL;
+      }
+    }
+    return instance;
+  }
+
+  virtual OfxStatus renderFrame(OFX::Host::ImageEffect::Instance &instance, OfxTime frame, bool sequential, bool interactive)
+  {
+    // get the RoI for each input clip
+    // the regions of interest for each input clip are returned in a std::map
+    // on a real host, these will be the regions of each input clip that the
+    // effect needs to render a given frame (clipped to the RoD).
+    //
+    // In our example we are doing full frame fetches regardless.
+    std::map<OFX::Host::ImageEffect::ClipInstance *, OfxRectD> rois;
+    OfxStatus stat = instance.getRegionOfInterestAction(frame, _renderScale, _regionOfInterest, rois);
+    if(stat != kOfxStatOK && stat != kOfxStatReplyDefault)
+      return stat;
+
+    // render a frame
+    stat = instance.renderAction(frame, kOfxImageFieldBoth, _renderWindow, _renderScale, sequential, interactive, /*draft=*/false);
+    if(stat != kOfxStatOK)
+      return stat;
+
+    // get the output image buffer for that frame
+    MyHost::MyClipInstance* outputClip = dynamic_cast<MyHost::MyClipInstance*>(instance.getClip("Output"));
+    MyHost::MyImage *outputImage = outputClip ? outputClip->getOutputImage(frame) : NULL;
+    if(!outputImage)
+      return kOfxStatFailed;
+
+    std::ostringstream ss;
+    ss << "Output." << frame << ".ppm";
+    exportToPPM(ss.str(), outputImage);
+
+    // it is written out, so we have no more use for it
+    outputClip->releaseOutputImage(frame);
+    return kOfxStatOK;
+  }
+};
+
 int main(int argc, char **argv) 
 {
   //_CrtSetBreakAlloc(3168);
@@ -114,19 +178,34 @@ int main(int argc, char **argv)
   // register the image effect cache with the global plugin cache
   imageEffectPluginCache.registerInCache(*OFX::Host::PluginCache::getPluginCache());
 
-  // try to read an old cache
-  std::ifstream ifs("hostDemoPluginCache.xml");
-  OFX::Host::PluginCache::getPluginCache()->readCache(ifs);
+  // load and describe any new plugins on all our CPUs
+  OFX::Host::PluginCache::getPluginCache()->setParallelScan(true);
+
+  // and do that in hostDemoDescribe processes, so a bad plugin can't take us down with it
+  std::string helper = argv[0];
+  std::string::size_type slash = helper.find_last_of("/\\");
+  helper = (slash == std::string::npos ? std::string(".") : helper.substr(0, slash)) + "/hostDemoDescribe";
+  OFX::Host::PluginCache::getPluginCache()->setDescribeHelper(helper);
+
+  // try to read an old cache, the binary one is much quicker to load, but fall back to the XML one
+  bool haveBinaryCache = OFX::Host::PluginCache::getPluginCache()->readBinaryCache("hostDemoPluginCache.bin");
+  if(!haveBinaryCache) {
+    std::ifstream ifs("hostDemoPluginCache.xml");
+    OFX::Host::PluginCache::getPluginCache()->readCache(ifs);
+    ifs.close();
+  }
   OFX::Host::PluginCache::getPluginCache()->scanPluginFiles();
-  ifs.close();
 
-  /// flush out the current cache
-  std::ofstream of("hostDemoPluginCache.xml");
-  OFX::Host::PluginCache::getPluginCache()->writePluginCache(of);
-  of.close();
+  /// flush out the current cache if it has changed, writing the XML one means decoding every plugin in it
+  if(OFX::Host::PluginCache::getPluginCache()->dirty() || !haveBinaryCache) {
+    std::ofstream of("hostDemoPluginCache.xml");
+    OFX::Host::PluginCache::getPluginCache()->writePluginCache(of);
+    of.close();
+    OFX::Host::PluginCache::getPluginCache()->writeBinaryCache("hostDemoPluginCache.bin");
+  }
 
   // get the invert example plugin which uses the OFX C++ support code
-  OFX::Host::ImageEffect::ImageEffectPlugin* plugin = imageEffectPluginCache.getPluginById("net.sf.openfx:invertPlugin");
+  OFX::Host::ImageEffect::ImageEffectPlugin* plugin = imageEffectPluginCache.getPluginById("net.sf.openfx.invertPlugin");
 
   imageEffectPluginCache.dumpToStdOut();
 
@@ -170,45 +249,14 @@ int main(int argc, char **argv)
       
       int numFramesToRender = OFXHOSTDEMOCLIPLENGTH;
 
-      // say we are about to render a bunch of frames 
-      stat = instance->beginRenderAction(0, numFramesToRender, 1.0, false, renderScale, /*sequential=*/true, /*interactive=*/false
-                                         );
-      assert(stat == kOfxStatOK || stat == kOfxStatReplyDefault);
-
-      // get the output clip
-      MyHost::MyClipInstance* outputClip = dynamic_cast<MyHost::MyClipInstance*>(instance->getClip("Output"));
-      assert(outputClip);
-
-      for(int t = 0; t <= numFramesToRender; ++t) 
-      {
-        // call get region of interest on each of the inputs
-        OfxTime frame = t;
-
-        // get the RoI for each input clip
-        // the regions of interest for each input clip are returned in a std::map
-        // on a real host, these will be the regions of each input clip that the
-        // effect needs to render a given frame (clipped to the RoD).
-        //
-        // In our example we are doing full frame fetches regardless.
-        std::map<OFX::Host::ImageEffect::ClipInstance *, OfxRectD> rois;
-        stat = instance->getRegionOfInterestAction(frame, renderScale,
-                                                   regionOfInterest, rois);
-        assert(stat == kOfxStatOK || stat == kOfxStatReplyDefault);
-
-        // render a frame
-        stat = instance->renderAction(t,kOfxImageFieldBoth,renderWindow, renderScale, /*sequential=*/true, /*interactive=*/false, /*draft=*/false);
-        assert(stat == kOfxStatOK);
-
-        // get the output image buffer
-        MyHost::MyImage *outputImage = outputClip->getOutputImage();
-
-        std::ostringstream ss;
-        ss << "Output." << t << ".ppm";
-        exportToPPM(ss.str(), outputImage);
-      }
+      // render the frames, several at once if the plugin allows it
+      MyRenderClient client(renderScale, renderWindow, regionOfInterest);
+      OFX::Host::ImageEffect::RenderDriver driver(*instance, client);
+      stat = driver.render(0, numFramesToRender, 1.0, renderScale, /*interactive=*/false);
+      assert(stat == kOfxStatOK);
 
-      instance->endRenderAction(0, numFramesToRender, 1.0, false, renderScale, /*sequential=*/true, /*interactive=*/false
-                                );
+      // if the image memory ran short during the render, have the plugins drop their caches now
+      OFX::Host::ImageEffect::purgeCachesUnderPressure();
     }
   }
   OFX::Host::PluginCache::clearPluginCache();
@@ -148,15 +148,16 @@ namespace MyHost {
     : OFX::Host::ImageEffect::Image(clip) /// this ctor will set basic props on the image
     , _data(NULL)
   {
-    // make some memory
-    _data = new OfxRGBAColourB[kPalSizeXPixels * kPalSizeYPixels] ; /// PAL SD RGBA
-    
+    // make some memory, we make our images up as 8 bit RGBA
+    char *rgbaData = new char[kPalSizeXPixels * kPalSizeYPixels * sizeof(OfxRGBAColourB)] ; /// PAL SD RGBA
+    OfxRGBAColourB *rgba = (OfxRGBAColourB *) rgbaData;
+
     int fillValue = (int)(floor(255.0 * (time/OFXHOSTDEMOCLIPLENGTH))) & 0xff;
     OfxRGBAColourB color;
     color.r = color.g = color.b = fillValue;
     color.a = 255;
 
-    std::fill(_data, _data + kPalSizeXPixels * kPalSizeYPixels, color);
+    std::fill(rgba, rgba + kPalSizeXPixels * kPalSizeYPixels, color);
     // draw the time and the view number in reverse color
     const int scale = 5;
     const int charwidth = 4*scale;
@@ -165,20 +166,38 @@ namespace MyHost {
     int yy = 50;
     int d;
     d = (int(time)/10)%10;
-    drawDigit(_data, kPalSizeXPixels, kPalSizeYPixels, d, xx, yy, scale, color);
+    drawDigit(rgba, kPalSizeXPixels, kPalSizeYPixels, d, xx, yy, scale, color);
     xx += charwidth;
     d = int(time)%10;
-    drawDigit(_data, kPalSizeXPixels, kPalSizeYPixels, d, xx, yy, scale, color);
+    drawDigit(rgba, kPalSizeXPixels, kPalSizeYPixels, d, xx, yy, scale, color);
     xx += charwidth;
     d = 10;
-    drawDigit(_data, kPalSizeXPixels, kPalSizeYPixels, d, xx, yy, scale, color);
+    drawDigit(rgba, kPalSizeXPixels, kPalSizeYPixels, d, xx, yy, scale, color);
     xx += charwidth;
     d = int(time*10)%10;
-    drawDigit(_data, kPalSizeXPixels, kPalSizeYPixels, d, xx, yy, scale, color);
+    drawDigit(rgba, kPalSizeXPixels, kPalSizeYPixels, d, xx, yy, scale, color);
     xx = 50;
     yy += 8*scale;
     d = int(view)%10;
-    drawDigit(_data, kPalSizeXPixels, kPalSizeYPixels, d, xx, yy, scale, color);
+    drawDigit(rgba, kPalSizeXPixels, kPalSizeYPixels, d, xx, yy, scale, color);
+
+    // the clip preferences may have mapped the clip to another depth or components, if so remap our pixels to those
+    OFX::PixelConverter::Buffer native = {rgba, kPalRegionPixels, int(kPalSizeXPixels * sizeof(OfxRGBAColourB)),
+                                          OFX::PixelConverter::eDepthByte, 4};
+    _buffer = native;
+    _buffer.depth = OFX::PixelConverter::depthFromString(getStringProperty(kOfxImageEffectPropPixelDepth));
+    _buffer.nComponents = OFX::PixelConverter::componentsFromString(getStringProperty(kOfxImageEffectPropComponents));
+    if(_buffer.depth == OFX::PixelConverter::eDepthNone || _buffer.nComponents == 0 ||
+       (_buffer.depth == native.depth && _buffer.nComponents == native.nComponents)) {
+      _buffer = native;
+      _data = rgbaData;
+    }
+    else {
+      _buffer.rowBytes = kPalSizeXPixels * _buffer.nComponents * OFX::PixelConverter::bytesPerComponent(_buffer.depth);
+      _buffer.data = _data = new char[kPalSizeYPixels * _buffer.rowBytes];
+      OFX::PixelConverter::convert(native, _buffer, kPalRegionPixels);
+      delete [] rgbaData;
+    }
 
     // render scale x and y of 1.0
     setDoubleProperty(kOfxImageEffectPropRenderScale, 1.0, 0);
@@ -192,45 +211,62 @@ namespace MyHost {
     setIntProperty(kOfxImagePropBounds, kPalRegionPixels.y1, 1);
     setIntProperty(kOfxImagePropBounds, kPalRegionPixels.x2, 2);
     setIntProperty(kOfxImagePropBounds, kPalRegionPixels.y2, 3);
-    
+
     setIntProperty(kOfxImagePropRegionOfDefinition, kPalRegionPixels.x1, 0);
     setIntProperty(kOfxImagePropRegionOfDefinition, kPalRegionPixels.y1, 1);
     setIntProperty(kOfxImagePropRegionOfDefinition, kPalRegionPixels.x2, 2);
     setIntProperty(kOfxImagePropRegionOfDefinition, kPalRegionPixels.y2, 3);        
 
     // row bytes
-    setIntProperty(kOfxImagePropRowBytes, kPalSizeXPixels * sizeof(OfxRGBAColourB));
-  }
-
-  OfxRGBAColourB* MyImage::pixel(int x, int y) const
-  {
-    OfxRectI bounds = getBounds();
-    if ((x >= bounds.x1) && ( x< bounds.x2) && ( y >= bounds.y1) && ( y < bounds.y2) )
-    {
-      int rowBytes = getIntProperty(kOfxImagePropRowBytes);
-      int offset = (y - bounds.y1) * rowBytes + (x - bounds.x1) * sizeof(OfxRGBAColourB);
-      return reinterpret_cast<OfxRGBAColourB*>(&(reinterpret_cast<char*>(_data)[offset]));
-    }
-    return 0;
+    setIntProperty(kOfxImagePropRowBytes, _buffer.rowBytes);
   }
 
   MyImage::~MyImage() 
   {
-    delete _data;
+    delete [] _data;
   }
 
   MyClipInstance::MyClipInstance(MyEffectInstance* effect, OFX::Host::ImageEffect::ClipDescriptor *desc)
     : OFX::Host::ImageEffect::ClipInstance(effect, *desc)
     , _effect(effect)
     , _name(desc->getName())
-    , _outputImage(NULL)
   {
   }
 
+  OFX::Host::ImageEffect::ImageCache &getImageCache()
+  {
+    // 64MB is enough for a few dozen of our PAL frames at any depth
+    static OFX::Host::ImageEffect::ImageCache cache(64 * 1024 * 1024);
+    return cache;
+  }
+
   MyClipInstance::~MyClipInstance()
   {
-    if(_outputImage)
-      _outputImage->releaseReference();
+    // the cache keys frames by their clip, so drop ours before we go
+    getImageCache().invalidate(this);
+    for(std::map<OfxTime, MyImage *>::iterator i = _outputImages.begin(); i != _outputImages.end(); ++i)
+      i->second->releaseReference();
+  }
+
+  MyImage* MyClipInstance::getOutputImage(OfxTime time)
+  {
+    OFX::Host::Thread::AutoMutex lock(_outputLock);
+    std::map<OfxTime, MyImage *>::iterator i = _outputImages.find(time);
+    return i == _outputImages.end() ? NULL : i->second;
+  }
+
+  void MyClipInstance::releaseOutputImage(OfxTime time)
+  {
+    MyImage *image = NULL;
+    {
+      OFX::Host::Thread::AutoMutex lock(_outputLock);
+      std::map<OfxTime, MyImage *>::iterator i = _outputImages.find(time);
+      if(i == _outputImages.end())
+        return;
+      image = i->second;
+      _outputImages.erase(i);
+    }
+    image->releaseReference();
   }
    
   /// Get the Raw Unmapped Pixel Depth from the host. We are always 8 bits in our example
@@ -354,28 +390,37 @@ namespace MyHost {
   OFX::Host::ImageEffect::Image* MyClipInstance::getImage(OfxTime time, const OfxRectD *optionalBounds)
   {
     if(_name == "Output") {
-      if(!_outputImage) {
+      // several frames may be rendering at once, so keep an image per frame
+      OFX::Host::Thread::AutoMutex lock(_outputLock);
+      MyImage *&outputImage = _outputImages[time];
+      if(!outputImage) {
         // make a new ref counted image
-        _outputImage = new MyImage(*this, 0);
+        outputImage = new MyImage(*this, time);
       }
      
       // add another reference to the member image for this fetch
       // as we have a ref count of 1 due to construction, this will
       // cause the output image never to delete by the plugin
       // when it releases the image
-      _outputImage->addReference();
+      outputImage->addReference();
 
       // return it
-      return _outputImage;
+      return outputImage;
     }
     else {
-      // Fetch on demand for the input clip.
-      // It does get deleted after the plugin is done with it as we
-      // have not incremented the auto ref
-      // 
-      // You should do somewhat more sophisticated image management
-      // than this.
-      MyImage *image = new MyImage(*this, time);
+      // Fetch input frames through the cache, the same frame fetched at the same
+      // depth and components is only made once. The image we hand back carries a
+      // reference for the plugin, which it drops when it releases the image, the
+      // cache keeps its own.
+      OfxPointD renderScale = {1, 1};
+      OFX::Host::ImageEffect::ImageCache::Key key(_effect, this, time, kOfxImageFieldNone, renderScale,
+                                                  getPixelDepth(), getComponents(), 0);
+      OFX::Host::ImageEffect::ImageCache &cache = getImageCache();
+      OFX::Host::ImageEffect::Image *image = cache.find(key, kPalRegionPixels);
+      if(!image) {
+        image = new MyImage(*this, time);
+        cache.insert(key, image);
+      }
       return image;
     }
   }
@@ -30,6 +30,9 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef HOST_DEMO_CLIP_INSTANCE_H
 #define HOST_DEMO_CLIP_INSTANCE_H
 
+#include "ofxsPixelConverter.H"
+#include "ofxhImageCache.h"
+
 #define OFXHOSTDEMOCLIPLENGTH 1.0
 
 namespace MyHost {
@@ -37,14 +40,19 @@ namespace MyHost {
   // foward
   class MyClipInstance;
 
+  /// the cache input clips keep their frames in, so an effect fetching the same frame twice gets it made once
+  OFX::Host::ImageEffect::ImageCache &getImageCache();
+
   /// make an image up
   class MyImage : public OFX::Host::ImageEffect::Image 
   {
   protected :
-    OfxRGBAColourB   *_data; // where we are keeping our image data
+    char                        *_data;   // where we are keeping our image data
+    OFX::PixelConverter::Buffer  _buffer; // what that data is, at the depth and components the clip was mapped to
   public :
     explicit MyImage(MyClipInstance &clip, OfxTime t, int view = 0);
-    OfxRGBAColourB* pixel(int x, int y) const;
+    /// our pixels, for the pixel converter to read
+    const OFX::PixelConverter::Buffer &getBuffer() const { return _buffer; }
     ~MyImage();
   };
 
@@ -52,13 +60,18 @@ namespace MyHost {
   protected:
     MyEffectInstance *_effect;
     std::string       _name;
-    MyImage          *_outputImage; ///< only set for output clips
+    OFX::Host::Thread::Mutex     _outputLock;   ///< guards _outputImages, frames may render concurrently
+    std::map<OfxTime, MyImage *> _outputImages; ///< only set for output clips, one image per frame
 
   public:
     MyClipInstance(MyEffectInstance* effect, OFX::Host::ImageEffect::ClipDescriptor* desc);
 
     virtual ~MyClipInstance();
-    MyImage* getOutputImage() { return _outputImage; }
+    /// get the image rendered at the given time, NULL if there is none
+    MyImage* getOutputImage(OfxTime time);
+
+    /// let go of the image rendered at the given time, once we are done with it
+    void releaseOutputImage(OfxTime time);
 
     /// Get the Raw Unmapped Pixel Depth from the host
     ///
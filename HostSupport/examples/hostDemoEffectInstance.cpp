@@ -40,6 +40,9 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ofxhPropertySuite.h"
 #include "ofxhClip.h"
 #include "ofxhParam.h"
+#ifdef OFX_SUPPORTS_PARAMETRIC
+#include "ofxhParametricParam.h"
+#endif
 #include "ofxhMemory.h"
 #include "ofxhImageEffect.h"
 #include "ofxhPluginAPICache.h"
@@ -186,6 +189,14 @@ namespace MyHost {
       return new OFX::Host::Param::GroupInstance(descriptor,this);
     else if(descriptor.getType()==kOfxParamTypePage)
       return new OFX::Host::Param::PageInstance(descriptor,this);
+#ifdef OFX_SUPPORTS_PARAMETRIC
+    else if(descriptor.getType()==kOfxParamTypeParametric) {
+      // curves are evaluated per pixel, so have them tabulated
+      OFX::Host::ParametricParam::ParametricInstance *param = new OFX::Host::ParametricParam::ParametricInstance(descriptor,this);
+      param->useLookupTables(4096);
+      return param;
+    }
+#endif
     else
       return 0;
   }
@@ -29,6 +29,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <iostream>
 #include <fstream>
+#include <vector>
+#include <cmath>
 
 // ofx
 #include "ofxCore.h"
@@ -55,6 +57,30 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace MyHost {
 
+  // Our numeric params keep their values in the host support library's animation engine.
+  // Setting a value without a time keys it at the current time if the param is animating.
+
+  static void setDefaults(OFX::Host::Param::Animation &animation, OFX::Host::Property::Set &properties, bool isInt)
+  {
+    std::vector<double> values(animation.getNumDimensions());
+    for(int i = 0; i < int(values.size()); i++)
+      values[i] = isInt ? properties.getIntProperty(kOfxParamPropDefault, i) : properties.getDoubleProperty(kOfxParamPropDefault, i);
+    animation.setValue(&values[0]);
+  }
+
+  static void setValue(OFX::Host::Param::Animation &animation, OfxTime now, const double *values)
+  {
+    if(animation.getNumKeys() > 0)
+      animation.setKey(now, values);
+    else
+      animation.setValue(values);
+  }
+
+  static int toInt(double v)
+  {
+    return int(floor(v + 0.5));
+  }
+
   //
   // MyIntegerInstance
   //
@@ -64,25 +90,35 @@ namespace MyHost {
                                        OFX::Host::Param::Descriptor& descriptor)
     : _effect(effect), _descriptor(descriptor), OFX::Host::Param::IntegerInstance(descriptor)
   {
+    useAnimation(1);
+    setDefaults(_animation, getProperties(), true);
   }
 
-  OfxStatus MyIntegerInstance::get(int&)
+  OfxStatus MyIntegerInstance::get(int& v)
   {
-    return kOfxStatErrMissingHostFeature;
+    return get(_effect->timeLineGetTime(), v);
   }
 
-  OfxStatus MyIntegerInstance::get(OfxTime time, int&)
+  OfxStatus MyIntegerInstance::get(OfxTime time, int& v)
   {
-    return kOfxStatErrMissingHostFeature;
+    double values[1];
+    readAnimation().getValue(time, values);
+    v = toInt(values[0]);
+    return kOfxStatOK;
   }
 
-  OfxStatus MyIntegerInstance::set(int)
+  OfxStatus MyIntegerInstance::set(int v)
   {
-    return kOfxStatErrMissingHostFeature;
+    double values[1] = {double(v)};
+    setValue(_animation, _effect->timeLineGetTime(), values);
+    return kOfxStatOK;
   }
 
-  OfxStatus MyIntegerInstance::set(OfxTime time, int) {
-    return kOfxStatErrMissingHostFeature;
+  OfxStatus MyIntegerInstance::set(OfxTime time, int v)
+  {
+    double values[1] = {double(v)};
+    _animation.setKey(time, values);
+    return kOfxStatOK;
   }
 
   //
@@ -94,40 +130,35 @@ namespace MyHost {
                                      OFX::Host::Param::Descriptor& descriptor)
     : _effect(effect), _descriptor(descriptor), OFX::Host::Param::DoubleInstance(descriptor)
   {
+    useAnimation(1);
+    setDefaults(_animation, getProperties(), false);
   }
 
-  OfxStatus MyDoubleInstance::get(double& d)
+  OfxStatus MyDoubleInstance::get(double& v)
   {
-    // values for the Basic OFX plugin to work
-    d = 2.0;
-    return kOfxStatOK;
+    return get(_effect->timeLineGetTime(), v);
   }
 
-  OfxStatus MyDoubleInstance::get(OfxTime time, double& d)
+  OfxStatus MyDoubleInstance::get(OfxTime time, double& v)
   {
-    // values for the Basic OFX plugin to work
-    d = 2.0;
+    double values[1];
+    readAnimation().getValue(time, values);
+    v = values[0];
     return kOfxStatOK;
   }
 
-  OfxStatus MyDoubleInstance::set(double)
-  {
-    return kOfxStatErrMissingHostFeature;
-  }
-
-  OfxStatus MyDoubleInstance::set(OfxTime time, double) 
+  OfxStatus MyDoubleInstance::set(double v)
   {
-    return kOfxStatErrMissingHostFeature;
-  }
-
-  OfxStatus MyDoubleInstance::derive(OfxTime time, double&)
-  {
-    return kOfxStatErrMissingHostFeature;
+    double values[1] = {v};
+    setValue(_animation, _effect->timeLineGetTime(), values);
+    return kOfxStatOK;
   }
 
-  OfxStatus MyDoubleInstance::integrate(OfxTime time1, OfxTime time2, double&)
+  OfxStatus MyDoubleInstance::set(OfxTime time, double v)
   {
-    return kOfxStatErrMissingHostFeature;
+    double values[1] = {v};
+    _animation.setKey(time, values);
+    return kOfxStatOK;
   }
 
   //
@@ -202,26 +233,38 @@ namespace MyHost {
                                  OFX::Host::Param::Descriptor& descriptor)
     : _effect(effect), _descriptor(descriptor), OFX::Host::Param::RGBAInstance(descriptor)
   {
+    useAnimation(4);
+    setDefaults(_animation, getProperties(), false);
   }
 
-  OfxStatus MyRGBAInstance::get(double&,double&,double&,double&)
+  OfxStatus MyRGBAInstance::get(double& r,double& g,double& b,double& a)
   {
-    return kOfxStatErrMissingHostFeature;
+    return get(_effect->timeLineGetTime(), r, g, b, a);
   }
 
-  OfxStatus MyRGBAInstance::get(OfxTime time, double&,double&,double&,double&)
+  OfxStatus MyRGBAInstance::get(OfxTime time, double& r,double& g,double& b,double& a)
   {
-    return kOfxStatErrMissingHostFeature;
+    double values[4];
+    readAnimation().getValue(time, values);
+    r = values[0];
+    g = values[1];
+    b = values[2];
+    a = values[3];
+    return kOfxStatOK;
   }
 
-  OfxStatus MyRGBAInstance::set(double,double,double,double)
+  OfxStatus MyRGBAInstance::set(double r,double g,double b,double a)
   {
-    return kOfxStatErrMissingHostFeature;
+    double values[4] = {r, g, b, a};
+    setValue(_animation, _effect->timeLineGetTime(), values);
+    return kOfxStatOK;
   }
 
-  OfxStatus MyRGBAInstance::set(OfxTime time, double,double,double,double)
+  OfxStatus MyRGBAInstance::set(OfxTime time, double r,double g,double b,double a)
   {
-    return kOfxStatErrMissingHostFeature;
+    double values[4] = {r, g, b, a};
+    _animation.setKey(time, values);
+    return kOfxStatOK;
   }
 
   //
@@ -233,26 +276,37 @@ namespace MyHost {
                                OFX::Host::Param::Descriptor& descriptor)
     : _effect(effect), _descriptor(descriptor), OFX::Host::Param::RGBInstance(descriptor)
   {
+    useAnimation(3);
+    setDefaults(_animation, getProperties(), false);
   }
 
-  OfxStatus MyRGBInstance::get(double&,double&,double&)
+  OfxStatus MyRGBInstance::get(double& r,double& g,double& b)
   {
-    return kOfxStatErrMissingHostFeature;
+    return get(_effect->timeLineGetTime(), r, g, b);
   }
 
-  OfxStatus MyRGBInstance::get(OfxTime time, double&,double&,double&)
+  OfxStatus MyRGBInstance::get(OfxTime time, double& r,double& g,double& b)
   {
-    return kOfxStatErrMissingHostFeature;
+    double values[3];
+    readAnimation().getValue(time, values);
+    r = values[0];
+    g = values[1];
+    b = values[2];
+    return kOfxStatOK;
   }
 
-  OfxStatus MyRGBInstance::set(double,double,double)
+  OfxStatus MyRGBInstance::set(double r,double g,double b)
   {
-    return kOfxStatErrMissingHostFeature;
+    double values[3] = {r, g, b};
+    setValue(_animation, _effect->timeLineGetTime(), values);
+    return kOfxStatOK;
   }
 
-  OfxStatus MyRGBInstance::set(OfxTime time, double,double,double)
+  OfxStatus MyRGBInstance::set(OfxTime time, double r,double g,double b)
   {
-    return kOfxStatErrMissingHostFeature;
+    double values[3] = {r, g, b};
+    _animation.setKey(time, values);
+    return kOfxStatOK;
   }
 
   //
@@ -264,26 +318,36 @@ namespace MyHost {
                                          OFX::Host::Param::Descriptor& descriptor)
     : _effect(effect), _descriptor(descriptor), OFX::Host::Param::Double2DInstance(descriptor)
   {
+    useAnimation(2);
+    setDefaults(_animation, getProperties(), false);
   }
 
-  OfxStatus MyDouble2DInstance::get(double&,double&)
+  OfxStatus MyDouble2DInstance::get(double& x,double& y)
   {
-    return kOfxStatErrMissingHostFeature;
+    return get(_effect->timeLineGetTime(), x, y);
   }
 
-  OfxStatus MyDouble2DInstance::get(OfxTime time,double&,double&)
+  OfxStatus MyDouble2DInstance::get(OfxTime time, double& x,double& y)
   {
-    return kOfxStatErrMissingHostFeature;
+    double values[2];
+    readAnimation().getValue(time, values);
+    x = values[0];
+    y = values[1];
+    return kOfxStatOK;
   }
 
-  OfxStatus MyDouble2DInstance::set(double,double)
+  OfxStatus MyDouble2DInstance::set(double x,double y)
   {
-    return kOfxStatErrMissingHostFeature;
+    double values[2] = {x, y};
+    setValue(_animation, _effect->timeLineGetTime(), values);
+    return kOfxStatOK;
   }
 
-  OfxStatus MyDouble2DInstance::set(OfxTime time,double,double)
+  OfxStatus MyDouble2DInstance::set(OfxTime time, double x,double y)
   {
-    return kOfxStatErrMissingHostFeature;
+    double values[2] = {x, y};
+    _animation.setKey(time, values);
+    return kOfxStatOK;
   }
 
   //
@@ -295,26 +359,36 @@ namespace MyHost {
                                            OFX::Host::Param::Descriptor& descriptor)
     : _effect(effect), _descriptor(descriptor), OFX::Host::Param::Integer2DInstance(descriptor)
   {
+    useAnimation(2);
+    setDefaults(_animation, getProperties(), true);
   }
 
-  OfxStatus MyInteger2DInstance::get(int&,int&)
+  OfxStatus MyInteger2DInstance::get(int& x,int& y)
   {
-    return kOfxStatErrMissingHostFeature;
+    return get(_effect->timeLineGetTime(), x, y);
   }
 
-  OfxStatus MyInteger2DInstance::get(OfxTime time,int&,int&)
+  OfxStatus MyInteger2DInstance::get(OfxTime time, int& x,int& y)
   {
-    return kOfxStatErrMissingHostFeature;
+    double values[2];
+    readAnimation().getValue(time, values);
+    x = toInt(values[0]);
+    y = toInt(values[1]);
+    return kOfxStatOK;
   }
 
-  OfxStatus MyInteger2DInstance::set(int,int)
+  OfxStatus MyInteger2DInstance::set(int x,int y)
   {
-    return kOfxStatErrMissingHostFeature;
+    double values[2] = {double(x), double(y)};
+    setValue(_animation, _effect->timeLineGetTime(), values);
+    return kOfxStatOK;
   }
 
-  OfxStatus MyInteger2DInstance::set(OfxTime time,int,int)
+  OfxStatus MyInteger2DInstance::set(OfxTime time, int x,int y)
   {
-    return kOfxStatErrMissingHostFeature;
+    double values[2] = {double(x), double(y)};
+    _animation.setKey(time, values);
+    return kOfxStatOK;
   }
 
   //
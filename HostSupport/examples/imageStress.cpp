@@ -0,0 +1,312 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+/// Stress test for image reference counting. Many threads fetch and release
+/// images through clipGetImage and clipReleaseImage at once, the way the
+/// workers of a fully safe plugin would. The threads are started here rather
+/// than through the multithread suite, whose pool has only as many threads as
+/// there are CPUs.
+/// Half the fetches share one image owned by the clip, half get a fresh image
+/// each time. At the end every fresh image must have been deleted exactly once
+/// and the shared one must still be alive until the clip lets it go.
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#if defined(WINDOWS)
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#endif
+
+#include "ofxCore.h"
+#include "ofxImageEffect.h"
+#include "ofxProperty.h"
+
+#include "ofxhPropertySuite.h"
+#include "ofxhClip.h"
+#include "ofxhImageEffect.h"
+#include "ofxhThread.h"
+#include "ofxhPluginCache.h"
+#include "ofxhImageEffectAPI.h"
+
+/// a host that does nothing, we only need its suites
+class StressHost : public OFX::Host::ImageEffect::Host
+{
+public :
+  OFX::Host::ImageEffect::Instance* newInstance(void* clientData,
+                                                OFX::Host::ImageEffect::ImageEffectPlugin* plugin,
+                                                OFX::Host::ImageEffect::Descriptor& desc,
+                                                const std::string& context)
+  {
+    return NULL;
+  }
+
+  OFX::Host::ImageEffect::Descriptor *makeDescriptor(OFX::Host::ImageEffect::ImageEffectPlugin* plugin)
+  {
+    return new OFX::Host::ImageEffect::Descriptor(plugin);
+  }
+
+  OFX::Host::ImageEffect::Descriptor *makeDescriptor(const OFX::Host::ImageEffect::Descriptor &rootContext,
+                                                     OFX::Host::ImageEffect::ImageEffectPlugin *plugin)
+  {
+    return new OFX::Host::ImageEffect::Descriptor(rootContext, plugin);
+  }
+
+  OFX::Host::ImageEffect::Descriptor *makeDescriptor(const std::string &bundlePath,
+                                                     OFX::Host::ImageEffect::ImageEffectPlugin *plugin)
+  {
+    return new OFX::Host::ImageEffect::Descriptor(bundlePath, plugin);
+  }
+
+  OfxStatus vmessage(const char* type, const char* id, const char* format, va_list args)
+  {
+    vprintf(format, args);
+    printf("\n");
+    return kOfxStatOK;
+  }
+
+  OfxStatus setPersistentMessage(const char* type, const char* id, const char* format, va_list args)
+  {
+    return vmessage(type, id, format, args);
+  }
+
+  OfxStatus clearPersistentMessage()
+  {
+    return kOfxStatOK;
+  }
+
+#ifdef OFX_SUPPORTS_OPENGLRENDER
+  virtual OfxStatus flushOpenGLResources() const { return kOfxStatFailed; };
+#endif
+};
+
+/// counts live images so we can tell if any were leaked or deleted twice
+static OFX::Host::Thread::AtomicCount gLiveImages;
+static OFX::Host::Thread::AtomicCount gDeletedImages;
+
+class StressImage : public OFX::Host::ImageEffect::Image
+{
+public :
+  explicit StressImage(OFX::Host::ImageEffect::ClipInstance &clip)
+    : OFX::Host::ImageEffect::Image(clip)
+  {
+    gLiveImages.increment();
+  }
+
+  ~StressImage()
+  {
+    gLiveImages.decrement();
+    gDeletedImages.increment();
+  }
+};
+
+/// a clip that hands out a shared image at even times and a fresh one at odd times
+class StressClip : public OFX::Host::ImageEffect::ClipInstance
+{
+  StressImage *_shared;
+
+public :
+  explicit StressClip(OFX::Host::ImageEffect::ClipDescriptor &desc)
+    : OFX::Host::ImageEffect::ClipInstance(NULL, desc)
+    , _shared(NULL)
+  {
+    _shared = new StressImage(*this);
+  }
+
+  ~StressClip()
+  {
+    _shared->releaseReference();
+  }
+
+  const std::string &getUnmappedBitDepth() const { static const std::string v(kOfxBitDepthByte); return v; }
+  const std::string &getUnmappedComponents() const { static const std::string v(kOfxImageComponentRGBA); return v; }
+  const std::string &getPremult() const { static const std::string v(kOfxImageUnPreMultiplied); return v; }
+  double getAspectRatio() const { return 1; }
+  double getFrameRate() const { return 25; }
+  void getFrameRange(double &startFrame, double &endFrame) const { startFrame = 0; endFrame = 25; }
+  const std::string &getFieldOrder() const { static const std::string v(kOfxImageFieldNone); return v; }
+  bool getConnected() const { return true; }
+  double getUnmappedFrameRate() const { return 25; }
+  void getUnmappedFrameRange(double &startFrame, double &endFrame) const { startFrame = 0; endFrame = 25; }
+  bool getContinuousSamples() const { return false; }
+  OfxRectD getRegionOfDefinition(OfxTime time) const { OfxRectD r = {0, 0, 16, 16}; return r; }
+
+#ifdef OFX_SUPPORTS_OPENGLRENDER
+  OFX::Host::ImageEffect::Texture* loadTexture(OfxTime time, const char *format, const OfxRectD *optionalBounds) { return NULL; }
+#endif
+
+  OFX::Host::ImageEffect::Image* getImage(OfxTime time, const OfxRectD *optionalBounds)
+  {
+    if(int(time) % 2 == 0) {
+      _shared->addReference();
+      return _shared;
+    }
+    return new StressImage(*this);
+  }
+};
+
+static const int kThreads = 16;
+static const int kRounds = 20000;
+
+struct StressArgs {
+  const OfxImageEffectSuiteV1 *effectSuite;
+  const OfxPropertySuiteV1    *propSuite;
+  OfxImageClipHandle           clip;
+  OFX::Host::Thread::AtomicCount failures;
+  OFX::Host::Thread::AtomicCount freshFetches;
+  OFX::Host::Thread::AtomicCount nextIndex;
+};
+
+/// fetch and release images, holding a few at once so releases interleave with other threads' fetches
+static void stressLoop(StressArgs *args)
+{
+  int threadIndex = int(args->nextIndex.increment());
+  const int kHeld = 4;
+  OfxPropertySetHandle held[kHeld];
+
+  for(int round = 0; round < kRounds; ++round) {
+    for(int i = 0; i < kHeld; ++i) {
+      OfxTime time = threadIndex + round + i;
+      if(args->effectSuite->clipGetImage(args->clip, time, NULL, &held[i]) != kOfxStatOK || !held[i]) {
+        args->failures.increment();
+        held[i] = NULL;
+        continue;
+      }
+      if(int(time) % 2)
+        args->freshFetches.increment();
+
+      // read something off it, as a plugin would
+      int bounds[4];
+      if(args->propSuite->propGetIntN(held[i], kOfxImagePropBounds, 4, bounds) != kOfxStatOK)
+        args->failures.increment();
+    }
+    for(int i = 0; i < kHeld; ++i) {
+      if(held[i] && args->effectSuite->clipReleaseImage(held[i]) != kOfxStatOK)
+        args->failures.increment();
+    }
+  }
+}
+
+#if defined(WINDOWS)
+typedef HANDLE ThreadHandle;
+static unsigned int __stdcall stressThread(void *args)
+{
+  stressLoop((StressArgs *) args);
+  return 0;
+}
+#else
+typedef pthread_t ThreadHandle;
+static void *stressThread(void *args)
+{
+  stressLoop((StressArgs *) args);
+  return 0;
+}
+#endif
+
+/// run stressLoop on kThreads threads at once, returns false if any failed to start
+static bool runThreads(StressArgs &args)
+{
+  std::vector<ThreadHandle> threads;
+  for(int i = 0; i < kThreads; ++i) {
+#if defined(WINDOWS)
+    ThreadHandle thread = (HANDLE) _beginthreadex(0, 0, stressThread, &args, 0, 0);
+    if(!thread)
+      break;
+#else
+    ThreadHandle thread;
+    if(pthread_create(&thread, 0, stressThread, &args) != 0)
+      break;
+#endif
+    threads.push_back(thread);
+  }
+
+  for(size_t i = 0; i < threads.size(); ++i) {
+#if defined(WINDOWS)
+    WaitForSingleObject(threads[i], INFINITE);
+    CloseHandle(threads[i]);
+#else
+    pthread_join(threads[i], 0);
+#endif
+  }
+  return int(threads.size()) == kThreads;
+}
+
+int main(int argc, char **argv)
+{
+  StressHost host;
+  const OfxImageEffectSuiteV1 *effectSuite = (const OfxImageEffectSuiteV1 *) host.fetchSuite(kOfxImageEffectSuite, 1);
+  const OfxPropertySuiteV1 *propSuite = (const OfxPropertySuiteV1 *) host.fetchSuite(kOfxPropertySuite, 1);
+  if(!effectSuite || !propSuite) {
+    printf("FAILED to fetch the suites\n");
+    return 1;
+  }
+
+  bool ok = true;
+  {
+    OFX::Host::ImageEffect::ClipDescriptor desc(kOfxImageEffectSimpleSourceClipName);
+    StressClip clip(desc);
+
+    StressArgs args;
+    args.effectSuite = effectSuite;
+    args.propSuite = propSuite;
+    args.clip = clip.getHandle();
+
+    if(!runThreads(args)) {
+      printf("FAILED to start %d threads\n", kThreads);
+      ok = false;
+    }
+    if(args.failures.get() != 0) {
+      printf("FAILED %ld suite calls failed\n", args.failures.get());
+      ok = false;
+    }
+
+    // every fresh image has gone, only the clip's shared one is left
+    if(gLiveImages.get() != 1 || gDeletedImages.get() != args.freshFetches.get()) {
+      printf("FAILED %ld images alive, %ld deleted, %ld fresh fetches\n",
+             gLiveImages.get(), gDeletedImages.get(), args.freshFetches.get());
+      ok = false;
+    }
+    printf("%d threads made %ld fetches, %ld of fresh images\n",
+           kThreads, long(kThreads) * kRounds * 4, args.freshFetches.get());
+  }
+
+  // and the shared one went with the clip
+  if(gLiveImages.get() != 0) {
+    printf("FAILED %ld images leaked\n", gLiveImages.get());
+    ok = false;
+  }
+
+  printf(ok ? "PASSED\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+////////////////////////////////////////////////////////////////////////////////
+/// Benchmark of the support library's vectorised pixel kernels, see
+/// ofxsPixelKernels.H. Runs each kernel over an HD RGBA frame a row at a time,
+/// for each component type, with the plain C++ kernels and then with each
+/// instruction set this CPU has, picked with OFX::Kernels::setInstructionSet,
+/// and reports millions of pixels a second, best of several frames. Each vector
+/// kernel's frame is checked against the plain C++ one's, as they are meant to
+/// give exactly the same results.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+#if defined(WINDOWS)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "ofxsPixelKernels.H"
+
+using namespace OFX::Kernels;
+
+static const int kWidth = 1920;
+static const int kHeight = 1080;
+static const int kComponents = 4;
+static const int kRuns = 5;
+
+static const InstructionSetEnum instructionSets[] = {
+  eInstructionSetScalar, eInstructionSetSSE2, eInstructionSetAVX2, eInstructionSetAVX512
+};
+static const char * const instructionSetNames[] = { "scalar", "SSE2", "AVX2", "AVX-512" };
+static const int kNInstructionSets = 4;
+
+static const char * const kernelNames[] = { "blend", "invert", "gain", "clamp", "convert to float", "convert from float" };
+static const int kNKernels = 6;
+
+/// wall clock seconds
+static double seconds()
+{
+#if defined(WINDOWS)
+  LARGE_INTEGER now, frequency;
+  QueryPerformanceCounter(&now);
+  QueryPerformanceFrequency(&frequency);
+  return double(now.QuadPart) / double(frequency.QuadPart);
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+/// a random component, a little beyond 0..max for the float types so clamping has work to do
+template <class PIX> static PIX randomComponent()
+{
+  float max = PixelTraits<PIX>::maxValue();
+  float v = float(rand()) / float(RAND_MAX);
+  if(PixelTraits<PIX>::kIsFloat)
+    return PIX(v * 1.2f - 0.1f);
+  return PIX(v * max);
+}
+
+/// one kernel over a frame of PIX, a row at a time
+template <class PIX> struct Frame {
+  std::vector<PIX>   from, to, dst;
+  std::vector<float> floats;
+  int                rowLength;
+
+  Frame() : rowLength(kWidth * kComponents)
+  {
+    size_t n = size_t(rowLength) * kHeight;
+    from.resize(n);
+    to.resize(n);
+    dst.resize(n);
+    floats.resize(n);
+    for(size_t i = 0; i < n; ++i) {
+      from[i] = randomComponent<PIX>();
+      to[i] = randomComponent<PIX>();
+      floats[i] = randomComponent<float>();
+    }
+  }
+
+  void run(int kernel)
+  {
+    static const float scales[kComponents] = { 0.5f, 1.25f, 2.0f, 1.0f };
+    const float max = PixelTraits<PIX>::maxValue();
+    for(int y = 0; y < kHeight; ++y) {
+      size_t row = size_t(y) * rowLength;
+      switch(kernel) {
+        case 0 : blendRow(&from[row], &to[row], &dst[row], rowLength, 0.3f); break;
+        case 1 : invertRow(&from[row], &dst[row], rowLength); break;
+        case 2 : gainRow(&from[row], &dst[row], kWidth, kComponents, scales); break;
+        case 3 : clampRow(&from[row], &dst[row], rowLength, 0.1f * max, 0.9f * max); break;
+        case 4 : convertRow(&from[row], &floats[row], rowLength); break;
+        case 5 : convertRow(&floats[row], &dst[row], rowLength); break;
+      }
+    }
+  }
+
+  /// what the kernel wrote, as bytes
+  std::vector<char> result(int kernel) const
+  {
+    const char *data = kernel == 4 ? (const char *) &floats[0] : (const char *) &dst[0];
+    size_t size = kernel == 4 ? floats.size() * sizeof(float) : dst.size() * sizeof(PIX);
+    return std::vector<char>(data, data + size);
+  }
+};
+
+/// bench every kernel for one type with every instruction set, returns false if a vector kernel differed from the plain one
+template <class PIX> static bool benchType(const char *typeName, InstructionSetEnum best)
+{
+  Frame<PIX> frame;
+  bool ok = true;
+  for(int k = 0; k < kNKernels; ++k) {
+    // the float to float conversions are copies
+    if(k >= 4 && int(PixelTraits<PIX>::kIndex) == int(PixelTraits<float>::kIndex))
+      continue;
+
+    printf("%-14s %-18s :", typeName, kernelNames[k]);
+    std::vector<char> expected;
+    for(int s = 0; s < kNInstructionSets; ++s) {
+      if(instructionSets[s] > best) {
+        printf(" %8s", "-");
+        continue;
+      }
+      setInstructionSet(instructionSets[s]);
+      double fastest = 1e30;
+      for(int run = 0; run < kRuns; ++run) {
+        double start = seconds();
+        frame.run(k);
+        fastest = std::min(fastest, seconds() - start);
+      }
+      printf(" %8.0f", kWidth * kHeight / fastest * 1e-6);
+
+      if(s == 0)
+        expected = frame.result(k);
+      else if(frame.result(k) != expected) {
+        printf(" (differs from scalar with %s)", instructionSetNames[s]);
+        ok = false;
+      }
+    }
+    printf("\n");
+  }
+  return ok;
+}
+
+int main(int argc, char **argv)
+{
+  InstructionSetEnum best = detectInstructionSet();
+
+  printf("%dx%d RGBA, millions of pixels a second, best of %d\n", kWidth, kHeight, kRuns);
+  printf("%-14s %-18s :", "", "");
+  for(int s = 0; s < kNInstructionSets; ++s)
+    printf(" %8s", instructionSetNames[s]);
+  printf("\n");
+
+  bool ok = benchType<unsigned char>("unsigned char", best);
+  ok = benchType<unsigned short>("unsigned short", best) && ok;
+  ok = benchType<OFX::Half>("half", best) && ok;
+  ok = benchType<float>("float", best) && ok;
+
+  if(!ok) {
+    printf("FAILED\n");
+    return 1;
+  }
+  return 0;
+}
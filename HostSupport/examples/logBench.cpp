@@ -0,0 +1,210 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+////////////////////////////////////////////////////////////////////////////////
+/// Benchmark of the support library's logging. Times the property fetches a
+/// plugin makes through OFX::PropertySet, which log every fetch at the print
+/// level, with logging off and on, on one thread and on several at once. The
+/// support library's property set and log are built into this program and
+/// talk straight to the host's property suite.
+///
+/// Logs to logBench.txt, or the file OFX_PLUGIN_LOGFILE names.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#if defined(WINDOWS)
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+// ofx
+#include "ofxCore.h"
+#include "ofxImageEffect.h"
+
+// ofx host
+#include "ofxhPropertySuite.h"
+
+// ofx support
+#include "ofxsCore.h"
+#include "ofxsLog.h"
+
+using namespace OFX::Host::Property;
+
+////////////////////////////////////////////////////////////////////////////////
+// what the support library's property set needs of the rest of the library
+
+namespace OFX {
+  namespace Private {
+    OfxPropertySuiteV1 *gPropSuite = 0;
+  };
+
+  void throwSuiteStatusException(OfxStatus stat) throw(OFX::Exception::Suite, std::bad_alloc)
+  {
+    throw OFX::Exception::Suite(stat);
+  }
+
+  const char* mapStatusToString(OfxStatus stat)
+  {
+    return stat == kOfxStatOK ? "kOfxStatOK" : "error";
+  }
+};
+
+/// the properties of an image, as in ofxhClip.cpp
+static const PropSpec imageStuffs[] = {
+  { kOfxPropType, eString, 1, false, kOfxTypeImage },
+  { kOfxImageEffectPropPixelDepth, eString, 1, true, kOfxBitDepthNone  },
+  { kOfxImageEffectPropComponents, eString, 1, true, kOfxImageComponentNone },
+  { kOfxImageEffectPropPreMultiplication, eString, 1, true, kOfxImageOpaque  },
+  { kOfxImageEffectPropRenderScale, eDouble, 2, true, "1.0" },
+  { kOfxImagePropPixelAspectRatio, eDouble, 1, true, "1.0"  },
+  { kOfxImagePropData, ePointer, 1, true, NULL },
+  { kOfxImagePropBounds, eInt, 4, true, "0" },
+  { kOfxImagePropRegionOfDefinition, eInt, 4, true, "0", },
+  { kOfxImagePropRowBytes, eInt, 1, true, "0", },
+  { kOfxImagePropField, eString, 1, true, "", },
+  { kOfxImagePropUniqueIdentifier, eString, 1, true, "" },
+  propSpecEnd
+};
+
+static const int kIterations = 200000;
+static const int kThreads = 4;
+
+/// wall clock seconds, as the threaded runs overlap
+static double seconds()
+{
+#if defined(WINDOWS)
+  LARGE_INTEGER now, frequency;
+  QueryPerformanceCounter(&now);
+  QueryPerformanceFrequency(&frequency);
+  return double(now.QuadPart) / double(frequency.QuadPart);
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+/// what a plugin typically asks of an image it has fetched, five fetches an iteration
+static void fetchLoop(OfxPropertySetHandle handle)
+{
+  OFX::PropertySet image(handle);
+  long sum = 0;
+  for(int i = 0; i < kIterations; ++i) {
+    sum += image.propGetInt(kOfxImagePropBounds, 2);
+    sum += image.propGetInt(kOfxImagePropRowBytes);
+    sum += image.propGetPointer(kOfxImagePropData) != 0;
+    sum += image.propGetString(kOfxImageEffectPropPixelDepth).size();
+    sum += image.propGetDouble(kOfxImagePropPixelAspectRatio) > 0;
+  }
+  if(sum == 42)
+    printf(" ");
+}
+
+#if defined(WINDOWS)
+typedef HANDLE ThreadHandle;
+static unsigned int __stdcall fetchThread(void *handle)
+{
+  fetchLoop((OfxPropertySetHandle) handle);
+  return 0;
+}
+#else
+typedef pthread_t ThreadHandle;
+static void *fetchThread(void *handle)
+{
+  fetchLoop((OfxPropertySetHandle) handle);
+  return 0;
+}
+#endif
+
+/// run fetchLoop on nThreads threads at once, returns the ns a fetch took, or a negative number if threads failed to start
+static double timeFetches(OfxPropertySetHandle handle, int nThreads)
+{
+  double start = seconds();
+  std::vector<ThreadHandle> threads;
+  for(int i = 0; i < nThreads; ++i) {
+#if defined(WINDOWS)
+    ThreadHandle thread = (HANDLE) _beginthreadex(0, 0, fetchThread, handle, 0, 0);
+    if(!thread)
+      break;
+#else
+    ThreadHandle thread;
+    if(pthread_create(&thread, 0, fetchThread, handle) != 0)
+      break;
+#endif
+    threads.push_back(thread);
+  }
+
+  for(size_t i = 0; i < threads.size(); ++i) {
+#if defined(WINDOWS)
+    WaitForSingleObject(threads[i], INFINITE);
+    CloseHandle(threads[i]);
+#else
+    pthread_join(threads[i], 0);
+#endif
+  }
+  double elapsed = seconds() - start;
+  if(int(threads.size()) != nThreads)
+    return -1;
+  return 1e9 * elapsed / (5.0 * kIterations * nThreads);
+}
+
+int main(int argc, char **argv)
+{
+  Set image(imageStuffs);
+  image.setIntProperty(kOfxImagePropBounds, 720, 2);
+  image.setIntProperty(kOfxImagePropRowBytes, 720 * 4);
+  image.setStringProperty(kOfxImageEffectPropPixelDepth, kOfxBitDepthByte);
+
+  OFX::Private::gPropSuite = (OfxPropertySuiteV1 *) GetSuite(1);
+  if(!getenv("OFX_PLUGIN_LOGFILE"))
+    OFX::Log::setFileName("logBench.txt");
+
+  static const OFX::Log::LevelEnum levels[] = { OFX::Log::eLevelNone, OFX::Log::eLevelPrint };
+  static const char * const levelNames[] = { "logging off", "logging on" };
+  static const int threadCounts[] = { 1, kThreads };
+  for(int l = 0; l < 2; ++l) {
+    OFX::Log::setLevel(levels[l]);
+    for(int t = 0; t < 2; ++t) {
+      double ns = timeFetches(image.getHandle(), threadCounts[t]);
+      if(ns < 0) {
+        printf("FAILED to start %d threads\n", threadCounts[t]);
+        return 1;
+      }
+      printf("%-11s, %d thread%s : %7.1f ns a fetch\n", levelNames[l], threadCounts[t],
+             threadCounts[t] == 1 ? " " : "s", ns);
+    }
+  }
+  OFX::Log::close();
+  return 0;
+}
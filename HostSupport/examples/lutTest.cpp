@@ -0,0 +1,171 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+////////////////////////////////////////////////////////////////////////////////
+/// Test of the lookup tables a parametric param's curves can be sampled into,
+/// see ParametricParam::ParametricInstance::useLookupTables. Builds typical
+/// colour curves, an S curve, a contrast curve, a lift and a highlight roll
+/// off, evaluates each directly at a million positions across the param's
+/// range, then again through tables of 4096 samples, and checks the two never
+/// differ by 1e-7 of the curve's value range or more. A curve without control
+/// points is the identity, which is linear, so its table must be exact. Curves
+/// are then edited with the tables in use, to check the tables follow.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+// ofx
+#include "ofxCore.h"
+#include "ofxParam.h"
+#include "ofxParametricParam.h"
+
+// ofx host
+#include "ofxhPropertySuite.h"
+#include "ofxhParam.h"
+#include "ofxhParametricParam.h"
+
+using namespace OFX::Host;
+
+static const int kLUTSize = 4096;
+static const int kPositions = 1000000;
+static const double kTolerance = 1e-7;
+static const double kLinearTolerance = 1e-12;
+
+/// the properties of a parametric param, as in ofxhParam.cpp, which adds them only if the
+/// host is built with OFX_SUPPORTS_PARAMETRIC
+static const Property::PropSpec parametricStuff[] = {
+  { kOfxParamPropParametricDimension, Property::eInt,    1, false, "1" },
+  { kOfxParamPropParametricRange,     Property::eDouble, 2, false, "0" },
+  Property::propSpecEnd
+};
+
+/// a curve's control points
+struct Point { double key, value; };
+
+static const Point sCurve[] = { {0, 0}, {0.25, 0.15}, {0.5, 0.5}, {0.75, 0.85}, {1, 1} };
+static const Point contrast[] = { {0, 0}, {0.1, 0.02}, {0.3, 0.2}, {0.5, 0.5}, {0.7, 0.8}, {0.9, 0.98}, {1, 1} };
+static const Point lift[] = { {0, 0.05}, {0.2, 0.3}, {0.5, 0.65}, {1, 1} };
+static const Point rollOff[] = { {0, 0}, {0.5, 0.6}, {0.8, 0.82}, {1, 0.9} };
+
+struct Curve {
+  const char  *name;
+  const Point *points;
+  int          nPoints;
+};
+
+static const Curve curves[] = {
+  { "identity",  0,        0 },
+  { "S curve",   sCurve,   sizeof(sCurve) / sizeof(Point) },
+  { "contrast",  contrast, sizeof(contrast) / sizeof(Point) },
+  { "lift",      lift,     sizeof(lift) / sizeof(Point) },
+  { "roll off",  rollOff,  sizeof(rollOff) / sizeof(Point) },
+};
+static const int kNCurves = sizeof(curves) / sizeof(curves[0]);
+
+static int gFailures = 0;
+
+static void check(bool ok, const char *what, double got, double expected)
+{
+  if(!ok) {
+    if(gFailures < 10)
+      printf("FAILED %s : got %.12g, expected %.12g\n", what, got, expected);
+    ++gFailures;
+  }
+}
+
+/// the position of the ith of kPositions evenly spread over the range, a little beyond each end
+static double position(int i)
+{
+  return -0.01 + 1.02 * i / (kPositions - 1);
+}
+
+/// every curve's values at every position
+static std::vector<double> evaluate(const ParametricParam::ParametricInstance &param)
+{
+  std::vector<double> values(size_t(kNCurves) * kPositions);
+  for(int c = 0; c < kNCurves; ++c)
+    for(int i = 0; i < kPositions; ++i)
+      param.getValue(c, 0, position(i), values[size_t(c) * kPositions + i]);
+  return values;
+}
+
+/// compare the tables' values with the curves', returns the largest error of each curve relative to its value range
+static void compare(const std::vector<double> &direct, const std::vector<double> &table, const char *when)
+{
+  for(int c = 0; c < kNCurves; ++c) {
+    const double *d = &direct[size_t(c) * kPositions];
+    const double *t = &table[size_t(c) * kPositions];
+    double lo = *std::min_element(d, d + kPositions), hi = *std::max_element(d, d + kPositions);
+    double largest = 0;
+    int worst = 0;
+    for(int i = 0; i < kPositions; ++i) {
+      if(fabs(t[i] - d[i]) > largest) {
+        largest = fabs(t[i] - d[i]);
+        worst = i;
+      }
+    }
+    double relative = largest / (hi - lo);
+    printf("%-9s%-14s : largest error %.3g of the value range\n", curves[c].name, when, relative);
+    check(relative < (curves[c].nPoints ? kTolerance : kLinearTolerance), curves[c].name, t[worst], d[worst]);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  ParametricParam::ParametricDescriptor descriptor(kOfxParamTypeParametric, "curves");
+  descriptor.getProperties().addProperties(parametricStuff);
+  descriptor.getProperties().setIntProperty(kOfxParamPropParametricDimension, kNCurves);
+  descriptor.getProperties().setDoubleProperty(kOfxParamPropParametricRange, 1.0, 1);
+
+  ParametricParam::ParametricInstance param(descriptor);
+  for(int c = 0; c < kNCurves; ++c)
+    for(int i = 0; i < curves[c].nPoints; ++i)
+      param.addControlPoint(c, 0, curves[c].points[i].key, curves[c].points[i].value, false);
+
+  std::vector<double> direct = evaluate(param);
+  param.useLookupTables(kLUTSize);
+  compare(direct, evaluate(param), "");
+
+  // move the S curve's middle point with the tables in use, they must be resampled
+  param.setNthControlPoint(1, 0, 2, 0.5, 0.6, false);
+  std::vector<double> table = evaluate(param);
+  param.useLookupTables(0);
+  direct = evaluate(param);
+  compare(direct, table, " after an edit");
+
+  if(gFailures) {
+    printf("FAILED %d checks\n", gFailures);
+    return 1;
+  }
+  printf("PASSED\n");
+  return 0;
+}
@@ -0,0 +1,189 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+////////////////////////////////////////////////////////////////////////////////
+/// Test of the image memory pool. Checks that buffers are rounded up to their
+/// size class and aligned, that released buffers are handed out again rather
+/// than reallocated, and that the budget drops spare buffers and calls the
+/// pressure handler. It ends with an image held by a static, which is released
+/// into the global pool while the program exits.
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+// ofx
+#include "ofxCore.h"
+#include "ofxImageEffect.h"
+
+// ofx host
+#include "ofxhMemory.h"
+
+using namespace OFX::Host;
+
+static int gFailures = 0;
+
+/// note a failed check
+static void check(bool ok, const char *what)
+{
+  if(!ok) {
+    printf("FAILED %s\n", what);
+    ++gFailures;
+  }
+}
+
+/// frees every buffer a pool handed out when asked
+class Releaser : public Memory::PressureHandler {
+public :
+  Memory::Pool                      &pool;
+  std::vector<std::pair<void *, size_t> > held;
+  int                                calls;
+
+  explicit Releaser(Memory::Pool &p) : pool(p), calls(0) {}
+
+  void memoryPressure(size_t /*nBytes*/)
+  {
+    ++calls;
+    for(size_t i = 0; i < held.size(); ++i)
+      pool.release(held[i].first, held[i].second);
+    held.clear();
+  }
+};
+
+/// an image buffer that lives until the program exits, released after main returns
+static Memory::PooledInstance gExitImage;
+
+/// allocation, size classes and alignment
+static void testAllocate()
+{
+  Memory::Pool pool;
+  size_t sizes[] = {1, 256, 257, 1000, 4096, 5000, 1920 * 1080 * 16};
+  for(size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+    size_t capacity = 0;
+    void *ptr = pool.allocate(sizes[i], capacity);
+    check(ptr != 0, "allocate returned a buffer");
+    check(capacity >= sizes[i], "capacity covers the request");
+    check(capacity <= 256 || capacity < sizes[i] + sizes[i] / 4 + 1, "capacity within a quarter of the request");
+    check((size_t(ptr) % Memory::Pool::kAlignment) == 0, "buffer is aligned");
+    memset(ptr, 0xff, sizes[i]);
+    pool.release(ptr, capacity);
+  }
+
+  Memory::Pool::Statistics stats = pool.getStatistics();
+  check(stats.bytesInUse == 0, "nothing in use after releasing everything");
+  check(stats.releases == stats.allocations, "every allocation released");
+}
+
+/// released buffers come back for the same size class, and only for it
+static void testReuse()
+{
+  Memory::Pool pool;
+  size_t capacity1, capacity2, capacity3;
+  void *first = pool.allocate(100000, capacity1);
+  pool.release(first, capacity1);
+
+  // a slightly different size in the same class gets the same buffer back
+  void *again = pool.allocate(99000, capacity2);
+  check(again == first && capacity2 == capacity1, "same size class reuses the released buffer");
+
+  // a different class has to go to the system
+  void *other = pool.allocate(400000, capacity3);
+  check(other != first, "another size class gets a new buffer");
+
+  Memory::Pool::Statistics stats = pool.getStatistics();
+  check(stats.allocations == 3 && stats.reuses == 1 && stats.systemAllocations == 2, "reuse counted");
+  check(stats.bytesInUse == capacity2 + capacity3, "bytes in use counted");
+
+  pool.release(again, capacity2);
+  pool.release(other, capacity3);
+  stats = pool.getStatistics();
+  check(stats.bytesSpare == capacity2 + capacity3, "released buffers kept spare");
+
+  pool.trim();
+  stats = pool.getStatistics();
+  check(stats.bytesSpare == 0, "trim drops the spare buffers");
+}
+
+/// going over budget drops spares first, then asks the handler
+static void testBudget()
+{
+  Memory::Pool pool;
+  Releaser releaser(pool);
+  pool.setPressureHandler(&releaser);
+
+  size_t capacity;
+  void *spare = pool.allocate(1 << 20, capacity);
+  pool.release(spare, capacity);
+  pool.setBudget(3 << 20);
+
+  // two held, then a third that does not fit with the spare
+  for(int i = 0; i < 2; ++i) {
+    void *ptr = pool.allocate(1 << 20, capacity);
+    releaser.held.push_back(std::make_pair(ptr, capacity));
+  }
+  void *ptr = pool.allocate(3 << 19, capacity);
+  Memory::Pool::Statistics stats = pool.getStatistics();
+  check(releaser.calls == 1 && releaser.held.empty(), "pressure handler asked to free memory");
+  check(stats.purges == 1, "purge counted");
+  pool.release(ptr, capacity);
+
+  pool.setPressureHandler(0);
+}
+
+/// pooled instances hand their buffers back to the global pool
+static void testInstances()
+{
+  Memory::Pool::Statistics before = Memory::Pool::global().getStatistics();
+  {
+    Memory::PooledInstance a;
+    a.alloc(640 * 480 * 4);
+    void *ptr = a.getPtr();
+    a.freeMem();
+    a.alloc(640 * 480 * 4);
+    check(a.getPtr() == ptr, "instance gets its freed buffer back");
+  }
+  Memory::Pool::Statistics after = Memory::Pool::global().getStatistics();
+  check(after.bytesInUse == before.bytesInUse, "instance released its buffer");
+
+  gExitImage.alloc(1000);
+}
+
+int main(int argc, char **argv)
+{
+  testAllocate();
+  testReuse();
+  testBudget();
+  testInstances();
+  if(gFailures) {
+    printf("FAILED %d checks\n", gFailures);
+    return 1;
+  }
+  printf("PASSED\n");
+  return 0;
+}
@@ -0,0 +1,176 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+/// Benchmark of the support library's image processors, comparing the render
+/// window shared out in one band per thread against many small tiles. Loads the
+/// example noise and invert plugins and renders frames with each, forcing the
+/// scheduling with the OFX_PROCESSING_SCHEDULING environment variable that
+/// OFX::ImageProcessor honours. The plugins read that once, so the benchmark
+/// runs itself again for each scheduling, which is given as its argument.
+///
+/// Set OFX_PLUGIN_PATH so the plugins can be found.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#if defined(WINDOWS)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// ofx
+#include "ofxCore.h"
+#include "ofxImageEffect.h"
+
+// ofx host
+#include "ofxhBinary.h"
+#include "ofxhPropertySuite.h"
+#include "ofxhClip.h"
+#include "ofxhParam.h"
+#include "ofxhMemory.h"
+#include "ofxhImageEffect.h"
+#include "ofxhPluginAPICache.h"
+#include "ofxhPluginCache.h"
+#include "ofxhHost.h"
+#include "ofxhImageEffectAPI.h"
+#include "ofxhThread.h"
+
+// my host
+#include "hostDemoHostDescriptor.h"
+#include "hostDemoEffectInstance.h"
+#include "hostDemoClipInstance.h"
+
+static const int kFrames = 25;
+static const int kPasses = 8;
+
+/// wall clock seconds, the plugins render on several threads so CPU time would mislead
+static double seconds()
+{
+#if defined(WINDOWS)
+  LARGE_INTEGER now, frequency;
+  QueryPerformanceCounter(&now);
+  QueryPerformanceFrequency(&frequency);
+  return double(now.QuadPart) / double(frequency.QuadPart);
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+static void forceScheduling(const char *scheduling)
+{
+#if defined(WINDOWS)
+  _putenv_s("OFX_PROCESSING_SCHEDULING", scheduling);
+#else
+  setenv("OFX_PROCESSING_SCHEDULING", scheduling, 1);
+#endif
+}
+
+/// render kFrames frames kPasses times, returns the milliseconds a frame took, or a negative number on failure
+static double timeRenders(OFX::Host::ImageEffect::Instance &instance)
+{
+  OfxPointD renderScale = {1, 1};
+  OfxRectI renderWindow = {0, 0, 720, 576};
+
+  double start = seconds();
+  for(int pass = 0; pass < kPasses; ++pass) {
+    for(int frame = 0; frame < kFrames; ++frame) {
+      OfxStatus stat = instance.renderAction(frame, kOfxImageFieldBoth, renderWindow, renderScale,
+                                             /*sequential=*/false, /*interactive=*/false, /*draft=*/false);
+      if(stat != kOfxStatOK)
+        return -1;
+    }
+  }
+  return 1000 * (seconds() - start) / (kFrames * kPasses);
+}
+
+/// time a plugin with the scheduling the environment forces
+static bool benchPlugin(OFX::Host::ImageEffect::PluginCache &cache, const char *id, const char *context, const char *scheduling)
+{
+  OFX::Host::ImageEffect::ImageEffectPlugin* plugin = cache.getPluginById(id);
+  if(!plugin) {
+    printf("could not find %s, set OFX_PLUGIN_PATH\n", id);
+    return false;
+  }
+
+  OFX::Host::ImageEffect::Instance *instance = plugin->createInstance(context, NULL);
+  if(!instance)
+    return false;
+  OfxStatus stat = instance->createInstanceAction();
+  if((stat != kOfxStatOK && stat != kOfxStatReplyDefault) || !instance->getClipPreferences()) {
+    printf("could not create an instance of %s\n", id);
+    delete instance;
+    return false;
+  }
+
+  // the first render loads everything in, so do one before timing
+  timeRenders(*instance);
+  double ms = timeRenders(*instance);
+  delete instance;
+  if(ms < 0) {
+    printf("%s failed to render\n", id);
+    return false;
+  }
+
+  printf("%-28s : %-5s %7.2f ms a frame\n", id, scheduling, ms);
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  // run each scheduling in a process of its own
+  if(argc < 2) {
+    const char *schedulings[] = {"bands", "tiles"};
+    bool ok = true;
+    for(int i = 0; i < 2; ++i) {
+      std::string command = std::string("\"") + argv[0] + "\" " + schedulings[i];
+      ok = system(command.c_str()) == 0 && ok;
+    }
+    return ok ? 0 : 1;
+  }
+  forceScheduling(argv[1]);
+
+  OFX::Host::PluginCache::getPluginCache()->setCacheVersion("processingBenchV1");
+  MyHost::Host myHost;
+  OFX::Host::ImageEffect::PluginCache imageEffectPluginCache(myHost);
+  imageEffectPluginCache.registerInCache(*OFX::Host::PluginCache::getPluginCache());
+  OFX::Host::PluginCache::getPluginCache()->scanPluginFiles();
+
+  printf("rendering %d PAL frames %d times on %u CPUs\n", kFrames, kPasses, OFX::Host::Thread::WorkerPool::numCPUs());
+  bool ok = benchPlugin(imageEffectPluginCache, "net.sf.openfx.noisePlugin", kOfxImageEffectContextGenerator, argv[1]);
+  ok = benchPlugin(imageEffectPluginCache, "net.sf.openfx.invertPlugin", kOfxImageEffectContextFilter, argv[1]) && ok;
+
+  OFX::Host::PluginCache::clearPluginCache();
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+/// Benchmark of property lookups. Times the property suite calls a plugin makes
+/// on an image's property set, which find properties by interned name, against
+/// looking the same properties up in a std::map keyed by std::string, which is
+/// how property sets used to find them.
+
+#include <stdio.h>
+#include <time.h>
+#include <string>
+
+#include "ofxCore.h"
+#include "ofxImageEffect.h"
+#include "ofxhPropertySuite.h"
+
+using namespace OFX::Host::Property;
+
+/// the properties of an image, as in ofxhClip.cpp
+static const PropSpec imageStuffs[] = {
+  { kOfxPropType, eString, 1, false, kOfxTypeImage },
+  { kOfxImageEffectPropPixelDepth, eString, 1, true, kOfxBitDepthNone  },
+  { kOfxImageEffectPropComponents, eString, 1, true, kOfxImageComponentNone },
+  { kOfxImageEffectPropPreMultiplication, eString, 1, true, kOfxImageOpaque  },
+  { kOfxImageEffectPropRenderScale, eDouble, 2, true, "1.0" },
+  { kOfxImagePropPixelAspectRatio, eDouble, 1, true, "1.0"  },
+  { kOfxImagePropData, ePointer, 1, true, NULL },
+  { kOfxImagePropBounds, eInt, 4, true, "0" },
+  { kOfxImagePropRegionOfDefinition, eInt, 4, true, "0", },
+  { kOfxImagePropRowBytes, eInt, 1, true, "0", },
+  { kOfxImagePropField, eString, 1, true, "", },
+  { kOfxImagePropUniqueIdentifier, eString, 1, true, "" },
+  propSpecEnd
+};
+
+static const int kIterations = 2000000;
+
+static double seconds()
+{
+  return double(clock()) / CLOCKS_PER_SEC;
+}
+
+/// what a plugin typically asks of an image it has fetched, through the suite
+static double suiteLookups(const OfxPropertySuiteV1 *suite, OfxPropertySetHandle handle)
+{
+  double start = seconds();
+  long sum = 0;
+  for(int i = 0; i < kIterations; ++i) {
+    int bounds[4];
+    int rowBytes;
+    void *data;
+    char *depth;
+    char *components;
+    suite->propGetIntN(handle, kOfxImagePropBounds, 4, bounds);
+    suite->propGetInt(handle, kOfxImagePropRowBytes, 0, &rowBytes);
+    suite->propGetPointer(handle, kOfxImagePropData, 0, &data);
+    suite->propGetString(handle, kOfxImageEffectPropPixelDepth, 0, &depth);
+    suite->propGetString(handle, kOfxImageEffectPropComponents, 0, &components);
+    sum += bounds[2] + rowBytes + (data != 0) + depth[0] + components[0];
+  }
+  double elapsed = seconds() - start;
+  if(sum == 42)
+    printf(" ");
+  return elapsed;
+}
+
+/// the same lookups, through a map keyed by a std::string made per call
+static double mapLookups(const PropertyMap &props)
+{
+  double start = seconds();
+  long sum = 0;
+  for(int i = 0; i < kIterations; ++i) {
+    Int *bounds = dynamic_cast<Int *>(props.find(kOfxImagePropBounds)->second);
+    Int *rowBytes = dynamic_cast<Int *>(props.find(kOfxImagePropRowBytes)->second);
+    Pointer *data = dynamic_cast<Pointer *>(props.find(kOfxImagePropData)->second);
+    String *depth = dynamic_cast<String *>(props.find(kOfxImageEffectPropPixelDepth)->second);
+    String *components = dynamic_cast<String *>(props.find(kOfxImageEffectPropComponents)->second);
+    int b[4];
+    bounds->getValueN(b, 4);
+    sum += b[2] + rowBytes->getValue() + (data->getValue() != 0) +
+      depth->getValue()[0] + components->getValue()[0];
+  }
+  double elapsed = seconds() - start;
+  if(sum == 42)
+    printf(" ");
+  return elapsed;
+}
+
+int main(int argc, char **argv)
+{
+  Set image(imageStuffs);
+  image.setIntProperty(kOfxImagePropBounds, 720, 2);
+  image.setIntProperty(kOfxImagePropRowBytes, 720 * 4);
+
+  const OfxPropertySuiteV1 *suite = (const OfxPropertySuiteV1 *) GetSuite(1);
+
+  // five lookups per iteration
+  double lookups = 5.0 * kIterations;
+  double interned = suiteLookups(suite, image.getHandle());
+  double mapped = mapLookups(image.getProperties());
+
+  printf("interned suite lookups : %6.1f ns each\n", 1e9 * interned / lookups);
+  printf("std::map lookups       : %6.1f ns each\n", 1e9 * mapped / lookups);
+  return 0;
+}
@@ -0,0 +1,184 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+/// Benchmark of RenderDriver, rendering a run of frames of the example invert
+/// plugin on 1, 2, ... up to as many threads as there are CPUs, and reporting
+/// the frames rendered a second on each. With one thread the frames are
+/// rendered one after another, with the plugin threading within each frame,
+/// with more several frames are rendered at once. Give the most threads to try
+/// as an argument to go past the number of CPUs.
+///
+/// Set OFX_PLUGIN_PATH so the invert plugin can be found.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <map>
+
+#if defined(WINDOWS)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// ofx
+#include "ofxCore.h"
+#include "ofxImageEffect.h"
+
+// ofx host
+#include "ofxhBinary.h"
+#include "ofxhPropertySuite.h"
+#include "ofxhClip.h"
+#include "ofxhParam.h"
+#include "ofxhMemory.h"
+#include "ofxhImageEffect.h"
+#include "ofxhPluginAPICache.h"
+#include "ofxhPluginCache.h"
+#include "ofxhHost.h"
+#include "ofxhImageEffectAPI.h"
+#include "ofxhThread.h"
+#include "ofxhRenderDriver.h"
+
+// my host
+#include "hostDemoHostDescriptor.h"
+#include "hostDemoEffectInstance.h"
+#include "hostDemoClipInstance.h"
+
+static const int kFrames = 100;
+
+/// wall clock seconds, frames render on several threads so CPU time would mislead
+static double seconds()
+{
+#if defined(WINDOWS)
+  LARGE_INTEGER now, frequency;
+  QueryPerformanceCounter(&now);
+  QueryPerformanceFrequency(&frequency);
+  return double(now.QuadPart) / double(frequency.QuadPart);
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+/// renders a PAL frame and throws the output away
+class BenchRenderClient : public OFX::Host::ImageEffect::RenderDriver::Client {
+public :
+  virtual OFX::Host::ImageEffect::Instance *cloneInstance(OFX::Host::ImageEffect::Instance &original)
+  {
+    OFX::Host::ImageEffect::Instance *instance = original.getPlugin()->createInstance(original.getContext(), NULL);
+    if(instance) {
+      OfxStatus stat = instance->createInstanceAction();
+      if((stat != kOfxStatOK && stat != kOfxStatReplyDefault) || !instance->getClipPreferences()) {
+        delete instance;
+        return NULL;
+      }
+    }
+    return instance;
+  }
+
+  virtual OfxStatus renderFrame(OFX::Host::ImageEffect::Instance &instance, OfxTime frame, bool sequential, bool interactive)
+  {
+    OfxPointD renderScale = {1, 1};
+    OfxRectI renderWindow = {0, 0, 720, 576};
+    OfxRectD regionOfInterest = {0, 0, 720 * instance.getProjectPixelAspectRatio(), 576};
+
+    std::map<OFX::Host::ImageEffect::ClipInstance *, OfxRectD> rois;
+    OfxStatus stat = instance.getRegionOfInterestAction(frame, renderScale, regionOfInterest, rois);
+    if(stat != kOfxStatOK && stat != kOfxStatReplyDefault)
+      return stat;
+
+    stat = instance.renderAction(frame, kOfxImageFieldBoth, renderWindow, renderScale, sequential, interactive, /*draft=*/false);
+    if(stat != kOfxStatOK)
+      return stat;
+
+    MyHost::MyClipInstance* outputClip = dynamic_cast<MyHost::MyClipInstance*>(instance.getClip("Output"));
+    if(!outputClip || !outputClip->getOutputImage(frame))
+      return kOfxStatFailed;
+    outputClip->releaseOutputImage(frame);
+    return kOfxStatOK;
+  }
+};
+
+int main(int argc, char **argv)
+{
+  OFX::Host::PluginCache::getPluginCache()->setCacheVersion("renderBenchV1");
+  MyHost::Host myHost;
+  OFX::Host::ImageEffect::PluginCache imageEffectPluginCache(myHost);
+  imageEffectPluginCache.registerInCache(*OFX::Host::PluginCache::getPluginCache());
+  OFX::Host::PluginCache::getPluginCache()->scanPluginFiles();
+
+  OFX::Host::ImageEffect::ImageEffectPlugin* plugin = imageEffectPluginCache.getPluginById("net.sf.openfx.invertPlugin");
+  if(!plugin) {
+    printf("could not find the invert plugin, set OFX_PLUGIN_PATH\n");
+    OFX::Host::PluginCache::clearPluginCache();
+    return 1;
+  }
+
+  OFX::Host::ImageEffect::Instance *instance = plugin->createInstance(kOfxImageEffectContextFilter, NULL);
+  OfxStatus stat = instance ? instance->createInstanceAction() : kOfxStatFailed;
+  if((stat != kOfxStatOK && stat != kOfxStatReplyDefault) || !instance->getClipPreferences()) {
+    printf("could not create an invert instance\n");
+    delete instance;
+    OFX::Host::PluginCache::clearPluginCache();
+    return 1;
+  }
+
+  unsigned int maxThreads = argc > 1 ? (unsigned int) atoi(argv[1]) : OFX::Host::Thread::WorkerPool::numCPUs();
+  printf("rendering %d PAL frames of %s, which is %s, on %u CPUs\n", kFrames, plugin->getIdentifier().c_str(),
+         instance->getRenderThreadSafety().c_str(), OFX::Host::Thread::WorkerPool::numCPUs());
+
+  bool ok = true;
+  {
+    BenchRenderClient client;
+    OfxPointD renderScale = {1, 1};
+    OFX::Host::ImageEffect::RenderDriver driver(*instance, client);
+
+    // the first render loads everything in, so do one before timing
+    driver.render(0, kFrames - 1, 1, renderScale, /*interactive=*/false);
+
+    double oneThread = 0;
+    for(unsigned int nThreads = 1; nThreads <= maxThreads && ok; ++nThreads) {
+      driver.setMaxThreads(nThreads);
+      double start = seconds();
+      ok = driver.render(0, kFrames - 1, 1, renderScale, /*interactive=*/false) == kOfxStatOK;
+      double fps = kFrames / (seconds() - start);
+      if(nThreads == 1)
+        oneThread = fps;
+      printf("%2u thread%s : %8.1f frames a second, %.2f times one thread\n", nThreads, nThreads == 1 ? " " : "s", fps, fps / oneThread);
+    }
+    if(!ok)
+      printf("the render failed\n");
+  }
+
+  delete instance;
+  OFX::Host::PluginCache::clearPluginCache();
+  return ok ? 0 : 1;
+}
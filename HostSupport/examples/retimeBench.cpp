@@ -0,0 +1,148 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+////////////////////////////////////////////////////////////////////////////////
+/// Benchmark of a 10,000 frame retime, which like the Retimer example asks for
+/// the integral of its speed curve from 0 to each output frame. The closed form
+/// integrals of the animation engine are timed through paramGetIntegral against
+/// what a host without them would do, integrate numerically with Simpson's rule
+/// over values from paramGetValueAtTime. The numerical retime is too slow to run
+/// in full, so every 100th frame is timed and the total scaled up.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+
+#if defined(WINDOWS)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// ofx
+#include "ofxCore.h"
+#include "ofxParam.h"
+
+// ofx host
+#include "ofxhPropertySuite.h"
+#include "ofxhParam.h"
+#include "ofxhAnimation.h"
+
+using namespace OFX::Host;
+
+static const int kFrames = 10000;
+static const int kNumericalStep = 100;
+static const int kSamplesPerFrame = 16;
+
+/// wall clock seconds
+static double seconds()
+{
+#if defined(WINDOWS)
+  LARGE_INTEGER now, frequency;
+  QueryPerformanceCounter(&now);
+  QueryPerformanceFrequency(&frequency);
+  return double(now.QuadPart) / double(frequency.QuadPart);
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+/// a double param that keeps its keys in the built in animation engine
+class AnimatedDouble : public Param::DoubleInstance {
+public :
+  explicit AnimatedDouble(Param::Descriptor &descriptor) : Param::DoubleInstance(descriptor) { useAnimation(1); }
+
+  OfxStatus get(double &v) { return get(0, v); }
+  OfxStatus get(OfxTime time, double &v) { readAnimation().getValue(time, &v); return kOfxStatOK; }
+  OfxStatus set(double v) { getAnimation().setValue(&v); return kOfxStatOK; }
+  OfxStatus set(OfxTime time, double v) { getAnimation().setKey(time, &v); return kOfxStatOK; }
+};
+
+/// the source frame of an output frame, by Simpson's rule over the speed from 0 to it
+static double numericalSourceFrame(const OfxParameterSuiteV1 *suite, OfxParamHandle handle, int frame)
+{
+  int n = kSamplesPerFrame * frame;
+  double h = 1.0 / kSamplesPerFrame;
+  double sum = 0;
+  for(int j = 0; j <= n && n > 0; ++j) {
+    double weight = (j == 0 || j == n) ? 1 : (j % 2 ? 4 : 2);
+    double speed;
+    suite->paramGetValueAtTime(handle, j * h, &speed);
+    sum += weight * speed;
+  }
+  return sum * h / 3;
+}
+
+int main(int argc, char **argv)
+{
+  const OfxParameterSuiteV1 *suite = (const OfxParameterSuiteV1 *) Param::GetSuite(1);
+  Param::Descriptor descriptor(kOfxParamTypeDouble, "speed");
+
+  static const int keyCounts[] = { 10, 1000, 10000 };
+  for(int k = 0; k < 3; ++k) {
+    AnimatedDouble speed(descriptor);
+    int nKeys = keyCounts[k];
+    for(int i = 0; i < nKeys; ++i)
+      speed.set(i * double(kFrames) / nKeys, 1.0 + 0.5 * sin(i * 0.37));
+    OfxParamHandle handle = (OfxParamHandle) static_cast<Param::Instance *>(&speed);
+
+    double closedSum = 0;
+    double start = seconds();
+    for(int frame = 0; frame < kFrames; ++frame) {
+      double source;
+      suite->paramGetIntegral(handle, 0, frame, &source);
+      closedSum += source;
+    }
+    double closed = seconds() - start;
+
+    double numericalSum = 0;
+    double largestDifference = 0;
+    start = seconds();
+    for(int frame = 0; frame < kFrames; frame += kNumericalStep) {
+      numericalSum += numericalSourceFrame(suite, handle, frame);
+    }
+    double numerical = (seconds() - start) * kNumericalStep;
+
+    // the two should agree, Simpson's rule is exact on the curve's cubics between samples on keys
+    for(int frame = 0; frame < kFrames; frame += kNumericalStep * 10) {
+      double source;
+      suite->paramGetIntegral(handle, 0, frame, &source);
+      largestDifference = std::max(largestDifference, fabs(source - numericalSourceFrame(suite, handle, frame)));
+    }
+
+    printf("%5d keys : closed form %7.2f ms, numerical %8.0f ms, largest difference %.2g\n",
+           nKeys, 1000 * closed, 1000 * numerical, largestDifference);
+    if(closedSum == 42 || numericalSum == 42)
+      printf(" ");
+  }
+  return 0;
+}
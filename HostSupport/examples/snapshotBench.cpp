@@ -0,0 +1,229 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+////////////////////////////////////////////////////////////////////////////////
+/// Benchmark of what the support library's OFX::Image fetches from an image's
+/// property set each time a plugin calls fetchImage. Times fetching each
+/// property with its own propGet* call, one suite call per value, as ImageBase
+/// and Image used to, against one PropertySet::propGetSnapshot over the same
+/// properties, as they do now. The support library's property set and log are
+/// built into this program and talk straight to the host's property suite,
+/// with logging off.
+
+#include <stdio.h>
+#include <string>
+
+#if defined(WINDOWS)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// ofx
+#include "ofxCore.h"
+#include "ofxImageEffect.h"
+
+// ofx host
+#include "ofxhPropertySuite.h"
+
+// ofx support
+#include "ofxsCore.h"
+#include "ofxsLog.h"
+
+using namespace OFX::Host::Property;
+
+////////////////////////////////////////////////////////////////////////////////
+// what the support library's property set needs of the rest of the library
+
+namespace OFX {
+  namespace Private {
+    OfxPropertySuiteV1 *gPropSuite = 0;
+  };
+
+  void throwSuiteStatusException(OfxStatus stat) throw(OFX::Exception::Suite, std::bad_alloc)
+  {
+    throw OFX::Exception::Suite(stat);
+  }
+
+  const char* mapStatusToString(OfxStatus stat)
+  {
+    return stat == kOfxStatOK ? "kOfxStatOK" : "error";
+  }
+};
+
+/// the properties of an image, as in ofxhClip.cpp
+static const PropSpec imageStuffs[] = {
+  { kOfxPropType, eString, 1, false, kOfxTypeImage },
+  { kOfxImageEffectPropPixelDepth, eString, 1, true, kOfxBitDepthNone  },
+  { kOfxImageEffectPropComponents, eString, 1, true, kOfxImageComponentNone },
+  { kOfxImageEffectPropPreMultiplication, eString, 1, true, kOfxImageOpaque  },
+  { kOfxImageEffectPropRenderScale, eDouble, 2, true, "1.0" },
+  { kOfxImagePropPixelAspectRatio, eDouble, 1, true, "1.0"  },
+  { kOfxImagePropData, ePointer, 1, true, NULL },
+  { kOfxImagePropBounds, eInt, 4, true, "0" },
+  { kOfxImagePropRegionOfDefinition, eInt, 4, true, "0", },
+  { kOfxImagePropRowBytes, eInt, 1, true, "0", },
+  { kOfxImagePropField, eString, 1, true, "", },
+  { kOfxImagePropUniqueIdentifier, eString, 1, true, "" },
+  propSpecEnd
+};
+
+static const int kIterations = 1000000;
+
+/// the members of OFX::ImageBase and OFX::Image that are fetched from the property set
+struct ImageMembers {
+  int          rowBytes;
+  double       pixelAspectRatio;
+  std::string  components;
+  std::string  depth;
+  std::string  preMultiplication;
+  OfxRectI     regionOfDefinition;
+  OfxRectI     bounds;
+  std::string  field;
+  std::string  uniqueID;
+  OfxPointD    renderScale;
+  void        *pixelData;
+};
+
+/// wall clock seconds
+static double seconds()
+{
+#if defined(WINDOWS)
+  LARGE_INTEGER now, frequency;
+  QueryPerformanceCounter(&now);
+  QueryPerformanceFrequency(&frequency);
+  return double(now.QuadPart) / double(frequency.QuadPart);
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+/// fetch an image's members a property value at a time, as OFX::Image used to
+static void fetchEach(const OFX::PropertySet &props, ImageMembers &m)
+{
+  m.rowBytes         = props.propGetInt(kOfxImagePropRowBytes);
+  m.pixelAspectRatio = props.propGetDouble(kOfxImagePropPixelAspectRatio);
+  m.components       = props.propGetString(kOfxImageEffectPropComponents);
+  m.depth            = props.propGetString(kOfxImageEffectPropPixelDepth);
+  m.preMultiplication = props.propGetString(kOfxImageEffectPropPreMultiplication);
+
+  m.regionOfDefinition.x1 = props.propGetInt(kOfxImagePropRegionOfDefinition, 0);
+  m.regionOfDefinition.y1 = props.propGetInt(kOfxImagePropRegionOfDefinition, 1);
+  m.regionOfDefinition.x2 = props.propGetInt(kOfxImagePropRegionOfDefinition, 2);
+  m.regionOfDefinition.y2 = props.propGetInt(kOfxImagePropRegionOfDefinition, 3);
+
+  m.bounds.x1 = props.propGetInt(kOfxImagePropBounds, 0);
+  m.bounds.y1 = props.propGetInt(kOfxImagePropBounds, 1);
+  m.bounds.x2 = props.propGetInt(kOfxImagePropBounds, 2);
+  m.bounds.y2 = props.propGetInt(kOfxImagePropBounds, 3);
+
+  m.field    = props.propGetString(kOfxImagePropField);
+  m.uniqueID = props.propGetString(kOfxImagePropUniqueIdentifier);
+
+  m.renderScale.x = props.propGetDouble(kOfxImageEffectPropRenderScale, 0);
+  m.renderScale.y = props.propGetDouble(kOfxImageEffectPropRenderScale, 1);
+
+  m.pixelData = props.propGetPointer(kOfxImagePropData);
+}
+
+/// fetch an image's members with one snapshot, as OFX::Image does
+static void fetchSnapshot(const OFX::PropertySet &props, ImageMembers &m)
+{
+  const char *components = 0, *depth = 0, *preMultiplication = 0, *field = 0, *uniqueID = 0;
+  const OFX::PropertySet::SnapshotEntry entries[] = {
+    {kOfxImagePropRowBytes,                OFX::eInt,     1, &m.rowBytes,           false},
+    {kOfxImagePropPixelAspectRatio,        OFX::eDouble,  1, &m.pixelAspectRatio,   false},
+    {kOfxImageEffectPropComponents,        OFX::eString,  1, &components,           false},
+    {kOfxImageEffectPropPixelDepth,        OFX::eString,  1, &depth,                false},
+    {kOfxImageEffectPropPreMultiplication, OFX::eString,  1, &preMultiplication,    false},
+    {kOfxImagePropRegionOfDefinition,      OFX::eInt,     4, &m.regionOfDefinition, false},
+    {kOfxImagePropBounds,                  OFX::eInt,     4, &m.bounds,             false},
+    {kOfxImagePropField,                   OFX::eString,  1, &field,                false},
+    {kOfxImagePropUniqueIdentifier,        OFX::eString,  1, &uniqueID,             false},
+    {kOfxImageEffectPropRenderScale,       OFX::eDouble,  2, &m.renderScale,        false},
+    {kOfxImagePropData,                    OFX::ePointer, 1, &m.pixelData,          false},
+  };
+  props.propGetSnapshot(entries, sizeof(entries) / sizeof(entries[0]));
+
+  // OFX::Image maps most of its strings to enums, the unique ID it keeps
+  m.uniqueID = uniqueID ? uniqueID : "";
+}
+
+/// time a million fetches, returns the ns one took
+static double timeFetches(const OFX::PropertySet &props, void (*fetch)(const OFX::PropertySet &, ImageMembers &))
+{
+  ImageMembers m;
+  long sum = 0;
+  double start = seconds();
+  for(int i = 0; i < kIterations; ++i) {
+    fetch(props, m);
+    sum += m.bounds.x2 + m.rowBytes + (m.pixelData != 0);
+  }
+  double elapsed = seconds() - start;
+  if(sum == 42)
+    printf(" ");
+  return 1e9 * elapsed / kIterations;
+}
+
+int main(int argc, char **argv)
+{
+  Set image(imageStuffs);
+  image.setIntProperty(kOfxImagePropBounds, 720, 2);
+  image.setIntProperty(kOfxImagePropBounds, 576, 3);
+  image.setIntProperty(kOfxImagePropRegionOfDefinition, 720, 2);
+  image.setIntProperty(kOfxImagePropRegionOfDefinition, 576, 3);
+  image.setIntProperty(kOfxImagePropRowBytes, 720 * 4);
+  image.setStringProperty(kOfxImageEffectPropPixelDepth, kOfxBitDepthByte);
+  image.setStringProperty(kOfxImageEffectPropComponents, kOfxImageComponentRGBA);
+  image.setStringProperty(kOfxImagePropUniqueIdentifier, "snapshotBench");
+
+  OFX::Private::gPropSuite = (OfxPropertySuiteV1 *) GetSuite(1);
+  OFX::Log::setLevel(OFX::Log::eLevelNone);
+
+  OFX::PropertySet props(image.getHandle());
+
+  // check both fetch the same
+  ImageMembers each, snapshot;
+  fetchEach(props, each);
+  fetchSnapshot(props, snapshot);
+  if(each.rowBytes != snapshot.rowBytes || each.bounds.x2 != snapshot.bounds.x2 ||
+     each.regionOfDefinition.y2 != snapshot.regionOfDefinition.y2 ||
+     each.renderScale.y != snapshot.renderScale.y || each.uniqueID != snapshot.uniqueID) {
+    printf("FAILED the snapshot fetched different values\n");
+    return 1;
+  }
+
+  double eachNs = timeFetches(props, fetchEach);
+  double snapshotNs = timeFetches(props, fetchSnapshot);
+  printf("a call per value, 18 suite calls : %7.1f ns an image\n", eachNs);
+  printf("one snapshot, 11 suite calls     : %7.1f ns an image, %.2f times faster\n", snapshotNs, eachNs / snapshotNs);
+  return 0;
+}
@@ -0,0 +1,211 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OFXH_ANIMATION_H
+#define OFXH_ANIMATION_H
+
+#include <vector>
+
+#include "ofxCore.h"
+
+namespace OFX {
+
+  namespace Host {
+
+    namespace Param {
+
+      /// how an animation goes from a key to the next one
+      enum InterpolationEnum {
+        eInterpolationConstant,   ///< holds the key's value until the next key
+        eInterpolationLinear,     ///< a straight line to the next key
+        eInterpolationSmooth,     ///< eases out of the key and into the next, flat at both
+        eInterpolationCatmullRom  ///< leaves the key along the line between its neighbours
+      };
+
+      /// A built in keyframe store and evaluator for params with one or more double values,
+      /// which hosts can keep param values in rather than writing their own, see
+      /// KeyframeParam::useAnimation.
+      ///
+      /// All the dimensions of a param are keyed at the same times. Keys are kept as a structure
+      /// of arrays, the times in one array so finding a time is a search of contiguous doubles,
+      /// and the values of each dimension in their own.
+      ///
+      /// Before the first key and after the last the value is that of the nearest key, in
+      /// between it is interpolated as the earlier key of the two says. With no keys at all it
+      /// is the value last given to setValue.
+      ///
+      /// Renders ask for times in order, so evaluation starts looking from the segment the last
+      /// lookup found, which makes stepping through a sequence constant time whatever the
+      /// number of keys. Anything else is a binary search.
+      ///
+      /// Derivatives and integrals are those of the curves themselves, not numerical
+      /// approximations. The integral from the first key to each key is kept up to date as keys
+      /// change, so an integral between any two times is the difference of two lookups, rather
+      /// than a sum over the keys in between.
+      class Animation {
+      protected :
+        /// The segment the last lookup found, which render threads share. Every read and
+        /// write of it, copies included, is a relaxed atomic load or store, and a stale value
+        /// is only ever a wrong guess, as it is checked before it is used.
+        class SegmentHint {
+        public :
+          explicit SegmentHint(int segment = 0) : _segment(segment) {}
+          SegmentHint(const SegmentHint &other) : _segment(other.get()) {}
+          SegmentHint &operator=(const SegmentHint &other) {set(other.get()); return *this;}
+
+          int get() const
+          {
+#if defined(__ATOMIC_RELAXED)
+            return __atomic_load_n(&_segment, __ATOMIC_RELAXED);
+#else
+            return _segment;
+#endif
+          }
+
+          void set(int segment)
+          {
+#if defined(__ATOMIC_RELAXED)
+            __atomic_store_n(&_segment, segment, __ATOMIC_RELAXED);
+#else
+            _segment = segment;
+#endif
+          }
+
+        protected :
+          volatile int _segment;
+        };
+
+        int                               _nDimensions;
+        std::vector<OfxTime>              _times;          ///< key times, ascending
+        std::vector<std::vector<double> > _values;         ///< key values, one array per dimension
+        std::vector<unsigned char>        _interpolations; ///< an InterpolationEnum per key
+        std::vector<std::vector<double> > _integrals;      ///< integral from the first key to each key, one array per dimension
+        std::vector<double>               _staticValues;   ///< values per dimension when there are no keys
+        InterpolationEnum                 _defaultInterpolation;
+
+        mutable SegmentHint               _lastSegment;     ///< where findSegment starts looking
+
+        /// the key starting the segment time is in, the keys either side of it must exist
+        int findSegment(OfxTime time) const;
+
+        /// the slope a catmull-rom curve leaves or enters the key with in the dimension
+        double catmullRomSlope(int key, int dimension) const;
+
+        /// the value of a dimension part way through a segment
+        double interpolate(int segment, int dimension, OfxTime time) const;
+
+        /// the coefficients of the cubic in the fraction of the way through a segment that each
+        /// interpolation is, lowest power first, for evaluating many times in the segment
+        void segmentCoefficients(int segment, int dimension, double coefficients[4]) const;
+
+        /// the rate of change of a dimension part way through a segment
+        double interpolateDerivative(int segment, int dimension, OfxTime time) const;
+
+        /// the integral of a dimension from the start of a segment to time, which may be its end
+        double interpolateIntegral(int segment, int dimension, OfxTime time) const;
+
+        /// recompute _integrals from the given key on, the ones before it must be right
+        void updateIntegrals(int fromKey);
+
+        /// the integral of a dimension from the first key to time, negative before it
+        double integralTo(OfxTime time, int dimension) const;
+
+      public :
+        explicit Animation(int nDimensions = 0);
+
+        /// the number of values a key holds
+        int getNumDimensions() const {return _nDimensions;}
+
+        /// change the number of values a key holds, removing any keys and zeroing the values
+        void setNumDimensions(int nDimensions);
+
+        /// the interpolation new keys get, smooth unless set
+        InterpolationEnum getDefaultInterpolation() const {return _defaultInterpolation;}
+        void setDefaultInterpolation(InterpolationEnum v) {_defaultInterpolation = v;}
+
+        int getNumKeys() const {return int(_times.size());}
+
+        /// the time of the nth key, which must exist
+        OfxTime getKeyTime(int nth) const {return _times[nth];}
+
+        /// a value of the nth key, which must exist
+        double getKeyValue(int nth, int dimension) const {return _values[dimension][nth];}
+
+        /// how the nth key, which must exist, goes to the next one
+        InterpolationEnum getKeyInterpolation(int nth) const {return InterpolationEnum(_interpolations[nth]);}
+        void setKeyInterpolation(int nth, InterpolationEnum v);
+
+        /// The index of the key at time if direction is 0, of the last key before it if
+        /// direction is negative or of the first key after it if positive. -1 if there is none.
+        int getKeyIndex(OfxTime time, int direction) const;
+
+        /// set the values used while there are no keys, one per dimension
+        void setValue(const double *values);
+
+        /// add a key with a value per dimension, or change the values of the key already at time
+        void setKey(OfxTime time, const double *values);
+
+        /// remove the key at time, false if there is none
+        bool deleteKey(OfxTime time);
+
+        /// remove all the keys, leaving the values last given to setValue
+        void deleteAllKeys();
+
+        /// the value of every dimension at time
+        void getValue(OfxTime time, double *values) const;
+
+        /// the value of one dimension at time
+        double getValue(OfxTime time, int dimension) const;
+
+        /// The value of every dimension at each of nTimes times, values holds those of the first
+        /// time, then of the second and so on. The samples are evaluated a run of them in the
+        /// same segment at a time, as a polynomial with no branches the compiler can vectorise.
+        void getValues(const OfxTime *times, int nTimes, double *values) const;
+
+        /// the rate of change per unit time of every dimension at time, zero outside the keys
+        void getDerivative(OfxTime time, double *values) const;
+
+        /// the rate of change per unit time of one dimension at time
+        double getDerivative(OfxTime time, int dimension) const;
+
+        /// the integral of every dimension from time1 to time2
+        void getIntegral(OfxTime time1, OfxTime time2, double *values) const;
+
+        /// the integral of one dimension from time1 to time2, in O(log keys)
+        double getIntegral(OfxTime time1, OfxTime time2, int dimension) const;
+      };
+
+    }
+
+  }
+
+}
+
+#endif // OFXH_ANIMATION_H
@@ -33,6 +33,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "ofxImageEffect.h"
 #include "ofxhUtilities.h"
+#include "ofxhThread.h"
 
 namespace OFX {
 
@@ -78,7 +79,7 @@ namespace OFX {
         const std::string &getLongLabel() const;
 
         /// return a std::vector of supported comp
-        const std::vector<std::string> &getSupportedComponents() const;
+        std::vector<std::string> getSupportedComponents() const;
         
         /// is the given component supported
         bool isSupportedComponent(const std::string &comp) const;
@@ -307,7 +308,7 @@ namespace OFX {
       protected :
         /// called during ctors to get bits from the clip props into ours
         void getClipBits(ClipInstance& instance);
-        int _referenceCount; ///< reference count on this image
+        Thread::AtomicCount _referenceCount; ///< reference count on this image, images may be shared between render threads
 
       public:
         // default constructor
@@ -378,7 +379,7 @@ namespace OFX {
         void releaseReference();
 
         /// add a reference to this image
-        void addReference() {_referenceCount++;}
+        void addReference() {_referenceCount.increment();}
       };
 
       /// instance of an image inside an image effect
@@ -0,0 +1,179 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OFX_IMAGE_CACHE_H
+#define OFX_IMAGE_CACHE_H
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ofxCore.h"
+#include "ofxImageEffect.h"
+#include "ofxhThread.h"
+
+namespace OFX {
+
+  namespace Host {
+
+    namespace Param {
+      class SetInstance;
+    }
+
+    namespace ImageEffect {
+
+      // forward declarations
+      class Instance;
+      class ClipInstance;
+      class Image;
+
+      /// A least recently used cache of images, for ClipInstance implementations to put
+      /// fetched or rendered frames in, so fetching the same frame twice, say by a retimer
+      /// asking for floor(t) and floor(t)+1 on consecutive output frames, does not render
+      /// the upstream graph again.
+      ///
+      /// Images are looked up by the effect and clip they came from, the time, field,
+      /// render scale, pixel depth, components and a hash of the effect's parameters. A cached image satisfies a
+      /// request if its bounds contain the requested bounds, so one big tile can serve many
+      /// smaller requests.
+      ///
+      /// The cache holds a reference on every image in it, images handed out by find have
+      /// an extra reference which the caller must release. Entries are evicted least
+      /// recently used first to keep the cache within its budget.
+      ///
+      /// The cache does not hear about effects going away, hosts must call invalidate
+      /// with an effect instance before destroying it.
+      class ImageCache {
+      public :
+        /// what an image in the cache is of, bar its bounds
+        struct Key {
+          const Instance     *effect;      ///< the effect the image was rendered by
+          const ClipInstance *clip;        ///< the clip the image was fetched from
+          OfxTime             time;
+          std::string         field;       ///< one of kOfxImageField*
+          OfxPointD           renderScale;
+          std::string         depth;       ///< one of kOfxBitDepth*, the same frame may be fetched at several depths
+          std::string         components;  ///< one of kOfxImageComponent*
+          unsigned long long  paramsHash;  ///< see hashParams
+
+          Key();
+          Key(const Instance *effect, const ClipInstance *clip, OfxTime time, const std::string &field,
+              OfxPointD renderScale, const std::string &depth, const std::string &components,
+              unsigned long long paramsHash);
+
+          bool operator<(const Key &other) const;
+        };
+
+        /// counters describing what the cache has done
+        struct Statistics {
+          size_t hits;
+          size_t misses;
+          size_t insertions;
+          size_t evictions;
+          size_t entries;
+          size_t bytesInUse;
+        };
+
+        /// make a cache, a budget of 0 means it is unlimited
+        explicit ImageCache(size_t budget = 0);
+        ~ImageCache();
+
+        /// Find an image covering bounds, returns NULL if there is none. 
+        /// The returned image has had a reference added for the caller.
+        Image *find(const Key &key, const OfxRectI &bounds);
+
+        /// Put an image in the cache, adding a reference to it. Any cached images for the
+        /// same key whose bounds are inside the new image's are dropped. Images bigger
+        /// than the whole budget are not cached.
+        void insert(const Key &key, Image *image);
+
+        /// drop all images rendered by an effect
+        void invalidate(const Instance *effect);
+
+        /// drop all images fetched from a clip
+        void invalidate(const ClipInstance *clip);
+
+        /// drop everything
+        void clear();
+
+        /// set the budget in bytes of pixel data, evicting if need be, 0 means unlimited
+        void setBudget(size_t budget);
+        size_t getBudget() const;
+
+        /// get a snapshot of the counters
+        Statistics getStatistics() const;
+
+        /// Hash the values of all the parameters in a set at the given time, for use as
+        /// Key::paramsHash. Pages, groups, pushbuttons and unknown types are skipped.
+        static unsigned long long hashParams(Param::SetInstance &params, OfxTime time);
+
+      protected :
+        struct Entry;
+        typedef std::list<Entry *> LRUList;
+        typedef std::map<Key, std::vector<Entry *> > EntryMap;
+
+        /// an image in the cache
+        struct Entry {
+          EntryMap::iterator  slot;   ///< where we are in _entries
+          LRUList::iterator   lru;    ///< where we are in _lru
+          Image              *image;
+          OfxRectI            bounds;
+          size_t              bytes;
+        };
+
+        /// take an entry out of the cache, the image reference is appended to dead, assumes the lock is held
+        void removeLocked(Entry *entry, std::vector<Image *> &dead);
+
+        /// evict until within budget, assumes the lock is held
+        void evictLocked(std::vector<Image *> &dead);
+
+        /// release images taken out of the cache, called without the lock held
+        static void releaseImages(std::vector<Image *> &dead);
+
+        mutable Thread::Mutex  _lock;
+        EntryMap               _entries;  ///< entries by key, each with their own bounds
+        LRUList                _lru;      ///< most recently used at the front
+        size_t                 _budget;
+        Statistics             _stats;
+
+      private :
+        /// not copyable
+        ImageCache(const ImageCache &);
+        void operator=(const ImageCache &);
+      };
+
+    } // ImageEffect
+
+  } // Host
+
+} // OFX
+
+#endif // OFX_IMAGE_CACHE_H
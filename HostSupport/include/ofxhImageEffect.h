@@ -299,6 +299,12 @@ namespace OFX {
       /// a map used to specify needed frame ranges on set of clips
       typedef std::map<ClipInstance *, std::vector<OfxRangeD> > RangeMap;
 
+      /// If the image memory pool went over its budget since the last call, ask every created
+      /// instance to purge its caches, and return true. The pool only notes the pressure, as it
+      /// runs out on whichever thread happens to be allocating, so hosts call this from a thread
+      /// they may run actions on, between renders for instance.
+      bool purgeCachesUnderPressure();
+
       /// an image effect plugin instance.
       ///
       /// Client code needs to filling the pure virtuals in this.
@@ -324,6 +330,11 @@ namespace OFX {
         std::string                                   _outputFielding;  ///< set by clip prefs
         double                                        _outputFrameRate; ///< set by clip prefs
 
+        /// pre-built argument sets for the per frame actions, see ofxhImageEffect.cpp
+        class ActionArgs;
+        class ActionArgsPool;
+        ActionArgsPool                               *_actionArgsPool; ///< argument sets not in use by any action
+
       public:        
         /// constructor based on clip descriptor
         Instance(ImageEffectPlugin* plugin,
@@ -40,6 +40,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ofxImageEffect.h"
 #include "ofxhImageEffect.h"
 #include "ofxhHost.h"
+#include "ofxhThread.h"
 
 namespace OFX {
   
@@ -57,7 +58,8 @@ namespace OFX {
 
         // this comes off Descriptor's property set after a describe
         // context independent
-        Descriptor *_baseDescriptor; /// NEEDS TO BE MADE WITH A FACTORY FUNCTION ON THE HOST!!!!!!
+        /// made on first use for plugins read from a cache, as most of those are never looked at
+        mutable Descriptor *_baseDescriptor; /// NEEDS TO BE MADE WITH A FACTORY FUNCTION ON THE HOST!!!!!!
         
         /// map to store contexts in
         std::map<std::string, Descriptor *> _contexts;
@@ -69,6 +71,9 @@ namespace OFX {
 
         void addContextInternal(const std::string &context) const;
 
+        /// get the base descriptor, making it if need be
+        Descriptor &baseDescriptor() const;
+
       public:
 			  ImageEffectPlugin(PluginCache &pc, PluginBinary *pb, int pi, OfxPlugin *pl);
 
@@ -173,6 +178,9 @@ namespace OFX {
         /// pointer to our image effect host
         OFX::Host::ImageEffect::Host* _host;
 
+        /// a parallel scan loads plugins on several threads, the host's loadingStatus is called under this
+        mutable Thread::Mutex _loadingStatusLock;
+
       public:  
 
         explicit PluginCache(OFX::Host::ImageEffect::Host &host);
@@ -202,6 +210,9 @@ namespace OFX {
 
         /// handle the case where the info needs filling in from the file.  runs the "describe" action on the plugin.
         void loadFromPlugin(Plugin *p) const;
+
+        /// runs the "describe in context" action on the plugin for each context it supports
+        void describeFully(Plugin *p);
         
         /// handler for preparing to read in a chunk of XML from the cache, set up context to do this
         void beginXmlParsing(Plugin *p);
@@ -219,6 +230,9 @@ namespace OFX {
 
         void confirmPlugin(Plugin *p);
 
+        /// drop a plugin from those we know, working out the latest versions again
+        void forgetPlugin(Plugin *p);
+
         virtual bool pluginSupported(Plugin *p, std::string &reason) const;
 
         Plugin *newPlugin(PluginBinary *pb,
@@ -31,6 +31,11 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef OFX_MEMORY_H
 #define OFX_MEMORY_H
 
+#include <stddef.h>
+#include <vector>
+
+#include "ofxhThread.h"
+
 namespace OFX {
 
   namespace Host {
@@ -56,6 +61,112 @@ namespace OFX {
         int     _locked;
       };
 
+      /// Called by a Pool when allocating would take it over its budget, after it has
+      /// given its own spare buffers back to the system.
+      class PressureHandler {
+      public :
+        virtual ~PressureHandler() {}
+
+        /// try and free up some memory, nBytes is the size of the allocation that caused the pressure
+        virtual void memoryPressure(size_t nBytes) = 0;
+      };
+
+      /// A size class pool for image sized buffers. 
+      ///
+      /// Requests are rounded up to one of four sizes per power of two, and freed buffers
+      /// are kept on a list for their size class, so the next frame's buffers of the same
+      /// shape come back without touching the system allocator. All buffers are 64 byte
+      /// aligned and, if asked for, big ones are backed by huge pages where the OS can.
+      ///
+      /// The budget is soft, going over it releases the spare buffers and then calls the
+      /// pressure handler, but the allocation is always attempted.
+      class Pool {
+      public :
+        /// alignment of every buffer handed out
+        static const size_t kAlignment = 64;
+
+        /// counters describing what the pool has done
+        struct Statistics {
+          size_t allocations;       ///< number of calls to allocate
+          size_t reuses;            ///< number of those served from a spare buffer
+          size_t systemAllocations; ///< number of those that went to the system
+          size_t releases;          ///< number of calls to release
+          size_t purges;            ///< number of times the budget was exceeded
+          size_t bytesInUse;        ///< bytes currently handed out, rounded to their size class
+          size_t bytesSpare;        ///< bytes sitting on the spare lists
+          size_t peakBytesInUse;    ///< high water mark of bytesInUse
+        };
+
+        Pool();
+        ~Pool();
+
+        /// the pool used by the default memory instances, which lives until the program ends
+        static Pool &global();
+
+        /// get a buffer of at least nBytes, capacity is set to its real size which must be given back to release
+        void *allocate(size_t nBytes, size_t &capacity);
+
+        /// give back a buffer got from allocate
+        void release(void *ptr, size_t capacity);
+
+        /// give all spare buffers back to the system
+        void trim();
+
+        /// set the budget in bytes of buffers in use plus spare, 0 means no budget
+        void setBudget(size_t nBytes);
+        size_t getBudget() const;
+
+        /// set whether buffers of 2MB or more should ask for huge pages
+        void setUseHugePages(bool v);
+        bool getUseHugePages() const;
+
+        /// set the handler called when going over budget, may be NULL
+        void setPressureHandler(PressureHandler *handler);
+
+        /// get a snapshot of the counters
+        Statistics getStatistics() const;
+
+      protected :
+        /// the size class for nBytes, and the capacity of that class
+        static int sizeClass(size_t nBytes, size_t &capacity);
+
+        /// get memory from the system
+        void *systemAlloc(size_t capacity);
+
+        /// give memory back to the system
+        static void systemFree(void *ptr);
+
+        /// free all spare buffers, assumes the lock is held
+        void trimLocked();
+
+        mutable Thread::Mutex                _lock;
+        std::vector< std::vector<void *> >   _spare;    ///< spare buffers, indexed by size class
+        size_t                               _budget;
+        bool                                 _useHugePages;
+        bool                                 _inPressure; ///< set while the pressure handler is running
+        PressureHandler                     *_pressureHandler;
+        Statistics                           _stats;
+
+      private :
+        /// not copyable
+        Pool(const Pool &);
+        void operator=(const Pool &);
+      };
+
+      /// A memory instance whose buffer comes from the global Pool, the default used by
+      /// ImageEffect::Instance::imageMemoryAlloc and ImageEffect::Host::imageMemoryAlloc.
+      class PooledInstance : public Instance {
+      public :
+        PooledInstance();
+        virtual ~PooledInstance();
+
+        virtual bool alloc(size_t nBytes);
+        virtual void freeMem();
+
+      protected :
+        size_t _capacity; ///< size class of _ptr, as given by Pool::allocate
+      };
+
     } // Memory
 
   } // Host
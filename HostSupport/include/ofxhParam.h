@@ -41,6 +41,9 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 //ofxh
 #include "ofxhPropertySuite.h"
+#include "ofxhAnimation.h"
+#include "ofxhParamSnapshot.h"
+#include "ofxhThread.h"
 
 
 namespace OFX {
@@ -52,6 +55,9 @@ namespace OFX {
       /// fetch the param suite
       const void *GetSuite(int version);
 
+      /// fetch the batched param suite, see ofxsParamBatchSuite.h
+      const void *GetBatchSuite(int version);
+
       bool isColourParam(const std::string &paramType);
 
       bool isIntParam(const std::string &paramType);
@@ -256,12 +262,53 @@ namespace OFX {
         /// integrate a value, implemented by instances to deconstruct var args
         virtual OfxStatus integrateV(OfxTime time1, OfxTime time2, va_list arg);
 
+        /// get the values at many times, for NetSfOfxParameterBatchSuiteV1, implemented by the double valued params
+        virtual OfxStatus getValuesAtTimes(const OfxTime *times, int nTimes, double *values);
+
         /// overridden from Property::NotifyHook
         virtual void notify(const std::string &name, bool single, int num) OFX_EXCEPTION_SPEC;
       };
 
+      /// The keyframes of an animating param. These fail with kOfxStatErrMissingHostFeature
+      /// unless the host overrides them or keeps the param's keys in the built in animation
+      /// engine, by calling useAnimation, editing values through getAnimation and reading them
+      /// through readAnimation.
       class KeyframeParam {
+      protected:
+        friend class SetInstance;
+
+        Animation _animation;    ///< the built in keys, with no dimensions unless useAnimation was called
+        int       _snapshotSlot; ///< where the param is in its set's snapshots, -1 until first published
+
+        /// the derivative of each dimension from the built in animation, for the double params' derive
+        OfxStatus deriveAnimation(OfxTime time, double *values) const;
+
+        /// the integral of each dimension from the built in animation, for the double params' integrate
+        OfxStatus integrateAnimation(OfxTime time1, OfxTime time2, double *values) const;
       public:
+        KeyframeParam() : _snapshotSlot(-1) {}
+
+        /// keep the param's keys in the built in animation engine, with the given number of values a key
+        void useAnimation(int nDimensions) {_animation.setNumDimensions(nDimensions);}
+
+        /// has useAnimation been called
+        bool usesAnimation() const {return _animation.getNumDimensions() > 0;}
+
+        /// the live animation, which the thread editing the param changes
+        Animation &getAnimation() {return _animation;}
+        const Animation &getAnimation() const {return _animation;}
+
+        /// The animation to get values from. On a thread rendering with a pinned snapshot of the
+        /// param's set, see SetInstance::RenderPin, it is the param as it was when the render
+        /// started, which needs no lock however the param is being edited meanwhile. Anywhere
+        /// else it is the live animation.
+        const Animation &readAnimation() const
+        {
+          const Snapshot *snapshot = Snapshot::pinned();
+          const Animation *animation = snapshot ? snapshot->find(this, _snapshotSlot) : 0;
+          return animation ? *animation : _animation;
+        }
+
         virtual OfxStatus getNumKeys(unsigned int &nKeys) const ;
         virtual OfxStatus getKeyTime(int nth, OfxTime& time) const ;
         virtual OfxStatus getKeyIndex(OfxTime time, int direction, int & index) const ;
@@ -361,8 +408,10 @@ namespace OFX {
         virtual OfxStatus get(OfxTime time, double&) = 0;
         virtual OfxStatus set(double) = 0;
         virtual OfxStatus set(OfxTime time, double) = 0;
-        virtual OfxStatus derive(OfxTime time, double&) = 0;
-        virtual OfxStatus integrate(OfxTime time1, OfxTime time2, double&) = 0;
+
+        // derived class does not need to implement if it uses the built in animation, which is exact
+        virtual OfxStatus derive(OfxTime time, double&) ;
+        virtual OfxStatus integrate(OfxTime time1, OfxTime time2, double&) ;
 
         /// implementation of var args function
         virtual OfxStatus getV(va_list arg);
@@ -381,6 +430,9 @@ namespace OFX {
 
         /// implementation of var args function
         virtual OfxStatus integrateV(OfxTime time1, OfxTime time2, va_list arg);
+
+        /// from the built in animation if the param uses it, otherwise a get per time
+        virtual OfxStatus getValuesAtTimes(const OfxTime *times, int nTimes, double *values);
       };
 
       class BooleanInstance : public Instance, public KeyframeParam {
@@ -416,7 +468,7 @@ namespace OFX {
         virtual OfxStatus set(double,double,double,double) = 0;
         virtual OfxStatus set(OfxTime time, double,double,double,double) = 0;
 
-        // derived class does not need to implement, default is an approximation
+        // derived class does not need to implement if it uses the built in animation, which is exact
         virtual OfxStatus derive(OfxTime time, double&,double&,double&,double&) ;
         virtual OfxStatus integrate(OfxTime time1, OfxTime time2, double&,double&,double&,double&) ;
 
@@ -437,6 +489,9 @@ namespace OFX {
 
         /// implementation of var args function
         virtual OfxStatus integrateV(OfxTime time1, OfxTime time2, va_list arg);
+
+        /// from the built in animation if the param uses it, otherwise a get per time
+        virtual OfxStatus getValuesAtTimes(const OfxTime *times, int nTimes, double *values);
       };
 
       class RGBInstance : public Instance, public KeyframeParam {
@@ -449,7 +504,7 @@ namespace OFX {
         virtual OfxStatus set(double,double,double) = 0;
         virtual OfxStatus set(OfxTime time, double,double,double) = 0;
 
-        // derived class does not need to implement, default is an approximation
+        // derived class does not need to implement if it uses the built in animation, which is exact
         virtual OfxStatus derive(OfxTime time, double&,double&,double&) ;
         virtual OfxStatus integrate(OfxTime time1, OfxTime time2, double&,double&,double&) ;
 
@@ -470,6 +525,9 @@ namespace OFX {
 
         /// implementation of var args function
         virtual OfxStatus integrateV(OfxTime time1, OfxTime time2, va_list arg);
+
+        /// from the built in animation if the param uses it, otherwise a get per time
+        virtual OfxStatus getValuesAtTimes(const OfxTime *times, int nTimes, double *values);
       };
         
       class Double2DInstance : public Instance, public KeyframeParam {
@@ -482,7 +540,7 @@ namespace OFX {
         virtual OfxStatus set(double,double) = 0;
         virtual OfxStatus set(OfxTime time, double,double) = 0;
 
-        // derived class does not need to implement, default is an approximation
+        // derived class does not need to implement if it uses the built in animation, which is exact
         virtual OfxStatus derive(OfxTime time, double&,double&) ;
         virtual OfxStatus integrate(OfxTime time1, OfxTime time2, double&,double&) ;
 
@@ -503,6 +561,9 @@ namespace OFX {
 
         /// implementation of var args function
         virtual OfxStatus integrateV(OfxTime time1, OfxTime time2, va_list arg);
+
+        /// from the built in animation if the param uses it, otherwise a get per time
+        virtual OfxStatus getValuesAtTimes(const OfxTime *times, int nTimes, double *values);
       };
 
       class Integer2DInstance : public Instance, public KeyframeParam {
@@ -548,7 +609,7 @@ namespace OFX {
         virtual OfxStatus set(double,double,double)  = 0;
         virtual OfxStatus set(OfxTime time, double,double,double)  = 0;
 
-        // derived class does not need to implement, default is an approximation
+        // derived class does not need to implement if it uses the built in animation, which is exact
         virtual OfxStatus derive(OfxTime time, double&,double&,double&) ;
         virtual OfxStatus integrate(OfxTime time1, OfxTime time2, double&,double&,double&) ;
 
@@ -569,6 +630,9 @@ namespace OFX {
 
         /// implementation of var args function
         virtual OfxStatus integrateV(OfxTime time1, OfxTime time2, va_list arg);
+
+        /// from the built in animation if the param uses it, otherwise a get per time
+        virtual OfxStatus getValuesAtTimes(const OfxTime *times, int nTimes, double *values);
       };
 
       class Integer3DInstance : public Instance, public KeyframeParam {
@@ -645,10 +709,19 @@ namespace OFX {
       /// As we are the owning object we delete the params inside ourselves. It was tempting
       /// to make params autoref objects and have shared ownership with the client code
       /// but that adds complexity for no strong gain.
+      ///
+      /// Params keeping their values in the built in animation engine are also published in
+      /// immutable, copy on write snapshots, see Snapshot. A render pins the latest snapshot
+      /// for its duration with a RenderPin, and its param reads then come from that and need no
+      /// lock, so renders on several threads can run while the params are being edited. Edits
+      /// made through the param suite are published as they are made; hosts changing a param's
+      /// animation themselves call publishParam once they have.
       class SetInstance : public BaseSet {
       protected:
         std::map<std::string, Instance*> _params;        ///< params by name
         std::list<Instance *>            _paramList;     ///< params list
+        Snapshot                        *_snapshot;      ///< the latest published version of the params, NULL until one is
+        Thread::Mutex                    _snapshotLock;  ///< held to replace _snapshot or to take a reference on it
 
       public :
         /// ctor
@@ -697,6 +770,38 @@ namespace OFX {
         /// Client host code needs to implement this
         virtual OfxStatus editEnd() = 0;
 
+        /// Make the param's animation as it is now what renders starting from now on see, by
+        /// publishing a new snapshot. Renders already running keep the one they started with.
+        /// Does nothing for params not using the built in animation.
+        void publishParam(Instance *param);
+
+        /// Publish a new version of an animation of owner's that is not a KeyframeParam's own,
+        /// such as a parametric param's curve, taking over the caller's reference on it. slot
+        /// is where owner keeps it in the snapshots, -1 until first published, when it is set.
+        void publishAnimation(const void *owner, int &slot, Snapshot::SharedAnimation *animation);
+
+        /// a reference on the latest snapshot, NULL if nothing was published, let it go with Snapshot::release
+        const Snapshot *pinSnapshot();
+
+        /// Pins the latest snapshot of a set for the calling thread's param reads for its
+        /// lifetime, and for those of the threads its multiThread calls run on. Inside a
+        /// render of the same set it keeps the snapshot already pinned, so every action of
+        /// one frame sees the same values.
+        class RenderPin {
+        public :
+          explicit RenderPin(SetInstance &set);
+          ~RenderPin();
+
+        protected :
+          const Snapshot *_snapshot;  ///< the snapshot this pinned, NULL if it kept one already pinned
+          void           *_previous;  ///< the pin this one hides, if renders nest
+
+        private :
+          /// not copyable
+          RenderPin(const RenderPin &);
+          void operator=(const RenderPin &);
+        };
+
       };
     }
   }
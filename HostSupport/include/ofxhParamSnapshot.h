@@ -0,0 +1,150 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OFXH_PARAM_SNAPSHOT_H
+#define OFXH_PARAM_SNAPSHOT_H
+
+#include <vector>
+
+#include "ofxhAnimation.h"
+#include "ofxhThread.h"
+
+namespace OFX {
+
+  namespace Host {
+
+    namespace Param {
+
+      // forward declare
+      class KeyframeParam;
+      class SetInstance;
+
+      /// One immutable version of the params of a SetInstance that keep their values in the
+      /// built in animation engine, which renders read while the params are being edited.
+      ///
+      /// A version holds a copy of each animation, one per keyframed param and one per curve of
+      /// each parametric param. Publishing an edited animation makes a new version sharing every
+      /// other copy with the last one, so an edit costs a copy of the one animation plus a
+      /// pointer per animation, whatever the size of the others.
+      ///
+      /// Versions are reference counted, by the SetInstance while they are its latest and by each
+      /// render pinning them, the last one to let go deletes it.
+      class Snapshot {
+      public :
+        /// A copy of an animation, shared by the versions it did not change between. The
+        /// curves of parametric params keep a lookup table sampled from it alongside.
+        struct SharedAnimation {
+          explicit SharedAnimation(const Animation &a) : animation(a), tableMin(0), tableMax(0), tableScale(0), refs(1) {}
+
+          Animation                   animation;
+          std::vector<double>         table;      ///< samples of the animation from tableMin to tableMax, empty if none
+          double                      tableMin;
+          double                      tableMax;
+          double                      tableScale; ///< samples per unit time
+          mutable Thread::AtomicCount refs;
+
+          /// take a reference
+          void addRef() const { refs.increment(); }
+
+          /// let a reference go, deleting the copy if it was the last
+          void release() const
+          {
+            if(refs.decrement() == 0)
+              delete this;
+          }
+        };
+
+        /// the animation owner published at slot in this version, NULL if it was not published in it
+        const SharedAnimation *findShared(const void *owner, int slot) const
+        {
+          if(slot < 0 || slot >= int(_entries.size()) || _entries[slot].owner != owner)
+            return 0;
+          return _entries[slot].animation;
+        }
+
+        /// the animation param had in this version, NULL if it was not published in it
+        const Animation *find(const KeyframeParam *param, int slot) const
+        {
+          const SharedAnimation *shared = findShared(param, slot);
+          return shared ? &shared->animation : 0;
+        }
+
+        /// The version the calling thread is rendering with, NULL outside a render. It is also
+        /// set on the threads running the multiThread calls of the render.
+        static const Snapshot *pinned()
+        {
+          return static_cast<const Snapshot *>(Thread::WorkerPool::renderContext());
+        }
+
+        /// the set this is a version of
+        const SetInstance *getSet() const { return _set; }
+
+        /// take a reference
+        void addRef() const { _refs.increment(); }
+
+        /// let a reference go, deleting the version if it was the last
+        void release() const;
+
+      protected :
+        friend class SetInstance;
+
+        /// an animation and whose it is, a keyframed param or a parametric param, at its slot
+        struct Entry {
+          const void      *owner;
+          SharedAnimation *animation;
+        };
+
+        const SetInstance          *_set;
+        std::vector<Entry>          _entries;
+        mutable Thread::AtomicCount _refs;
+
+        /// an empty version of set, with one reference
+        explicit Snapshot(const SetInstance *set) : _set(set), _refs(1) {}
+
+        /// the same entries as other, with one reference
+        explicit Snapshot(const Snapshot &other);
+
+        ~Snapshot();
+
+        /// give owner's slot a copy of animation, adding the slot if need be
+        void setEntry(const void *owner, int slot, SharedAnimation *animation);
+
+      private :
+        /// not assignable
+        void operator=(const Snapshot &);
+      };
+
+    }
+
+  }
+
+}
+
+#endif // OFXH_PARAM_SNAPSHOT_H
@@ -0,0 +1,164 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OFXH_PARAMETRIC_PARAM_H
+#define OFXH_PARAMETRIC_PARAM_H
+
+#include <vector>
+
+#include "ofxParametricParam.h"
+
+#include "ofxhParam.h"
+
+namespace OFX {
+
+  namespace Host {
+
+    namespace ParametricParam {
+
+      /// fetch the parametric param suite, see ofxParametricParam.h
+      const void *GetSuite(int version);
+
+      /// The control points of the curves of a parametric param, one curve per dimension,
+      /// which the suite functions work through.
+      ///
+      /// Each curve is kept in a one dimensional Param::Animation, its key times being the
+      /// parametric positions of the control points, so curves are catmull-rom splines through
+      /// their points, flat outside them, and have the animation engine's segment lookups.
+      ///
+      /// Curves do not animate, the host says as much with kOfxParamHostPropSupportsParametricAnimation,
+      /// so the times and addAnimationKey the suite passes are ignored. Hosts wanting either
+      /// override the virtuals.
+      class Curves {
+      protected :
+        std::vector<Param::Animation> _curves; ///< control points of each curve, made as they are first edited
+
+        /// the curve to edit, made if need be
+        Param::Animation &editCurve(int curveIndex);
+
+        /// called after a curve's control points change
+        virtual void curveChanged(int curveIndex);
+
+        /// the curve the read only suite functions look at, the one being edited unless overridden
+        virtual const Param::Animation *readCurve(int curveIndex) const;
+
+      public :
+        virtual ~Curves();
+
+        /// the number of curves, the param's kOfxParamPropParametricDimension
+        virtual int getNumCurves() const = 0;
+
+        /// the curve being edited, NULL if none was made yet
+        const Param::Animation *findCurve(int curveIndex) const;
+
+        /// the value of a curve at a parametric position
+        virtual OfxStatus getValue(int curveIndex, OfxTime time, double parametricPosition, double &value) const;
+
+        virtual OfxStatus getNControlPoints(int curveIndex, OfxTime time, int &nControlPoints) const;
+        virtual OfxStatus getNthControlPoint(int curveIndex, OfxTime time, int nthCtl, double &key, double &value) const;
+
+        /// move the nth control point, which may change its place in the order
+        virtual OfxStatus setNthControlPoint(int curveIndex, OfxTime time, int nthCtl, double key, double value, bool addAnimationKey);
+
+        /// add a control point, or set the one already within a millionth of the curve's span of key
+        virtual OfxStatus addControlPoint(int curveIndex, OfxTime time, double key, double value, bool addAnimationKey);
+
+        virtual OfxStatus deleteControlPoint(int curveIndex, int nthCtl);
+        virtual OfxStatus deleteAllControlPoints(int curveIndex);
+      };
+
+      /// The descriptor of a parametric param, whose curves are the default ones the plugin
+      /// sets through the suite while describing.
+      class ParametricDescriptor : public Param::Descriptor, public Curves {
+      public :
+        ParametricDescriptor(const std::string &type, const std::string &name);
+
+        /// read from the properties, as the plugin may still be setting the dimension
+        virtual int getNumCurves() const;
+      };
+
+      /// An instance of a parametric param, starting with its descriptor's curves, or an
+      /// identity over kOfxParamPropParametricRange for those the plugin did not set.
+      ///
+      /// Each edit of a curve publishes a copy of it in the snapshots of the param's set, see
+      /// Param::Snapshot, so renders read the curves as they were when they started while
+      /// the curves are being edited. Anywhere but a render the latest copies are read.
+      ///
+      /// Colour curve plugins evaluate their curves once per pixel, so a host can have each
+      /// curve sampled into a dense table with useLookupTables. Values in the range are then
+      /// a linear blend of the two nearest samples, two table reads. A curve's table is kept
+      /// with its copy, so is resampled whenever it is edited.
+      class ParametricInstance : public Param::Instance, public Curves {
+      protected :
+        int    _lutSize; ///< samples per table, 0 if not using them
+        double _lutMin;  ///< the parametric range the tables cover
+        double _lutMax;
+
+        std::vector<Param::Snapshot::SharedAnimation *> _published;     ///< the latest copy of each curve, we hold a reference on these
+        std::vector<int>                                _snapshotSlots; ///< where each curve is in the set's snapshots, -1 until published
+
+        /// republish the curve
+        virtual void curveChanged(int curveIndex);
+
+        /// the curve's copy in the snapshot the calling thread's render pinned, else its latest
+        virtual const Param::Animation *readCurve(int curveIndex) const;
+
+        /// the copy of the curve to read, as readCurve, NULL if none was made
+        const Param::Snapshot::SharedAnimation *readPublished(int curveIndex) const;
+
+        /// copy the curve, with a table if using them, and publish the copy
+        void publishCurve(int curveIndex);
+
+      public :
+        explicit ParametricInstance(Param::Descriptor &descriptor, Param::SetInstance *instance = 0);
+
+        virtual ~ParametricInstance();
+
+        /// fixed once made, so not looked up in the properties every evaluation
+        virtual int getNumCurves() const;
+
+        /// Sample every curve into a table of nSamples values over kOfxParamPropParametricRange,
+        /// or stop using tables if nSamples is less than 2 or the range is empty. Blending samples
+        /// is exact for linear stretches of a curve, elsewhere the error falls with the square of
+        /// the sample spacing, as samples are nudged to straddle the curve it is at most a
+        /// sixteenth of the spacing squared times the curve's second derivative. That is under
+        /// 1e-7 of the value range with 4096 samples for typical colour curves, see lutTest.
+        void useLookupTables(int nSamples);
+
+        virtual OfxStatus getValue(int curveIndex, OfxTime time, double parametricPosition, double &value) const;
+      };
+
+    }
+
+  }
+
+}
+
+#endif // OFXH_PARAMETRIC_PARAM_H
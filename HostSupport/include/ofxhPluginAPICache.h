@@ -74,6 +74,11 @@ namespace OFX
         
         virtual void loadFromPlugin(Plugin *) const = 0;
 
+        /// Run any describe actions the API has beyond those loadFromPlugin runs, eg: per context
+        /// ones, so a plugin that fails in them fails inside a describe helper rather than later
+        /// on in the host. Does nothing by default.
+        virtual void describeFully(Plugin *) {}
+
         /// factory method, to create a new plugin (from binary)
         virtual Plugin *newPlugin(PluginBinary *, int pi, OfxPlugin *plug) = 0;
 
@@ -91,6 +96,10 @@ namespace OFX
 
         virtual void confirmPlugin(Plugin *) = 0;
 
+        /// A plugin given to confirmPlugin is about to be deleted by PluginCache::rescanPluginFiles,
+        /// drop any reference kept to it. Does nothing by default.
+        virtual void forgetPlugin(Plugin *) {}
+
         virtual bool pluginSupported(Plugin *, std::string &reason) const = 0;
 
         void registerInCache(OFX::Host::PluginCache &pluginCache);
@@ -44,6 +44,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ofxhPropertySuite.h"
 #include "ofxhPluginAPICache.h"
 #include "ofxhBinary.h"
+#include "ofxhPluginCacheFile.h"
+#include "ofxhThread.h"
 
 namespace OFX {
 
@@ -56,6 +58,7 @@ namespace OFX {
     class Plugin;
     class PluginBinary;
     class PluginCache;
+    class PluginWatcher;
 
     /// C++ version of the information kept inside an OfxPlugin struct
     class PluginDesc  {
@@ -145,6 +148,14 @@ namespace OFX {
     protected :
       PluginBinary *_binary; ///< the file I live inside
       int           _index;  ///< where I live inside that file
+
+      friend class PluginCache;
+      PluginCache *_sourceCache;                  ///< the cache I was read from, if any, never cleared
+      mutable PluginCache *_pendingCache;         ///< set if my API specific data is still to be decoded from a cache, guarded by its _cacheFileLock
+      const CacheFile::Reader *_pendingFile;      ///< the cache it is in
+      unsigned int _pendingRecord;                ///< which record in that cache is mine
+      mutable bool _pendingDecoding;              ///< whether my API specific data is being decoded right now
+      Thread::AtomicCount _liveInstances;         ///< instances of me not yet destroyed, see PluginCache::purgeRetiredBinaries
     public :
       Plugin();
 
@@ -164,7 +175,15 @@ namespace OFX {
       }
 
       /// construct this based on the struct returned by the getNthPlugin() in the binary
-      Plugin(PluginBinary *bin, int idx, OfxPlugin *o) : PluginDesc(o), _binary(bin), _index(idx)
+      Plugin(PluginBinary *bin, int idx, OfxPlugin *o)
+        : PluginDesc(o)
+        , _binary(bin)
+        , _index(idx)
+        , _sourceCache(0)
+        , _pendingCache(0)
+        , _pendingFile(0)
+        , _pendingRecord(0)
+        , _pendingDecoding(false)
       {
       }
       
@@ -176,6 +195,11 @@ namespace OFX {
         : PluginDesc(api, apiVersion, identifier, rawIdentifier, majorVersion, minorVersion)
         , _binary(bin)
         , _index(idx) 
+        , _sourceCache(0)
+        , _pendingCache(0)
+        , _pendingFile(0)
+        , _pendingRecord(0)
+        , _pendingDecoding(false)
       {
       }
 
@@ -184,6 +208,19 @@ namespace OFX {
 
       virtual APICache::PluginAPICacheI &getApiHandler() = 0;
 
+      /// A plugin read from a cache has its API specific data left undecoded until it is
+      /// first needed. API specific plugin classes must call this before looking at
+      /// anything that comes from the cache, eg: their descriptor.
+      void loadPendingCacheData() const;
+
+      /// API specific instance classes call these as they are made and as they finish being
+      /// destroyed, so a binary a rescan dropped is kept until nothing is using it
+      void instanceCreated() { _liveInstances.increment(); }
+      void instanceDestroyed() { _liveInstances.decrement(); }
+
+      /// are there any instances of me
+      bool hasLiveInstances() const { return _liveInstances.get() != 0; }
+
       bool trumps(Plugin *other) {
         int myMajor = getVersionMajor();
         int theirMajor = other->getVersionMajor();
@@ -219,6 +256,7 @@ namespace OFX {
       time_t _fileModificationTime;   ///< used as a time stamp to check modification times, used for caching
       off_t _fileSize;                ///< file size last time we check, used for caching
       bool _binaryChanged;            ///< whether the timestamp/filesize in this cache is different from that in the actual binary
+      bool _blacklisted;              ///< whether describing this binary failed, so it is to be skipped until it changes
       
     public :
 
@@ -231,6 +269,7 @@ namespace OFX {
         , _fileModificationTime(mtime)
         , _fileSize(size)
         , _binaryChanged(false)
+        , _blacklisted(false)
       {
         if (isInvalid()) {
           return;
@@ -248,6 +287,7 @@ namespace OFX {
         , _filePath(file)
         , _bundlePath(bundlePath)
         , _binaryChanged(false)
+        , _blacklisted(false)
       {
         loadPluginInfo(cache);
       }
@@ -260,7 +300,7 @@ namespace OFX {
       	return _fileModificationTime;
       }
     
-      off_t getFileSize() {
+      off_t getFileSize() const {
       	return _fileSize;
       }
 
@@ -276,6 +316,28 @@ namespace OFX {
         return _binaryChanged;
       }
 
+      /// did describing this binary out of process fail, see PluginCache::setDescribeHelper
+      bool isBlacklisted() const {
+        return _blacklisted;
+      }
+
+      /// mark the binary as one whose plugins are not to be loaded, until it changes
+      void setBlacklisted(bool blacklisted) {
+        _blacklisted = blacklisted;
+      }
+
+      /// blacklist the binary as it is now, dropping any plugins
+      void blacklist() {
+        for (size_t i = 0; i < _plugins.size(); i++) {
+          delete _plugins[i];
+        }
+        _plugins.clear();
+        _fileModificationTime = _binary.getTime();
+        _fileSize = _binary.getSize();
+        _binaryChanged = false;
+        _blacklisted = true;
+      }
+
       bool isLoaded() const {
         return _binary.isLoaded();
       }
@@ -339,6 +401,15 @@ namespace OFX {
       }
     };
 
+    /// What PluginCache::rescanPluginFiles found had changed. Plugins are described by value,
+    /// as the Plugin objects of those removed or changed are no longer listed by the time the
+    /// host hears, and are deleted once their last instance is.
+    struct PluginCacheChanges {
+      std::vector<PluginDesc> added;    ///< plugins of new binaries, or new to a changed binary
+      std::vector<PluginDesc> removed;  ///< plugins of binaries that went, or that a changed binary no longer has
+      std::vector<PluginDesc> changed;  ///< plugins of changed binaries, which are now new Plugin objects
+    };
+
     /// Where we keep our plugins.    
     class PluginCache {
     protected :
@@ -348,11 +419,15 @@ namespace OFX {
       std::set<std::string>     _nonrecursePath; ///< list of directories to look in (non-recursively)
       std::list<std::string>    _pluginDirs;  ///< list of directories we found
       std::list<PluginBinary *> _binaries; ///< all the binaries we know about, we own these
+      std::list<PluginBinary *> _retiredBinaries; ///< binaries a rescan dropped, kept while their plugins have instances, we own these
       std::list<Plugin *>       _plugins;  ///< all the plugins inside the binaries, we don't own these, populated from _binaries
       std::set<std::string>     _knownBinFiles;
 
       PluginBinary *_xmlCurrentBinary;
       Plugin *_xmlCurrentPlugin;
+      CacheFile::PluginRecord _xmlCurrentRecord;    ///< where _xmlCurrentPlugin's events are in _xmlEvents
+      CacheFile::Writer *_xmlEvents;                ///< the API specific data of the plugins readCache is reading, while it is
+      std::vector<Plugin *> _xmlPlugins;            ///< those plugins, by their record in _xmlEvents
 
       std::list<PluginCacheSupportedApi> _apiHandlers;
 
@@ -363,9 +438,36 @@ namespace OFX {
 
       bool _dirty;
       bool _enablePluginSeek;       ///< Turn off to make all seekPluginFile() calls return an empty string
+      bool _parallelScan;           ///< whether scanPluginFiles uses the worker pool
+      std::string _describeHelper;  ///< executable to describe binaries with out of process, if any
+      double _describeTimeout;      ///< seconds the describe helper has for each binary
+
+      /// read what a describe helper wrote, returning the binary it describes, or NULL if it is bad
+      PluginBinary *readDescribeHelperOutput(const std::string &xml);
+
+      /// the part of scanPluginFiles that walks the path and loads new or changed binaries, on the worker pool
+      void parallelScan(std::set<std::string> &foundBinFiles);
+
+      /// Load and describe the bundles, given as (directory, name), that are not yet in the cache
+      /// and any cached binaries that have changed, on the worker pool or in describe helpers.
+      void loadBundles(const std::vector<std::pair<std::string, std::string> > &bundles, std::set<std::string> &foundBinFiles);
+
+      bool _watchPluginFiles;   ///< whether scanPluginFiles starts watching the path
+      PluginWatcher *_watcher;  ///< what rescanPluginFiles reads events from, if watching
+
+      /// watch the directories and bundles we know of, replacing any watcher we had
+      void startWatching();
+      void stopWatching();
 
       static PluginCache* gPluginCachePtr; ///< singleton plugin cache
 
+      std::list<CacheFile::Reader *> _cacheFiles;     ///< caches plugins may still be decoding from, we own these
+      mutable Thread::RecursiveMutex _cacheFileLock;  ///< serialises decoding, as the API handlers hold parse state
+
+      /// decode a plugin's API specific data from its cache
+      friend class Plugin;
+      void loadPendingCacheData(Plugin *plugin);
+
     public:
       /// ctor, which inits _pluginPath to default locations and not much else
       PluginCache();
@@ -415,9 +517,18 @@ namespace OFX {
         _cacheVersion = cacheVersion;
       }
 
-      // populate the cache.  must call scanPluginFiles() after to check for changes.
+      /// Populate the cache from XML written by writePluginCache. Plugins' API specific data,
+      /// eg: image effect descriptors, is kept in a compact form and only decoded when first
+      /// asked for. Must call scanPluginFiles() after to check for changes.
       void readCache(std::istream &is);
 
+      /// Populate the cache from a file written by writeBinaryCache, instead of readCache.
+      /// Plugins' API specific data is only decoded when first asked for, so the file stays
+      /// mapped for the life of the cache. Returns false if the file is missing, of another
+      /// version or damaged, in which case nothing is read and the host may try readCache.
+      /// Must call scanPluginFiles() after to check for changes.
+      bool readBinaryCache(const std::string &path);
+
       // seek a particular file on the OFX plugin path
       std::string seekPluginFile(const std::string &baseName) const;
       
@@ -425,11 +536,74 @@ namespace OFX {
       /// Enable (the default): normal operation; disable: returns an empty string instead
       void setPluginSeekEnabled(bool enabled) { _enablePluginSeek = enabled; }
 
+      /// Sets whether scanPluginFiles walks the plugin path and loads and describes new or
+      /// changed binaries on several threads. Off by default. If on, the load and describe
+      /// actions of plugins in different binaries may be called concurrently, the host's
+      /// loadingStatus is still only called on one thread at a time. Either way the resulting
+      /// cache is the same.
+      void setParallelScan(bool enabled) { _parallelScan = enabled; }
+
+      /// Sets an executable that scanPluginFiles runs to load and describe each new or changed
+      /// binary, rather than doing so in this process, so a plugin that crashes or hangs in
+      /// there cannot take the host with it. Several helpers run at once, each is killed if it
+      /// takes longer than timeout seconds. Binaries whose helper crashed or was killed are
+      /// blacklisted in the cache, and skipped until they change. Binaries the helper could not
+      /// be run on at all, say it exited with 127 or 2, are described in process as usual. An
+      /// empty path turns this off.
+      ///
+      /// The helper is a program built by the host, which sets up its Host and API handlers
+      /// as it would itself and then calls runDescribeHelper, see examples/hostDemoDescribe.cpp.
+      ///
+      /// Only supported on UNIX, elsewhere binaries are loaded in process as with setParallelScan.
+      void setDescribeHelper(const std::string &path, double timeout = 30) {
+        _describeHelper = path;
+        _describeTimeout = timeout;
+      }
+
+      /// The body of a describe helper's main, given its command line of
+      ///
+      ///   helper binaryPath bundlePath cacheVersion
+      ///
+      /// It loads the binary, runs every describe action its plugins have and writes the
+      /// cache for that binary to stdout. Anything the plugins print to stdout is sent to
+      /// stderr. Returns the exit code for the helper, 0 on success and 2 for a bad command line.
+      int runDescribeHelper(int argc, char **argv);
+
       /// scan for plugins
       void scanPluginFiles();
 
-      // write the plugin cache output file to the given stream
+      /// Sets whether scanPluginFiles watches the directories it found and the bundles in
+      /// them, so rescanPluginFiles need only look at those that have changed since. Uses
+      /// inotify and so only does anything on Linux. Off by default.
+      void setWatchPluginFiles(bool enabled) { _watchPluginFiles = enabled; }
+
+      /// Bring the cache up to date with the plugin path after scanPluginFiles, loading new
+      /// and changed binaries, dropping those that have gone and saying which plugins that
+      /// affected. Returns whether any plugins were added, removed or changed. The cache is
+      /// only marked dirty if a binary was.
+      ///
+      /// When watching, see setWatchPluginFiles, only directories and bundles there have been
+      /// events in are listed and stat'd again, and if there have been none nothing is.
+      /// Otherwise the whole path is walked and every binary stat'd, as scanPluginFiles does.
+      ///
+      /// Plugins of binaries that changed or went are no longer listed, but instances of them
+      /// may carry on. Their binaries are retired, and only unloaded and deleted once none
+      /// of their plugins have instances left, see purgeRetiredBinaries.
+      bool rescanPluginFiles(PluginCacheChanges &changes);
+
+      /// Delete the binaries rescanPluginFiles retired whose plugins no longer have any
+      /// instances, unloading them. Done at the start of every rescan, hosts may also call
+      /// it after destroying instances. Not to be called while instances are being destroyed
+      /// on other threads.
+      void purgeRetiredBinaries();
+
+      // write the plugin cache output file to the given stream. this decodes any plugins
+      // not yet decoded, so hosts should only rewrite the cache if it is dirty()
       void writePluginCache(std::ostream &os) const;
+
+      /// Write the plugin cache as a binary cache file for readBinaryCache, returns false
+      /// on failure. Plugins not yet decoded are copied over as they are.
+      bool writeBinaryCache(const std::string &path) const;
       
       // callback function for the XML
       void elementBeginCallback(void *userData, const XML_Char *name, const XML_Char **attrs);
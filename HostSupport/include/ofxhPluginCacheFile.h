@@ -0,0 +1,263 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OFX_PLUGIN_CACHE_FILE_H
+#define OFX_PLUGIN_CACHE_FILE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#if defined(WINDOWS)
+#include "windows.h"
+#endif
+
+namespace OFX {
+
+  namespace Host {
+
+    namespace APICache {
+      class PluginAPICacheI;
+    }
+
+    /// The binary plugin cache file format.
+    ///
+    /// The XML cache has to be parsed in full and every plugin's descriptor rebuilt from
+    /// it at startup. The binary format instead is mapped into memory and read in place.
+    /// It is laid out as
+    ///
+    ///   - a Header,
+    ///   - a string table, an offset for each string followed by the NUL terminated strings,
+    ///     so every string in the file is stored once and referred to by index,
+    ///   - a flat array of BinaryRecord, one per plugin binary, with the mtime and size it
+    ///     had when the cache was written,
+    ///   - a flat array of PluginRecord, those of a binary being contiguous,
+    ///   - a stream of words holding each plugin's API specific data.
+    ///
+    /// The API specific data is what the API handler wrote with saveXML, stored as pre-parsed
+    /// element begin/end and character events, so it can be handed back to the handler's XML
+    /// callbacks without going near a parser, and only when the plugin's descriptor is first
+    /// asked for.
+    ///
+    /// Files are in native byte order, a file written on a machine of the other byte order,
+    /// or of another format version, is rejected and the caller falls back to rescanning.
+    namespace CacheFile {
+
+      class Reader;
+
+      /// bump this whenever the layout changes
+      enum { kFormatVersion = 2 };
+
+      /// the start of a cache file, offsets are in bytes from the start of the file
+      struct Header {
+        char         magic[8];        ///< "OFXCACHE"
+        unsigned int formatVersion;   ///< kFormatVersion
+        unsigned int byteOrder;       ///< 0x01020304 as written
+        unsigned int cacheVersion;    ///< string index of the host's cache version
+        unsigned int nStrings;
+        unsigned int stringsOffset;   ///< nStrings offsets into the string data, then the string data
+        unsigned int stringsSize;     ///< bytes of string data
+        unsigned int nBinaries;
+        unsigned int binariesOffset;
+        unsigned int nPlugins;
+        unsigned int pluginsOffset;
+        unsigned int nEvents;         ///< in words
+        unsigned int eventsOffset;
+      };
+
+      /// a plugin binary
+      struct BinaryRecord {
+        long long    mtime;
+        long long    size;
+        unsigned int path;            ///< string index
+        unsigned int bundlePath;      ///< string index
+        unsigned int firstPlugin;     ///< index of the binary's first PluginRecord
+        unsigned int nPlugins;
+        unsigned int flags;           ///< BinaryFlagsEnum bits
+        unsigned int reserved;        ///< zero
+      };
+
+      /// flags on a BinaryRecord
+      enum BinaryFlagsEnum {
+        eBinaryBlacklisted = 1        ///< see PluginBinary::isBlacklisted
+      };
+
+      /// a plugin inside a binary
+      struct PluginRecord {
+        unsigned int api;             ///< string index
+        unsigned int rawIdentifier;   ///< string index
+        int          index;
+        int          apiVersion;
+        int          versionMajor;
+        int          versionMinor;
+        unsigned int eventsBegin;     ///< the plugin's API specific data in the event stream
+        unsigned int eventsEnd;
+      };
+
+      /// what is in the event stream, each opcode is followed by string indices
+      enum EventEnum {
+        eElementBegin = 1,   ///< name, number of attributes, then a name and value per attribute
+        eElementEnd,         ///< name
+        eCharacters          ///< text
+      };
+
+      /// A read only view of a whole file. It is mapped into memory where the OS lets us,
+      /// otherwise it is read into memory.
+      class MappedFile {
+      public :
+        MappedFile();
+        ~MappedFile();
+
+        /// map the file, returns false if it could not be opened
+        bool open(const std::string &path);
+
+        /// take over a file already in memory, leaving buffer empty
+        void adopt(std::vector<char> &buffer);
+
+        /// unmap the file
+        void close();
+
+        const char *data() const { return _data; }
+        size_t size() const { return _size; }
+
+      protected :
+        const char        *_data;
+        size_t             _size;
+        std::vector<char>  _buffer;   ///< what we read the file into if we could not map it
+#if defined(WINDOWS)
+        HANDLE             _file;
+        HANDLE             _mapping;
+#else
+        void              *_map;
+#endif
+
+      private :
+        /// not copyable
+        MappedFile(const MappedFile &);
+        void operator=(const MappedFile &);
+      };
+
+      /// Builds a cache file in memory and saves it.
+      class Writer {
+      public :
+        Writer();
+
+        /// index of a string in the table, adding it if need be
+        unsigned int addString(const std::string &s);
+
+        /// add a binary, its plugins must be added straight after
+        void addBinary(const BinaryRecord &binary);
+
+        /// add a plugin to the last binary added
+        void addPlugin(const PluginRecord &plugin);
+
+        /// Parse a piece of XML and append it to the event stream, setting plugin's
+        /// eventsBegin and eventsEnd. Returns false if the XML is malformed.
+        bool addXML(const std::string &xml, PluginRecord &plugin);
+
+        /// Append another file's events for a plugin to the event stream, setting to's
+        /// eventsBegin and eventsEnd. This saves decoding a plugin just to write it out again.
+        void addEvents(const Reader &reader, const PluginRecord &from, PluginRecord &to);
+
+        /// Where the event stream is up to. For recording events through the XML callbacks
+        /// below, the events between two calls are those of the elements seen in between.
+        unsigned int eventPosition();
+
+        /// lay out the file in memory
+        void build(std::vector<char> &file, const std::string &cacheVersion);
+
+        /// Write the file. It is written next to path and renamed over it, so readers never
+        /// see half a file. Returns false on any error.
+        bool save(const std::string &path, const std::string &cacheVersion);
+
+        /// callbacks for the XML parser, which add to the event stream
+        void elementBegin(const char *name, const char **attrs);
+        void elementEnd(const char *name);
+        void characters(const char *data, int len);
+
+      protected :
+        std::map<std::string, unsigned int>  _stringIndices;
+        std::vector<std::string>             _strings;
+        std::vector<BinaryRecord>            _binaries;
+        std::vector<PluginRecord>            _plugins;
+        std::vector<unsigned int>            _events;
+        std::string                          _text;   ///< character data collected between elements
+
+        /// append any pending character data to the event stream
+        void flushCharacters();
+      };
+
+      /// Reads a cache file in place.
+      class Reader {
+      public :
+        Reader();
+
+        /// Map and validate a file. Returns false if the file is missing, truncated,
+        /// inconsistent or of another format version or byte order.
+        bool open(const std::string &path);
+
+        /// as above, for a file built in memory, which is taken over leaving file empty
+        bool open(std::vector<char> &file);
+
+        /// drop the file
+        void close();
+
+        const char *getString(unsigned int idx) const;
+        const char *getCacheVersion() const { return getString(_header.cacheVersion); }
+
+        unsigned int getNBinaries() const { return _header.nBinaries; }
+        BinaryRecord getBinary(unsigned int idx) const;
+
+        unsigned int getNPlugins() const { return _header.nPlugins; }
+        PluginRecord getPlugin(unsigned int idx) const;
+
+        /// a word of the event stream
+        unsigned int getEvent(unsigned int idx) const;
+
+        /// Hand a plugin's API specific data to an API handler's XML callbacks, as if it
+        /// were being read from an XML cache. The caller brackets this with the handler's
+        /// begin/endXmlParsing. Returns false if the events are malformed.
+        bool replay(const PluginRecord &plugin, APICache::PluginAPICacheI &api) const;
+
+      protected :
+        MappedFile   _file;
+        Header       _header;
+
+        /// check what is in _file, closing it if it is bad
+        bool validate();
+      };
+
+    }
+
+  }
+
+}
+
+#endif // OFX_PLUGIN_CACHE_FILE_H
@@ -36,6 +36,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <algorithm>
 #include <sstream>
 
+#include "ofxhThread.h"
+
 #ifndef WINDOWS
 #define OFX_EXCEPTION_SPEC throw (OFX::Host::Property::Exception)
 #else
@@ -72,6 +74,28 @@ namespace OFX {
       class Property; 
       class Set;
 
+      /// An interned property name. There is exactly one AtomRecord per distinct name for the
+      /// lifetime of the process, so two names are equal iff their atoms are the same pointer,
+      /// and the hash of the name is computed once, when it is first interned.
+      struct AtomRecord {
+        std::string   name;   ///< the interned name, never freed
+        unsigned int  hash;   ///< FNV-1a hash of name
+      };
+
+      /// a handle to an interned name, compare these by pointer
+      typedef const AtomRecord *Atom;
+
+      /// Return the atom for the given name, adding it to the global atom table if needed.
+      /// This is safe to call from several threads at once.
+      Atom intern(const char *name);
+
+      /// Return the atom for the given name, adding it to the global atom table if needed.
+      inline Atom intern(const std::string &name) { return intern(name.c_str()); }
+
+      /// Return the atom for the given name, or NULL if nothing has ever interned that name,
+      /// in which case no property set can possibly contain a property of that name.
+      Atom findAtom(const char *name);
+
       /// exception, representing an OfxStatus
       class Exception {
         OfxStatus _stat;
@@ -210,7 +234,7 @@ namespace OFX {
       /// base class for all properties
       class Property {
       protected :
-        std::string  _name;                     ///< name of this property
+        Atom         _atom;                     ///< interned name of this property
         TypeEnum     _type;                     ///< type of this property
         int          _dimension;                ///< the fixed dimension of this property 
         bool         _pluginReadOnly;           ///< set is forbidden through suite: value may still change between get() calls
@@ -224,6 +248,12 @@ namespace OFX {
                  TypeEnum type,
                  int dimension = 1,
                  bool pluginReadOnly=false);
+
+        /// ctor, from an already interned name
+        Property(Atom name,
+                 TypeEnum type,
+                 int dimension = 1,
+                 bool pluginReadOnly=false);
             
         /// copy ctor
         Property(const Property &other);
@@ -243,9 +273,15 @@ namespace OFX {
         virtual Property *deepCopy() = 0;
         
         /// get the name of this property
-        const std::string &getName()
+        const std::string &getName() const
+        {
+          return _atom->name;
+        }
+
+        /// get the interned name of this property
+        Atom getAtom() const
         {
-          return _name;
+          return _atom;
         }
         
         /// get the type of this property
@@ -290,9 +326,68 @@ namespace OFX {
         virtual std::string getStringValue(int nth) = 0;
       };
       
+      /// Holds the values of a property. Up to kInlineSize values are kept inside the object
+      /// itself, so small fixed dimension properties (flags, render scales, bounds and so on) never
+      /// touch the heap. Anything with more values than that keeps them all in a std::vector.
+      template<class Type>
+      class PropertyValues {
+      public :
+        enum {kInlineSize = 4};
+
+      protected :
+        size_t            _size;                ///< number of values
+        Type              _inline[kInlineSize]; ///< the values if there are no more than kInlineSize of them
+        std::vector<Type> _heap;                ///< the values if there are more than kInlineSize of them
+
+        bool onHeap() const { return _size > (size_t)kInlineSize; }
+
+      public :
+        /// ctor, no values
+        PropertyValues() : _size(0) {}
+
+        /// ctor, n copies of v
+        PropertyValues(size_t n, const Type &v) : _size(0) { assign(n, v); }
+
+        /// number of values
+        size_t size() const { return _size; }
+
+        /// get the nth value
+        Type &operator[](size_t n) { return onHeap() ? _heap[n] : _inline[n]; }
+
+        /// get the nth value
+        const Type &operator[](size_t n) const { return onHeap() ? _heap[n] : _inline[n]; }
+
+        /// change the number of values, any new ones are default constructed
+        void resize(size_t n)
+        {
+          if(n > (size_t)kInlineSize) {
+            if(!onHeap())
+              _heap.assign(_inline, _inline + _size);
+            _heap.resize(n);
+          }
+          else if(onHeap()) {
+            std::copy(_heap.begin(), _heap.begin() + n, _inline);
+            _heap.clear();
+          }
+          else {
+            for(size_t i = _size; i < n; ++i)
+              _inline[i] = Type();
+          }
+          _size = n;
+        }
+
+        /// set to n copies of v
+        void assign(size_t n, const Type &v)
+        {
+          resize(n);
+          for(size_t i = 0; i < n; ++i)
+            (*this)[i] = v;
+        }
+      };
+
       /// this represents a generic property.
       /// template parameter T is the type descriptor of the
-      /// type of property to model.  the class holds an internal _value vector which can be used
+      /// type of property to model.  the class holds an internal _value array which can be used
       /// to store the values.  if set and get hooks are installed, these will be called instead
       /// of using this variable.
       /// Make sure that T::ReturnType is const if appropriate, as no extra qualifiers are applied here.
@@ -306,10 +401,10 @@ namespace OFX {
         
       protected :
         /// this is the present value of the property
-        std::vector<Type> _value;
+        PropertyValues<Type> _value;
 
         /// this is the default value of the property
-        std::vector<Type> _defaultValue;
+        PropertyValues<Type> _defaultValue;
 
       public :
         /// constructor
@@ -318,6 +413,12 @@ namespace OFX {
                          bool pluginReadOnly,
                          APIType defaultValue);
 
+        /// constructor, from an already interned name
+        PropertyTemplate(Atom name,
+                         int dimension,
+                         bool pluginReadOnly,
+                         APIType defaultValue);
+
         PropertyTemplate(const PropertyTemplate<T> &pt);
 
         PropertyTemplate<T> *deepCopy() {
@@ -328,8 +429,17 @@ namespace OFX {
         {
         }
 
-        /// get the vector
-        const std::vector<Type> &getValues()
+        /// get a copy of the values as a vector, so avoid it on anything that is called often
+        std::vector<Type> getValues() const
+        {
+          std::vector<Type> values(_value.size());
+          for(size_t i = 0; i < _value.size(); ++i)
+            values[i] = _value[i];
+          return values;
+        }
+
+        /// get the values held locally, without going through the getHook or copying them
+        const PropertyValues<Type> &getValuesRaw() const
         {
           return _value;
         }
@@ -391,6 +501,54 @@ namespace OFX {
       /// A std::map of properties by name
       typedef std::map<std::string, Property *> PropertyMap;
 
+      /// An open addressed hash table of properties, keyed by their interned name.
+      /// Uses linear probing over a power of two number of slots, which is kept
+      /// at most half full. There is no removal, only replacement.
+      class PropertyIndex {
+      public :
+        /// a slot in the table, empty if atom is NULL
+        struct Slot {
+          Atom      atom;
+          Property *prop;
+        };
+
+      protected :
+        std::vector<Slot> _slots; ///< the table itself
+        int               _count; ///< number of occupied slots
+
+        /// double the table size and rehash everything in it
+        void grow();
+
+      public :
+        /// ctor
+        PropertyIndex() : _count(0) {}
+
+        /// find the property with the given atom, NULL if not there
+        Property *find(Atom atom) const
+        {
+          if(!atom || _slots.empty()) 
+            return NULL;
+          size_t mask = _slots.size() - 1;
+          for(size_t i = atom->hash & mask; ; i = (i + 1) & mask) {
+            const Slot &slot = _slots[i];
+            if(slot.atom == atom) return slot.prop;
+            if(!slot.atom) return NULL;
+          }
+        }
+
+        /// insert or replace the property under its own atom, returns the property it replaced, if any
+        Property *insert(Property *prop);
+
+        /// make sure there is room for n more properties without growing
+        void reserve(int n);
+
+        /// number of properties in the table
+        int size() const { return _count; }
+
+        /// the raw slots, for iterating over, skip any with a null atom
+        const std::vector<Slot> &getSlots() const { return _slots; }
+      };
+
 
       //................................................................................
       /// Class that holds a set of properties and manipulates them
@@ -402,7 +560,23 @@ namespace OFX {
         const int   _magic; ///< to check for handles being nice
 
       protected :
-        PropertyMap _props; ///< Our properties.
+        /// a block of memory that properties made by addProperties are constructed in, see ofxhPropertySuite.cpp
+        struct Slab;
+
+        PropertyIndex _props; ///< Our properties, by interned name.
+
+        /// The slabs our properties live in, so that a PropSpec table costs a single
+        /// allocation rather than one per property.
+        Slab *_slabs;
+
+        /// Our properties by name, only built on demand by getProperties()
+        mutable PropertyMap _propsByName;
+
+        /// does _propsByName need rebuilding
+        mutable bool _propsByNameDirty;
+
+        /// held while checking and rebuilding _propsByName, as render threads may ask for it together
+        mutable Thread::Mutex _propsByNameLock;
 
         /// chained property set, which is read only
         /// these are searched on a get if not found 
@@ -412,23 +586,26 @@ namespace OFX {
         /// hide assignment
         void operator=(const Set &);
 
+        /// delete the property, which may live in one of our slabs
+        void destroyProperty(Property *prop);
+
         /// set a particular property
-        template<class T> void setProperty(const std::string &property, int index, const typename T::Type &value);
+        template<class T> void setProperty(const char *property, int index, const typename T::Type &value);
 
         /// set the first N of a particular property
-        template<class T> void setPropertyN(const std::string &property, int count, const typename T::APIType *value);
+        template<class T> void setPropertyN(const char *property, int count, const typename T::APIType *value);
 
         /// get a particular property
-        template<class T> typename T::ReturnType getProperty(const std::string &property, int index)  const;
+        template<class T> typename T::ReturnType getProperty(const char *property, int index)  const;
 
         /// get the first N of a particular property
-        template<class T> void getPropertyN(const std::string &property, int index, typename T::APIType *v)  const;
+        template<class T> void getPropertyN(const char *property, int index, typename T::APIType *v)  const;
 
         /// get a particular property without going through any getHook
-        template<class T> typename T::ReturnType getPropertyRaw(const std::string &property, int index)  const;
+        template<class T> typename T::ReturnType getPropertyRaw(const char *property, int index)  const;
 
         /// get a particular property without going through any getHook
-        template<class T> void getPropertyRawN(const std::string &property, int count, typename T::APIType *v)  const;
+        template<class T> void getPropertyRawN(const char *property, int count, typename T::APIType *v)  const;
 
       public :
         /// take an array of of PropSpecs (which must be terminated with an entry in which
@@ -444,7 +621,7 @@ namespace OFX {
         /// destructor
         virtual ~Set();
 
-        /// adds a bunch of properties from PropSpec
+        /// adds a bunch of properties from PropSpec, these are all made in a single allocation
         void addProperties(const PropSpec *);
         
         /// add one new property
@@ -456,11 +633,9 @@ namespace OFX {
         /// set the chained property set
         void setChainedSet(Set *s) {_chainedSet = s;}
 
-        /// grab the internal properties map
-        const PropertyMap &getProperties() const
-        {
-          return _props;
-        }
+        /// grab the properties as a map sorted by name. This is built on demand under a lock,
+        /// so prefer the fetch methods for looking up individual properties.
+        const PropertyMap &getProperties() const;
 
         /// set the get hook for a particular property.  users may need to call particular
         /// specialised versions of this.
@@ -474,12 +649,30 @@ namespace OFX {
         /// 'followChain' arg is not false.
         Property *fetchProperty(const std::string &name, bool followChain = false) const;
 
+        /// Fetchs a pointer to a property of the given name, following the property chain if the
+        /// 'followChain' arg is not false.
+        Property *fetchProperty(const char *name, bool followChain = false) const;
+
+        /// Fetchs a pointer to a property of the given interned name, following the property chain if the
+        /// 'followChain' arg is not false.
+        Property *fetchProperty(Atom name, bool followChain = false) const
+        {
+          Property *prop = _props.find(name);
+          if(!prop && followChain && _chainedSet) {
+            return _chainedSet->fetchProperty(name, true);
+          }
+          return prop;
+        }
+
         /// get property with the particular name and type.  if the property is 
         /// missing or is of the wrong type, return an error status.  if this is a sloppy
         /// property set and the property is missing, a new one will be created of the right
         /// type
         template<class T> bool fetchTypedProperty(const std::string &name, T *&prop, bool followChain = false) const;
 
+        /// as above, but avoids making a std::string from the name
+        template<class T> bool fetchTypedProperty(const char *name, T *&prop, bool followChain = false) const;
+
         /// retrieve the nameed string property
         String *fetchStringProperty(const std::string &name,  bool followChain = false) const;
 
@@ -549,6 +742,27 @@ namespace OFX {
         /// get the dimension of a particular property
         int getDimension(const std::string &property) const;
 
+        /// Overloads of the getters and setters above that take the name as a C string. Host
+        /// code mostly passes the kOfx... macros, and these save making a std::string from them
+        /// on every call.
+        int getIntPropertyRaw(const char *property, int index = 0) const;
+        double getDoublePropertyRaw(const char *property, int index = 0) const;
+        void *getPointerPropertyRaw(const char *property, int index = 0) const;
+        const std::string &getStringPropertyRaw(const char *property, int index = 0) const;
+        const std::string &getStringProperty(const char *property, int index = 0) const;
+        int getIntProperty(const char *property, int index = 0) const;
+        void getIntPropertyN(const char *property,  int *v, int N) const;
+        double getDoubleProperty(const char *property, int index = 0) const;
+        void getDoublePropertyN(const char *property,  double *v, int N) const;
+        void *getPointerProperty(const char *property, int index = 0) const;
+        void setStringProperty(const char *property, const std::string &value, int index = 0);
+        void setIntProperty(const char *property, int v, int index = 0);
+        void setIntPropertyN(const char *property, const int *v, int N);
+        void setDoubleProperty(const char *property, double v, int index = 0);
+        void setDoublePropertyN(const char *property, const double *v, int N);
+        void setPointerProperty(const char *property,  void *v, int index = 0);
+        int getDimension(const char *property) const;
+
         /// is the given string one of the values of a multi-dimensional string prop
         /// this returns a non negative index if it is found, otherwise, -1
         int findStringPropValueIndex(const std::string &propName,
@@ -0,0 +1,130 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OFX_RENDER_DRIVER_H
+#define OFX_RENDER_DRIVER_H
+
+#include <vector>
+
+#include "ofxCore.h"
+#include "ofxImageEffect.h"
+
+namespace OFX {
+
+  namespace Host {
+
+    namespace ImageEffect {
+
+      // forward declarations
+      class Instance;
+
+      /// Renders a range of frames of an effect on several threads at once, as far as the
+      /// plugin's render thread safety allows.
+      ///
+      ///   - kOfxImageEffectRenderFullySafe, all threads render frames on the one instance,
+      ///   - kOfxImageEffectRenderInstanceSafe, each thread renders on its own instance, the
+      ///     extra instances are made by the client's cloneInstance and kept for later renders,
+      ///     each render first has the client's syncInstance bring them up to date, or clones
+      ///     them again if it cannot,
+      ///   - kOfxImageEffectRenderUnsafe, frames are rendered one at a time on the calling thread,
+      ///     and no other unsafe render of the same plugin through any driver may run meanwhile.
+      ///
+      /// Each instance used gets a beginRenderAction before its first frame and an
+      /// endRenderAction after the last one, flagged as non sequential if frames are
+      /// rendered concurrently.
+      ///
+      /// Frames are rendered on the host support worker pool, see Thread::WorkerPool, so
+      /// any multiThread calls the plugin makes while rendering run inline on the thread
+      /// rendering that frame. With only one thread the frames are rendered on the calling
+      /// thread and the plugin may multi thread within a frame as normal.
+      class RenderDriver {
+      public :
+        /// What the host supplies to the driver
+        class Client {
+        public :
+          virtual ~Client() {}
+
+          /// Make another instance of the same effect as original, with its params, clips
+          /// and clip preferences set up to match and createInstanceAction called. Only 
+          /// called for instance safe plugins. Return NULL if that is not possible, and
+          /// fewer threads will be used.
+          virtual Instance *cloneInstance(Instance &original) = 0;
+
+          /// Bring a clone made by cloneInstance up to date with any changes to the original's
+          /// params since, called at the start of each render. Return false if that is not
+          /// possible, the clone is then destroyed and made afresh with cloneInstance, which is
+          /// what the default does.
+          virtual bool syncInstance(Instance &/*clone*/, Instance &/*original*/) { return false; }
+
+          /// Render one frame on the given instance, typically calling its
+          /// getRegionOfInterestAction and renderAction and then collecting the output image.
+          /// This is called concurrently from several threads, perhaps on the same instance,
+          /// so the host's clips must hand out a separate output image for each frame.
+          virtual OfxStatus renderFrame(Instance &instance, OfxTime time, bool sequential, bool interactive) = 0;
+        };
+
+        /// ctor, the instance must have had createInstanceAction and clip preferences done
+        RenderDriver(Instance &instance, Client &client);
+
+        /// dtor, deletes any cloned instances
+        ~RenderDriver();
+
+        /// set the most threads to render on, 0, the default, means the number of CPUs
+        void setMaxThreads(unsigned int n) {_maxThreads = n;}
+        unsigned int getMaxThreads() const {return _maxThreads;}
+
+        /// Render the frames first, first+step ... up to last. Returns kOfxStatOK, or the
+        /// first failing status from the client, after which no more frames are started.
+        OfxStatus render(OfxTime first, OfxTime last, OfxTime step, OfxPointD renderScale, bool interactive);
+
+      protected :
+        struct Job;
+
+        /// multiThread entry point, renders frames until there are none left
+        static void renderThread(unsigned int threadIndex, unsigned int threadMax, void *job);
+
+        Instance               &_instance;
+        Client                 &_client;
+        unsigned int            _maxThreads;
+        std::vector<Instance *> _clones;     ///< extra instances for instance safe plugins
+
+      private :
+        /// not copyable
+        RenderDriver(const RenderDriver &);
+        void operator=(const RenderDriver &);
+      };
+
+    } // ImageEffect
+
+  } // Host
+
+} // OFX
+
+#endif // OFX_RENDER_DRIVER_H
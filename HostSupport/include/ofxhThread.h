@@ -0,0 +1,282 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef OFX_THREAD_H
+#define OFX_THREAD_H
+
+#include <list>
+#include <vector>
+
+#if defined(WINDOWS)
+#include "windows.h"
+#else
+#include <pthread.h>
+#endif
+
+#include "ofxCore.h"
+#include "ofxMultiThread.h"
+
+namespace OFX {
+
+  namespace Host {
+
+    namespace Thread {
+
+      /// A plain, non recursive mutex for protecting the host support library's own state.
+      class Mutex {
+      public :
+        Mutex();
+        ~Mutex();
+
+        /// block until we have the lock
+        void lock();
+
+        /// release the lock
+        void unlock();
+
+        /// try and get the lock, returns false immediately if someone else has it
+        bool tryLock();
+
+      protected :
+        friend class Condition;
+
+#if defined(WINDOWS)
+        CRITICAL_SECTION _handle;
+#else
+        pthread_mutex_t  _handle;
+#endif
+
+      private :
+        /// not copyable
+        Mutex(const Mutex &);
+        void operator=(const Mutex &);
+      };
+
+      /// A mutex the thread holding it may lock again, it must be unlocked as many times as it was locked.
+      class RecursiveMutex {
+      public :
+        RecursiveMutex();
+        ~RecursiveMutex();
+
+        /// block until we have the lock
+        void lock();
+
+        /// release one level of the lock
+        void unlock();
+
+        /// try and get the lock, returns false immediately if another thread has it
+        bool tryLock();
+
+      protected :
+#if defined(WINDOWS)
+        CRITICAL_SECTION _handle;
+#else
+        pthread_mutex_t  _handle;
+#endif
+
+      private :
+        /// not copyable
+        RecursiveMutex(const RecursiveMutex &);
+        void operator=(const RecursiveMutex &);
+      };
+
+      /// A condition variable, to wait on with a Mutex held.
+      class Condition {
+      public :
+        Condition();
+        ~Condition();
+
+        /// release the mutex, wait until signalled and get the mutex back, may wake spuriously
+        void wait(Mutex &mutex);
+
+        /// wake one waiting thread
+        void signal();
+
+        /// wake all waiting threads
+        void broadcast();
+
+      protected :
+#if defined(WINDOWS)
+        CONDITION_VARIABLE _handle;
+#else
+        pthread_cond_t     _handle;
+#endif
+
+      private :
+        /// not copyable
+        Condition(const Condition &);
+        void operator=(const Condition &);
+      };
+
+      /// Holds a mutex locked for its lifetime.
+      class AutoMutex {
+      public :
+        explicit AutoMutex(Mutex &mutex) : _mutex(mutex) { _mutex.lock(); }
+        ~AutoMutex() { _mutex.unlock(); }
+
+      protected :
+        Mutex &_mutex;
+
+      private :
+        /// not copyable
+        AutoMutex(const AutoMutex &);
+        void operator=(const AutoMutex &);
+      };
+
+      /// A count that many threads can step up and down at once without a lock.
+      class AtomicCount {
+      public :
+        explicit AtomicCount(long value = 0) : _value(value) {}
+
+        /// add one, returning the new value
+        long increment()
+        {
+#if defined(WINDOWS)
+          return InterlockedIncrement(&_value);
+#else
+          return __sync_add_and_fetch(&_value, 1);
+#endif
+        }
+
+        /// take one away, returning the new value
+        long decrement()
+        {
+#if defined(WINDOWS)
+          return InterlockedDecrement(&_value);
+#else
+          return __sync_sub_and_fetch(&_value, 1);
+#endif
+        }
+
+        /// the current value, which may already be stale if other threads are at it
+        long get() const { return _value; }
+
+      protected :
+        volatile long _value;
+
+      private :
+        /// not copyable
+        AtomicCount(const AtomicCount &);
+        void operator=(const AtomicCount &);
+      };
+
+      /// A persistent pool of worker threads that runs OfxMultiThreadSuiteV1::multiThread calls.
+      ///
+      /// The workers are started on first use, one fewer than the number of CPUs, as the
+      /// calling thread does its share of the work too. Each call is split into its nThreads
+      /// indices which the workers and the caller take in turn, so asking for more threads
+      /// than there are CPUs is fine, the extra indices run once a thread comes free.
+      /// Several render threads may call multiThread at once, their calls share the workers.
+      ///
+      /// While a thread is running an index its index and 'spawned' flag are kept in thread
+      /// local storage for multiThreadIndex and multiThreadIsSpawnedThread. A multiThread
+      /// call from inside a spawned function runs all its indices inline on the calling
+      /// thread rather than waiting on workers that may all be busy with the outer call.
+      class WorkerPool {
+      public :
+        /// the pool used by the host's multithread suite
+        static WorkerPool &get();
+
+        /// run func for each index in [0, nThreads), returns when they are all done
+        OfxStatus multiThread(OfxThreadFunctionV1 func, unsigned int nThreads, void *customArg);
+
+        /// the number of CPUs on the machine
+        static unsigned int numCPUs();
+
+        /// the index of the function the calling thread is running, 0 if it is not running one
+        static OfxStatus threadIndex(unsigned int *threadIndex);
+
+        /// is the calling thread running a function for multiThread
+        static bool isSpawnedThread();
+
+        /// What the calling thread's render set with setRenderContext, NULL if nothing. It is
+        /// handed on to the threads running a multiThread call's indices, so a render's workers
+        /// see the same, the param snapshot a render reads is kept here.
+        static void *renderContext();
+
+        /// set the calling thread's render context
+        static void setRenderContext(void *context);
+
+        ~WorkerPool();
+
+      protected :
+        /// a multiThread call in progress
+        struct Job {
+          OfxThreadFunctionV1 *func;
+          unsigned int         nThreads;
+          void                *customArg;
+          void                *renderContext; ///< the render context of the calling thread
+          unsigned int         next;         ///< the next index to hand out
+          unsigned int         outstanding;  ///< the number of indices not yet finished
+        };
+
+        WorkerPool();
+
+        /// start the workers if we have not already, assumes the lock is held
+        void startLocked();
+
+        /// what the workers do
+        void workerLoop();
+
+        /// run one index of a job, setting up the thread locals
+        static void runIndex(Job &job, unsigned int index);
+
+        /// take the next index of a job, dropping the job from the queue if that was its last, assumes the lock is held
+        unsigned int takeIndexLocked(Job &job);
+
+#if defined(WINDOWS)
+        static unsigned int __stdcall workerEntry(void *pool);
+        typedef HANDLE    ThreadHandle;
+#else
+        static void *workerEntry(void *pool);
+        typedef pthread_t ThreadHandle;
+#endif
+
+        Mutex                      _lock;
+        Condition                  _work;     ///< signalled when a job is queued or we are stopping
+        Condition                  _done;     ///< signalled when a job finishes
+        std::list<Job *>           _jobs;     ///< jobs with indices still to hand out
+        std::vector<ThreadHandle>  _threads;
+        bool                       _started;
+        bool                       _stopping;
+
+      private :
+        /// not copyable
+        WorkerPool(const WorkerPool &);
+        void operator=(const WorkerPool &);
+      };
+
+    } // Thread
+
+  } // Host
+
+} // OFX
+
+#endif // OFX_THREAD_H
@@ -89,7 +89,13 @@ namespace OFX {
       sv[index] = value;
   }
 
-  /// get me deepest bit depth 
+  /// how deep a bit depth is, 1 for byte, then short, half and float, 0 for none or one we don't know
+  int GetBitDepthRank(const std::string &depth);
+
+  /// the bit depth of the given rank, see GetBitDepthRank, none for one out of range
+  const std::string &GetBitDepthOfRank(int rank);
+
+  /// get me deepest bit depth, by GetBitDepthRank
   std::string FindDeepestBitDepth(const std::string &s1, const std::string &s2);
 
   /// get the min value
@@ -0,0 +1,391 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <algorithm>
+
+// ofx
+#include "ofxCore.h"
+
+// ofx host
+#include "ofxhAnimation.h"
+
+namespace OFX {
+
+  namespace Host {
+
+    namespace Param {
+
+      Animation::Animation(int nDimensions)
+        : _nDimensions(0)
+        , _defaultInterpolation(eInterpolationSmooth)
+        , _lastSegment(0)
+      {
+        setNumDimensions(nDimensions);
+      }
+
+      void Animation::setNumDimensions(int nDimensions)
+      {
+        _nDimensions = nDimensions;
+        _times.clear();
+        _interpolations.clear();
+        _values.assign(nDimensions, std::vector<double>());
+        _integrals.assign(nDimensions, std::vector<double>());
+        _staticValues.assign(nDimensions, 0.0);
+        _lastSegment.set(0);
+      }
+
+      void Animation::setKeyInterpolation(int nth, InterpolationEnum v)
+      {
+        _interpolations[nth] = (unsigned char) v;
+        updateIntegrals(nth);
+      }
+
+      int Animation::getKeyIndex(OfxTime time, int direction) const
+      {
+        int nKeys = getNumKeys();
+        if(direction == 0) {
+          int i = int(std::lower_bound(_times.begin(), _times.end(), time) - _times.begin());
+          return i < nKeys && _times[i] == time ? i : -1;
+        }
+        else if(direction < 0) {
+          int i = int(std::lower_bound(_times.begin(), _times.end(), time) - _times.begin());
+          return i - 1;
+        }
+        else {
+          int i = int(std::upper_bound(_times.begin(), _times.end(), time) - _times.begin());
+          return i < nKeys ? i : -1;
+        }
+      }
+
+      void Animation::setValue(const double *values)
+      {
+        _staticValues.assign(values, values + _nDimensions);
+      }
+
+      void Animation::setKey(OfxTime time, const double *values)
+      {
+        int i = int(std::lower_bound(_times.begin(), _times.end(), time) - _times.begin());
+        if(i == getNumKeys() || _times[i] != time) {
+          _times.insert(_times.begin() + i, time);
+          _interpolations.insert(_interpolations.begin() + i, (unsigned char) _defaultInterpolation);
+          for(int d = 0; d < _nDimensions; d++)
+            _values[d].insert(_values[d].begin() + i, values[d]);
+        }
+        else {
+          for(int d = 0; d < _nDimensions; d++)
+            _values[d][i] = values[d];
+        }
+        // a key moves the catmull-rom slopes of its neighbours, so the segments from two keys back may change
+        updateIntegrals(std::max(0, i - 2));
+      }
+
+      bool Animation::deleteKey(OfxTime time)
+      {
+        int i = getKeyIndex(time, 0);
+        if(i < 0)
+          return false;
+        _times.erase(_times.begin() + i);
+        _interpolations.erase(_interpolations.begin() + i);
+        for(int d = 0; d < _nDimensions; d++)
+          _values[d].erase(_values[d].begin() + i);
+        updateIntegrals(std::max(0, i - 2));
+        return true;
+      }
+
+      void Animation::deleteAllKeys()
+      {
+        _times.clear();
+        _interpolations.clear();
+        for(int d = 0; d < _nDimensions; d++) {
+          _values[d].clear();
+          _integrals[d].clear();
+        }
+      }
+
+      int Animation::findSegment(OfxTime time) const
+      {
+        int nSegments = getNumKeys() - 1;
+        int segment = _lastSegment.get();
+        if(segment >= 0 && segment < nSegments && _times[segment] <= time) {
+          if(time < _times[segment + 1])
+            return segment;
+          // the next segment along, where a render stepping through time goes
+          if(segment + 1 < nSegments && time < _times[segment + 2]) {
+            _lastSegment.set(segment + 1);
+            return segment + 1;
+          }
+        }
+        segment = int(std::upper_bound(_times.begin(), _times.end(), time) - _times.begin()) - 1;
+        _lastSegment.set(segment);
+        return segment;
+      }
+
+      double Animation::catmullRomSlope(int key, int dimension) const
+      {
+        // the end keys only have one neighbour, so use the slope to it
+        int before = key > 0 ? key - 1 : key;
+        int after = key < getNumKeys() - 1 ? key + 1 : key;
+        const std::vector<double> &values = _values[dimension];
+        return (values[after] - values[before]) / (_times[after] - _times[before]);
+      }
+
+      double Animation::interpolate(int segment, int dimension, OfxTime time) const
+      {
+        const std::vector<double> &values = _values[dimension];
+        double v0 = values[segment], v1 = values[segment + 1];
+        double length = _times[segment + 1] - _times[segment];
+        double s = (time - _times[segment]) / length;
+
+        switch(_interpolations[segment]) {
+        case eInterpolationConstant :
+          return v0;
+        case eInterpolationLinear :
+          return v0 + (v1 - v0) * s;
+        case eInterpolationSmooth :
+          return v0 + (v1 - v0) * s * s * (3.0 - 2.0 * s);
+        default : {
+          // a cubic hermite between the keys
+          double m0 = catmullRomSlope(segment, dimension) * length;
+          double m1 = catmullRomSlope(segment + 1, dimension) * length;
+          double s2 = s * s, s3 = s2 * s;
+          return (2.0 * s3 - 3.0 * s2 + 1.0) * v0 + (s3 - 2.0 * s2 + s) * m0 + (3.0 * s2 - 2.0 * s3) * v1 + (s3 - s2) * m1;
+        }
+        }
+      }
+
+      void Animation::segmentCoefficients(int segment, int dimension, double coefficients[4]) const
+      {
+        const std::vector<double> &values = _values[dimension];
+        double v0 = values[segment], v1 = values[segment + 1];
+        double delta = v1 - v0;
+        coefficients[0] = v0;
+
+        switch(_interpolations[segment]) {
+        case eInterpolationConstant :
+          coefficients[1] = coefficients[2] = coefficients[3] = 0.0;
+          break;
+        case eInterpolationLinear :
+          coefficients[1] = delta;
+          coefficients[2] = coefficients[3] = 0.0;
+          break;
+        case eInterpolationSmooth :
+          coefficients[1] = 0.0;
+          coefficients[2] = 3.0 * delta;
+          coefficients[3] = -2.0 * delta;
+          break;
+        default : {
+          double length = _times[segment + 1] - _times[segment];
+          double m0 = catmullRomSlope(segment, dimension) * length;
+          double m1 = catmullRomSlope(segment + 1, dimension) * length;
+          coefficients[1] = m0;
+          coefficients[2] = 3.0 * delta - 2.0 * m0 - m1;
+          coefficients[3] = m0 + m1 - 2.0 * delta;
+          break;
+        }
+        }
+      }
+
+      double Animation::interpolateDerivative(int segment, int dimension, OfxTime time) const
+      {
+        const std::vector<double> &values = _values[dimension];
+        double v0 = values[segment], v1 = values[segment + 1];
+        double length = _times[segment + 1] - _times[segment];
+        double s = (time - _times[segment]) / length;
+
+        // the derivatives of interpolate's curves in s, which is time over length
+        switch(_interpolations[segment]) {
+        case eInterpolationConstant :
+          return 0.0;
+        case eInterpolationLinear :
+          return (v1 - v0) / length;
+        case eInterpolationSmooth :
+          return (v1 - v0) * 6.0 * s * (1.0 - s) / length;
+        default : {
+          double m0 = catmullRomSlope(segment, dimension) * length;
+          double m1 = catmullRomSlope(segment + 1, dimension) * length;
+          double s2 = s * s;
+          return ((6.0 * s2 - 6.0 * s) * v0 + (3.0 * s2 - 4.0 * s + 1.0) * m0 + (6.0 * s - 6.0 * s2) * v1 + (3.0 * s2 - 2.0 * s) * m1) / length;
+        }
+        }
+      }
+
+      double Animation::interpolateIntegral(int segment, int dimension, OfxTime time) const
+      {
+        const std::vector<double> &values = _values[dimension];
+        double v0 = values[segment], v1 = values[segment + 1];
+        double length = _times[segment + 1] - _times[segment];
+        double s = (time - _times[segment]) / length;
+        double s2 = s * s, s3 = s2 * s, s4 = s3 * s;
+
+        // the integrals of interpolate's curves from 0 to s, scaled back to time
+        switch(_interpolations[segment]) {
+        case eInterpolationConstant :
+          return v0 * s * length;
+        case eInterpolationLinear :
+          return (v0 * s + (v1 - v0) * s2 * 0.5) * length;
+        case eInterpolationSmooth :
+          return (v0 * s + (v1 - v0) * (s3 - 0.5 * s4)) * length;
+        default : {
+          double m0 = catmullRomSlope(segment, dimension) * length;
+          double m1 = catmullRomSlope(segment + 1, dimension) * length;
+          return ((0.5 * s4 - s3 + s) * v0 + (0.25 * s4 - 2.0 / 3.0 * s3 + 0.5 * s2) * m0 +
+                  (s3 - 0.5 * s4) * v1 + (0.25 * s4 - s3 / 3.0) * m1) * length;
+        }
+        }
+      }
+
+      void Animation::updateIntegrals(int fromKey)
+      {
+        int nKeys = getNumKeys();
+        for(int d = 0; d < _nDimensions; d++) {
+          std::vector<double> &integrals = _integrals[d];
+          integrals.resize(nKeys);
+          if(nKeys == 0)
+            continue;
+          if(fromKey == 0)
+            integrals[0] = 0.0;
+          for(int key = fromKey; key < nKeys - 1; key++)
+            integrals[key + 1] = integrals[key] + interpolateIntegral(key, d, _times[key + 1]);
+        }
+      }
+
+      double Animation::integralTo(OfxTime time, int dimension) const
+      {
+        int nKeys = getNumKeys();
+        if(nKeys == 0)
+          return _staticValues[dimension] * time;
+        if(time <= _times[0])
+          return _values[dimension][0] * (time - _times[0]);
+        if(time >= _times[nKeys - 1])
+          return _integrals[dimension][nKeys - 1] + _values[dimension][nKeys - 1] * (time - _times[nKeys - 1]);
+        int segment = findSegment(time);
+        return _integrals[dimension][segment] + interpolateIntegral(segment, dimension, time);
+      }
+
+      void Animation::getValue(OfxTime time, double *values) const
+      {
+        int nKeys = getNumKeys();
+        if(nKeys == 0) {
+          std::copy(_staticValues.begin(), _staticValues.end(), values);
+        }
+        else if(time <= _times[0]) {
+          for(int d = 0; d < _nDimensions; d++)
+            values[d] = _values[d][0];
+        }
+        else if(time >= _times[nKeys - 1]) {
+          for(int d = 0; d < _nDimensions; d++)
+            values[d] = _values[d][nKeys - 1];
+        }
+        else {
+          int segment = findSegment(time);
+          for(int d = 0; d < _nDimensions; d++)
+            values[d] = interpolate(segment, d, time);
+        }
+      }
+
+      double Animation::getValue(OfxTime time, int dimension) const
+      {
+        int nKeys = getNumKeys();
+        if(nKeys == 0)
+          return _staticValues[dimension];
+        if(time <= _times[0])
+          return _values[dimension][0];
+        if(time >= _times[nKeys - 1])
+          return _values[dimension][nKeys - 1];
+        return interpolate(findSegment(time), dimension, time);
+      }
+
+
+      void Animation::getValues(const OfxTime *times, int nTimes, double *values) const
+      {
+        int nKeys = getNumKeys();
+        int i = 0;
+        while(i < nTimes) {
+          // held values, before, after or without keys
+          if(nKeys == 0 || times[i] <= _times[0] || times[i] >= _times[nKeys - 1]) {
+            getValue(times[i], values + i * _nDimensions);
+            i++;
+            continue;
+          }
+
+          // the run of samples from here in the same segment
+          int segment = findSegment(times[i]);
+          OfxTime start = _times[segment], end = _times[segment + 1];
+          int runEnd = i + 1;
+          while(runEnd < nTimes && times[runEnd] >= start && times[runEnd] < end)
+            runEnd++;
+
+          double scale = 1.0 / (end - start);
+          for(int d = 0; d < _nDimensions; d++) {
+            double c[4];
+            segmentCoefficients(segment, d, c);
+            double *out = values + d;
+            for(int j = i; j < runEnd; j++) {
+              double s = (times[j] - start) * scale;
+              out[j * _nDimensions] = c[0] + s * (c[1] + s * (c[2] + s * c[3]));
+            }
+          }
+          i = runEnd;
+        }
+      }
+
+      void Animation::getDerivative(OfxTime time, double *values) const
+      {
+        for(int d = 0; d < _nDimensions; d++)
+          values[d] = getDerivative(time, d);
+      }
+
+      double Animation::getDerivative(OfxTime time, int dimension) const
+      {
+        // flat outside the keys, at a key it is that of the segment leaving it
+        int nKeys = getNumKeys();
+        if(nKeys == 0 || time < _times[0] || time >= _times[nKeys - 1])
+          return 0.0;
+        return interpolateDerivative(findSegment(time), dimension, time);
+      }
+
+      void Animation::getIntegral(OfxTime time1, OfxTime time2, double *values) const
+      {
+        for(int d = 0; d < _nDimensions; d++)
+          values[d] = getIntegral(time1, time2, d);
+      }
+
+      double Animation::getIntegral(OfxTime time1, OfxTime time2, int dimension) const
+      {
+        if(getNumKeys() == 0)
+          return _staticValues[dimension] * (time2 - time1);
+        return integralTo(time2, dimension) - integralTo(time1, dimension);
+      }
+
+    }
+
+  }
+
+}
@@ -115,8 +115,8 @@ namespace OFX {
         return s;
       }
       
-      /// return a std::vector of supported comp
-      const std::vector<std::string> &ClipBase::getSupportedComponents() const
+      /// return a copy of the supported components, a copy so that render threads can ask at once
+      std::vector<std::string> ClipBase::getSupportedComponents() const
       {
         Property::String *p =  _properties.fetchStringProperty(kOfxImageEffectPropSupportedComponents);
         assert(p != NULL);
@@ -584,8 +584,7 @@ namespace OFX {
       // release the reference 
       void ImageBase::releaseReference()
       {
-        _referenceCount -= 1;
-        if(_referenceCount <= 0)
+        if(_referenceCount.decrement() <= 0)
           delete this;
       }
 
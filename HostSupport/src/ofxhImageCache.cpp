@@ -0,0 +1,393 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+// ofx
+#include "ofxCore.h"
+#include "ofxImageEffect.h"
+
+// ofx host
+#include "ofxhBinary.h"
+#include "ofxhPropertySuite.h"
+#include "ofxhClip.h"
+#include "ofxhParam.h"
+#ifdef OFX_SUPPORTS_PARAMETRIC
+#include "ofxhParametricParam.h"
+#endif
+#include "ofxhImageCache.h"
+
+namespace OFX {
+
+  namespace Host {
+
+    namespace ImageEffect {
+
+      ////////////////////////////////////////////////////////////////////////////////
+      // key
+
+      ImageCache::Key::Key()
+        : effect(0)
+        , clip(0)
+        , time(0)
+        , paramsHash(0)
+      {
+        renderScale.x = renderScale.y = 1;
+      }
+
+      ImageCache::Key::Key(const Instance *e, const ClipInstance *c, OfxTime t, const std::string &f,
+                           OfxPointD rs, const std::string &d, const std::string &comps, unsigned long long ph)
+        : effect(e)
+        , clip(c)
+        , time(t)
+        , field(f)
+        , renderScale(rs)
+        , depth(d)
+        , components(comps)
+        , paramsHash(ph)
+      {
+      }
+
+      bool ImageCache::Key::operator<(const Key &other) const
+      {
+        if(effect != other.effect) return effect < other.effect;
+        if(clip != other.clip) return clip < other.clip;
+        if(time != other.time) return time < other.time;
+        if(renderScale.x != other.renderScale.x) return renderScale.x < other.renderScale.x;
+        if(renderScale.y != other.renderScale.y) return renderScale.y < other.renderScale.y;
+        if(paramsHash != other.paramsHash) return paramsHash < other.paramsHash;
+        if(field != other.field) return field < other.field;
+        if(depth != other.depth) return depth < other.depth;
+        return components < other.components;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      // cache
+
+      /// is inner inside outer
+      static bool contains(const OfxRectI &outer, const OfxRectI &inner)
+      {
+        return outer.x1 <= inner.x1 && outer.y1 <= inner.y1 &&
+          outer.x2 >= inner.x2 && outer.y2 >= inner.y2;
+      }
+
+      ImageCache::ImageCache(size_t budget)
+        : _budget(budget)
+      {
+        _stats.hits = 0;
+        _stats.misses = 0;
+        _stats.insertions = 0;
+        _stats.evictions = 0;
+        _stats.entries = 0;
+        _stats.bytesInUse = 0;
+      }
+
+      ImageCache::~ImageCache()
+      {
+        clear();
+      }
+
+      Image *ImageCache::find(const Key &key, const OfxRectI &bounds)
+      {
+        Thread::AutoMutex lock(_lock);
+
+        EntryMap::iterator slot = _entries.find(key);
+        if(slot != _entries.end()) {
+          std::vector<Entry *> &entries = slot->second;
+          for(std::vector<Entry *>::iterator i = entries.begin(); i != entries.end(); ++i) {
+            Entry *entry = *i;
+            if(contains(entry->bounds, bounds)) {
+              // move to the front of the lru list
+              _lru.splice(_lru.begin(), _lru, entry->lru);
+              entry->image->addReference();
+              ++_stats.hits;
+              return entry->image;
+            }
+          }
+        }
+
+        ++_stats.misses;
+        return 0;
+      }
+
+      void ImageCache::insert(const Key &key, Image *image)
+      {
+        if(!image)
+          return;
+
+        OfxRectI bounds = image->getBounds();
+        int rowBytes = image->getIntProperty(kOfxImagePropRowBytes);
+        size_t bytes = size_t(abs(rowBytes)) * size_t(bounds.y2 > bounds.y1 ? bounds.y2 - bounds.y1 : 0);
+
+        std::vector<Image *> dead;
+        {
+          Thread::AutoMutex lock(_lock);
+
+          if(_budget && bytes > _budget)
+            return;
+
+          // drop anything this image makes redundant
+          EntryMap::iterator slot = _entries.find(key);
+          if(slot != _entries.end()) {
+            std::vector<Entry *> redundant;
+            for(std::vector<Entry *>::iterator i = slot->second.begin(); i != slot->second.end(); ++i) {
+              if(contains(bounds, (*i)->bounds))
+                redundant.push_back(*i);
+            }
+            // this may erase the slot
+            for(std::vector<Entry *>::iterator i = redundant.begin(); i != redundant.end(); ++i)
+              removeLocked(*i, dead);
+          }
+
+          slot = _entries.insert(std::make_pair(key, std::vector<Entry *>())).first;
+
+          Entry *entry = new Entry;
+          entry->slot = slot;
+          entry->image = image;
+          entry->bounds = bounds;
+          entry->bytes = bytes;
+          _lru.push_front(entry);
+          entry->lru = _lru.begin();
+          slot->second.push_back(entry);
+
+          image->addReference();
+          ++_stats.insertions;
+          ++_stats.entries;
+          _stats.bytesInUse += bytes;
+
+          evictLocked(dead);
+        }
+        releaseImages(dead);
+      }
+
+      void ImageCache::removeLocked(Entry *entry, std::vector<Image *> &dead)
+      {
+        std::vector<Entry *> &entries = entry->slot->second;
+        for(std::vector<Entry *>::iterator i = entries.begin(); i != entries.end(); ++i) {
+          if(*i == entry) {
+            entries.erase(i);
+            break;
+          }
+        }
+        if(entries.empty())
+          _entries.erase(entry->slot);
+
+        _lru.erase(entry->lru);
+        --_stats.entries;
+        _stats.bytesInUse -= entry->bytes;
+
+        dead.push_back(entry->image);
+        delete entry;
+      }
+
+      void ImageCache::evictLocked(std::vector<Image *> &dead)
+      {
+        while(_budget && _stats.bytesInUse > _budget && !_lru.empty()) {
+          removeLocked(_lru.back(), dead);
+          ++_stats.evictions;
+        }
+      }
+
+      void ImageCache::releaseImages(std::vector<Image *> &dead)
+      {
+        for(std::vector<Image *>::iterator i = dead.begin(); i != dead.end(); ++i)
+          (*i)->releaseReference();
+        dead.clear();
+      }
+
+      void ImageCache::invalidate(const Instance *effect)
+      {
+        std::vector<Image *> dead;
+        {
+          Thread::AutoMutex lock(_lock);
+          for(LRUList::iterator i = _lru.begin(); i != _lru.end(); ) {
+            Entry *entry = *i++;
+            if(entry->slot->first.effect == effect)
+              removeLocked(entry, dead);
+          }
+        }
+        releaseImages(dead);
+      }
+
+      void ImageCache::invalidate(const ClipInstance *clip)
+      {
+        std::vector<Image *> dead;
+        {
+          Thread::AutoMutex lock(_lock);
+          for(LRUList::iterator i = _lru.begin(); i != _lru.end(); ) {
+            Entry *entry = *i++;
+            if(entry->slot->first.clip == clip)
+              removeLocked(entry, dead);
+          }
+        }
+        releaseImages(dead);
+      }
+
+      void ImageCache::clear()
+      {
+        std::vector<Image *> dead;
+        {
+          Thread::AutoMutex lock(_lock);
+          while(!_lru.empty())
+            removeLocked(_lru.back(), dead);
+        }
+        releaseImages(dead);
+      }
+
+      void ImageCache::setBudget(size_t budget)
+      {
+        std::vector<Image *> dead;
+        {
+          Thread::AutoMutex lock(_lock);
+          _budget = budget;
+          evictLocked(dead);
+        }
+        releaseImages(dead);
+      }
+
+      size_t ImageCache::getBudget() const
+      {
+        Thread::AutoMutex lock(_lock);
+        return _budget;
+      }
+
+      ImageCache::Statistics ImageCache::getStatistics() const
+      {
+        Thread::AutoMutex lock(_lock);
+        return _stats;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      // parameter hashing
+
+      /// FNV-1a over some bytes
+      static void hashBytes(unsigned long long &hash, const void *data, size_t n)
+      {
+        const unsigned char *p = (const unsigned char *) data;
+        for(size_t i = 0; i < n; ++i) {
+          hash ^= p[i];
+          hash *= 1099511628211ULL;
+        }
+      }
+
+      static void hashDoubles(unsigned long long &hash, double a, double b = 0, double c = 0, double d = 0)
+      {
+        double v[4] = {a, b, c, d};
+        hashBytes(hash, v, sizeof(v));
+      }
+
+      static void hashInts(unsigned long long &hash, int a, int b = 0, int c = 0)
+      {
+        int v[3] = {a, b, c};
+        hashBytes(hash, v, sizeof(v));
+      }
+
+      unsigned long long ImageCache::hashParams(Param::SetInstance &params, OfxTime time)
+      {
+        unsigned long long hash = 14695981039346656037ULL;
+
+        const std::list<Param::Instance*> &paramList = params.getParamList();
+        for(std::list<Param::Instance*>::const_iterator it = paramList.begin(); it != paramList.end(); ++it) {
+          Param::Instance *param = *it;
+
+          const std::string &name = param->getName();
+          hashBytes(hash, name.c_str(), name.size() + 1);
+
+          if(Param::IntegerInstance *p = dynamic_cast<Param::IntegerInstance *>(param)) {
+            int v = 0; p->get(time, v);
+            hashInts(hash, v);
+          }
+          else if(Param::ChoiceInstance *p = dynamic_cast<Param::ChoiceInstance *>(param)) {
+            int v = 0; p->get(time, v);
+            hashInts(hash, v);
+          }
+          else if(Param::BooleanInstance *p = dynamic_cast<Param::BooleanInstance *>(param)) {
+            bool v = false; p->get(time, v);
+            hashInts(hash, v ? 1 : 0);
+          }
+          else if(Param::DoubleInstance *p = dynamic_cast<Param::DoubleInstance *>(param)) {
+            double v = 0; p->get(time, v);
+            hashDoubles(hash, v);
+          }
+          else if(Param::Double2DInstance *p = dynamic_cast<Param::Double2DInstance *>(param)) {
+            double x = 0, y = 0; p->get(time, x, y);
+            hashDoubles(hash, x, y);
+          }
+          else if(Param::Double3DInstance *p = dynamic_cast<Param::Double3DInstance *>(param)) {
+            double x = 0, y = 0, z = 0; p->get(time, x, y, z);
+            hashDoubles(hash, x, y, z);
+          }
+          else if(Param::Integer2DInstance *p = dynamic_cast<Param::Integer2DInstance *>(param)) {
+            int x = 0, y = 0; p->get(time, x, y);
+            hashInts(hash, x, y);
+          }
+          else if(Param::Integer3DInstance *p = dynamic_cast<Param::Integer3DInstance *>(param)) {
+            int x = 0, y = 0, z = 0; p->get(time, x, y, z);
+            hashInts(hash, x, y, z);
+          }
+          else if(Param::RGBAInstance *p = dynamic_cast<Param::RGBAInstance *>(param)) {
+            double r = 0, g = 0, b = 0, a = 0; p->get(time, r, g, b, a);
+            hashDoubles(hash, r, g, b, a);
+          }
+          else if(Param::RGBInstance *p = dynamic_cast<Param::RGBInstance *>(param)) {
+            double r = 0, g = 0, b = 0; p->get(time, r, g, b);
+            hashDoubles(hash, r, g, b);
+          }
+          // custom params are string params, their value is the plugin's serialisation of them
+          else if(Param::StringInstance *p = dynamic_cast<Param::StringInstance *>(param)) {
+            std::string v; p->get(time, v);
+            hashBytes(hash, v.c_str(), v.size() + 1);
+          }
+#ifdef OFX_SUPPORTS_PARAMETRIC
+          // the curves are read as a render started would read them, from its snapshot
+          else if(ParametricParam::ParametricInstance *p = dynamic_cast<ParametricParam::ParametricInstance *>(param)) {
+            int nCurves = p->getNumCurves();
+            hashInts(hash, nCurves);
+            for(int curve = 0; curve < nCurves; ++curve) {
+              int nPoints = 0; p->getNControlPoints(curve, time, nPoints);
+              hashInts(hash, curve, nPoints);
+              for(int i = 0; i < nPoints; ++i) {
+                double key = 0, value = 0; p->getNthControlPoint(curve, time, i, key, value);
+                hashDoubles(hash, key, value);
+              }
+            }
+          }
+#endif
+        }
+
+        return hash;
+      }
+
+    } // ImageEffect
+
+  } // Host
+
+} // OFX
@@ -32,6 +32,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // ofx
 #include "ofxCore.h"
 #include "ofxImageEffect.h"
+#include "ofxsParamBatchSuite.h"
 
 // ofx host
 #include "ofxhBinary.h"
@@ -45,6 +46,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ofxhHost.h"
 #include "ofxhImageEffectAPI.h"
 #include "ofxhUtilities.h"
+#include "ofxhThread.h"
 #ifdef OFX_SUPPORTS_PARAMETRIC
 #include "ofxhParametricParam.h"
 #endif
@@ -55,6 +57,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <string.h>
 #include <stdarg.h>
+#include <set>
 
 namespace OFX {
 
@@ -345,6 +348,233 @@ namespace OFX {
         Property::propSpecEnd
       };
 
+      ////////////////////////////////////////////////////////////////////////////////
+      // cached action arguments
+
+      /// in args for the RoD action
+      static const Property::PropSpec rodInArgsStuff[] = {
+        { kOfxPropTime, Property::eDouble, 1, true, "0" },
+        { kOfxImageEffectPropRenderScale, Property::eDouble, 2, true, "0" },
+        Property::propSpecEnd
+      };
+
+      /// out args for the RoD action
+      static const Property::PropSpec rodOutArgsStuff[] = {
+        { kOfxImageEffectPropRegionOfDefinition , Property::eDouble, 4, false, "0" },
+        Property::propSpecEnd
+      };
+
+      /// in args for the RoI action, the out args are made per clip
+      static const Property::PropSpec roiInArgsStuff[] = {
+        { kOfxPropTime, Property::eDouble, 1, true, "0" },
+        { kOfxImageEffectPropRenderScale, Property::eDouble, 2, true, "0" },
+        { kOfxImageEffectPropRegionOfInterest , Property::eDouble, 4, true, 0 },
+        Property::propSpecEnd
+      };
+
+      /// in args for the frames needed action, the out args are made per clip
+      static const Property::PropSpec framesNeededInArgsStuff[] = {
+        { kOfxPropTime, Property::eDouble, 1, true, "0" },          
+        Property::propSpecEnd
+      };
+
+      /// in args for the render action
+      static const Property::PropSpec renderInArgsStuff[] = {
+        { kOfxPropTime, Property::eDouble, 1, true, "0" },
+        { kOfxImageEffectPropFieldToRender, Property::eString, 1, true, "" }, 
+        { kOfxImageEffectPropRenderWindow, Property::eInt, 4, true, "0" },
+        { kOfxImageEffectPropRenderScale, Property::eDouble, 2, true, "0" },
+        { kOfxImageEffectPropSequentialRenderStatus, Property::eInt, 1, true, "0" },
+        { kOfxImageEffectPropInteractiveRenderStatus, Property::eInt, 1, true, "0" },
+        { kOfxImageEffectPropRenderQualityDraft, Property::eInt, 1, true, "0" },
+        Property::propSpecEnd
+      };
+
+      /// in args for the is identity action
+      static const Property::PropSpec isIdentityInArgsStuff[] = {
+        { kOfxPropTime, Property::eDouble, 1, true, "0" },
+        { kOfxImageEffectPropFieldToRender, Property::eString, 1, true, "" }, 
+        { kOfxImageEffectPropRenderWindow, Property::eInt, 4, true, "0" },
+        { kOfxImageEffectPropRenderScale, Property::eDouble, 2, true, "0" },
+        Property::propSpecEnd
+      };
+
+      /// out args for the is identity action
+      static const Property::PropSpec isIdentityOutArgsStuff[] = {
+        { kOfxPropTime, Property::eDouble, 1, false, "0.0" },
+        { kOfxPropName, Property::eString, 1, false, "" },
+        Property::propSpecEnd
+      };
+
+      /// The in and out arguments for the actions that are called for every frame or tile of
+      /// a render, made once with the right shape for the instance's clips and then refilled
+      /// in place on every call. Each thread running one of these actions takes its own from
+      /// the instance's ActionArgsPool, so concurrent renders never share one.
+      class Instance::ActionArgs {
+      public :
+        /// the per clip properties of the RoI and frames needed out args
+        struct ClipArgs {
+          ClipInstance     *clip;
+          std::string       roiName;        ///< "OfxImageClipPropRoI_" + the clip name
+          std::string       frameRangeName; ///< "OfxImageClipPropFrameRange_" + the clip name
+          Property::Double *roi;            ///< the RoI out property, NULL if the RoI action does not ask about this clip
+          Property::Double *frameRange;     ///< the frame range out property, NULL for the output clip
+        };
+
+        Property::Set rodIn, rodOut;
+        Property::Set roiIn, roiOut;
+        Property::Set framesNeededIn, framesNeededOut;
+        Property::Set renderIn;
+        Property::Set isIdentityIn, isIdentityOut;
+
+        /// one per clip, in the same order as the instance's clip map
+        std::vector<ClipArgs> clips;
+
+        ActionArgs(const std::map<std::string, ClipInstance*> &clipMap, bool isGenerator)
+          : rodIn(rodInArgsStuff)
+          , rodOut(rodOutArgsStuff)
+          , roiIn(roiInArgsStuff)
+          , framesNeededIn(framesNeededInArgsStuff)
+          , renderIn(renderInArgsStuff)
+          , isIdentityIn(isIdentityInArgsStuff)
+          , isIdentityOut(isIdentityOutArgsStuff)
+        {
+          clips.reserve(clipMap.size());
+          for(std::map<std::string, ClipInstance*>::const_iterator it = clipMap.begin(); it != clipMap.end(); ++it) {
+            ClipArgs c;
+            c.clip = it->second;
+            c.roiName = "OfxImageClipPropRoI_" + it->first;
+            c.frameRangeName = "OfxImageClipPropFrameRange_" + it->first;
+            c.roi = 0;
+            c.frameRange = 0;
+
+            if(!c.clip->isOutput() || isGenerator) {
+              Property::PropSpec spec = { c.roiName.c_str(), Property::eDouble, 4, false, "" };
+              roiOut.createProperty(spec);
+              c.roi = roiOut.fetchDoubleProperty(c.roiName);
+            }
+            if(!c.clip->isOutput()) {
+              Property::PropSpec spec = { c.frameRangeName.c_str(), Property::eDouble, 0, false, "" };
+              framesNeededOut.createProperty(spec);
+              c.frameRange = framesNeededOut.fetchDoubleProperty(c.frameRangeName);
+            }
+            clips.push_back(c);
+          }
+        }
+      };
+
+      /// A pool of ActionArgs for an instance, one for each thread currently running an action.
+      class Instance::ActionArgsPool {
+      protected :
+        Thread::Mutex              _lock;
+        std::vector<ActionArgs *>  _spare;
+
+      public :
+        ~ActionArgsPool()
+        {
+          for(std::vector<ActionArgs *>::iterator i = _spare.begin(); i != _spare.end(); ++i)
+            delete *i;
+        }
+
+        /// get a set of args nobody else is using, making one if need be
+        ActionArgs *acquire(const std::map<std::string, ClipInstance*> &clipMap, bool isGenerator)
+        {
+          {
+            Thread::AutoMutex lock(_lock);
+            if(!_spare.empty()) {
+              ActionArgs *args = _spare.back();
+              _spare.pop_back();
+              return args;
+            }
+          }
+          return new ActionArgs(clipMap, isGenerator);
+        }
+
+        /// give back args got with acquire
+        void release(ActionArgs *args)
+        {
+          Thread::AutoMutex lock(_lock);
+          _spare.push_back(args);
+        }
+
+        /// holds a set of args from the pool for the length of a scope
+        class Lease {
+        public :
+          Lease(Instance &instance)
+            : _pool(*instance._actionArgsPool)
+            , _args(_pool.acquire(instance._clips, instance.getContext() == kOfxImageEffectContextGenerator))
+          {
+          }
+
+          ~Lease() { _pool.release(_args); }
+
+          ActionArgs *operator->() const { return _args; }
+
+        protected :
+          ActionArgsPool &_pool;
+          ActionArgs     *_args;
+        };
+      };
+
+      ////////////////////////////////////////////////////////////////////////////////
+      // memory pressure
+
+      /// Keeps track of the created effect instances so that they can be asked to purge their
+      /// caches when the image memory pool goes over its budget. The host installs it as the
+      /// pool's pressure handler when it is made. The pool calls it on whichever thread is
+      /// allocating, maybe mid render, so it only notes the pressure for purgeCachesUnderPressure.
+      class InstancePurger : public Memory::PressureHandler {
+      protected :
+        Thread::Mutex         _lock;
+        std::set<Instance *>  _instances;
+        bool                  _pending;    ///< has the pool run short since the last purge
+
+        InstancePurger() : _pending(false) {}
+
+      public :
+        /// the one purger, never deleted as instances may outlive static destruction
+        static InstancePurger &get()
+        {
+          static InstancePurger *purger = new InstancePurger;
+          return *purger;
+        }
+
+        void add(Instance *instance)
+        {
+          Thread::AutoMutex lock(_lock);
+          _instances.insert(instance);
+        }
+
+        void remove(Instance *instance)
+        {
+          Thread::AutoMutex lock(_lock);
+          _instances.erase(instance);
+        }
+
+        virtual void memoryPressure(size_t /*nBytes*/)
+        {
+          Thread::AutoMutex lock(_lock);
+          _pending = true;
+        }
+
+        /// purge everyone if the pool ran short, the lock is held throughout so no instance can go away under us
+        bool purgePending()
+        {
+          Thread::AutoMutex lock(_lock);
+          if(!_pending)
+            return false;
+          _pending = false;
+          for(std::set<Instance *>::iterator i = _instances.begin(); i != _instances.end(); ++i)
+            (*i)->purgeCachesAction();
+          return true;
+        }
+      };
+
+      bool purgeCachesUnderPressure()
+      {
+        return InstancePurger::get().purgePending();
+      }
+
       Instance::Instance(ImageEffectPlugin* plugin,
                          Descriptor         &other, 
                          const std::string  &context,
@@ -359,7 +589,11 @@ namespace OFX {
         , _continuousSamples(false)
         , _frameVarying(false)
         , _outputFrameRate(24)
+        , _actionArgsPool(new ActionArgsPool)
       {
+        // keep our plugin's binary should a rescan drop it
+        _plugin->instanceCreated();
+
         int i = 0;
         _properties.setChainedSet(&other.getProps());
 
@@ -561,6 +795,9 @@ namespace OFX {
       }
 
       Instance::~Instance(){
+        // no purging from here on
+        InstancePurger::get().remove(this);
+
         // destroy the instance, only if succesfully created
         if (_created) {
 #       ifdef OFX_DEBUG_ACTIONS
@@ -580,6 +817,11 @@ namespace OFX {
             delete i->second;
           i->second = NULL;
         }
+
+        delete _actionArgsPool;
+
+        // done with the plugin, bar our params, whose destructors do not call it
+        _plugin->instanceDestroyed();
       }
 
       /// this is used to populate with any extra action in argumnents that may be needed
@@ -625,7 +867,7 @@ namespace OFX {
         if(instance)
           return instance;
         else{
-          Memory::Instance* instance = new Memory::Instance;
+          Memory::Instance* instance = new Memory::PooledInstance;
           instance->alloc(nBytes);
           return instance;
         }
@@ -705,6 +947,7 @@ namespace OFX {
 
         if (st == kOfxStatOK) {
           _created = true;
+          InstancePurger::get().add(this);
         }
 
         return st;
@@ -941,18 +1184,10 @@ namespace OFX {
                                        bool     draftRender
                                        )
       {
-        static const Property::PropSpec inStuff[] = {
-          { kOfxPropTime, Property::eDouble, 1, true, "0" },
-          { kOfxImageEffectPropFieldToRender, Property::eString, 1, true, "" }, 
-          { kOfxImageEffectPropRenderWindow, Property::eInt, 4, true, "0" },
-          { kOfxImageEffectPropRenderScale, Property::eDouble, 2, true, "0" },
-          { kOfxImageEffectPropSequentialRenderStatus, Property::eInt, 1, true, "0" },
-          { kOfxImageEffectPropInteractiveRenderStatus, Property::eInt, 1, true, "0" },
-          { kOfxImageEffectPropRenderQualityDraft, Property::eInt, 1, true, "0" },
-          Property::propSpecEnd
-        };
-
-        Property::Set inArgs(inStuff);
+        // the plugin's param reads come from one snapshot however long the render takes
+        Param::SetInstance::RenderPin pin(*this);
+        ActionArgsPool::Lease args(*this);
+        Property::Set &inArgs = args->renderIn;
         
         inArgs.setStringProperty(kOfxImageEffectPropFieldToRender,field);
         inArgs.setDoubleProperty(kOfxPropTime,time);
@@ -1104,20 +1339,11 @@ namespace OFX {
                                                       OfxPointD   renderScale,
                                                       OfxRectD &rod)
       {
-        static const Property::PropSpec inStuff[] = {
-          { kOfxPropTime, Property::eDouble, 1, true, "0" },
-          { kOfxImageEffectPropRenderScale, Property::eDouble, 2, true, "0" },
-          Property::propSpecEnd
-        };
-
-        static const Property::PropSpec outStuff[] = {
-          { kOfxImageEffectPropRegionOfDefinition , Property::eDouble, 4, false, "0" },
-          Property::propSpecEnd
-        };
-
-        Property::Set inArgs(inStuff);
-        Property::Set outArgs(outStuff);
+        ActionArgsPool::Lease args(*this);
+        Property::Set &inArgs = args->rodIn;
+        Property::Set &outArgs = args->rodOut;
         
+        outArgs.fetchProperty(kOfxImageEffectPropRegionOfDefinition)->reset();
         inArgs.setDoubleProperty(kOfxPropTime,time);
         inArgs.setDoublePropertyN(kOfxImageEffectPropRenderScale, &renderScale.x, 2);
 
@@ -1176,37 +1402,18 @@ namespace OFX {
         }
         else {
           /// set up the in args 
-          static const Property::PropSpec inStuff[] = {
-            { kOfxPropTime, Property::eDouble, 1, true, "0" },
-            { kOfxImageEffectPropRenderScale, Property::eDouble, 2, true, "0" },
-            { kOfxImageEffectPropRegionOfInterest , Property::eDouble, 4, true, 0 },
-            Property::propSpecEnd
-          };
-          Property::Set inArgs(inStuff);
+          ActionArgsPool::Lease args(*this);
+          Property::Set &inArgs = args->roiIn;
+          Property::Set &outArgs = args->roiOut;
 
           inArgs.setDoublePropertyN(kOfxImageEffectPropRenderScale, &renderScale.x, 2);
           inArgs.setDoubleProperty(kOfxPropTime,time);
           inArgs.setDoublePropertyN(kOfxImageEffectPropRegionOfInterest, &roi.x1, 4);
 
-          Property::Set outArgs;
-          for(std::map<std::string, ClipInstance*>::iterator it=_clips.begin();
-              it!=_clips.end();
-              ++it) {
-            if(!it->second->isOutput() ||
-               getContext() == kOfxImageEffectContextGenerator) {
-              Property::PropSpec s;
-              std::string name = "OfxImageClipPropRoI_"+it->first;
-            
-              s.name = name.c_str();
-              s.type = Property::eDouble;
-              s.dimension = 4;
-              s.readonly = false;
-              s.defaultValue = "";
-              outArgs.createProperty(s);
-            
-              /// initialise to the default
-              outArgs.setDoublePropertyN(s.name, &roi.x1, 4);
-            }
+          /// initialise the out args to the default
+          for(std::vector<ActionArgs::ClipArgs>::iterator it = args->clips.begin(); it != args->clips.end(); ++it) {
+            if(it->roi) 
+              it->roi->setValueN(&roi.x1, 4);
           }
 
 #         ifdef OFX_DEBUG_ACTIONS
@@ -1222,53 +1429,42 @@ namespace OFX {
             std::cout << "OFX: "<<(void*)this<<"->"<<kOfxImageEffectActionGetRegionsOfInterest<<"("<<time<<",("<<renderScale.x<<","<<renderScale.y<<"),("<<roi.x1<<","<<roi.y1<<","<<roi.x2<<","<<roi.y2<<"))->"<<StatStr(stat);
             if (stat == kOfxStatOK) {
                 std::cout << ": ";
-                for(std::map<std::string, ClipInstance*>::iterator it=_clips.begin();
-                    it!=_clips.end();
-                    ++it) {
-                    std::string name = "OfxImageClipPropRoI_"+it->first;
+                for(std::vector<ActionArgs::ClipArgs>::iterator it = args->clips.begin(); it != args->clips.end(); ++it) {
+                    if(!it->roi)
+                      continue;
                     OfxRectD thisRoi;
-                    thisRoi.x1 = outArgs.getDoubleProperty(name,0);
-                    thisRoi.y1 = outArgs.getDoubleProperty(name,1);
-                    thisRoi.x2 = outArgs.getDoubleProperty(name,2);
-                    thisRoi.y2 = outArgs.getDoubleProperty(name,3);
-                    std::cout << it->first << "->("<<thisRoi.x1<<","<<thisRoi.y1<<","<<thisRoi.x2<<","<<thisRoi.y2<<") ";
+                    it->roi->getValueN(&thisRoi.x1, 4);
+                    std::cout << it->clip->getName() << "->("<<thisRoi.x1<<","<<thisRoi.y1<<","<<thisRoi.x2<<","<<thisRoi.y2<<") ";
                 }
             }
             std::cout << std::endl;
 #           endif
           /// set the thing up
-          for(std::map<std::string, ClipInstance*>::iterator it=_clips.begin();
-              it!=_clips.end();
-              ++it) {
-              if(!it->second->isOutput() ||
-               getContext() == kOfxImageEffectContextGenerator) {
-                if (it->second->isOutput() || it->second->getConnected()) { // needed to be able to fetch the RoD
+          for(std::vector<ActionArgs::ClipArgs>::iterator it = args->clips.begin(); it != args->clips.end(); ++it) {
+            ClipInstance *clip = it->clip;
+            if(it->roi) {
+              if (clip->isOutput() || clip->getConnected()) { // needed to be able to fetch the RoD
                   
-                  if(it->second->supportsTiles()) {
-                    std::string name = "OfxImageClipPropRoI_"+it->first;
-                    OfxRectD thisRoi;
-                    thisRoi.x1 = outArgs.getDoubleProperty(name,0);
-                    thisRoi.y1 = outArgs.getDoubleProperty(name,1);
-                    thisRoi.x2 = outArgs.getDoubleProperty(name,2);
-                    thisRoi.y2 = outArgs.getDoubleProperty(name,3);
+                if(clip->supportsTiles()) {
+                  OfxRectD thisRoi;
+                  it->roi->getValueN(&thisRoi.x1, 4);
                   
-                    // and DON'T clamp it to the clip's rod
-                    // We cannot clip it against the RoD because the RoI may be used for frames
-                    // at different a time or view than the current time and view passed to this action
-                    // which would result in a wrong clipping. Unfortunately only the implementation of
-                    // the host can do the correct clipping.
-                    //thisRoi = Clamp(thisRoi, rod);
-                    rois[it->second] = thisRoi;
-                  }
-                  else {
-                    /// not supporting tiles on this input, so set it to the rod
-                    OfxRectD rod = it->second->getRegionOfDefinition(time
-                                                                       );
-                    rois[it->second] = rod;
-                  }
+                  // and DON'T clamp it to the clip's rod
+                  // We cannot clip it against the RoD because the RoI may be used for frames
+                  // at different a time or view than the current time and view passed to this action
+                  // which would result in a wrong clipping. Unfortunately only the implementation of
+                  // the host can do the correct clipping.
+                  //thisRoi = Clamp(thisRoi, rod);
+                  rois[clip] = thisRoi;
+                }
+                else {
+                  /// not supporting tiles on this input, so set it to the rod
+                  OfxRectD rod = clip->getRegionOfDefinition(time);
+                  rois[clip] = rod;
                 }
               }
             }
+          }
         }
   
         return stat;
@@ -1281,34 +1477,18 @@ namespace OFX {
                                                RangeMap &rangeMap)
       {
         OfxStatus stat = kOfxStatReplyDefault;
-        Property::Set outArgs;
+        ActionArgsPool::Lease args(*this);
+        Property::Set &outArgs = args->framesNeededOut;
       
         if(temporalAccess()) {
-          static const Property::PropSpec inStuff[] = {
-            { kOfxPropTime, Property::eDouble, 1, true, "0" },          
-            Property::propSpecEnd
-          };
-          Property::Set inArgs(inStuff);       
+          Property::Set &inArgs = args->framesNeededIn;
           inArgs.setDoubleProperty(kOfxPropTime,time);
         
-        
-          for(std::map<std::string, ClipInstance*>::iterator it=_clips.begin();
-              it!=_clips.end();
-              ++it) {
-            if(!it->second->isOutput()) {
-              Property::PropSpec s;
-              std::string name = "OfxImageClipPropFrameRange_"+it->first;
-              
-              s.name = name.c_str();
-              s.type = Property::eDouble;
-              s.dimension = 0;
-              s.readonly = false;
-              s.defaultValue = "";
-              outArgs.createProperty(s);
-              /// intialise it to the current frame
-              outArgs.setDoubleProperty(name, time, 0);
-              outArgs.setDoubleProperty(name, time, 1);
-            }
+          /// intialise the out args to the current frame
+          double currentFrame[2] = {time, time};
+          for(std::vector<ActionArgs::ClipArgs>::iterator it = args->clips.begin(); it != args->clips.end(); ++it) {
+            if(it->frameRange)
+              it->frameRange->setValueN(currentFrame, 2);
           }
 
 #         ifdef OFX_DEBUG_ACTIONS
@@ -1322,19 +1502,14 @@ namespace OFX {
             std::cout << "OFX: "<<(void*)this<<"->"<<kOfxImageEffectActionGetFramesNeeded<<"("<<time<<")->"<<StatStr(stat);
             if (stat == kOfxStatOK) {
                 std::cout << ": ";
-                for(std::map<std::string, ClipInstance*>::iterator it=_clips.begin();
-                    it!=_clips.end();
-                    ++it) {
-                    ClipInstance *clip = it->second;
-
-                    if(!clip->isOutput()) {
-                        std::string name = "OfxImageClipPropFrameRange_"+it->first;
-                        std::cout << it->first << "->[";
+                for(std::vector<ActionArgs::ClipArgs>::iterator it = args->clips.begin(); it != args->clips.end(); ++it) {
+                    if(it->frameRange) {
+                        std::cout << it->clip->getName() << "->[";
 
-                        int nRanges = outArgs.getDimension(name);
+                        int nRanges = it->frameRange->getDimension();
                         for(int r=0;r<nRanges;){
-                            double min = outArgs.getDoubleProperty(name,r);
-                            double max = outArgs.getDoubleProperty(name,r+1);
+                            double min = it->frameRange->getValue(r);
+                            double max = it->frameRange->getValue(r+1);
                             r += 2;
                             std::cout <<"("<<min<<","<<max<<")";
                             if (r < nRanges-1) {
@@ -1353,19 +1528,15 @@ namespace OFX {
         defaultRange.min = 
           defaultRange.max = time;
 
-        for(std::map<std::string, ClipInstance*>::iterator it=_clips.begin();
-            it!=_clips.end();
-            ++it) {
-          ClipInstance *clip = it->second;
+        for(std::vector<ActionArgs::ClipArgs>::iterator it = args->clips.begin(); it != args->clips.end(); ++it) {
+          ClipInstance *clip = it->clip;
           
-          if(!clip->isOutput()) {
+          if(it->frameRange) {
             if(stat != kOfxStatOK) {
               rangeMap[clip].push_back(defaultRange);
             }
             else {
-              std::string name = "OfxImageClipPropFrameRange_"+it->first;
-          
-              int nRanges = outArgs.getDimension(name);
+              int nRanges = it->frameRange->getDimension();
               if(nRanges%2 != 0)
                 return kOfxStatFailed; // bad! needs to be divisible by 2
 
@@ -1374,8 +1545,8 @@ namespace OFX {
               }
               else {
                 for(int r=0;r<nRanges;){
-                  double min = outArgs.getDoubleProperty(name,r);
-                  double max = outArgs.getDoubleProperty(name,r+1);
+                  double min = it->frameRange->getValue(r);
+                  double max = it->frameRange->getValue(r+1);
                   r += 2;
                 
                   OfxRangeD range;
@@ -1397,28 +1568,16 @@ namespace OFX {
                                            OfxPointD   renderScale,
                                            std::string &clip)
       {
-        static const Property::PropSpec inStuff[] = {
-          { kOfxPropTime, Property::eDouble, 1, true, "0" },
-          { kOfxImageEffectPropFieldToRender, Property::eString, 1, true, "" }, 
-          { kOfxImageEffectPropRenderWindow, Property::eInt, 4, true, "0" },
-          { kOfxImageEffectPropRenderScale, Property::eDouble, 2, true, "0" },
-          Property::propSpecEnd
-        };
-
-        static const Property::PropSpec outStuff[] = {
-          { kOfxPropTime, Property::eDouble, 1, false, "0.0" },
-          { kOfxPropName, Property::eString, 1, false, "" },
-          Property::propSpecEnd
-        };
-
-        Property::Set inArgs(inStuff);        
+        ActionArgsPool::Lease args(*this);
+        Property::Set &inArgs = args->isIdentityIn;
 
         inArgs.setStringProperty(kOfxImageEffectPropFieldToRender,field);
         inArgs.setDoubleProperty(kOfxPropTime,time);
         inArgs.setIntPropertyN(kOfxImageEffectPropRenderWindow, &renderRoI.x1, 4);
         inArgs.setDoublePropertyN(kOfxImageEffectPropRenderScale, &renderScale.x, 2);
 
-        Property::Set outArgs(outStuff);
+        Property::Set &outArgs = args->isIdentityOut;
+        outArgs.setStringProperty(kOfxPropName, "");
 
 #       ifdef OFX_DEBUG_ACTIONS
           std::cout << "OFX: "<<(void*)this<<"->"<<kOfxImageEffectActionIsIdentity<<"("<<time<<","<<field<<",("<<renderRoI.x1<<","<<renderRoI.y1<<","<<renderRoI.x2<<","<<renderRoI.y2<<"),("<<renderScale.x<<","<<renderScale.y<<"))"<<std::endl;
@@ -1782,50 +1941,27 @@ namespace OFX {
       /// given the bit depth, find the best match for it.
       const std::string &Instance::bestSupportedDepth(const std::string &depth) const
       {
-        static const std::string none(kOfxBitDepthNone);
-        static const std::string bytes(kOfxBitDepthByte);
-        static const std::string shorts(kOfxBitDepthShort);
-        static const std::string halfs(kOfxBitDepthHalf);
-        static const std::string floats(kOfxBitDepthFloat);
-
-        if(depth == none)
-          return none;
+        if(depth == kOfxBitDepthNone)
+          return GetBitDepthOfRank(0);
 
         if(isPixelDepthSupported(depth))
           return depth;
-        
-        if(depth == floats) {
-          if(isPixelDepthSupported(shorts))
-            return shorts;
-          if(isPixelDepthSupported(bytes))
-            return bytes;
-        }
-          
-        if(depth == halfs) {
-          if(isPixelDepthSupported(floats))
-            return floats;
-          if(isPixelDepthSupported(shorts))
-            return shorts;
-          if(isPixelDepthSupported(bytes))
-            return bytes;
-        }
-          
-        if(depth == shorts) {
-          if(isPixelDepthSupported(floats))
-            return floats;
-          if(isPixelDepthSupported(bytes))
-            return bytes;
-        }
 
-        if(depth == bytes) {
-          if(isPixelDepthSupported(shorts))
-            return shorts;
-          if(isPixelDepthSupported(floats))
-            return floats;
+        /// the nearest deeper depth loses nothing, failing that the nearest shallower, ranked as FindDeepestBitDepth ranks them
+        int rank = GetBitDepthRank(depth);
+        if(rank > 0) {
+          for(int r = rank + 1; GetBitDepthOfRank(r) != kOfxBitDepthNone; ++r) {
+            if(isPixelDepthSupported(GetBitDepthOfRank(r)))
+              return GetBitDepthOfRank(r);
+          }
+          for(int r = rank - 1; r > 0; --r) {
+            if(isPixelDepthSupported(GetBitDepthOfRank(r)))
+              return GetBitDepthOfRank(r);
+          }
         }
         
         /// WTF? Something wrong here
-        return none;          
+        return GetBitDepthOfRank(0);
       }
 
 
@@ -2586,72 +2722,68 @@ namespace OFX {
         return gImageEffectHost->mutexTryLock(mutex);
       }
 #else // !OFX_SUPPORTS_MULTITHREAD
-      /// a simple multithread suite
+      /// the default multithread suite, run on the host support library's worker pool
       static OfxStatus multiThread(OfxThreadFunctionV1 func,
-                                   unsigned int /*nThreads*/,
+                                   unsigned int nThreads,
                                    void *customArg)
       {
-        if (!func)
-          return kOfxStatFailed;
-        func(0,1,customArg);
-        return kOfxStatOK;
+        return Thread::WorkerPool::get().multiThread(func, nThreads, customArg);
       }
 
       static OfxStatus multiThreadNumCPUs(unsigned int *nCPUs)
       {
         if (!nCPUs)
           return kOfxStatFailed;
-        *nCPUs = 1;
+        *nCPUs = Thread::WorkerPool::numCPUs();
         return kOfxStatOK;
       }
 
       static OfxStatus multiThreadIndex(unsigned int *threadIndex){
-        if (!threadIndex)
-          return kOfxStatFailed;
-        *threadIndex = 0;
-        return kOfxStatOK;
+        return Thread::WorkerPool::threadIndex(threadIndex);
       }
 
       static int multiThreadIsSpawnedThread(void){
-        return false;
+        return Thread::WorkerPool::isSpawnedThread();
       }
 
-      static OfxStatus mutexCreate(OfxMutexHandle *mutex, int /*lockCount*/)
+      static OfxStatus mutexCreate(OfxMutexHandle *mutex, int lockCount)
       {
         if (!mutex)
           return kOfxStatFailed;
-        // do nothing single threaded
-        *mutex = 0;
+        Thread::RecursiveMutex *m = new Thread::RecursiveMutex;
+        // the mutex starts off locked lockCount times by the creating thread
+        for(int i = 0; i < lockCount; ++i)
+          m->lock();
+        *mutex = (OfxMutexHandle) m;
         return kOfxStatOK;
       }
 
       static OfxStatus mutexDestroy(const OfxMutexHandle mutex)
       {
-        if (mutex != 0)
+        if (mutex == 0)
           return kOfxStatErrBadHandle;
-        // do nothing single threaded
+        delete (Thread::RecursiveMutex *) mutex;
         return kOfxStatOK;
       }
 
       static OfxStatus mutexLock(const OfxMutexHandle mutex){
-        if (mutex != 0)
+        if (mutex == 0)
           return kOfxStatErrBadHandle;
-        // do nothing single threaded
+        ((Thread::RecursiveMutex *) mutex)->lock();
         return kOfxStatOK;
       }
        
       static OfxStatus mutexUnLock(const OfxMutexHandle mutex){
-        if (mutex != 0)
+        if (mutex == 0)
           return kOfxStatErrBadHandle;
-        // do nothing single threaded
+        ((Thread::RecursiveMutex *) mutex)->unlock();
         return kOfxStatOK;
       }       
 
       static OfxStatus mutexTryLock(const OfxMutexHandle mutex){
-        if (mutex != 0)
+        if (mutex == 0)
           return kOfxStatErrBadHandle;
-        // do nothing single threaded
-        return kOfxStatOK;
+        return ((Thread::RecursiveMutex *) mutex)->tryLock() ? kOfxStatOK : kOfxStatFailed;
       }
 #endif // !OFX_SUPPORTS_MULTITHREAD
        
@@ -2722,6 +2854,9 @@ namespace OFX {
       {
         /// add the properties for an image effect host, derived classs to set most of them
         _properties.addProperties(hostStuffs);
+
+        /// have the image memory pool purge effect caches when it runs short
+        Memory::Pool::global().setPressureHandler(&InstancePurger::get());
       }
 
       /// optionally over-ridden function to register the creation of a new descriptor in the host app
@@ -2750,7 +2885,7 @@ namespace OFX {
         if(instance)
           return instance;
         else{
-          Memory::Instance* instance = new Memory::Instance;
+          Memory::Instance* instance = new Memory::PooledInstance;
           instance->alloc(nBytes);
           return instance;
         }
@@ -2806,6 +2941,9 @@ namespace OFX {
             return NULL;
         }
 #     endif
+        else if (strcmp(suiteName, kNetSfOfxParameterBatchSuite)==0) {
+          return Param::GetBatchSuite(suiteVersion);
+        }
 #     ifdef OFX_SUPPORTS_PARAMETRIC
         else if (strcmp(suiteName, kOfxParametricParameterSuite)==0) {
           return ParametricParam::GetSuite(suiteVersion);
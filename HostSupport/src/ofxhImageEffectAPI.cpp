@@ -29,6 +29,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <assert.h>
 
+#include <algorithm>
 #include <string>
 #include <map>
 #include <ctype.h>
@@ -48,6 +49,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ofxhHost.h"
 #include "ofxhImageEffectAPI.h"
 #include "ofxhXml.h"
+#include "ofxhThread.h"
 
 // Disable the "this pointer used in base member initialiser list" warning in Windows
 namespace OFX {
@@ -88,7 +90,7 @@ namespace OFX {
         , _madeKnownContexts(false)
         , _pluginHandle(0)
       {        
-        _baseDescriptor = gImageEffectHost->makeDescriptor(this);
+        // the descriptor is made by baseDescriptor when the cached properties are decoded into it
       }
 
 #ifdef WINDOWS
@@ -124,14 +126,29 @@ namespace OFX {
       }
 
 
+      /// guards making base descriptors for plugins that are not decoded under the plugin cache's lock
+      static Thread::Mutex gBaseDescriptorLock;
+
+      Descriptor &ImageEffectPlugin::baseDescriptor() const
+      {
+        // always take the lock, testing _baseDescriptor outside it is not safe without a
+        // memory barrier, and an uncontended lock costs little next to what callers do next
+        Thread::AutoMutex lock(gBaseDescriptorLock);
+        if(!_baseDescriptor)
+          _baseDescriptor = gImageEffectHost->makeDescriptor(const_cast<ImageEffectPlugin *>(this));
+        return *_baseDescriptor;
+      }
+
       /// get the image effect descriptor
       Descriptor &ImageEffectPlugin::getDescriptor() {
-        return *_baseDescriptor;
+        loadPendingCacheData();
+        return baseDescriptor();
       }
 
       /// get the image effect descriptor const version
       const Descriptor &ImageEffectPlugin::getDescriptor() const {
-        return *_baseDescriptor;
+        loadPendingCacheData();
+        return baseDescriptor();
       }
 
       void ImageEffectPlugin::addContext(const std::string &context, Descriptor *ied)
@@ -243,6 +260,9 @@ namespace OFX {
         OFX::Host::Property::Set inarg(inargspec);
 
         PluginHandle *ph = getPluginHandle();
+        if (!ph) {
+          return 0;
+        }
         std::auto_ptr<ImageEffect::Descriptor> newContext( gImageEffectHost->makeDescriptor(getDescriptor(), this));
 
         OfxStatus stat;
@@ -402,7 +422,11 @@ namespace OFX {
         std::string msg = "loading ";
         msg += op->getRawIdentifier();
 
-        _host->loadingStatus(msg);
+        {
+          // hosts need not expect loadingStatus on several threads at once
+          Thread::AutoMutex lock(_loadingStatusLock);
+          _host->loadingStatus(msg);
+        }
 
         ImageEffectPlugin *p = dynamic_cast<ImageEffectPlugin*>(op);
         assert(p);
@@ -467,6 +491,21 @@ namespace OFX {
       }
 
 
+      /// runs the "describe in context" action on the plugin for each context it supports
+      void PluginCache::describeFully(Plugin *op) {
+        ImageEffectPlugin *p = dynamic_cast<ImageEffectPlugin*>(op);
+        if (!p) {
+          return;
+        }
+
+        std::set<std::string> contexts = p->getContexts();
+        for (std::set<std::string>::const_iterator it = contexts.begin(); it != contexts.end(); ++it) {
+          if (!p->getContext(*it)) {
+            std::cerr << "describe in context " << *it << " failed on plugin " << op->getIdentifier() << std::endl;
+          }
+        }
+      }
+
       /// handler for preparing to read in a chunk of XML from the cache, set up context to do this
       void PluginCache::beginXmlParsing(Plugin *p) {
         _currentPlugin = dynamic_cast<ImageEffectPlugin*>(p);
@@ -572,6 +611,24 @@ namespace OFX {
         }
       }
 
+      void PluginCache::forgetPlugin(Plugin *p) {
+        ImageEffectPlugin *plugin = dynamic_cast<ImageEffectPlugin*>(p);
+        std::vector<ImageEffectPlugin *>::iterator i = std::find(_plugins.begin(), _plugins.end(), plugin);
+        if (i == _plugins.end()) {
+          return;
+        }
+        _plugins.erase(i);
+
+        // another version may now be the latest, so confirm the rest again in the same order
+        std::vector<ImageEffectPlugin *> plugins;
+        plugins.swap(_plugins);
+        _pluginsByID.clear();
+        _pluginsByIDMajor.clear();
+        for (i = plugins.begin(); i != plugins.end(); ++i) {
+          confirmPlugin(*i);
+        }
+      }
+
       Plugin *PluginCache::newPlugin(PluginBinary *pb,
         int pi,
         OfxPlugin *pl) {
@@ -36,6 +36,15 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // ofx host
 #include "ofxhMemory.h"
 
+#include <stdlib.h>
+#include <new>
+
+#if defined(WINDOWS)
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
 namespace OFX {
 
   namespace Host {
@@ -83,6 +92,268 @@ namespace OFX {
         }
       }
 
+      ////////////////////////////////////////////////////////////////////////////////
+      // pool
+
+      /// size of the smallest size class
+      static const size_t kMinClassSize = 256;
+      static const int    kMinClassShift = 8;
+
+      /// buffers at least this big may be backed by huge pages
+      static const size_t kHugePageSize = 2 * 1024 * 1024;
+
+      /// one class for the smallest size, then four for each power of two above it
+      static const int kNumClasses = 1 + 4 * (int(sizeof(size_t)) * 8 - kMinClassShift);
+
+      Pool::Pool()
+        : _spare(kNumClasses)
+        , _budget(0)
+        , _useHugePages(false)
+        , _inPressure(false)
+        , _pressureHandler(0)
+      {
+        _stats.allocations = 0;
+        _stats.reuses = 0;
+        _stats.systemAllocations = 0;
+        _stats.releases = 0;
+        _stats.purges = 0;
+        _stats.bytesInUse = 0;
+        _stats.bytesSpare = 0;
+        _stats.peakBytesInUse = 0;
+      }
+
+      Pool::~Pool()
+      {
+        trim();
+      }
+
+      /// Never deleted, as images held by statics may be released into it while the
+      /// program exits, after a function local static pool would have gone.
+      Pool &Pool::global()
+      {
+        static Pool *pool = new Pool;
+        return *pool;
+      }
+
+      int Pool::sizeClass(size_t nBytes, size_t &capacity)
+      {
+        if(nBytes <= kMinClassSize) {
+          capacity = kMinClassSize;
+          return 0;
+        }
+
+        // find e such that 2^e < nBytes <= 2^(e+1)
+        int e = kMinClassShift;
+        while(e + 1 < int(sizeof(size_t)) * 8 && (size_t(1) << (e + 1)) < nBytes)
+          ++e;
+
+        // then round up to the next quarter of the way to 2^(e+1)
+        size_t base = size_t(1) << e;
+        size_t step = base >> 2;
+        size_t quarters = (nBytes - base + step - 1) / step;
+
+        capacity = base + quarters * step;
+        return 1 + (e - kMinClassShift) * 4 + int(quarters - 1);
+      }
+
+      void *Pool::systemAlloc(size_t capacity)
+      {
+        bool huge = _useHugePages && capacity >= kHugePageSize;
+        size_t alignment = huge ? kHugePageSize : kAlignment;
+
+#if defined(WINDOWS)
+        // large pages need special privileges on windows, so just align
+        (void)huge;
+        return _aligned_malloc(capacity, alignment);
+#else
+        void *ptr = 0;
+        if(posix_memalign(&ptr, alignment, capacity) != 0)
+          return 0;
+#  if defined(MADV_HUGEPAGE)
+        if(huge)
+          madvise(ptr, capacity, MADV_HUGEPAGE);
+#  endif
+        return ptr;
+#endif
+      }
+
+      void Pool::systemFree(void *ptr)
+      {
+#if defined(WINDOWS)
+        _aligned_free(ptr);
+#else
+        free(ptr);
+#endif
+      }
+
+      void *Pool::allocate(size_t nBytes, size_t &capacity)
+      {
+        int sc = sizeClass(nBytes, capacity);
+
+        _lock.lock();
+        ++_stats.allocations;
+
+        for(bool askedForHelp = false; ; askedForHelp = true) {
+          // recycle a spare one if we can
+          std::vector<void *> &spare = _spare[sc];
+          if(!spare.empty()) {
+            void *ptr = spare.back();
+            spare.pop_back();
+            ++_stats.reuses;
+            _stats.bytesSpare -= capacity;
+            _stats.bytesInUse += capacity;
+            if(_stats.bytesInUse > _stats.peakBytesInUse)
+              _stats.peakBytesInUse = _stats.bytesInUse;
+            _lock.unlock();
+            return ptr;
+          }
+
+          if(askedForHelp || !_budget || _stats.bytesInUse + _stats.bytesSpare + capacity <= _budget)
+            break;
+
+          // over budget, first drop our own spares
+          ++_stats.purges;
+          trimLocked();
+          if(_stats.bytesInUse + capacity <= _budget || !_pressureHandler || _inPressure)
+            break;
+
+          // then ask the handler to free some, without holding the lock as it will call back into us
+          _inPressure = true;
+          PressureHandler *handler = _pressureHandler;
+          _lock.unlock();
+          try {
+            handler->memoryPressure(capacity);
+          }
+          catch(...) {
+          }
+          _lock.lock();
+          _inPressure = false;
+        }
+
+        _stats.bytesInUse += capacity;
+        if(_stats.bytesInUse > _stats.peakBytesInUse)
+          _stats.peakBytesInUse = _stats.bytesInUse;
+        ++_stats.systemAllocations;
+        _lock.unlock();
+
+        void *ptr = systemAlloc(capacity);
+        if(!ptr) {
+          // try again with nothing held in reserve
+          trim();
+          ptr = systemAlloc(capacity);
+        }
+        if(!ptr) {
+          Thread::AutoMutex lock(_lock);
+          _stats.bytesInUse -= capacity;
+          throw std::bad_alloc();
+        }
+        return ptr;
+      }
+
+      void Pool::release(void *ptr, size_t capacity)
+      {
+        if(!ptr)
+          return;
+
+        size_t classCapacity;
+        int sc = sizeClass(capacity, classCapacity);
+        {
+          Thread::AutoMutex lock(_lock);
+          ++_stats.releases;
+          _stats.bytesInUse -= capacity;
+
+          // keep it for later, unless that would hold us over budget
+          if(!_budget || _stats.bytesInUse + _stats.bytesSpare + capacity <= _budget) {
+            _spare[sc].push_back(ptr);
+            _stats.bytesSpare += capacity;
+            return;
+          }
+        }
+        systemFree(ptr);
+      }
+
+      void Pool::trim()
+      {
+        Thread::AutoMutex lock(_lock);
+        trimLocked();
+      }
+
+      void Pool::trimLocked()
+      {
+        for(std::vector< std::vector<void *> >::iterator i = _spare.begin(); i != _spare.end(); ++i) {
+          for(std::vector<void *>::iterator j = i->begin(); j != i->end(); ++j)
+            systemFree(*j);
+          i->clear();
+        }
+        _stats.bytesSpare = 0;
+      }
+
+      void Pool::setBudget(size_t nBytes)
+      {
+        Thread::AutoMutex lock(_lock);
+        _budget = nBytes;
+        if(_budget && _stats.bytesInUse + _stats.bytesSpare > _budget)
+          trimLocked();
+      }
+
+      size_t Pool::getBudget() const
+      {
+        Thread::AutoMutex lock(_lock);
+        return _budget;
+      }
+
+      void Pool::setUseHugePages(bool v)
+      {
+        Thread::AutoMutex lock(_lock);
+        _useHugePages = v;
+      }
+
+      bool Pool::getUseHugePages() const
+      {
+        Thread::AutoMutex lock(_lock);
+        return _useHugePages;
+      }
+
+      void Pool::setPressureHandler(PressureHandler *handler)
+      {
+        Thread::AutoMutex lock(_lock);
+        _pressureHandler = handler;
+      }
+
+      Pool::Statistics Pool::getStatistics() const
+      {
+        Thread::AutoMutex lock(_lock);
+        return _stats;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      // pooled instance
+
+      PooledInstance::PooledInstance() : _capacity(0) {}
+
+      PooledInstance::~PooledInstance() {
+        Pool::global().release(_ptr, _capacity);
+        _ptr = 0;
+      }
+
+      bool PooledInstance::alloc(size_t nBytes) {
+        if(!_locked){
+          if(_ptr)
+            freeMem();
+          _ptr = (char *) Pool::global().allocate(nBytes, _capacity);
+          return true;
+        }
+        else
+          return false;
+      }
+
+      void PooledInstance::freeMem(){
+        Pool::global().release(_ptr, _capacity);
+        _ptr = 0;
+        _capacity = 0;
+        _locked = 0;
+      }
+
     } // Memory
 
   } // Host
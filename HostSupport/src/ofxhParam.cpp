@@ -30,6 +30,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // ofx
 #include "ofxCore.h"
 #include "ofxImageEffect.h"
+#include "ofxsParamBatchSuite.h"
 #ifdef OFX_SUPPORTS_PARAMETRIC
 #include "ofxParametricParam.h"
 #endif
@@ -39,6 +40,9 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ofxhPropertySuite.h"
 #include "ofxhParam.h"
 #include "ofxhImageEffect.h"
+#ifdef OFX_SUPPORTS_PARAMETRIC
+#include "ofxhParametricParam.h"
+#endif
 #include "ofxOld.h" // old plugins may rely on deprecated properties being present
 
 
@@ -46,6 +50,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <float.h>
 #include <limits.h>
 #include <stdarg.h>
+#include <new>
 
 namespace OFX {
 
@@ -553,7 +558,16 @@ namespace OFX {
         if(!isStandardType(paramType)) 
           return NULL; /// << EEK! This is bad.
 
+#ifdef OFX_SUPPORTS_PARAMETRIC
+        // parametric descriptors keep the default curves the plugin sets on them
+        Descriptor *desc;
+        if(std::string(paramType) == kOfxParamTypeParametric)
+          desc = new ParametricParam::ParametricDescriptor(paramType, name);
+        else
+          desc = new Descriptor(paramType, name);
+#else
         Descriptor *desc = new Descriptor(paramType, name); 
+#endif
         desc->addStandardParamProps(paramType);
         addParam(name, desc);
         return desc;
@@ -649,6 +663,12 @@ namespace OFX {
         return kOfxStatErrUnsupported;
       }
 
+      /// get the values at many times, implemented by the double valued params
+      OfxStatus Instance::getValuesAtTimes(const OfxTime * /*times*/, int /*nTimes*/, double * /*values*/)
+      {
+        return kOfxStatErrUnsupported;
+      }
+
       /// overridden from Property::NotifyHook
       void Instance::notify(const std::string &name, bool /*single*/, int /*num*/) OFX_EXCEPTION_SPEC
       {
@@ -689,24 +709,54 @@ namespace OFX {
       // KeyframeParam
       // 
 
-      OfxStatus KeyframeParam::getNumKeys(unsigned int &/*nKeys*/) const {
-        return kOfxStatErrMissingHostFeature; 
+      OfxStatus KeyframeParam::getNumKeys(unsigned int &nKeys) const {
+        if(!usesAnimation())
+          return kOfxStatErrMissingHostFeature;
+        nKeys = readAnimation().getNumKeys();
+        return kOfxStatOK;
       }
 
-      OfxStatus KeyframeParam::getKeyTime(int /*nth*/, OfxTime& /*time*/) const {
-        return kOfxStatErrMissingHostFeature; 
+      OfxStatus KeyframeParam::getKeyTime(int nth, OfxTime& time) const {
+        if(!usesAnimation())
+          return kOfxStatErrMissingHostFeature;
+        if(nth < 0 || nth >= readAnimation().getNumKeys())
+          return kOfxStatErrBadIndex;
+        time = readAnimation().getKeyTime(nth);
+        return kOfxStatOK;
       }
 
-      OfxStatus KeyframeParam::getKeyIndex(OfxTime /*time*/, int /*direction*/, int & /*index*/) const {
-        return kOfxStatErrMissingHostFeature; 
+      OfxStatus KeyframeParam::getKeyIndex(OfxTime time, int direction, int & index) const {
+        if(!usesAnimation())
+          return kOfxStatErrMissingHostFeature;
+        index = readAnimation().getKeyIndex(time, direction);
+        return index < 0 ? kOfxStatFailed : kOfxStatOK;
       }
 
-      OfxStatus KeyframeParam::deleteKey(OfxTime /*time*/) {
-        return kOfxStatErrMissingHostFeature; 
+      OfxStatus KeyframeParam::deleteKey(OfxTime time) {
+        if(!usesAnimation())
+          return kOfxStatErrMissingHostFeature;
+        return _animation.deleteKey(time) ? kOfxStatOK : kOfxStatErrBadIndex;
       }
 
       OfxStatus KeyframeParam::deleteAllKeys() { 
-        return kOfxStatErrMissingHostFeature; 
+        if(!usesAnimation())
+          return kOfxStatErrMissingHostFeature;
+        _animation.deleteAllKeys();
+        return kOfxStatOK;
+      }
+
+      OfxStatus KeyframeParam::deriveAnimation(OfxTime time, double *values) const {
+        if(!usesAnimation())
+          return kOfxStatErrMissingHostFeature;
+        readAnimation().getDerivative(time, values);
+        return kOfxStatOK;
+      }
+
+      OfxStatus KeyframeParam::integrateAnimation(OfxTime time1, OfxTime time2, double *values) const {
+        if(!usesAnimation())
+          return kOfxStatErrMissingHostFeature;
+        readAnimation().getIntegral(time1, time2, values);
+        return kOfxStatOK;
       }
 
       void GroupInstance::setChildren(std::vector<Param::Instance*> children)
@@ -902,6 +952,14 @@ namespace OFX {
       //
       // DoubleInstance
       //
+      OfxStatus DoubleInstance::derive(OfxTime time, double &value) {
+        return deriveAnimation(time, &value);
+      }
+
+      OfxStatus DoubleInstance::integrate(OfxTime time1, OfxTime time2, double &value) {
+        return integrateAnimation(time1, time2, &value);
+      }
+
       /// implementation of var args function
       OfxStatus DoubleInstance::getV(va_list arg)
       {
@@ -974,6 +1032,20 @@ namespace OFX {
         return stat;
       }
 
+      OfxStatus DoubleInstance::getValuesAtTimes(const OfxTime *times, int nTimes, double *values)
+      {
+        if(usesAnimation()) {
+          readAnimation().getValues(times, nTimes, values);
+          return kOfxStatOK;
+        }
+        for(int i = 0; i < nTimes; i++) {
+          OfxStatus stat = get(times[i], values[i]);
+          if(stat != kOfxStatOK)
+            return stat;
+        }
+        return kOfxStatOK;
+      }
+
       //
       // BooleanInstance
       //
@@ -1034,12 +1106,28 @@ namespace OFX {
       // RGBAInstance
       // 
 
-      OfxStatus RGBAInstance::derive(OfxTime /*time*/, double&, double&, double&, double&) {
-        return kOfxStatErrMissingHostFeature; 
+      OfxStatus RGBAInstance::derive(OfxTime time, double &r, double &g, double &b, double &a) {
+        double values[4];
+        OfxStatus stat = deriveAnimation(time, values);
+        if(stat == kOfxStatOK) {
+          r = values[0];
+          g = values[1];
+          b = values[2];
+          a = values[3];
+        }
+        return stat;
       }
 
-      OfxStatus RGBAInstance::integrate(OfxTime /*time1*/, OfxTime /*time2*/, double&,double&,double&,double&) {
-        return kOfxStatErrMissingHostFeature; 
+      OfxStatus RGBAInstance::integrate(OfxTime time1, OfxTime time2, double &r, double &g, double &b, double &a) {
+        double values[4];
+        OfxStatus stat = integrateAnimation(time1, time2, values);
+        if(stat == kOfxStatOK) {
+          r = values[0];
+          g = values[1];
+          b = values[2];
+          a = values[3];
+        }
+        return stat;
       }
 
       /// implementation of var args function
@@ -1132,15 +1220,44 @@ namespace OFX {
         return stat;
       }
 
+      OfxStatus RGBAInstance::getValuesAtTimes(const OfxTime *times, int nTimes, double *values)
+      {
+        if(usesAnimation()) {
+          readAnimation().getValues(times, nTimes, values);
+          return kOfxStatOK;
+        }
+        for(int i = 0; i < nTimes; i++) {
+          double *v = values + i * 4;
+          OfxStatus stat = get(times[i], v[0], v[1], v[2], v[3]);
+          if(stat != kOfxStatOK)
+            return stat;
+        }
+        return kOfxStatOK;
+      }
+
       //
       // RGBInstance
       //
-      OfxStatus RGBInstance::derive(OfxTime /*time*/, double&,double&,double&) {
-        return kOfxStatErrMissingHostFeature; 
+      OfxStatus RGBInstance::derive(OfxTime time, double &r, double &g, double &b) {
+        double values[3];
+        OfxStatus stat = deriveAnimation(time, values);
+        if(stat == kOfxStatOK) {
+          r = values[0];
+          g = values[1];
+          b = values[2];
+        }
+        return stat;
       }
 
-      OfxStatus RGBInstance::integrate(OfxTime /*time1*/, OfxTime /*time2*/, double&,double&,double&) {
-        return kOfxStatErrMissingHostFeature; 
+      OfxStatus RGBInstance::integrate(OfxTime time1, OfxTime time2, double &r, double &g, double &b) {
+        double values[3];
+        OfxStatus stat = integrateAnimation(time1, time2, values);
+        if(stat == kOfxStatOK) {
+          r = values[0];
+          g = values[1];
+          b = values[2];
+        }
+        return stat;
       }
 
       /// implementation of var args function
@@ -1227,16 +1344,43 @@ namespace OFX {
         return stat;
       }
 
+      OfxStatus RGBInstance::getValuesAtTimes(const OfxTime *times, int nTimes, double *values)
+      {
+        if(usesAnimation()) {
+          readAnimation().getValues(times, nTimes, values);
+          return kOfxStatOK;
+        }
+        for(int i = 0; i < nTimes; i++) {
+          double *v = values + i * 3;
+          OfxStatus stat = get(times[i], v[0], v[1], v[2]);
+          if(stat != kOfxStatOK)
+            return stat;
+        }
+        return kOfxStatOK;
+      }
+
       //
       // Double2DInstance
       //
 
-      OfxStatus Double2DInstance::derive(OfxTime /*time*/, double&,double&) {
-        return kOfxStatErrMissingHostFeature; 
+      OfxStatus Double2DInstance::derive(OfxTime time, double &x, double &y) {
+        double values[2];
+        OfxStatus stat = deriveAnimation(time, values);
+        if(stat == kOfxStatOK) {
+          x = values[0];
+          y = values[1];
+        }
+        return stat;
       }
 
-      OfxStatus Double2DInstance::integrate(OfxTime /*time1*/, OfxTime /*time2*/, double&,double&) {
-        return kOfxStatErrMissingHostFeature; 
+      OfxStatus Double2DInstance::integrate(OfxTime time1, OfxTime time2, double &x, double &y) {
+        double values[2];
+        OfxStatus stat = integrateAnimation(time1, time2, values);
+        if(stat == kOfxStatOK) {
+          x = values[0];
+          y = values[1];
+        }
+        return stat;
       }
 
       OfxStatus Double2DInstance::getV(va_list arg)
@@ -1316,6 +1460,21 @@ namespace OFX {
         return stat;
       }
 
+      OfxStatus Double2DInstance::getValuesAtTimes(const OfxTime *times, int nTimes, double *values)
+      {
+        if(usesAnimation()) {
+          readAnimation().getValues(times, nTimes, values);
+          return kOfxStatOK;
+        }
+        for(int i = 0; i < nTimes; i++) {
+          double *v = values + i * 2;
+          OfxStatus stat = get(times[i], v[0], v[1]);
+          if(stat != kOfxStatOK)
+            return stat;
+        }
+        return kOfxStatOK;
+      }
+
       //
       // Integer2DInstance
       //
@@ -1409,12 +1568,26 @@ namespace OFX {
       // Double3DInstance
       //
 
-      OfxStatus Double3DInstance::derive(OfxTime /*time*/, double&,double&,double&) {
-        return kOfxStatErrMissingHostFeature; 
+      OfxStatus Double3DInstance::derive(OfxTime time, double &x, double &y, double &z) {
+        double values[3];
+        OfxStatus stat = deriveAnimation(time, values);
+        if(stat == kOfxStatOK) {
+          x = values[0];
+          y = values[1];
+          z = values[2];
+        }
+        return stat;
       }
 
-      OfxStatus Double3DInstance::integrate(OfxTime /*time1*/, OfxTime /*time2*/, double&,double&,double&) {
-        return kOfxStatErrMissingHostFeature; 
+      OfxStatus Double3DInstance::integrate(OfxTime time1, OfxTime time2, double &x, double &y, double &z) {
+        double values[3];
+        OfxStatus stat = integrateAnimation(time1, time2, values);
+        if(stat == kOfxStatOK) {
+          x = values[0];
+          y = values[1];
+          z = values[2];
+        }
+        return stat;
       }
 
       OfxStatus Double3DInstance::getV(va_list arg)
@@ -1500,6 +1673,21 @@ namespace OFX {
         return stat;
       }
 
+      OfxStatus Double3DInstance::getValuesAtTimes(const OfxTime *times, int nTimes, double *values)
+      {
+        if(usesAnimation()) {
+          readAnimation().getValues(times, nTimes, values);
+          return kOfxStatOK;
+        }
+        for(int i = 0; i < nTimes; i++) {
+          double *v = values + i * 3;
+          OfxStatus stat = get(times[i], v[0], v[1], v[2]);
+          if(stat != kOfxStatOK)
+            return stat;
+        }
+        return kOfxStatOK;
+      }
+
       //
       // Integer3DInstance
       //
@@ -1651,11 +1839,16 @@ namespace OFX {
 
       /// ctor
       SetInstance::SetInstance()
+        : _snapshot(0)
       {}
 
       /// dtor. 
       SetInstance::~SetInstance()
       {
+        // renders still running hold their own references
+        if(_snapshot)
+          _snapshot->release();
+
         // iterate the params and delete them
         std::list<Instance *>::iterator i;
         for(i = _paramList.begin(); i != _paramList.end(); ++i) {
@@ -1683,9 +1876,61 @@ namespace OFX {
         else
           return kOfxStatErrExists;
 
+        publishParam(instance);
         return kOfxStatOK;
       }
 
+      void SetInstance::publishParam(Instance *param)
+      {
+        KeyframeParam *keyframes = dynamic_cast<KeyframeParam*>(param);
+        if(!keyframes || !keyframes->usesAnimation())
+          return;
+
+        // copy the animation before taking the lock, pinning renders only ever wait for pointer copies
+        publishAnimation(keyframes, keyframes->_snapshotSlot, new Snapshot::SharedAnimation(keyframes->_animation));
+      }
+
+      void SetInstance::publishAnimation(const void *owner, int &slot, Snapshot::SharedAnimation *animation)
+      {
+        Thread::AutoMutex lock(_snapshotLock);
+        Snapshot *next = _snapshot ? new Snapshot(*_snapshot) : new Snapshot(this);
+        if(slot < 0)
+          slot = int(next->_entries.size());
+        next->setEntry(owner, slot, animation);
+
+        Snapshot *previous = _snapshot;
+        _snapshot = next;
+        if(previous)
+          previous->release();
+      }
+
+      const Snapshot *SetInstance::pinSnapshot()
+      {
+        Thread::AutoMutex lock(_snapshotLock);
+        if(_snapshot)
+          _snapshot->addRef();
+        return _snapshot;
+      }
+
+      SetInstance::RenderPin::RenderPin(SetInstance &set)
+        : _snapshot(0)
+        , _previous(Thread::WorkerPool::renderContext())
+      {
+        // an action run inside a render of the same set keeps the version the render pinned
+        const Snapshot *pinned = Snapshot::pinned();
+        if(pinned && pinned->getSet() == &set)
+          return;
+        _snapshot = set.pinSnapshot();
+        Thread::WorkerPool::setRenderContext(const_cast<Snapshot *>(_snapshot));
+      }
+
+      SetInstance::RenderPin::~RenderPin()
+      {
+        Thread::WorkerPool::setRenderContext(_previous);
+        if(_snapshot)
+          _snapshot->release();
+      }
+
       ////////////////////////////////////////////////////////////////////////////////
       // Suite functions below
 
@@ -2032,6 +2277,7 @@ namespace OFX {
         va_end(ap);
 
         if (stat == kOfxStatOK) {
+          paramInstance->getParamSetInstance()->publishParam(paramInstance);
           paramInstance->getParamSetInstance()->paramChangedByPlugin(paramInstance);
         }
 
@@ -2070,6 +2316,7 @@ namespace OFX {
         va_end(ap);
 
         if (stat == kOfxStatOK) {
+          paramInstance->getParamSetInstance()->publishParam(paramInstance);
           paramInstance->getParamSetInstance()->paramChangedByPlugin(paramInstance);
         }
 
@@ -2195,6 +2442,10 @@ namespace OFX {
           return kOfxStatErrBadHandle;
         }
         OfxStatus stat = paramInstance->deleteKey(time);
+        if (stat == kOfxStatOK) {
+          pInstance->getParamSetInstance()->publishParam(pInstance);
+          pInstance->getParamSetInstance()->paramChangedByPlugin(pInstance);
+        }
 #       ifdef OFX_DEBUG_PARAMETERS
         std::cout << ' ' << StatStr(stat) << std::endl;
 #       endif
@@ -2223,6 +2474,10 @@ namespace OFX {
           return kOfxStatErrBadHandle;
         }
         OfxStatus stat = paramInstance->deleteAllKeys();
+        if (stat == kOfxStatOK) {
+          pInstance->getParamSetInstance()->publishParam(pInstance);
+          pInstance->getParamSetInstance()->paramChangedByPlugin(pInstance);
+        }
 #       ifdef OFX_DEBUG_PARAMETERS
         std::cout << ' ' << StatStr(stat) << std::endl;
 #       endif
@@ -2248,6 +2503,8 @@ namespace OFX {
         }
 
         OfxStatus stat = paramInstanceTo->copyFrom(*paramInstanceFrom,dstOffset,frameRange);
+        if(stat == kOfxStatOK && paramInstanceTo->getParamSetInstance())
+          paramInstanceTo->getParamSetInstance()->publishParam(paramInstanceTo);
 #       ifdef OFX_DEBUG_PARAMETERS
         std::cout << ' ' << StatStr(stat) << std::endl;
 #       endif
@@ -2320,6 +2577,49 @@ namespace OFX {
         return NULL;
       }
 
+      static OfxStatus paramGetValuesAtTimes(OfxParamHandle paramHandle,
+                                             const OfxTime *times,
+                                             int nTimes,
+                                             double *values)
+      {
+#       ifdef OFX_DEBUG_PARAMETERS
+        std::cout << "OFX: paramGetValuesAtTimes - " << paramHandle << ' ' << nTimes << " ...";
+#       endif
+        Instance *paramInstance = reinterpret_cast<Instance*>(paramHandle);
+        if(!paramInstance || !paramInstance->verifyMagic()) {
+#         ifdef OFX_DEBUG_PARAMETERS
+          std::cout << ' ' << StatStr(kOfxStatErrBadHandle) << std::endl;
+#         endif
+          return kOfxStatErrBadHandle;
+        }
+
+        OfxStatus stat;
+        try {
+          stat = paramInstance->getValuesAtTimes(times, nTimes, values);
+        }
+        catch(std::bad_alloc &) {
+          stat = kOfxStatErrMemory;
+        }
+        catch(...) {
+          stat = kOfxStatFailed;
+        }
+
+#       ifdef OFX_DEBUG_PARAMETERS
+        std::cout << ' ' << StatStr(stat) << std::endl;
+#       endif
+        return stat;
+      }
+
+      static const NetSfOfxParameterBatchSuiteV1 gParamBatchSuiteV1 = {
+        paramGetValuesAtTimes
+      };
+
+      const void *GetBatchSuite(int version) {
+        if(version == 1)
+          return &gParamBatchSuiteV1;
+        return NULL;
+      }
+
     } // Param
 
   } // Host
@@ -0,0 +1,79 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// ofx host
+#include "ofxhParamSnapshot.h"
+
+namespace OFX {
+
+  namespace Host {
+
+    namespace Param {
+
+      Snapshot::Snapshot(const Snapshot &other)
+        : _set(other._set)
+        , _entries(other._entries)
+        , _refs(1)
+      {
+        for(size_t i = 0; i < _entries.size(); ++i)
+          _entries[i].animation->addRef();
+      }
+
+      Snapshot::~Snapshot()
+      {
+        for(size_t i = 0; i < _entries.size(); ++i)
+          _entries[i].animation->release();
+      }
+
+      void Snapshot::release() const
+      {
+        if(_refs.decrement() == 0)
+          delete this;
+      }
+
+      void Snapshot::setEntry(const void *owner, int slot, SharedAnimation *animation)
+      {
+        if(slot == int(_entries.size())) {
+          Entry entry = {owner, animation};
+          _entries.push_back(entry);
+        }
+        else {
+          Entry &entry = _entries[slot];
+          entry.animation->release();
+          entry.owner = owner;
+          entry.animation = animation;
+        }
+      }
+
+    }
+
+  }
+
+}
@@ -0,0 +1,446 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <algorithm>
+
+// ofx
+#include "ofxCore.h"
+#include "ofxParametricParam.h"
+
+// ofx host
+#include "ofxhParametricParam.h"
+
+namespace OFX {
+
+  namespace Host {
+
+    namespace ParametricParam {
+
+      ////////////////////////////////////////////////////////////////////////////////
+      // Curves
+
+      Curves::~Curves() {}
+
+      Param::Animation &Curves::editCurve(int curveIndex)
+      {
+        if(curveIndex >= int(_curves.size())) {
+          Param::Animation curve(1);
+          curve.setDefaultInterpolation(Param::eInterpolationCatmullRom);
+          _curves.resize(curveIndex + 1, curve);
+        }
+        return _curves[curveIndex];
+      }
+
+      const Param::Animation *Curves::findCurve(int curveIndex) const
+      {
+        return curveIndex < int(_curves.size()) ? &_curves[curveIndex] : 0;
+      }
+
+      void Curves::curveChanged(int /*curveIndex*/) {}
+
+      const Param::Animation *Curves::readCurve(int curveIndex) const
+      {
+        return findCurve(curveIndex);
+      }
+
+      OfxStatus Curves::getValue(int curveIndex, OfxTime /*time*/, double parametricPosition, double &value) const
+      {
+        const Param::Animation *curve = readCurve(curveIndex);
+        value = curve ? curve->getValue(parametricPosition, 0) : 0.0;
+        return kOfxStatOK;
+      }
+
+      OfxStatus Curves::getNControlPoints(int curveIndex, OfxTime /*time*/, int &nControlPoints) const
+      {
+        const Param::Animation *curve = readCurve(curveIndex);
+        nControlPoints = curve ? curve->getNumKeys() : 0;
+        return kOfxStatOK;
+      }
+
+      OfxStatus Curves::getNthControlPoint(int curveIndex, OfxTime /*time*/, int nthCtl, double &key, double &value) const
+      {
+        const Param::Animation *curve = readCurve(curveIndex);
+        if(!curve || nthCtl < 0 || nthCtl >= curve->getNumKeys())
+          return kOfxStatErrBadIndex;
+        key = curve->getKeyTime(nthCtl);
+        value = curve->getKeyValue(nthCtl, 0);
+        return kOfxStatOK;
+      }
+
+      OfxStatus Curves::setNthControlPoint(int curveIndex, OfxTime /*time*/, int nthCtl, double key, double value, bool /*addAnimationKey*/)
+      {
+        const Param::Animation *found = findCurve(curveIndex);
+        if(!found || nthCtl < 0 || nthCtl >= found->getNumKeys())
+          return kOfxStatErrBadIndex;
+
+        // a point moved onto another replaces it
+        Param::Animation &curve = editCurve(curveIndex);
+        if(curve.getKeyTime(nthCtl) != key)
+          curve.deleteKey(curve.getKeyTime(nthCtl));
+        curve.setKey(key, &value);
+        curveChanged(curveIndex);
+        return kOfxStatOK;
+      }
+
+      OfxStatus Curves::addControlPoint(int curveIndex, OfxTime /*time*/, double key, double value, bool /*addAnimationKey*/)
+      {
+        Param::Animation &curve = editCurve(curveIndex);
+
+        int nKeys = curve.getNumKeys();
+        if(nKeys > 0) {
+          double tolerance = (curve.getKeyTime(nKeys - 1) - curve.getKeyTime(0)) * 1e-6;
+          int before = curve.getKeyIndex(key, -1), after = curve.getKeyIndex(key, 1), at = curve.getKeyIndex(key, 0);
+          if(at < 0 && before >= 0 && key - curve.getKeyTime(before) <= tolerance)
+            at = before;
+          if(at < 0 && after >= 0 && curve.getKeyTime(after) - key <= tolerance)
+            at = after;
+          if(at >= 0)
+            key = curve.getKeyTime(at);
+        }
+
+        curve.setKey(key, &value);
+        curveChanged(curveIndex);
+        return kOfxStatOK;
+      }
+
+      OfxStatus Curves::deleteControlPoint(int curveIndex, int nthCtl)
+      {
+        const Param::Animation *found = findCurve(curveIndex);
+        if(!found || nthCtl < 0 || nthCtl >= found->getNumKeys())
+          return kOfxStatErrBadIndex;
+
+        Param::Animation &curve = editCurve(curveIndex);
+        curve.deleteKey(curve.getKeyTime(nthCtl));
+        curveChanged(curveIndex);
+        return kOfxStatOK;
+      }
+
+      OfxStatus Curves::deleteAllControlPoints(int curveIndex)
+      {
+        editCurve(curveIndex).deleteAllKeys();
+        curveChanged(curveIndex);
+        return kOfxStatOK;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      // ParametricDescriptor
+
+      ParametricDescriptor::ParametricDescriptor(const std::string &type, const std::string &name)
+        : Param::Descriptor(type, name)
+      {
+      }
+
+      int ParametricDescriptor::getNumCurves() const
+      {
+        return _properties.getIntProperty(kOfxParamPropParametricDimension);
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      // ParametricInstance
+
+      ParametricInstance::ParametricInstance(Param::Descriptor &descriptor, Param::SetInstance *instance)
+        : Param::Instance(descriptor, instance)
+        , _lutSize(0)
+        , _lutMin(0)
+        , _lutMax(1)
+      {
+        const ParametricDescriptor *defaults = dynamic_cast<ParametricDescriptor *>(&descriptor);
+        int nCurves = _properties.getIntProperty(kOfxParamPropParametricDimension);
+        double min = _properties.getDoubleProperty(kOfxParamPropParametricRange, 0);
+        double max = _properties.getDoubleProperty(kOfxParamPropParametricRange, 1);
+
+        for(int i = 0; i < nCurves; ++i) {
+          const Param::Animation *curve = defaults ? defaults->findCurve(i) : 0;
+          if(curve && curve->getNumKeys() > 0) {
+            editCurve(i) = *curve;
+          }
+          else {
+            Param::Animation &identity = editCurve(i);
+            identity.setKey(min, &min);
+            identity.setKey(max, &max);
+          }
+          publishCurve(i);
+        }
+      }
+
+      ParametricInstance::~ParametricInstance()
+      {
+        for(size_t i = 0; i < _published.size(); ++i) {
+          if(_published[i])
+            _published[i]->release();
+        }
+      }
+
+      int ParametricInstance::getNumCurves() const
+      {
+        return int(_curves.size());
+      }
+
+      void ParametricInstance::useLookupTables(int nSamples)
+      {
+        _lutMin = _properties.getDoubleProperty(kOfxParamPropParametricRange, 0);
+        _lutMax = _properties.getDoubleProperty(kOfxParamPropParametricRange, 1);
+
+        // an empty range has no samples to spread over, so its curves are evaluated instead
+        _lutSize = nSamples >= 2 && _lutMax > _lutMin ? nSamples : 0;
+        for(int i = 0; i < int(_curves.size()); ++i)
+          publishCurve(i);
+      }
+
+      void ParametricInstance::curveChanged(int curveIndex)
+      {
+        publishCurve(curveIndex);
+      }
+
+      void ParametricInstance::publishCurve(int curveIndex)
+      {
+        Param::Snapshot::SharedAnimation *curve = new Param::Snapshot::SharedAnimation(_curves[curveIndex]);
+
+        if(_lutSize) {
+          curve->tableMin = _lutMin;
+          curve->tableMax = _lutMax;
+          curve->tableScale = (_lutSize - 1) / (_lutMax - _lutMin);
+
+          // sampled in order in one batch, so a segment at a time rather than a search per sample
+          std::vector<double> positions(_lutSize);
+          for(int i = 0; i < _lutSize; ++i)
+            positions[i] = _lutMin + i / curve->tableScale;
+          positions[_lutSize - 1] = _lutMax;
+
+          std::vector<double> samples(_lutSize);
+          curve->animation.getValues(&positions[0], _lutSize, &samples[0]);
+
+          // A blend of two samples is off a curve bending by f'' by up to h*h*f''/8 between them,
+          // always to the same side. Moving each sample by a sixteenth of its second difference,
+          // h*h*f''/16, splits that either side of the curve, halving the largest error, and
+          // leaves straight stretches be. The ends take their neighbour's.
+          curve->table = samples;
+          for(int i = 0; i < _lutSize && _lutSize > 2; ++i) {
+            int j = std::max(1, std::min(i, _lutSize - 2));
+            curve->table[i] -= (samples[j - 1] - 2 * samples[j] + samples[j + 1]) / 16;
+          }
+        }
+
+        if(curveIndex >= int(_published.size())) {
+          _published.resize(curveIndex + 1, 0);
+          _snapshotSlots.resize(curveIndex + 1, -1);
+        }
+        if(_published[curveIndex])
+          _published[curveIndex]->release();
+        _published[curveIndex] = curve;
+
+        if(Param::SetInstance *set = getParamSetInstance()) {
+          curve->addRef();
+          set->publishAnimation(this, _snapshotSlots[curveIndex], curve);
+        }
+      }
+
+      const Param::Snapshot::SharedAnimation *ParametricInstance::readPublished(int curveIndex) const
+      {
+        if(curveIndex >= int(_published.size()))
+          return 0;
+        const Param::Snapshot *snapshot = Param::Snapshot::pinned();
+        const Param::Snapshot::SharedAnimation *curve = snapshot ? snapshot->findShared(this, _snapshotSlots[curveIndex]) : 0;
+        return curve ? curve : _published[curveIndex];
+      }
+
+      const Param::Animation *ParametricInstance::readCurve(int curveIndex) const
+      {
+        const Param::Snapshot::SharedAnimation *curve = readPublished(curveIndex);
+        return curve ? &curve->animation : 0;
+      }
+
+      OfxStatus ParametricInstance::getValue(int curveIndex, OfxTime /*time*/, double parametricPosition, double &value) const
+      {
+        const Param::Snapshot::SharedAnimation *curve = readPublished(curveIndex);
+        if(!curve) {
+          value = 0.0;
+        }
+        else if(!curve->table.empty() && parametricPosition >= curve->tableMin && parametricPosition <= curve->tableMax) {
+          const std::vector<double> &table = curve->table;
+          double x = (parametricPosition - curve->tableMin) * curve->tableScale;
+          int i = std::min(int(x), int(table.size()) - 2);
+          value = table[i] + (table[i + 1] - table[i]) * (x - i);
+        }
+        else {
+          value = curve->animation.getValue(parametricPosition, 0);
+        }
+        return kOfxStatOK;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      // Suite functions below
+
+      /// the curves of a param handle, which may be a descriptor's while the plugin sets defaults
+      static OfxStatus findCurves(OfxParamHandle param, int curveIndex, Curves *&curves)
+      {
+        Param::Base *base = reinterpret_cast<Param::Base*>(param);
+        if(!base || !base->verifyMagic())
+          return kOfxStatErrBadHandle;
+
+        // down casts along the single inheritance chains, a cross cast to Curves costs several times more
+        if(ParametricInstance *instance = dynamic_cast<ParametricInstance*>(base))
+          curves = instance;
+        else if(ParametricDescriptor *descriptor = dynamic_cast<ParametricDescriptor*>(base))
+          curves = descriptor;
+        else
+          return kOfxStatErrBadHandle;
+
+        if(curveIndex < 0 || curveIndex >= curves->getNumCurves())
+          return kOfxStatErrBadIndex;
+        return kOfxStatOK;
+      }
+
+      /// tell the instance's set a plugin changed its curves, descriptors have no set
+      static void curvesChanged(OfxParamHandle param)
+      {
+        Param::Instance *instance = dynamic_cast<Param::Instance*>(reinterpret_cast<Param::Base*>(param));
+        if(instance && instance->getParamSetInstance())
+          instance->getParamSetInstance()->paramChangedByPlugin(instance);
+      }
+
+      static OfxStatus parametricParamGetValue(OfxParamHandle param,
+                                               int curveIndex,
+                                               OfxTime time,
+                                               double parametricPosition,
+                                               double *returnValue)
+      {
+        Curves *curves;
+        OfxStatus stat = findCurves(param, curveIndex, curves);
+        if(stat == kOfxStatOK)
+          stat = curves->getValue(curveIndex, time, parametricPosition, *returnValue);
+        return stat;
+      }
+
+      static OfxStatus parametricParamGetNControlPoints(OfxParamHandle param,
+                                                        int curveIndex,
+                                                        double time,
+                                                        int *returnValue)
+      {
+        Curves *curves;
+        OfxStatus stat = findCurves(param, curveIndex, curves);
+        if(stat == kOfxStatOK)
+          stat = curves->getNControlPoints(curveIndex, time, *returnValue);
+        return stat;
+      }
+
+      static OfxStatus parametricParamGetNthControlPoint(OfxParamHandle param,
+                                                         int curveIndex,
+                                                         double time,
+                                                         int nthCtl,
+                                                         double *key,
+                                                         double *value)
+      {
+        Curves *curves;
+        OfxStatus stat = findCurves(param, curveIndex, curves);
+        if(stat == kOfxStatOK)
+          stat = curves->getNthControlPoint(curveIndex, time, nthCtl, *key, *value);
+        return stat;
+      }
+
+      static OfxStatus parametricParamSetNthControlPoint(OfxParamHandle param,
+                                                         int curveIndex,
+                                                         double time,
+                                                         int nthCtl,
+                                                         double key,
+                                                         double value,
+                                                         bool addAnimationKey)
+      {
+        Curves *curves;
+        OfxStatus stat = findCurves(param, curveIndex, curves);
+        if(stat == kOfxStatOK)
+          stat = curves->setNthControlPoint(curveIndex, time, nthCtl, key, value, addAnimationKey);
+        if(stat == kOfxStatOK)
+          curvesChanged(param);
+        return stat;
+      }
+
+      static OfxStatus parametricParamAddControlPoint(OfxParamHandle param,
+                                                      int curveIndex,
+                                                      double time,
+                                                      double key,
+                                                      double value,
+                                                      bool addAnimationKey)
+      {
+        Curves *curves;
+        OfxStatus stat = findCurves(param, curveIndex, curves);
+        if(stat == kOfxStatOK)
+          stat = curves->addControlPoint(curveIndex, time, key, value, addAnimationKey);
+        if(stat == kOfxStatOK)
+          curvesChanged(param);
+        return stat;
+      }
+
+      static OfxStatus parametricParamDeleteControlPoint(OfxParamHandle param,
+                                                         int curveIndex,
+                                                         int nthCtl)
+      {
+        Curves *curves;
+        OfxStatus stat = findCurves(param, curveIndex, curves);
+        if(stat == kOfxStatOK)
+          stat = curves->deleteControlPoint(curveIndex, nthCtl);
+        if(stat == kOfxStatOK)
+          curvesChanged(param);
+        return stat;
+      }
+
+      static OfxStatus parametricParamDeleteAllControlPoints(OfxParamHandle param,
+                                                             int curveIndex)
+      {
+        Curves *curves;
+        OfxStatus stat = findCurves(param, curveIndex, curves);
+        if(stat == kOfxStatOK)
+          stat = curves->deleteAllControlPoints(curveIndex);
+        if(stat == kOfxStatOK)
+          curvesChanged(param);
+        return stat;
+      }
+
+      static const OfxParametricParameterSuiteV1 gParametricParamSuiteV1 = {
+        parametricParamGetValue,
+        parametricParamGetNControlPoints,
+        parametricParamGetNthControlPoint,
+        parametricParamSetNthControlPoint,
+        parametricParamAddControlPoint,
+        parametricParamDeleteControlPoint,
+        parametricParamDeleteAllControlPoints
+      };
+
+      const void *GetSuite(int version) {
+        if(version == 1)
+          return &gParametricParamSuiteV1;
+        return NULL;
+      }
+
+    } // ParametricParam
+
+  } // Host
+
+} // OFX
@@ -29,6 +29,7 @@
 
 #include <assert.h>
 
+#include <algorithm>
 #include <map>
 #include <string>
 #include <iostream>
@@ -50,9 +51,25 @@
 #include "ofxhMemory.h"
 #include "ofxhPluginAPICache.h"
 #include "ofxhPluginCache.h"
+#include "ofxhPluginCacheFile.h"
 #include "ofxhHost.h"
+#include "ofxhThread.h"
 #include "ofxhXml.h"
 
+#if defined(UNIX)
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
+
 #if defined (__linux__) || defined (__FreeBSD__)
 
 #define DIRLIST_SEP_CHARS ":;"
@@ -113,12 +130,14 @@ using namespace OFX::Host;
 
 /// try to open the plugin bundle object and query it for plugins
 void PluginBinary::loadPluginInfo(PluginCache *cache) {      
+  // a missing binary has a time and size of 0, so a rescan can tell when it turns up
+  _fileModificationTime = _binary.getTime();
+  _fileSize = _binary.getSize();
   if (isInvalid()) {
     return;
   }
-  _fileModificationTime = _binary.getTime();
-  _fileSize = _binary.getSize();
   _binaryChanged = false;
+  _blacklisted = false;
   
   // Take a reference to load the binary only once per session. It will
   // eventually be unloaded in the destructor (see below).
@@ -164,6 +183,15 @@ PluginBinary::~PluginBinary() {
   assert(!_binary.isLoaded());
 }
 
+void Plugin::loadPendingCacheData() const
+{
+  // _pendingCache may be being cleared by a thread decoding us, so it is only looked at
+  // under the cache's lock
+  if (_sourceCache) {
+    _sourceCache->loadPendingCacheData(const_cast<Plugin *>(this));
+  }
+}
+
 PluginHandle::PluginHandle(Plugin *p, OFX::Host::Host *host)
 {
   _b = p->getBinary();
@@ -236,14 +264,27 @@ PluginCache::~PluginCache()
     delete (*it);
   }
   _binaries.clear();
+  for(std::list<PluginBinary *>::iterator it=_retiredBinaries.begin(); it != _retiredBinaries.end(); ++it) {
+    delete (*it);
+  }
+  _retiredBinaries.clear();
+  stopWatching();
+  for(std::list<CacheFile::Reader *>::iterator it=_cacheFiles.begin(); it != _cacheFiles.end(); ++it) {
+    delete (*it);
+  }
+  delete _xmlEvents;
 }
 
-PluginCache::PluginCache() : _hostSpec(0), _xmlCurrentBinary(0), _xmlCurrentPlugin(0) {
+PluginCache::PluginCache() : _hostSpec(0), _xmlCurrentBinary(0), _xmlCurrentPlugin(0), _xmlEvents(0) {
   
   _cacheVersion = "";
   _ignoreCache = false;
   _dirty = false;
   _enablePluginSeek = true;
+  _parallelScan = false;
+  _describeTimeout = 30;
+  _watchPluginFiles = false;
+  _watcher = 0;
   
   std::string s = OFXGetEnv("OFX_PLUGIN_PATH");
   
@@ -411,6 +452,594 @@ void PluginCache::scanDirectory(std::set<std::string> &foundBinFiles, const std:
 #endif
 }
 
+/// a directory visited by a parallel scan
+struct ParallelScanDir {
+  std::string path;
+  bool recurse;
+  bool opened;
+
+  /// what was in it, in the order the OS listed it. bundles have a name and no directory,
+  /// subdirectories we may need to look in have a directory.
+  std::vector<std::pair<std::string, ParallelScanDir *> > entries;
+
+  ParallelScanDir(const std::string &p, bool r) : path(p), recurse(r), opened(false) {}
+
+  ~ParallelScanDir() {
+    for (size_t i = 0; i < entries.size(); i++) {
+      delete entries[i].second;
+    }
+  }
+};
+
+/// the directory walk of a parallel scan
+struct ParallelScanWalk {
+  Thread::Mutex lock;
+  Thread::Condition wake;               ///< signalled when a directory is queued or the walk is over
+  std::list<ParallelScanDir *> queue;   ///< directories to list
+  unsigned int busy;                    ///< directories being listed
+};
+
+/// list a directory for a parallel scan, without the lock held
+static void parallelScanList(ParallelScanDir &d)
+{
+#if defined (WINDOWS)
+  WIN32_FIND_DATA findData;
+  HANDLE findHandle = FindFirstFile((d.path + "\\*").c_str(), &findData);
+  if (findHandle == INVALID_HANDLE_VALUE) {
+    return;
+  }
+  d.opened = true;
+  do {
+    std::string name = findData.cFileName;
+    bool isdir = (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+#else
+  DIR *dir = opendir(d.path.c_str());
+  if (!dir) {
+    return;
+  }
+  d.opened = true;
+  while (dirent *de = readdir(dir)) {
+    std::string name = de->d_name;
+    // anything that may be a directory, opening it will tell
+    bool isdir = de->d_type != DT_REG;
+#endif
+    if (name.find(".ofx.bundle") != std::string::npos) {
+      d.entries.push_back(std::make_pair(name, (ParallelScanDir *) 0));
+    } 
+    else if (isdir && (d.recurse && name[0] != '@' && name != "." && name != "..")) {
+      d.entries.push_back(std::make_pair(name, new ParallelScanDir(d.path + DIRSEP + name, true)));
+    }
+#if defined (WINDOWS)
+  } while (FindNextFile(findHandle, &findData));
+  FindClose(findHandle);
+#else
+  }
+  closedir(dir);
+#endif
+}
+
+/// thread function for the directory walk of a parallel scan
+static void parallelScanWalkThread(unsigned int /*threadIndex*/, unsigned int /*threadMax*/, void *arg)
+{
+  ParallelScanWalk &walk = *static_cast<ParallelScanWalk *>(arg);
+
+  walk.lock.lock();
+  for (;;) {
+    // wait for a directory, or for the others to finish theirs without finding more
+    while (walk.queue.empty() && walk.busy > 0) {
+      walk.wake.wait(walk.lock);
+    }
+    if (walk.queue.empty()) {
+      break;
+    }
+
+    ParallelScanDir *d = walk.queue.front();
+    walk.queue.pop_front();
+    walk.busy++;
+    walk.lock.unlock();
+
+    parallelScanList(*d);
+
+    walk.lock.lock();
+    for (size_t i = 0; i < d->entries.size(); i++) {
+      if (d->entries[i].second) {
+        walk.queue.push_back(d->entries[i].second);
+      }
+    }
+    walk.busy--;
+    walk.wake.broadcast();
+  }
+  walk.lock.unlock();
+}
+
+/// gather the directories and bundles a walk found, in the order a serial scan would have
+static void parallelScanCollect(const ParallelScanDir &d,
+                                std::list<std::string> &dirs,
+                                std::vector<std::pair<std::string, std::string> > &bundles)
+{
+  if (!d.opened) {
+    return;
+  }
+  dirs.push_back(d.path);
+  for (size_t i = 0; i < d.entries.size(); i++) {
+    if (d.entries[i].second) {
+      parallelScanCollect(*d.entries[i].second, dirs, bundles);
+    }
+    else {
+      bundles.push_back(std::make_pair(d.path, d.entries[i].first));
+    }
+  }
+}
+
+/// a binary to load or reload in a parallel scan
+struct ParallelScanBinary {
+  PluginBinary *binary;          ///< set if reloading, else set once loaded
+  std::string binpath;
+  std::string binpathUniversal;  ///< what to fall back to on OSX
+  std::string bundlename;
+
+  /// how a describe helper got on with it
+  enum HelperResultEnum {
+    eHelperDescribed,            ///< it exited cleanly, with output
+    eHelperFailed,               ///< it crashed, hung or exited uncleanly, blacklist the binary
+    eHelperUnusable              ///< it could not be run, describe the binary in process instead
+  };
+  HelperResultEnum helperResult;
+  std::string helperOutput;      ///< what it wrote to stdout
+};
+
+/// the loading of binaries in a parallel scan
+struct ParallelScanLoad {
+  PluginCache *cache;
+  std::vector<ParallelScanBinary> binaries;
+  Thread::Mutex lock;   ///< guards next
+  size_t next;          ///< the next binary to hand out
+};
+
+/// thread function for the loading of binaries in a parallel scan, each binary
+/// is loaded and all its plugins described on one thread
+static void parallelScanLoadThread(unsigned int /*threadIndex*/, unsigned int /*threadMax*/, void *arg)
+{
+  ParallelScanLoad &load = *static_cast<ParallelScanLoad *>(arg);
+
+  for (;;) {
+    size_t n;
+    {
+      Thread::AutoMutex lock(load.lock);
+      if (load.next >= load.binaries.size()) {
+        return;
+      }
+      n = load.next++;
+    }
+
+    ParallelScanBinary &b = load.binaries[n];
+    if (b.binary) {
+      b.binary->loadPluginInfo(load.cache);
+    } 
+    else {
+      b.binary = new PluginBinary(b.binpath, b.bundlename, load.cache);
+#if defined(__APPLE__) && (defined(__x86_64) || defined(__x86_64__))
+      if (b.binary->isInvalid()) {
+        // fallback to "MacOS"
+        delete b.binary;
+        b.binary = new PluginBinary(b.binpathUniversal, b.bundlename, load.cache);
+      }
+#endif
+    }
+
+    for (int j=0;j<b.binary->getNPlugins();j++) {
+      Plugin *plug = &b.binary->getPlugin(j);
+      const APICache::PluginAPICacheI &api = plug->getApiHandler();
+      api.loadFromPlugin(plug);
+    }
+  }
+}
+
+#if defined(UNIX)
+/// seconds since some point in the past
+static double parallelScanNow()
+{
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+/// a describe helper process
+struct ParallelScanHelper {
+  size_t binary;     ///< which binary of the scan it is describing
+  pid_t pid;
+  int fd;            ///< the read end of its stdout, -1 once closed
+  double deadline;   ///< when we kill it
+};
+
+/// Start a describe helper on a binary of a parallel scan. Only async signal safe calls are
+/// made in the child, as other threads may hold locks when we fork.
+static bool parallelScanStartHelper(ParallelScanHelper &h, const std::string &helper,
+                                    const ParallelScanBinary &b, const std::string &cacheVersion)
+{
+  int fds[2];
+  if (pipe(fds) != 0) {
+    return false;
+  }
+
+  const char *argv[] = { helper.c_str(), b.binpath.c_str(), b.bundlename.c_str(), cacheVersion.c_str(), 0 };
+
+  pid_t pid = fork();
+  if (pid < 0) {
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+  if (pid == 0) {
+    dup2(fds[1], 1);
+    close(fds[0]);
+    close(fds[1]);
+    execv(argv[0], (char * const *) argv);
+    _exit(127);
+  }
+
+  close(fds[1]);
+  fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+  h.pid = pid;
+  h.fd = fds[0];
+  return true;
+}
+
+/// Run the describe helper on each binary of a parallel scan, nProcesses at a time, killing
+/// any that take longer than timeout seconds.
+static void parallelScanRunHelpers(ParallelScanLoad &load, const std::string &helper,
+                                   const std::string &cacheVersion, double timeout,
+                                   unsigned int nProcesses)
+{
+  std::list<ParallelScanHelper> running;
+  size_t next = 0;
+
+  while (next < load.binaries.size() || !running.empty()) {
+    // keep nProcesses going
+    while (next < load.binaries.size() && running.size() < nProcesses) {
+      ParallelScanHelper h;
+      h.binary = next++;
+      h.deadline = parallelScanNow() + timeout;
+      if (parallelScanStartHelper(h, helper, load.binaries[h.binary], cacheVersion)) {
+        running.push_back(h);
+      }
+      else {
+        load.binaries[h.binary].helperResult = ParallelScanBinary::eHelperUnusable;
+      }
+    }
+
+    // wait for output from any of them, or for the next deadline
+    std::vector<struct pollfd> fds;
+    std::vector<ParallelScanHelper *> fdHelpers;
+    double now = parallelScanNow();
+    double wait = timeout;
+    for (std::list<ParallelScanHelper>::iterator i = running.begin(); i != running.end(); ++i) {
+      if (i->fd >= 0) {
+        struct pollfd p = { i->fd, POLLIN, 0 };
+        fds.push_back(p);
+        fdHelpers.push_back(&*i);
+        wait = std::min(wait, i->deadline - now);
+      }
+      else {
+        // closed its stdout but not yet exited
+        wait = std::min(wait, 0.01);
+      }
+    }
+    int ms = wait > 0 ? int(wait * 1000) + 1 : 0;
+    if (poll(fds.empty() ? 0 : &fds[0], fds.size(), ms) > 0) {
+      for (size_t i = 0; i < fds.size(); i++) {
+        if (!fds[i].revents) {
+          continue;
+        }
+        char buf[65536];
+        ssize_t n = read(fds[i].fd, buf, sizeof(buf));
+        if (n > 0) {
+          load.binaries[fdHelpers[i]->binary].helperOutput.append(buf, n);
+        }
+        else if (n == 0 || errno != EINTR) {
+          close(fdHelpers[i]->fd);
+          fdHelpers[i]->fd = -1;
+        }
+      }
+    }
+
+    // see who has finished, or run out of time
+    now = parallelScanNow();
+    std::list<ParallelScanHelper>::iterator i = running.begin();
+    while (i != running.end()) {
+      ParallelScanBinary &b = load.binaries[i->binary];
+      int status = 0;
+      bool done = false;
+
+      if (i->fd < 0 && waitpid(i->pid, &status, WNOHANG) == i->pid) {
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+          b.helperResult = ParallelScanBinary::eHelperDescribed;
+        }
+        else if (WIFEXITED(status) && (WEXITSTATUS(status) == 2 || WEXITSTATUS(status) == 127)) {
+          // a bad command line, or it could not be run at all
+          std::cerr << "describe helper " << helper << " could not be run on " << b.binpath << std::endl;
+          b.helperResult = ParallelScanBinary::eHelperUnusable;
+        }
+        else {
+          std::cerr << "describe helper failed on plugin binary " << b.binpath << ", skipping it until it changes" << std::endl;
+          b.helperResult = ParallelScanBinary::eHelperFailed;
+        }
+        done = true;
+      }
+      else if (now > i->deadline) {
+        std::cerr << "describe helper timed out on plugin binary " << b.binpath << ", skipping it until it changes" << std::endl;
+        kill(i->pid, SIGKILL);
+        waitpid(i->pid, &status, 0);
+        if (i->fd >= 0) {
+          close(i->fd);
+        }
+        b.helperResult = ParallelScanBinary::eHelperFailed;
+        done = true;
+      }
+
+      if (done) {
+        i = running.erase(i);
+      }
+      else {
+        ++i;
+      }
+    }
+  }
+}
+#endif
+
+PluginBinary *PluginCache::readDescribeHelperOutput(const std::string &xml)
+{
+  // a helper that was cut short will not have finished the cache
+  std::string end = "</cache>\n";
+  if (xml.size() < end.size() || xml.compare(xml.size() - end.size(), end.size(), end) != 0) {
+    return 0;
+  }
+
+  size_t nBinaries = _binaries.size();
+  _ignoreCache = false;
+  _xmlCurrentBinary = 0;
+  _xmlCurrentPlugin = 0;
+
+  std::istringstream is(xml);
+  readCache(is);
+
+  // it should have described just the one binary
+  PluginBinary *pb = 0;
+  if (_binaries.size() == nBinaries + 1) {
+    pb = _binaries.back();
+    _binaries.pop_back();
+  }
+  while (_binaries.size() > nBinaries) {
+    delete _binaries.back();
+    _binaries.pop_back();
+  }
+  return pb;
+}
+
+int PluginCache::runDescribeHelper(int argc, char **argv)
+{
+  if (argc != 4) {
+    std::cerr << "usage : " << (argc > 0 ? argv[0] : "helper") << " binaryPath bundlePath cacheVersion" << std::endl;
+    return 2;
+  }
+
+#if defined(UNIX)
+  // keep stdout for the cache, and send anything else written to it to stderr
+  int out = dup(1);
+  dup2(2, 1);
+#endif
+
+  setCacheVersion(argv[3]);
+
+  PluginBinary *pb = new PluginBinary(argv[1], argv[2], this);
+  _binaries.push_back(pb);
+  _knownBinFiles.insert(pb->getFilePath());
+
+  for (int j=0;j<pb->getNPlugins();j++) {
+    Plugin *plug = &pb->getPlugin(j);
+    const APICache::PluginAPICacheI &api = plug->getApiHandler();
+    api.loadFromPlugin(plug);
+  }
+
+  // take the cache before the other describe actions, as loading the plugins for those
+  // describes them again, which may change what they said
+  std::ostringstream os;
+  writePluginCache(os);
+  std::string xml = os.str();
+
+  // a plugin that crashes or hangs in those means no cache is written
+  for (int j=0;j<pb->getNPlugins();j++) {
+    Plugin *plug = &pb->getPlugin(j);
+    APICache::PluginAPICacheI &api = plug->getApiHandler();
+    api.describeFully(plug);
+  }
+
+#if defined(UNIX)
+  const char *data = xml.c_str();
+  size_t left = xml.size();
+  while (left > 0) {
+    ssize_t n = write(out, data, left);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return 1;
+    }
+    data += n;
+    left -= n;
+  }
+  close(out);
+#else
+  std::cout << xml;
+  std::cout.flush();
+#endif
+  return 0;
+}
+
+void PluginCache::parallelScan(std::set<std::string> &foundBinFiles)
+{
+  unsigned int nThreads = Thread::WorkerPool::numCPUs();
+
+  // walk the path, each directory is listed by whichever thread gets to it
+  std::vector<ParallelScanDir *> roots;
+  ParallelScanWalk walk;
+  walk.busy = 0;
+  for (std::list<std::string>::iterator paths= _pluginPath.begin();
+       paths != _pluginPath.end();
+       paths++) {
+    roots.push_back(new ParallelScanDir(*paths, _nonrecursePath.find(*paths) == _nonrecursePath.end()));
+    walk.queue.push_back(roots.back());
+  }
+  Thread::WorkerPool::get().multiThread(parallelScanWalkThread, nThreads, &walk);
+
+  // put what it found in order
+  std::vector<std::pair<std::string, std::string> > bundles;
+  for (size_t i = 0; i < roots.size(); i++) {
+    parallelScanCollect(*roots[i], _pluginDirs, bundles);
+    delete roots[i];
+  }
+
+  loadBundles(bundles, foundBinFiles);
+}
+
+void PluginCache::loadBundles(const std::vector<std::pair<std::string, std::string> > &bundles, std::set<std::string> &foundBinFiles)
+{
+  unsigned int nThreads = (_parallelScan || !_describeHelper.empty()) ? Thread::WorkerPool::numCPUs() : 1;
+
+  // work out which binaries need loading as scanDirectory does
+  ParallelScanLoad load;
+  load.cache = this;
+  load.next = 0;
+  std::set<std::string> queued;
+  for (size_t i = 0; i < bundles.size(); i++) {
+    const std::string &dir = bundles[i].first;
+    const std::string &name = bundles[i].second;
+
+    std::string barename = name.substr(0, name.length() - strlen(".bundle"));
+    ParallelScanBinary b;
+    b.binary = 0;
+    b.bundlename = dir + DIRSEP + name;
+    b.binpath = dir + DIRSEP + name + DIRSEP "Contents" DIRSEP + ARCHSTR + DIRSEP + barename;
+#if defined(__APPLE__) && (defined(__x86_64) || defined(__x86_64__))
+    b.binpathUniversal = dir + DIRSEP + name + DIRSEP "Contents" DIRSEP + "MacOS" + DIRSEP + barename;
+    if (_knownBinFiles.find(b.binpathUniversal) != _knownBinFiles.end()) {
+      b.binpath = b.binpathUniversal;
+    }
+#endif
+    if (_knownBinFiles.find(b.binpath) == _knownBinFiles.end()) {
+      if (queued.insert(b.binpath).second) {
+        load.binaries.push_back(b);
+      }
+    }
+    else {
+      foundBinFiles.insert(b.binpath);
+    }
+  }
+  size_t nNew = load.binaries.size();
+
+  // as well as cached binaries that have changed since
+  for (std::list<PluginBinary *>::iterator i=_binaries.begin();i!=_binaries.end();i++) {
+    if ((*i)->hasBinaryChanged() && foundBinFiles.find((*i)->getFilePath()) != foundBinFiles.end()) {
+      ParallelScanBinary b;
+      b.binary = *i;
+      b.binpath = (*i)->getFilePath();
+      b.bundlename = (*i)->getBundlePath();
+      load.binaries.push_back(b);
+    }
+  }
+
+  if (load.binaries.empty()) {
+    return;
+  }
+  _dirty = true;
+
+  if (nThreads > load.binaries.size()) {
+    nThreads = (unsigned int) load.binaries.size();
+  }
+
+  bool outOfProcess = false;
+#if defined(UNIX)
+  if (!_describeHelper.empty()) {
+    if (access(_describeHelper.c_str(), X_OK) == 0) {
+      outOfProcess = true;
+    }
+    else {
+      std::cerr << "cannot run describe helper " << _describeHelper << ", describing plugins in process" << std::endl;
+    }
+  }
+#endif
+
+  if (!outOfProcess) {
+    Thread::WorkerPool::get().multiThread(parallelScanLoadThread, nThreads, &load);
+  }
+#if defined(UNIX)
+  else {
+    parallelScanRunHelpers(load, _describeHelper, _cacheVersion, _describeTimeout, nThreads);
+
+    // read what the helpers said, in order
+    ParallelScanLoad inProcess;
+    inProcess.cache = this;
+    inProcess.next = 0;
+    std::vector<size_t> inProcessIndices;
+    for (size_t i = 0; i < load.binaries.size(); i++) {
+      ParallelScanBinary &b = load.binaries[i];
+
+      if (b.helperResult == ParallelScanBinary::eHelperUnusable) {
+        // that says nothing against the binary, so describe it ourselves below
+        inProcess.binaries.push_back(b);
+        inProcessIndices.push_back(i);
+        continue;
+      }
+
+      PluginBinary *pb = 0;
+      if (b.helperResult == ParallelScanBinary::eHelperDescribed) {
+        pb = readDescribeHelperOutput(b.helperOutput);
+        if (!pb) {
+          std::cerr << "describe helper gave bad output for plugin binary " << b.binpath << ", skipping it until it changes" << std::endl;
+        }
+      }
+      if (!pb) {
+        // remember it so we skip it until it changes
+        pb = new PluginBinary(b.binpath, b.bundlename, 0, 0);
+        pb->blacklist();
+      }
+
+      if (i >= nNew) {
+        // put it in place of the changed one, or drop that so it is not loaded in process
+        std::list<PluginBinary *>::iterator old = std::find(_binaries.begin(), _binaries.end(), b.binary);
+        if (pb) {
+          _binaries.insert(old, pb);
+        }
+        _binaries.erase(old);
+        delete b.binary;
+      }
+      b.binary = pb;
+    }
+
+    // changed binaries among these are reloaded where they are in _binaries
+    if (!inProcess.binaries.empty()) {
+      unsigned int n = std::min(nThreads, (unsigned int) inProcess.binaries.size());
+      Thread::WorkerPool::get().multiThread(parallelScanLoadThread, n, &inProcess);
+      for (size_t i = 0; i < inProcessIndices.size(); i++) {
+        load.binaries[inProcessIndices[i]].binary = inProcess.binaries[i].binary;
+      }
+    }
+  }
+#endif
+
+  // and add the new ones in the order they were found
+  for (size_t i = 0; i < nNew; i++) {
+    PluginBinary *pb = load.binaries[i].binary;
+    if (!pb) {
+      continue;
+    }
+    _binaries.push_back(pb);
+    _knownBinFiles.insert(pb->getFilePath());
+    foundBinFiles.insert(pb->getFilePath());
+  }
+}
+
 std::string PluginCache::seekPluginFile(const std::string &baseName) const {
   // Exit early if disabled
   if (!_enablePluginSeek)
@@ -433,10 +1062,15 @@ void PluginCache::scanPluginFiles()
 {
   std::set<std::string> foundBinFiles;
   
-  for (std::list<std::string>::iterator paths= _pluginPath.begin();
-       paths != _pluginPath.end();
-       paths++) {
-    scanDirectory(foundBinFiles, *paths, _nonrecursePath.find(*paths) == _nonrecursePath.end());
+  if (_parallelScan || !_describeHelper.empty()) {
+    parallelScan(foundBinFiles);
+  } 
+  else {
+    for (std::list<std::string>::iterator paths= _pluginPath.begin();
+         paths != _pluginPath.end();
+         paths++) {
+      scanDirectory(foundBinFiles, *paths, _nonrecursePath.find(*paths) == _nonrecursePath.end());
+    }
   }
   
   std::list<PluginBinary *>::iterator i=_binaries.begin();
@@ -483,6 +1117,498 @@ void PluginCache::scanPluginFiles()
       i++;
     }
   }
+
+  if (_watchPluginFiles) {
+    startWatching();
+  }
+}
+
+#if defined(__linux__)
+namespace OFX {
+  namespace Host {
+
+    /// the inotify watches rescanPluginFiles reads, see PluginCache::setWatchPluginFiles
+    class PluginWatcher {
+    public :
+      int fd;
+      std::map<int, std::string> dirs;           ///< plugin directories, by watch
+      std::map<int, std::string> bundles;        ///< bundles, by the watch on the deepest directory of them there is towards the binary
+      std::map<std::string, int> bundleWatches;  ///< bundles' watches, by bundle
+      std::set<std::string> missed;              ///< directories that may have changed before we could watch them
+
+      PluginWatcher() : fd(-1) {}
+
+      ~PluginWatcher() {
+        if (fd >= 0) {
+          close(fd);
+        }
+      }
+
+      /// watch a plugin directory, returns false if we have run out of watches
+      bool watchDir(const std::string &dir)
+      {
+        int wd = inotify_add_watch(fd, dir.c_str(), IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                   IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR | IN_MASK_ADD);
+        if (wd < 0) {
+          return watchFailed(dir);
+        }
+        dirs[wd] = dir;
+        return true;
+      }
+
+      /// watch the directory a bundle's binary is in, or as far towards it as there is,
+      /// returns false if we have run out of watches
+      bool watchBundle(const std::string &bundle, const std::string &binpath)
+      {
+        unwatchBundle(bundle);
+        std::string dir = binpath.substr(0, binpath.find_last_of(DIRSEP));
+        for (;;) {
+          int wd = inotify_add_watch(fd, dir.c_str(), IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                     IN_CLOSE_WRITE | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF |
+                                     IN_ONLYDIR | IN_MASK_ADD);
+          if (wd >= 0) {
+            bundles[wd] = bundle;
+            bundleWatches[bundle] = wd;
+            return true;
+          }
+          if ((errno != ENOENT && errno != ENOTDIR) || dir.size() <= bundle.size()) {
+            return watchFailed(bundle);
+          }
+          dir = dir.substr(0, dir.find_last_of(DIRSEP));
+        }
+      }
+
+      void unwatchBundle(const std::string &bundle)
+      {
+        std::map<std::string, int>::iterator i = bundleWatches.find(bundle);
+        if (i == bundleWatches.end()) {
+          return;
+        }
+        int wd = i->second;
+        bundleWatches.erase(i);
+        bundles.erase(wd);
+        if (dirs.find(wd) == dirs.end()) {
+          inotify_rm_watch(fd, wd);
+        }
+      }
+
+      /// Read the events so far, adding the directories to list again and the bundles to stat
+      /// again. Returns false if events were lost, in which case everything must be looked at.
+      bool readEvents(std::set<std::string> &dirtyDirs, std::set<std::string> &dirtyBundles)
+      {
+        bool complete = true;
+        dirtyDirs.insert(missed.begin(), missed.end());
+        missed.clear();
+
+        union {
+          struct inotify_event event;
+          char bytes[16384];
+        } buf;
+
+        for (;;) {
+          ssize_t n = read(fd, buf.bytes, sizeof(buf.bytes));
+          if (n < 0 && errno == EINTR) {
+            continue;
+          }
+          if (n <= 0) {
+            break;
+          }
+          for (ssize_t at = 0; at < n; ) {
+            const struct inotify_event *e = (const struct inotify_event *) (buf.bytes + at);
+            at += sizeof(struct inotify_event) + e->len;
+
+            if (e->mask & IN_Q_OVERFLOW) {
+              complete = false;
+              continue;
+            }
+
+            std::map<int, std::string>::iterator d = dirs.find(e->wd);
+            if (d != dirs.end()) {
+              dirtyDirs.insert(d->second);
+              if (e->mask & IN_IGNORED) {
+                dirs.erase(d);
+              }
+            }
+
+            std::map<int, std::string>::iterator b = bundles.find(e->wd);
+            if (b != bundles.end()) {
+              dirtyBundles.insert(b->second);
+              if (e->mask & IN_IGNORED) {
+                bundleWatches.erase(b->second);
+                bundles.erase(b);
+              }
+            }
+          }
+        }
+        return complete;
+      }
+
+    protected :
+      /// a path could not be watched, which only matters if we have run out of watches,
+      /// otherwise it has gone, so look at the directory it was in
+      bool watchFailed(const std::string &path)
+      {
+        if (errno == ENOSPC || errno == ENOMEM) {
+          return false;
+        }
+        missed.insert(path.substr(0, path.find_last_of(DIRSEP)));
+        return true;
+      }
+    };
+
+  }
+}
+#endif
+
+void PluginCache::stopWatching()
+{
+#if defined(__linux__)
+  delete _watcher;
+#endif
+  _watcher = 0;
+}
+
+void PluginCache::startWatching()
+{
+  stopWatching();
+#if defined(__linux__)
+  PluginWatcher *w = new PluginWatcher;
+  w->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  bool ok = w->fd >= 0;
+  for (std::list<std::string>::iterator i = _pluginDirs.begin(); ok && i != _pluginDirs.end(); ++i) {
+    ok = w->watchDir(*i);
+  }
+  for (std::list<PluginBinary *>::iterator i = _binaries.begin(); ok && i != _binaries.end(); ++i) {
+    ok = w->watchBundle((*i)->getBundlePath(), (*i)->getFilePath());
+  }
+  if (!ok) {
+    std::cerr << "cannot watch the plugin path (" << strerror(errno) << "), rescans will look at all of it" << std::endl;
+    delete w;
+    return;
+  }
+  _watcher = w;
+#endif
+}
+
+/// the directory a path is in
+static std::string rescanParent(const std::string &path)
+{
+  std::string::size_type sep = path.find_last_of(DIRSEP);
+  return sep == std::string::npos ? std::string() : path.substr(0, sep);
+}
+
+/// is a path under a directory
+static bool rescanIsUnder(const std::string &path, const std::string &dir)
+{
+  return path.size() > dir.size() + 1 && path.compare(0, dir.size(), dir) == 0 &&
+    path.compare(dir.size(), strlen(DIRSEP), DIRSEP) == 0;
+}
+
+/// has a binary changed on disk since it was loaded or read from a cache
+static bool rescanBinaryChanged(const PluginBinary &pb)
+{
+  struct stat sb;
+  if (stat(pb.getFilePath().c_str(), &sb) != 0) {
+    sb.st_mtime = 0;
+    sb.st_size = 0;
+  }
+  return sb.st_mtime != pb.getFileModificationTime() || sb.st_size != pb.getFileSize();
+}
+
+/// list a directory and everything under it, on this thread
+static void rescanWalk(ParallelScanDir &d)
+{
+  parallelScanList(d);
+  for (size_t i = 0; i < d.entries.size(); i++) {
+    if (d.entries[i].second) {
+      rescanWalk(*d.entries[i].second);
+    }
+  }
+}
+
+void PluginCache::purgeRetiredBinaries()
+{
+  std::list<PluginBinary *>::iterator i = _retiredBinaries.begin();
+  while (i != _retiredBinaries.end()) {
+    PluginBinary *pb = *i;
+    bool inUse = false;
+    for (int j = 0; j < pb->getNPlugins() && !inUse; j++) {
+      inUse = pb->getPlugin(j).hasLiveInstances();
+    }
+    if (inUse) {
+      ++i;
+    }
+    else {
+      i = _retiredBinaries.erase(i);
+      delete pb;
+    }
+  }
+}
+
+bool PluginCache::rescanPluginFiles(PluginCacheChanges &changes)
+{
+  purgeRetiredBinaries();
+
+  changes.added.clear();
+  changes.removed.clear();
+  changes.changed.clear();
+
+  std::set<std::string> dirtyDirs;
+  std::set<std::string> dirtyBundles;
+  bool everything = true;
+#if defined(__linux__)
+  if (_watcher) {
+    everything = !_watcher->readEvents(dirtyDirs, dirtyBundles);
+    if (!everything && dirtyDirs.empty() && dirtyBundles.empty()) {
+      return false;
+    }
+  }
+#endif
+
+  std::map<std::string, PluginBinary *> known;  ///< the binaries we have, by bundle
+  for (std::list<PluginBinary *>::iterator i = _binaries.begin(); i != _binaries.end(); ++i) {
+    known[(*i)->getBundlePath()] = *i;
+  }
+
+  std::set<PluginBinary *> stale;                               ///< binaries that went or changed
+  std::vector<std::pair<std::string, std::string> > bundles;    ///< bundles to load, as (directory, name)
+  std::set<std::string> queued;                                 ///< and by path
+  std::set<std::string> found;                                  ///< bundles that are there, of those looked at
+
+  if (everything) {
+    // walk the whole path again, as scanPluginFiles does
+    std::list<std::string> dirs;
+    std::vector<std::pair<std::string, std::string> > listed;
+    for (std::list<std::string>::iterator paths = _pluginPath.begin(); paths != _pluginPath.end(); paths++) {
+      ParallelScanDir root(*paths, _nonrecursePath.find(*paths) == _nonrecursePath.end());
+      rescanWalk(root);
+      parallelScanCollect(root, dirs, listed);
+    }
+    _pluginDirs.swap(dirs);
+
+    for (size_t i = 0; i < listed.size(); i++) {
+      std::string bundle = listed[i].first + DIRSEP + listed[i].second;
+      std::map<std::string, PluginBinary *>::iterator k = known.find(bundle);
+      found.insert(bundle);
+      if (k != known.end() && !rescanBinaryChanged(*k->second)) {
+        continue;
+      }
+      if (k != known.end()) {
+        stale.insert(k->second);
+      }
+      if (queued.insert(bundle).second) {
+        bundles.push_back(listed[i]);
+      }
+    }
+    for (std::map<std::string, PluginBinary *>::iterator k = known.begin(); k != known.end(); ++k) {
+      if (found.find(k->first) == found.end()) {
+        stale.insert(k->second);
+      }
+    }
+  }
+  else {
+    // bundles something happened in, those we do not know of are looked for by listing where they are
+    for (std::set<std::string>::iterator b = dirtyBundles.begin(); b != dirtyBundles.end(); ++b) {
+      std::map<std::string, PluginBinary *>::iterator k = known.find(*b);
+      if (k == known.end()) {
+        dirtyDirs.insert(rescanParent(*b));
+      }
+      else if (rescanBinaryChanged(*k->second)) {
+        // reload it, unless the whole bundle went
+        struct stat sb;
+        stale.insert(k->second);
+        if (stat(b->c_str(), &sb) == 0 && (sb.st_mode & S_IFDIR) && queued.insert(*b).second) {
+          bundles.push_back(std::make_pair(rescanParent(*b), b->substr(rescanParent(*b).size() + strlen(DIRSEP))));
+        }
+      }
+    }
+
+    // and directories something happened in, which are listed again
+    std::set<std::string> knownDirs(_pluginDirs.begin(), _pluginDirs.end());
+    std::set<std::string> goneDirs;
+    for (std::set<std::string>::iterator dir = dirtyDirs.begin(); dir != dirtyDirs.end(); ++dir) {
+      if (knownDirs.find(*dir) == knownDirs.end()) {
+        continue;
+      }
+
+      bool root = std::find(_pluginPath.begin(), _pluginPath.end(), *dir) != _pluginPath.end();
+      ParallelScanDir d(*dir, !root || _nonrecursePath.find(*dir) == _nonrecursePath.end());
+      parallelScanList(d);
+      if (!d.opened) {
+        goneDirs.insert(*dir);
+        continue;
+      }
+#if defined(__linux__)
+      if (_watcher && !_watcher->watchDir(*dir)) {
+        stopWatching();
+      }
+#endif
+
+      std::set<std::string> listedDirs;
+      for (size_t i = 0; i < d.entries.size(); i++) {
+        std::string path = *dir + DIRSEP + d.entries[i].first;
+        if (!d.entries[i].second) {
+          // a bundle, which may be new or have been replaced
+          std::map<std::string, PluginBinary *>::iterator k = known.find(path);
+          found.insert(path);
+          if (k != known.end() && !rescanBinaryChanged(*k->second)) {
+            continue;
+          }
+          if (k != known.end()) {
+            stale.insert(k->second);
+          }
+          if (queued.insert(path).second) {
+            bundles.push_back(std::make_pair(*dir, d.entries[i].first));
+          }
+        }
+        else if (knownDirs.find(path) == knownDirs.end()) {
+          // a new directory, look at everything in it
+          std::list<std::string> dirs;
+          std::vector<std::pair<std::string, std::string> > listed;
+          rescanWalk(*d.entries[i].second);
+          parallelScanCollect(*d.entries[i].second, dirs, listed);
+          for (std::list<std::string>::iterator j = dirs.begin(); j != dirs.end(); ++j) {
+            _pluginDirs.push_back(*j);
+            knownDirs.insert(*j);
+#if defined(__linux__)
+            if (_watcher && !_watcher->watchDir(*j)) {
+              stopWatching();
+            }
+#endif
+          }
+          for (size_t j = 0; j < listed.size(); j++) {
+            std::string bundle = listed[j].first + DIRSEP + listed[j].second;
+            found.insert(bundle);
+            if (queued.insert(bundle).second) {
+              bundles.push_back(listed[j]);
+            }
+          }
+          listedDirs.insert(path);
+        }
+        else {
+          listedDirs.insert(path);
+        }
+      }
+
+      // directories in it that have gone
+      for (std::set<std::string>::iterator j = knownDirs.begin(); j != knownDirs.end(); ++j) {
+        if (rescanParent(*j) == *dir && listedDirs.find(*j) == listedDirs.end()) {
+          goneDirs.insert(*j);
+        }
+      }
+
+      // as well as bundles
+      for (std::map<std::string, PluginBinary *>::iterator k = known.begin(); k != known.end(); ++k) {
+        if (rescanParent(k->first) == *dir && found.find(k->first) == found.end()) {
+          stale.insert(k->second);
+        }
+      }
+    }
+
+    // drop directories that have gone, and any bundles in them
+    for (std::set<std::string>::iterator g = goneDirs.begin(); g != goneDirs.end(); ++g) {
+      std::list<std::string>::iterator j = _pluginDirs.begin();
+      while (j != _pluginDirs.end()) {
+        if (*j == *g || rescanIsUnder(*j, *g)) {
+          j = _pluginDirs.erase(j);
+        }
+        else {
+          ++j;
+        }
+      }
+      for (std::map<std::string, PluginBinary *>::iterator k = known.begin(); k != known.end(); ++k) {
+        if (rescanIsUnder(k->first, *g)) {
+          stale.insert(k->second);
+        }
+      }
+    }
+  }
+
+  if (stale.empty() && bundles.empty()) {
+    return false;
+  }
+  _dirty = true;
+
+  // take the binaries that went or changed out, remembering what their plugins were
+  std::multimap<std::string, PluginDesc> oldPlugins;
+  for (std::set<PluginBinary *>::iterator i = stale.begin(); i != stale.end(); ++i) {
+    PluginBinary *pb = *i;
+    for (int j = 0; j < pb->getNPlugins(); j++) {
+      Plugin *plug = &pb->getPlugin(j);
+      std::list<Plugin *>::iterator p = std::find(_plugins.begin(), _plugins.end(), plug);
+      if (p != _plugins.end()) {
+        _plugins.erase(p);
+        plug->getApiHandler().forgetPlugin(plug);
+        oldPlugins.insert(std::make_pair(pb->getBundlePath(), PluginDesc(*plug)));
+      }
+    }
+#if defined(__linux__)
+    if (_watcher) {
+      _watcher->unwatchBundle(pb->getBundlePath());
+    }
+#endif
+    _knownBinFiles.erase(pb->getFilePath());
+    _binaries.remove(pb);
+
+    // instances of its plugins may still be running
+    _retiredBinaries.push_back(pb);
+  }
+  purgeRetiredBinaries();
+
+  // load the new and changed ones
+  size_t nOld = _binaries.size();
+  std::set<std::string> foundBinFiles;
+  loadBundles(bundles, foundBinFiles);
+
+  std::list<PluginBinary *>::iterator i = _binaries.begin();
+  std::advance(i, nOld);
+  for (; i != _binaries.end(); ++i) {
+    PluginBinary *pb = *i;
+#if defined(__linux__)
+    if (_watcher && !_watcher->watchBundle(pb->getBundlePath(), pb->getFilePath())) {
+      stopWatching();
+    }
+#endif
+    for (int j = 0; j < pb->getNPlugins(); j++) {
+      Plugin *plug = &pb->getPlugin(j);
+      APICache::PluginAPICacheI &api = plug->getApiHandler();
+
+      std::string reason;
+      if (!api.pluginSupported(plug, reason)) {
+        std::cerr << "ignoring plugin " << plug->getIdentifier() <<
+          " as unsupported (" << reason << ")" << std::endl;
+        continue;
+      }
+      _plugins.push_back(plug);
+      api.confirmPlugin(plug);
+
+      // a plugin the binary had before has changed, else it is new
+      bool changed = false;
+      std::pair<std::multimap<std::string, PluginDesc>::iterator, std::multimap<std::string, PluginDesc>::iterator> was =
+        oldPlugins.equal_range(pb->getBundlePath());
+      for (std::multimap<std::string, PluginDesc>::iterator k = was.first; k != was.second; ++k) {
+        if (k->second.getIdentifier() == plug->getIdentifier()) {
+          oldPlugins.erase(k);
+          changed = true;
+          break;
+        }
+      }
+      (changed ? changes.changed : changes.added).push_back(PluginDesc(*plug));
+    }
+  }
+
+  for (std::multimap<std::string, PluginDesc>::iterator k = oldPlugins.begin(); k != oldPlugins.end(); ++k) {
+    changes.removed.push_back(k->second);
+  }
+
+#if defined(__linux__)
+  // a rescan of everything starts watching afresh
+  if (everything && _watchPluginFiles) {
+    startWatching();
+  }
+#endif
+
+  return !changes.added.empty() || !changes.removed.empty() || !changes.changed.empty();
 }
 
 
@@ -515,6 +1641,12 @@ void PluginCache::elementBeginCallback(void */*userData*/, const XML_Char *name,
   if (_ignoreCache) {
     return;
   }
+
+  // the plugin's API specific data is only recorded for now, see Plugin::loadPendingCacheData
+  if (_xmlCurrentPlugin) {
+    _xmlEvents->elementBegin(name, atts);
+    return;
+  }
   
   std::string ename = name;
   std::map<std::string, std::string> attmap;
@@ -551,6 +1683,7 @@ void PluginCache::elementBeginCallback(void */*userData*/, const XML_Char *name,
     size_t size = OFX::Host::Property::stringToInt(attmap["size"]);
     
     _xmlCurrentBinary = new PluginBinary(fname, bname, mtime, size);
+    _xmlCurrentBinary->setBlacklisted(attmap["blacklisted"] == "1");
     _binaries.push_back(_xmlCurrentBinary);
     _knownBinFiles.insert(fname);
     return;
@@ -585,17 +1718,16 @@ void PluginCache::elementBeginCallback(void */*userData*/, const XML_Char *name,
       Plugin *pe = apiCache->newPlugin(_xmlCurrentBinary, idx, api, api_version, identifier, rawIdentifier, major_version, minor_version);
       _xmlCurrentBinary->addPlugin(pe);
       _xmlCurrentPlugin = pe;
-      apiCache->beginXmlParsing(pe);
+
+      if (!_xmlEvents) {
+        _xmlEvents = new CacheFile::Writer;
+      }
+      memset(&_xmlCurrentRecord, 0, sizeof(_xmlCurrentRecord));
+      _xmlCurrentRecord.eventsBegin = _xmlEvents->eventPosition();
     }
     
     return;
   }
-  
-  if (_xmlCurrentPlugin) {
-    APICache::PluginAPICacheI &api = _xmlCurrentPlugin->getApiHandler();
-    api.xmlElementBegin(name, attmap);
-  }
-  
 }
 
 void PluginCache::elementCharCallback(void */*userData*/, const XML_Char *data, int size)
@@ -604,10 +1736,8 @@ void PluginCache::elementCharCallback(void */*userData*/, const XML_Char *data,
     return;
   }
   
-  std::string s(data, size);
   if (_xmlCurrentPlugin) {
-    APICache::PluginAPICacheI &api = _xmlCurrentPlugin->getApiHandler();
-    api.xmlCharacterHandler(s);
+    _xmlEvents->characters(data, size);
   } else {
     /// XXX: we only want whitespace
   }
@@ -624,8 +1754,9 @@ void PluginCache::elementEndCallback(void */*userData*/, const XML_Char *name) {
   
   if (ename == "plugin") {
     if (_xmlCurrentPlugin) {
-      APICache::PluginAPICacheI &api = _xmlCurrentPlugin->getApiHandler();
-      api.endXmlParsing();
+      _xmlCurrentRecord.eventsEnd = _xmlEvents->eventPosition();
+      _xmlEvents->addPlugin(_xmlCurrentRecord);
+      _xmlPlugins.push_back(_xmlCurrentPlugin);
     }
     _xmlCurrentPlugin = 0;
     return;
@@ -637,8 +1768,7 @@ void PluginCache::elementEndCallback(void */*userData*/, const XML_Char *name) {
   }
   
   if (_xmlCurrentPlugin) {
-    APICache::PluginAPICacheI &api = _xmlCurrentPlugin->getApiHandler();
-    api.xmlElementEnd(name);
+    _xmlEvents->elementEnd(name);
   }
 }
 
@@ -666,6 +1796,31 @@ void PluginCache::readCache(std::istream &ifs) {
   }
   
   XML_ParserFree(xP);
+  _xmlCurrentBinary = 0;
+  _xmlCurrentPlugin = 0;
+
+  // leave what was recorded for the plugins to decode when they need it
+  if (!_xmlPlugins.empty()) {
+    std::vector<char> image;
+    _xmlEvents->build(image, _cacheVersion);
+
+    CacheFile::Reader *reader = new CacheFile::Reader;
+    if (reader->open(image)) {
+      _cacheFiles.push_back(reader);
+      for (size_t i = 0; i < _xmlPlugins.size(); i++) {
+        _xmlPlugins[i]->_sourceCache = this;
+        _xmlPlugins[i]->_pendingCache = this;
+        _xmlPlugins[i]->_pendingFile = reader;
+        _xmlPlugins[i]->_pendingRecord = (unsigned int) i;
+      }
+    }
+    else {
+      delete reader;
+    }
+  }
+  _xmlPlugins.clear();
+  delete _xmlEvents;
+  _xmlEvents = 0;
 }
 
 void PluginCache::writePluginCache(std::ostream &os) const {
@@ -681,7 +1836,11 @@ void PluginCache::writePluginCache(std::ostream &os) const {
        << XML::attribute("bundle_path", b->getBundlePath()) 
        << XML::attribute("path", b->getFilePath())
        << XML::attribute("mtime", int(b->getFileModificationTime()))
-       << XML::attribute("size", int(b->getFileSize())) << "/>\n";
+       << XML::attribute("size", int(b->getFileSize()));
+    if (b->isBlacklisted()) {
+      os << XML::attribute("blacklisted", 1);
+    }
+    os << "/>\n";
     
     for (int j=0;j<b->getNPlugins();j++) {
       Plugin *p = &b->getPlugin(j);
@@ -709,6 +1868,155 @@ void PluginCache::writePluginCache(std::ostream &os) const {
 }
 
 
+bool PluginCache::readBinaryCache(const std::string &path)
+{
+  CacheFile::Reader *reader = new CacheFile::Reader;
+  if (!reader->open(path)) {
+#ifdef CACHE_DEBUG
+    printf("no usable binary cache in '%s'\n", path.c_str());
+#endif
+    delete reader;
+    return false;
+  }
+
+  if (_cacheVersion != reader->getCacheVersion()) {
+#ifdef CACHE_DEBUG
+    printf("mismatched version, ignoring binary cache (got '%s', wanted '%s')\n",
+           reader->getCacheVersion(),
+           _cacheVersion.c_str());
+#endif
+    delete reader;
+    return false;
+  }
+
+  // the plugins will decode from it, so it is ours until we go
+  _cacheFiles.push_back(reader);
+
+  for (unsigned int i = 0; i < reader->getNBinaries(); i++) {
+    CacheFile::BinaryRecord b = reader->getBinary(i);
+
+    PluginBinary *pb = new PluginBinary(reader->getString(b.path), reader->getString(b.bundlePath), time_t(b.mtime), off_t(b.size));
+    _binaries.push_back(pb);
+    _knownBinFiles.insert(pb->getFilePath());
+    pb->setBlacklisted((b.flags & CacheFile::eBinaryBlacklisted) != 0);
+
+    // scanPluginFiles will reload it
+    if (pb->hasBinaryChanged()) {
+      continue;
+    }
+
+    for (unsigned int j = 0; j < b.nPlugins; j++) {
+      CacheFile::PluginRecord p = reader->getPlugin(b.firstPlugin + j);
+
+      std::string api = reader->getString(p.api);
+      std::string rawIdentifier = reader->getString(p.rawIdentifier);
+      std::string identifier = rawIdentifier;
+
+      APICache::PluginAPICacheI *apiCache = findApiHandler(api, p.apiVersion);
+      if (apiCache) {
+        Plugin *pe = apiCache->newPlugin(pb, p.index, api, p.apiVersion, identifier, rawIdentifier, p.versionMajor, p.versionMinor);
+        pb->addPlugin(pe);
+        pe->_sourceCache = this;
+        pe->_pendingCache = this;
+        pe->_pendingFile = reader;
+        pe->_pendingRecord = b.firstPlugin + j;
+      }
+    }
+  }
+
+  return true;
+}
+
+void PluginCache::loadPendingCacheData(Plugin *plugin)
+{
+  _cacheFileLock.lock();
+
+  // the API handler may ask for data of the plugin it is decoding, and other threads
+  // may have got here first
+  if (!plugin->_pendingCache || plugin->_pendingDecoding) {
+    _cacheFileLock.unlock();
+    return;
+  }
+  plugin->_pendingDecoding = true;
+
+  const CacheFile::Reader *file = plugin->_pendingFile;
+  CacheFile::PluginRecord record = file->getPlugin(plugin->_pendingRecord);
+
+  APICache::PluginAPICacheI &api = plugin->getApiHandler();
+  api.beginXmlParsing(plugin);
+  bool ok = false;
+  try {
+    ok = file->replay(record, api);
+  }
+  catch (...) {
+  }
+  api.endXmlParsing();
+
+  if (!ok) {
+    std::cerr << "damaged binary cache entry for plugin " << plugin->getIdentifier() << std::endl;
+  }
+
+  plugin->_pendingDecoding = false;
+  plugin->_pendingFile = 0;
+  plugin->_pendingCache = 0;
+  _cacheFileLock.unlock();
+}
+
+bool PluginCache::writeBinaryCache(const std::string &path) const
+{
+  CacheFile::Writer writer;
+
+  // so no plugin is half way through decoding
+  _cacheFileLock.lock();
+
+  for (std::list<PluginBinary *>::const_iterator i=_binaries.begin();i!=_binaries.end();i++) {
+    PluginBinary *b = *i;
+
+    CacheFile::BinaryRecord br;
+    br.mtime = (long long) b->getFileModificationTime();
+    br.size = (long long) b->getFileSize();
+    br.path = writer.addString(b->getFilePath());
+    br.bundlePath = writer.addString(b->getBundlePath());
+    br.flags = b->isBlacklisted() ? CacheFile::eBinaryBlacklisted : 0;
+    br.reserved = 0;
+    writer.addBinary(br);
+
+    for (int j=0;j<b->getNPlugins();j++) {
+      Plugin *p = &b->getPlugin(j);
+
+      CacheFile::PluginRecord pr;
+      pr.api = writer.addString(p->getPluginApi());
+      pr.rawIdentifier = writer.addString(p->getRawIdentifier());
+      pr.index = p->getIndex();
+      pr.apiVersion = p->getApiVersion();
+      pr.versionMajor = p->getVersionMajor();
+      pr.versionMinor = p->getVersionMinor();
+
+      if (p->_pendingCache) {
+        // still as it was read, so copy it over as is
+        writer.addEvents(*p->_pendingFile, p->_pendingFile->getPlugin(p->_pendingRecord), pr);
+      }
+      else {
+        // the API handler only knows how to write XML, so store that pre-parsed
+        const APICache::PluginAPICacheI &api = p->getApiHandler();
+        std::ostringstream os;
+        os << "<apiproperties>\n";
+        api.saveXML(p, os);
+        os << "</apiproperties>\n";
+
+        if (!writer.addXML(os.str(), pr)) {
+          _cacheFileLock.unlock();
+          return false;
+        }
+      }
+      writer.addPlugin(pr);
+    }
+  }
+  _cacheFileLock.unlock();
+
+  return writer.save(path, _cacheVersion);
+}
+
 APICache::PluginAPICacheI *PluginCache::findApiHandler(const std::string &api, int version) {
   std::list<PluginCacheSupportedApi>::iterator i = _apiHandlers.begin();
   while (i != _apiHandlers.end()) {
@@ -0,0 +1,583 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "expat.h"
+
+// ofx
+#include "ofxCore.h"
+
+// ofx host
+#include "ofxhBinary.h"
+#include "ofxhPluginAPICache.h"
+#include "ofxhPluginCacheFile.h"
+
+#if defined(UNIX)
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace OFX {
+
+  namespace Host {
+
+    namespace CacheFile {
+
+      static const char kMagic[8] = { 'O', 'F', 'X', 'C', 'A', 'C', 'H', 'E' };
+      static const unsigned int kByteOrder = 0x01020304;
+
+      /// round up to keep each section 8 byte aligned
+      static size_t align8(size_t n)
+      {
+        return (n + 7) & ~size_t(7);
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      // MappedFile
+
+      MappedFile::MappedFile()
+        : _data(0)
+        , _size(0)
+#if defined(WINDOWS)
+        , _file(INVALID_HANDLE_VALUE)
+        , _mapping(0)
+#else
+        , _map(0)
+#endif
+      {
+      }
+
+      MappedFile::~MappedFile()
+      {
+        close();
+      }
+
+      bool MappedFile::open(const std::string &path)
+      {
+        close();
+
+#if defined(WINDOWS)
+        _file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if(_file == INVALID_HANDLE_VALUE)
+          return false;
+
+        DWORD size = GetFileSize(_file, NULL);
+        if(size == INVALID_FILE_SIZE || size == 0) {
+          close();
+          return false;
+        }
+
+        _mapping = CreateFileMappingA(_file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if(_mapping) {
+          _data = (const char *) MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+        }
+        if(_data) {
+          _size = size;
+          return true;
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0)
+          return false;
+
+        struct stat st;
+        if(fstat(fd, &st) != 0 || st.st_size <= 0) {
+          ::close(fd);
+          return false;
+        }
+
+        void *map = mmap(0, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if(map != MAP_FAILED) {
+          _map = map;
+          _data = (const char *) map;
+          _size = size_t(st.st_size);
+          return true;
+        }
+#endif
+
+        // could not map it, so read it instead
+        close();
+        FILE *f = fopen(path.c_str(), "rb");
+        if(!f)
+          return false;
+
+        char chunk[65536];
+        size_t n;
+        while((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+          _buffer.insert(_buffer.end(), chunk, chunk + n);
+        }
+        bool ok = !ferror(f) && !_buffer.empty();
+        fclose(f);
+
+        if(!ok) {
+          close();
+          return false;
+        }
+        _data = &_buffer[0];
+        _size = _buffer.size();
+        return true;
+      }
+
+      void MappedFile::adopt(std::vector<char> &buffer)
+      {
+        close();
+        _buffer.swap(buffer);
+        if(!_buffer.empty()) {
+          _data = &_buffer[0];
+          _size = _buffer.size();
+        }
+      }
+
+      void MappedFile::close()
+      {
+#if defined(WINDOWS)
+        if(_data && _buffer.empty())
+          UnmapViewOfFile(_data);
+        if(_mapping)
+          CloseHandle(_mapping);
+        if(_file != INVALID_HANDLE_VALUE)
+          CloseHandle(_file);
+        _mapping = 0;
+        _file = INVALID_HANDLE_VALUE;
+#else
+        if(_map)
+          munmap(_map, _size);
+        _map = 0;
+#endif
+        std::vector<char>().swap(_buffer);
+        _data = 0;
+        _size = 0;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      // Writer
+
+      /// callback for XML parser
+      static void writerElementBeginHandler(void *userData, const XML_Char *name, const XML_Char **atts)
+      {
+        ((Writer *) userData)->elementBegin(name, atts);
+      }
+
+      /// callback for XML parser
+      static void writerElementEndHandler(void *userData, const XML_Char *name)
+      {
+        ((Writer *) userData)->elementEnd(name);
+      }
+
+      /// callback for XML parser
+      static void writerCharHandler(void *userData, const XML_Char *data, int len)
+      {
+        ((Writer *) userData)->characters(data, len);
+      }
+
+      Writer::Writer()
+      {
+        // so that index 0 is always the empty string
+        addString("");
+      }
+
+      unsigned int Writer::addString(const std::string &s)
+      {
+        std::map<std::string, unsigned int>::iterator i = _stringIndices.find(s);
+        if(i != _stringIndices.end())
+          return i->second;
+
+        unsigned int idx = (unsigned int) _strings.size();
+        _strings.push_back(s);
+        _stringIndices[s] = idx;
+        return idx;
+      }
+
+      void Writer::addEvents(const Reader &reader, const PluginRecord &from, PluginRecord &to)
+      {
+        to.eventsBegin = eventPosition();
+
+        // the events are valid, Reader::open checked, but their strings need indices in our table
+        unsigned int i = from.eventsBegin;
+        while(i < from.eventsEnd) {
+          unsigned int op = reader.getEvent(i++);
+          _events.push_back(op);
+
+          unsigned int nStrings = 1;
+          if(op == eElementBegin && i + 1 < from.eventsEnd) {
+            _events.push_back(addString(reader.getString(reader.getEvent(i++))));
+            unsigned int nAttrs = reader.getEvent(i++);
+            _events.push_back(nAttrs);
+            nStrings = nAttrs * 2;
+          }
+          for(unsigned int s = 0; s < nStrings && i < from.eventsEnd; s++) {
+            _events.push_back(addString(reader.getString(reader.getEvent(i++))));
+          }
+        }
+
+        to.eventsEnd = eventPosition();
+      }
+
+      unsigned int Writer::eventPosition()
+      {
+        flushCharacters();
+        return (unsigned int) _events.size();
+      }
+
+      void Writer::addBinary(const BinaryRecord &binary)
+      {
+        _binaries.push_back(binary);
+        _binaries.back().firstPlugin = (unsigned int) _plugins.size();
+        _binaries.back().nPlugins = 0;
+      }
+
+      void Writer::addPlugin(const PluginRecord &plugin)
+      {
+        _plugins.push_back(plugin);
+        if(!_binaries.empty())
+          _binaries.back().nPlugins++;
+      }
+
+      bool Writer::addXML(const std::string &xml, PluginRecord &plugin)
+      {
+        size_t start = _events.size();
+        _text.clear();
+
+        XML_Parser xP = XML_ParserCreate(NULL);
+        XML_SetUserData(xP, this);
+        XML_SetElementHandler(xP, writerElementBeginHandler, writerElementEndHandler);
+        XML_SetCharacterDataHandler(xP, writerCharHandler);
+        bool ok = XML_Parse(xP, xml.data(), int(xml.size()), XML_TRUE) != XML_STATUS_ERROR;
+        XML_ParserFree(xP);
+
+        flushCharacters();
+
+        if(!ok) {
+          _events.resize(start);
+          plugin.eventsBegin = plugin.eventsEnd = (unsigned int) start;
+          return false;
+        }
+
+        plugin.eventsBegin = (unsigned int) start;
+        plugin.eventsEnd = (unsigned int) _events.size();
+        return true;
+      }
+
+      void Writer::flushCharacters()
+      {
+        // only bother with text that is more than the whitespace between elements
+        if(_text.find_first_not_of(" \t\r\n") != std::string::npos) {
+          _events.push_back(eCharacters);
+          _events.push_back(addString(_text));
+        }
+        _text.clear();
+      }
+
+      void Writer::elementBegin(const char *name, const char **attrs)
+      {
+        flushCharacters();
+
+        _events.push_back(eElementBegin);
+        _events.push_back(addString(name));
+
+        size_t nAttrsSlot = _events.size();
+        _events.push_back(0);
+
+        unsigned int nAttrs = 0;
+        for(; attrs[0]; attrs += 2, nAttrs++) {
+          _events.push_back(addString(attrs[0]));
+          _events.push_back(addString(attrs[1]));
+        }
+        _events[nAttrsSlot] = nAttrs;
+      }
+
+      void Writer::elementEnd(const char *name)
+      {
+        flushCharacters();
+
+        _events.push_back(eElementEnd);
+        _events.push_back(addString(name));
+      }
+
+      void Writer::characters(const char *data, int len)
+      {
+        _text.append(data, len);
+      }
+
+      void Writer::build(std::vector<char> &file, const std::string &cacheVersion)
+      {
+        Header header;
+        memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.formatVersion = kFormatVersion;
+        header.byteOrder = kByteOrder;
+        header.cacheVersion = addString(cacheVersion);
+
+        // lay out the sections
+        std::vector<unsigned int> stringOffsets;
+        stringOffsets.reserve(_strings.size());
+        size_t stringsSize = 0;
+        for(size_t i = 0; i < _strings.size(); i++) {
+          stringOffsets.push_back((unsigned int) stringsSize);
+          stringsSize += _strings[i].size() + 1;
+        }
+
+        size_t offset = align8(sizeof(Header));
+        header.nStrings = (unsigned int) _strings.size();
+        header.stringsOffset = (unsigned int) offset;
+        header.stringsSize = (unsigned int) stringsSize;
+        offset = align8(offset + _strings.size() * sizeof(unsigned int) + stringsSize);
+
+        header.nBinaries = (unsigned int) _binaries.size();
+        header.binariesOffset = (unsigned int) offset;
+        offset = align8(offset + _binaries.size() * sizeof(BinaryRecord));
+
+        header.nPlugins = (unsigned int) _plugins.size();
+        header.pluginsOffset = (unsigned int) offset;
+        offset = align8(offset + _plugins.size() * sizeof(PluginRecord));
+
+        header.nEvents = (unsigned int) _events.size();
+        header.eventsOffset = (unsigned int) offset;
+        offset += _events.size() * sizeof(unsigned int);
+
+        // build it
+        file.assign(offset, 0);
+        memcpy(&file[0], &header, sizeof(Header));
+
+        char *strings = &file[header.stringsOffset];
+        if(!stringOffsets.empty())
+          memcpy(strings, &stringOffsets[0], stringOffsets.size() * sizeof(unsigned int));
+        strings += stringOffsets.size() * sizeof(unsigned int);
+        for(size_t i = 0; i < _strings.size(); i++) {
+          memcpy(strings + stringOffsets[i], _strings[i].c_str(), _strings[i].size() + 1);
+        }
+
+        if(!_binaries.empty())
+          memcpy(&file[header.binariesOffset], &_binaries[0], _binaries.size() * sizeof(BinaryRecord));
+        if(!_plugins.empty())
+          memcpy(&file[header.pluginsOffset], &_plugins[0], _plugins.size() * sizeof(PluginRecord));
+        if(!_events.empty())
+          memcpy(&file[header.eventsOffset], &_events[0], _events.size() * sizeof(unsigned int));
+      }
+
+      bool Writer::save(const std::string &path, const std::string &cacheVersion)
+      {
+        std::vector<char> file;
+        build(file, cacheVersion);
+
+        // write it beside the real thing, then swap it in
+        std::string tmpPath = path + ".tmp";
+        FILE *f = fopen(tmpPath.c_str(), "wb");
+        if(!f)
+          return false;
+
+        bool ok = fwrite(&file[0], 1, file.size(), f) == file.size();
+        ok = (fclose(f) == 0) && ok;
+
+#if defined(WINDOWS)
+        // rename will not replace an existing file on windows
+        if(ok)
+          remove(path.c_str());
+#endif
+        if(!ok || rename(tmpPath.c_str(), path.c_str()) != 0) {
+          remove(tmpPath.c_str());
+          return false;
+        }
+        return true;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      // Reader
+
+      Reader::Reader()
+      {
+        memset(&_header, 0, sizeof(Header));
+      }
+
+      /// is the given section inside a file of the given size
+      static bool sectionFits(size_t fileSize, size_t offset, size_t count, size_t itemSize)
+      {
+        if(offset > fileSize)
+          return false;
+        return count <= (fileSize - offset) / itemSize;
+      }
+
+      bool Reader::open(const std::string &path)
+      {
+        close();
+
+        if(!_file.open(path))
+          return false;
+        return validate();
+      }
+
+      bool Reader::open(std::vector<char> &file)
+      {
+        close();
+
+        _file.adopt(file);
+        return validate();
+      }
+
+      bool Reader::validate()
+      {
+        const char *data = _file.data();
+        size_t size = _file.size();
+
+        if(size < sizeof(Header)) {
+          close();
+          return false;
+        }
+        memcpy(&_header, data, sizeof(Header));
+
+        bool ok = memcmp(_header.magic, kMagic, sizeof(kMagic)) == 0 &&
+          _header.byteOrder == kByteOrder &&
+          _header.formatVersion == kFormatVersion &&
+          sectionFits(size, _header.stringsOffset, _header.nStrings, sizeof(unsigned int)) &&
+          sectionFits(size, _header.stringsOffset + size_t(_header.nStrings) * sizeof(unsigned int), _header.stringsSize, 1) &&
+          sectionFits(size, _header.binariesOffset, _header.nBinaries, sizeof(BinaryRecord)) &&
+          sectionFits(size, _header.pluginsOffset, _header.nPlugins, sizeof(PluginRecord)) &&
+          sectionFits(size, _header.eventsOffset, _header.nEvents, sizeof(unsigned int)) &&
+          _header.cacheVersion < _header.nStrings;
+
+        // every string has to start inside the string data, which has to end with a NUL,
+        // so that none can run off the end
+        if(ok) {
+          const char *strings = data + _header.stringsOffset;
+          const char *stringData = strings + size_t(_header.nStrings) * sizeof(unsigned int);
+          ok = _header.stringsSize > 0 && stringData[_header.stringsSize - 1] == 0;
+          for(unsigned int i = 0; ok && i < _header.nStrings; i++) {
+            unsigned int offset;
+            memcpy(&offset, strings + i * sizeof(unsigned int), sizeof(unsigned int));
+            ok = offset < _header.stringsSize;
+          }
+        }
+
+        // and every record must refer to things that are there
+        for(unsigned int i = 0; ok && i < _header.nBinaries; i++) {
+          BinaryRecord b = getBinary(i);
+          ok = b.path < _header.nStrings && b.bundlePath < _header.nStrings &&
+            b.firstPlugin <= _header.nPlugins && b.nPlugins <= _header.nPlugins - b.firstPlugin;
+        }
+        for(unsigned int i = 0; ok && i < _header.nPlugins; i++) {
+          PluginRecord p = getPlugin(i);
+          ok = p.api < _header.nStrings && p.rawIdentifier < _header.nStrings &&
+            p.eventsBegin <= p.eventsEnd && p.eventsEnd <= _header.nEvents;
+        }
+
+        if(!ok) {
+          close();
+          return false;
+        }
+        return true;
+      }
+
+      void Reader::close()
+      {
+        _file.close();
+        memset(&_header, 0, sizeof(Header));
+      }
+
+      const char *Reader::getString(unsigned int idx) const
+      {
+        if(idx >= _header.nStrings)
+          return "";
+        const char *strings = _file.data() + _header.stringsOffset;
+        unsigned int offset;
+        memcpy(&offset, strings + idx * sizeof(unsigned int), sizeof(unsigned int));
+        return strings + size_t(_header.nStrings) * sizeof(unsigned int) + offset;
+      }
+
+      BinaryRecord Reader::getBinary(unsigned int idx) const
+      {
+        BinaryRecord b;
+        memcpy(&b, _file.data() + _header.binariesOffset + idx * sizeof(BinaryRecord), sizeof(BinaryRecord));
+        return b;
+      }
+
+      PluginRecord Reader::getPlugin(unsigned int idx) const
+      {
+        PluginRecord p;
+        memcpy(&p, _file.data() + _header.pluginsOffset + idx * sizeof(PluginRecord), sizeof(PluginRecord));
+        return p;
+      }
+
+      unsigned int Reader::getEvent(unsigned int idx) const
+      {
+        unsigned int e;
+        memcpy(&e, _file.data() + _header.eventsOffset + idx * sizeof(unsigned int), sizeof(unsigned int));
+        return e;
+      }
+
+      bool Reader::replay(const PluginRecord &plugin, APICache::PluginAPICacheI &api) const
+      {
+        unsigned int i = plugin.eventsBegin;
+        unsigned int end = plugin.eventsEnd;
+        if(end > _header.nEvents)
+          return false;
+
+        while(i < end) {
+          unsigned int op = getEvent(i++);
+
+          if(op == eElementBegin) {
+            if(end - i < 2)
+              return false;
+            unsigned int name = getEvent(i++);
+            unsigned int nAttrs = getEvent(i++);
+            if(nAttrs > (end - i) / 2)
+              return false;
+
+            std::map<std::string, std::string> attrs;
+            for(unsigned int a = 0; a < nAttrs; a++, i += 2) {
+              attrs[getString(getEvent(i))] = getString(getEvent(i + 1));
+            }
+            api.xmlElementBegin(getString(name), attrs);
+          }
+          else if(op == eElementEnd) {
+            if(i == end)
+              return false;
+            api.xmlElementEnd(getString(getEvent(i++)));
+          }
+          else if(op == eCharacters) {
+            if(i == end)
+              return false;
+            api.xmlCharacterHandler(getString(getEvent(i++)));
+          }
+          else {
+            return false;
+          }
+        }
+        return true;
+      }
+
+    }
+
+  }
+
+}
@@ -38,6 +38,8 @@
 
 #include <iostream>
 #include <string.h>
+#include <stdlib.h>
+#include <new>
 
 namespace OFX {
   namespace Host {
@@ -50,6 +52,136 @@ namespace OFX {
       std::string StringValue::kEmpty;
       const char *gTypeNames[] = {"int", "double", "string", "pointer" };
 
+      ////////////////////////////////////////////////////////////////////////////////
+      // the global atom table
+      //
+      // This is a fixed number of buckets, each of which is a singly linked list of atoms.
+      // Atoms are only ever pushed onto the head of a bucket with a compare and swap and are
+      // never removed, so lookups need no lock at all.
+
+      namespace {
+        /// an atom and the link to the next one in its bucket
+        struct AtomNode {
+          AtomRecord  record;
+          AtomNode   *next;
+        };
+
+        /// number of buckets in the global atom table, a power of two
+        const unsigned int kNAtomBuckets = 4096;
+
+        /// the global atom table
+        AtomNode * volatile gAtomBuckets[kNAtomBuckets];
+
+        /// FNV-1a hash of a string
+        inline unsigned int hashName(const char *name)
+        {
+          unsigned int h = 2166136261u;
+          for(const unsigned char *c = (const unsigned char *) name; *c; ++c) {
+            h ^= *c;
+            h *= 16777619u;
+          }
+          return h;
+        }
+
+        /// atomically replace *where with newValue if it still holds oldValue
+        inline bool compareAndSwap(AtomNode * volatile *where, AtomNode *oldValue, AtomNode *newValue)
+        {
+#ifdef WINDOWS
+          return InterlockedCompareExchangePointer((PVOID volatile *) where, newValue, oldValue) == oldValue;
+#else
+          return __sync_bool_compare_and_swap(where, oldValue, newValue);
+#endif
+        }
+
+        /// look for the name in the list starting at node
+        inline Atom findInBucket(const AtomNode *node, const char *name, unsigned int hash)
+        {
+          for(; node; node = node->next) {
+            if(node->record.hash == hash && strcmp(node->record.name.c_str(), name) == 0)
+              return &node->record;
+          }
+          return NULL;
+        }
+      }
+
+      Atom findAtom(const char *name)
+      {
+        if(!name) return NULL;
+        unsigned int hash = hashName(name);
+        return findInBucket(gAtomBuckets[hash & (kNAtomBuckets - 1)], name, hash);
+      }
+
+      Atom intern(const char *name)
+      {
+        if(!name) return NULL;
+        unsigned int hash = hashName(name);
+        AtomNode * volatile *bucket = &gAtomBuckets[hash & (kNAtomBuckets - 1)];
+        AtomNode *node = NULL;
+        for(;;) {
+          AtomNode *head = *bucket;
+          // someone may have added it since we last looked
+          if(Atom found = findInBucket(head, name, hash)) {
+            delete node;
+            return found;
+          }
+          if(!node) {
+            node = new AtomNode;
+            node->record.name = name;
+            node->record.hash = hash;
+          }
+          node->next = head;
+          if(compareAndSwap(bucket, head, node))
+            return &node->record;
+        }
+      }
+
+      ////////////////////////////////////////////////////////////////////////////////
+      // property index
+
+      void PropertyIndex::grow()
+      {
+        std::vector<Slot> old;
+        old.swap(_slots);
+        Slot empty = {NULL, NULL};
+        _slots.resize(old.empty() ? 32 : old.size() * 2, empty);
+
+        size_t mask = _slots.size() - 1;
+        for(std::vector<Slot>::const_iterator i = old.begin(); i != old.end(); ++i) {
+          if(i->atom) {
+            size_t j = i->atom->hash & mask;
+            while(_slots[j].atom) 
+              j = (j + 1) & mask;
+            _slots[j] = *i;
+          }
+        }
+      }
+
+      void PropertyIndex::reserve(int n)
+      {
+        while((size_t)(_count + n) * 2 > _slots.size())
+          grow();
+      }
+
+      Property *PropertyIndex::insert(Property *prop)
+      {
+        if((size_t)(_count + 1) * 2 > _slots.size())
+          grow();
+
+        Atom atom = prop->getAtom();
+        size_t mask = _slots.size() - 1;
+        size_t i = atom->hash & mask;
+        while(_slots[i].atom && _slots[i].atom != atom)
+          i = (i + 1) & mask;
+
+        Property *replaced = _slots[i].prop;
+        if(!_slots[i].atom) {
+          _slots[i].atom = atom;
+          ++_count;
+        }
+        _slots[i].prop = prop;
+        return replaced;
+      }
+
       /// this does some magic so that it calls get string/int/double/pointer appropriately
       template<> int GetHook::getProperty<IntValue>(const std::string &name, int index) const OFX_EXCEPTION_SPEC
       {
@@ -192,7 +324,19 @@ namespace OFX {
                          TypeEnum type,
                          int dimension,
                          bool pluginReadOnly)
-        : _name(name)
+        : _atom(intern(name))
+        , _type(type)
+        , _dimension(dimension)
+        , _pluginReadOnly(pluginReadOnly) 
+        , _getHook(0)          
+      {
+      }
+
+      Property::Property(Atom name,
+                         TypeEnum type,
+                         int dimension,
+                         bool pluginReadOnly)
+        : _atom(name)
         , _type(type)
         , _dimension(dimension)
         , _pluginReadOnly(pluginReadOnly) 
@@ -201,7 +345,7 @@ namespace OFX {
       }
 
       Property::Property(const Property &other)
-        : _name(other._name)
+        : _atom(other._atom)
         , _type(other._type)
         , _dimension(other._dimension)
         , _pluginReadOnly(other._pluginReadOnly) 
@@ -214,7 +358,7 @@ namespace OFX {
       {
         std::vector<NotifyHook *>::iterator i;
         for(i = _notifyHooks.begin(); i != _notifyHooks.end(); ++i) {
-          (*i)->notify(_name,  single, indexOrN);
+          (*i)->notify(_atom->name,  single, indexOrN);
         }
       }
 
@@ -223,31 +367,31 @@ namespace OFX {
       inline double castToAPIType(double d) { return d; }
       inline const char *castToAPIType(const std::string &s) { return s.c_str(); }
 
-      template<class T> PropertyTemplate<T>::PropertyTemplate(const std::string &name,					    
-        int dimension,													    
-        bool /*pluginReadOnly*/,
-        APIType defaultValue)												    
-        : Property(name, T::typeCode, dimension)									    
-      {															    
-															    
-        if (dimension) {												    
-          _value.resize(dimension);											    
-          _defaultValue.resize(dimension);										    
-        }														    
-															    
-        if (dimension) {												    
-          for (int i=0;i<dimension;i++) {										    
-            _defaultValue[i] = defaultValue;										    
-            _value[i] = defaultValue;											    
-          }														    
-        }														    
-      }															    
-															    
-      template<class T> PropertyTemplate<T>::PropertyTemplate(const PropertyTemplate<T> &pt)				    
-        : Property(pt)													    
-        , _value(pt._value)												    
-        , _defaultValue(pt._defaultValue)										    
-      {															    
+      template<class T> PropertyTemplate<T>::PropertyTemplate(const std::string &name,
+                                                              int dimension,
+                                                              bool /*pluginReadOnly*/,
+                                                              APIType defaultValue)
+        : Property(name, T::typeCode, dimension)
+        , _value(dimension, defaultValue)
+        , _defaultValue(dimension, defaultValue)
+      {
+      }
+
+      template<class T> PropertyTemplate<T>::PropertyTemplate(Atom name,
+                                                              int dimension,
+                                                              bool /*pluginReadOnly*/,
+                                                              APIType defaultValue)
+        : Property(name, T::typeCode, dimension)
+        , _value(dimension, defaultValue)
+        , _defaultValue(dimension, defaultValue)
+      {
+      }
+
+      template<class T> PropertyTemplate<T>::PropertyTemplate(const PropertyTemplate<T> &pt)
+        : Property(pt)
+        , _value(pt._value)
+        , _defaultValue(pt._defaultValue)
+      {
       }
 
 #ifdef WINDOWS
@@ -258,7 +402,7 @@ namespace OFX {
       const typename T::ReturnType PropertyTemplate<T>::getValue(int index) const OFX_EXCEPTION_SPEC 
       {
         if (_getHook) {
-          return _getHook->getProperty<T>(_name, index);
+          return _getHook->getProperty<T>(getName(), index);
         } 
         else {
           return getValueRaw(index);
@@ -271,7 +415,7 @@ namespace OFX {
       template<class T> 
       void PropertyTemplate<T>::getValueN(typename T::APIType *values, int count) const OFX_EXCEPTION_SPEC {
         if (_getHook) {
-          _getHook->getPropertyN<T>(_name, values, count);
+          _getHook->getPropertyN<T>(getName(), values, count);
         } 
         else {
           getValueNRaw(values, count);
@@ -346,7 +490,7 @@ namespace OFX {
         else {
           // code to get it from the hook
           if (_getHook) {
-            return _getHook->getDimension(_name);
+            return _getHook->getDimension(getName());
           } 
           else {
             return (int)_value.size();
@@ -357,14 +501,14 @@ namespace OFX {
       template <class T> void PropertyTemplate<T>::reset() OFX_EXCEPTION_SPEC 
       {
         if (_getHook) {
-          _getHook->reset(_name);
+          _getHook->reset(getName());
           int dim = getDimension();
 
           if(!isFixedSize()) {
             _value.resize(dim);
           }
           for(int i = 0; i < dim; ++i) {
-            _value[i] = _getHook->getProperty<T>(_name, i);
+            _value[i] = _getHook->getProperty<T>(getName(), i);
           }
         } 
         else {
@@ -418,19 +562,21 @@ namespace OFX {
         }
       }
 
-      Property *Set::fetchProperty(const std::string&name, bool followChain) const
+      Property *Set::fetchProperty(const std::string &name, bool followChain) const
       {
-        PropertyMap::const_iterator i = _props.find(name);
-        if (i == _props.end()) {
-          if(followChain && _chainedSet) {
-            return _chainedSet->fetchProperty(name, true);
-          }
+        return fetchProperty(name.c_str(), followChain);
+      }
+
+      Property *Set::fetchProperty(const char *name, bool followChain) const
+      {
+        // a name that was never interned can't be in any set
+        Atom atom = findAtom(name);
+        if(!atom) 
           return NULL;
-        }
-        return i->second;
+        return fetchProperty(atom, followChain);
       }
 
-      template<class T> bool Set::fetchTypedProperty(const std::string&name, T *&prop, bool followChain) const
+      template<class T> bool Set::fetchTypedProperty(const char *name, T *&prop, bool followChain) const
       {
         Property *myprop = fetchProperty(name, followChain);
 
@@ -444,6 +590,11 @@ namespace OFX {
         return true;
       }
 
+      template<class T> bool Set::fetchTypedProperty(const std::string &name, T *&prop, bool followChain) const
+      {
+        return fetchTypedProperty(name.c_str(), prop, followChain);
+      }
+
       String *Set::fetchStringProperty(const std::string &name, bool followChain) const {
         String *p;
         if (fetchTypedProperty(name, p, followChain)) {
@@ -476,60 +627,166 @@ namespace OFX {
         return NULL;
       }
 
+      ////////////////////////////////////////////////////////////////////////////////
+      // property slabs
+
+      /// Header of a block of memory that a run of properties made by addProperties are
+      /// placement new'd into. The properties follow the header directly.
+      struct Set::Slab {
+        Slab *next;  ///< next slab in the set
+        char *begin; ///< first byte of property storage
+        char *end;   ///< one past the last byte of property storage
+      };
+
+      namespace {
+        /// alignment of each property in a slab
+        const size_t kSlabAlign = 16;
+
+        /// round up to the slab alignment
+        inline size_t slabRound(size_t n)
+        {
+          return (n + kSlabAlign - 1) & ~(kSlabAlign - 1);
+        }
+
+        /// the room a property made from the given spec takes in a slab
+        size_t slabSize(const PropSpec &spec)
+        {
+          switch (spec.type) {
+          case eInt:     return slabRound(sizeof(Int));
+          case eDouble:  return slabRound(sizeof(Double));
+          case eString:  return slabRound(sizeof(String));
+          case ePointer: return slabRound(sizeof(Pointer));
+          default:       return 0;
+          }
+        }
+
+        /// make a property from the spec, in the given memory, or on the heap if that is NULL
+        Property *constructProperty(const PropSpec &spec, void *where)
+        {
+          Atom name = intern(spec.name);
+          switch (spec.type) {
+          case eInt: 
+            if(where) return new (where) Int(name, spec.dimension, spec.readonly, spec.defaultValue?atoi(spec.defaultValue):0);
+            return new Int(name, spec.dimension, spec.readonly, spec.defaultValue?atoi(spec.defaultValue):0);
+          case eDouble: 
+            if(where) return new (where) Double(name, spec.dimension, spec.readonly, spec.defaultValue?atof(spec.defaultValue):0);
+            return new Double(name, spec.dimension, spec.readonly, spec.defaultValue?atof(spec.defaultValue):0);
+          case eString: 
+            if(where) return new (where) String(name, spec.dimension, spec.readonly, spec.defaultValue?spec.defaultValue:"");
+            return new String(name, spec.dimension, spec.readonly, spec.defaultValue?spec.defaultValue:"");
+          case ePointer: 
+            if(where) return new (where) Pointer(name, spec.dimension, spec.readonly, (void*)spec.defaultValue);
+            return new Pointer(name, spec.dimension, spec.readonly, (void*)spec.defaultValue);
+          default: // XXX  error - unrecognised type
+            return NULL;
+          }
+        }
+      }
+
       /// add one new property
       void Set::createProperty(const PropSpec &spec)
       {
-        if (_props.find(spec.name) != _props.end()) {
+        if (fetchProperty(spec.name)) {
 #         ifdef OFX_DEBUG_PROPERTIES
           std::cout << "OFX: Tried to add a duplicate property to a Property::Set: " << spec.name << std::endl;
 #         endif
           return;
         }
 
-        switch (spec.type) {
-        case eInt: 
-          _props[spec.name] = new Int(spec.name, spec.dimension, spec.readonly, spec.defaultValue?atoi(spec.defaultValue):0);
-          break;
-        case eDouble: 
-          _props[spec.name] = new Double(spec.name, spec.dimension, spec.readonly, spec.defaultValue?atof(spec.defaultValue):0);
-          break;
-        case eString: 
-          _props[spec.name] = new String(spec.name, spec.dimension, spec.readonly, spec.defaultValue?spec.defaultValue:"");
-          break;
-        case ePointer: 
-          _props[spec.name] = new Pointer(spec.name, spec.dimension, spec.readonly, (void*)spec.defaultValue);
-          break;
-        default: // XXX  error - unrecognised type
-          break;
+        Property *prop = constructProperty(spec, NULL);
+        if(prop) {
+          _props.insert(prop);
+          _propsByNameDirty = true;
         }
       }
 
       void Set::addProperties(const PropSpec spec[]) 
       {
-        while (spec->name) {
-          createProperty(*spec);          
-          spec++;
+        // size up the whole table
+        int count = 0;
+        size_t bytes = 0;
+        for(const PropSpec *s = spec; s->name; ++s) {
+          bytes += slabSize(*s);
+          ++count;
+        }
+        if(count == 0)
+          return;
+
+        // and make the one block they all go in
+        size_t headerBytes = slabRound(sizeof(Slab));
+        char *memory = (char *) ::operator new(headerBytes + bytes);
+        Slab *slab = (Slab *) memory;
+        slab->begin = slab->end = memory + headerBytes;
+        slab->next = _slabs;
+        _slabs = slab;
+
+        _props.reserve(count);
+        for(; spec->name; ++spec) {
+          if (fetchProperty(spec->name)) {
+#           ifdef OFX_DEBUG_PROPERTIES
+            std::cout << "OFX: Tried to add a duplicate property to a Property::Set: " << spec->name << std::endl;
+#           endif
+            continue;
+          }
+          Property *prop = constructProperty(*spec, slab->end);
+          if(prop) {
+            slab->end += slabSize(*spec);
+            _props.insert(prop);
+          }
+        }
+        _propsByNameDirty = true;
+      }
+
+      /// delete the property, which may live in one of our slabs
+      void Set::destroyProperty(Property *prop)
+      {
+        for(Slab *slab = _slabs; slab; slab = slab->next) {
+          if((char *) prop >= slab->begin && (char *) prop < slab->end) {
+            prop->~Property();
+            return;
+          }
         }
+        delete prop;
       }
 
       /// add one new property
       void Set::addProperty(Property *prop)
       {
-        PropertyMap::iterator t = _props.find(prop->getName());
-        if(t != _props.end())
-           delete t->second;
-        _props[prop->getName()] = prop;
+        Property *replaced = _props.insert(prop);
+        if(replaced && replaced != prop)
+          destroyProperty(replaced);
+        _propsByNameDirty = true;
+      }
+
+      /// rebuild the sorted view of the properties if we need to
+      const PropertyMap &Set::getProperties() const
+      {
+        Thread::AutoMutex lock(_propsByNameLock);
+        if(_propsByNameDirty) {
+          _propsByName.clear();
+          const std::vector<PropertyIndex::Slot> &slots = _props.getSlots();
+          for(std::vector<PropertyIndex::Slot>::const_iterator i = slots.begin(); i != slots.end(); ++i) {
+            if(i->atom) 
+              _propsByName[i->atom->name] = i->prop;
+          }
+          _propsByNameDirty = false;
+        }
+        return _propsByName;
       }
 
       /// empty ctor
       Set::Set()
         : _magic(kMagic)
+        , _slabs(NULL)
+        , _propsByNameDirty(false)
         , _chainedSet(NULL) 
       {
       }
 
       Set::Set(const PropSpec spec[])
         : _magic(kMagic)
+        , _slabs(NULL)
+        , _propsByNameDirty(false)
         , _chainedSet(NULL) 
       {
         addProperties(spec);
@@ -537,43 +794,37 @@ namespace OFX {
 
       Set::Set(const Set &other) 
         : _magic(kMagic)
+        , _slabs(NULL)
+        , _propsByNameDirty(true)
         , _chainedSet(NULL) 
       {
-        bool failed = false;
-
-        for (std::map<std::string, Property *>::const_iterator i = other._props.begin();
-             i != other._props.end();
-             i++) 
-          {
-            Property *copyProp = i->second->deepCopy();
-            if (!copyProp) {
-              failed = true;
-              break;
-            }
-            _props[i->first] = copyProp;
+        const std::vector<PropertyIndex::Slot> &slots = other._props.getSlots();
+        _props.reserve(other._props.size());
+        for(std::vector<PropertyIndex::Slot>::const_iterator i = slots.begin(); i != slots.end(); ++i) {
+          if(i->atom) {
+            Property *copyProp = i->prop->deepCopy();
+            if(copyProp) 
+              _props.insert(copyProp);
           }
-        
-        if (failed)
-          
-          for (std::map<std::string, Property *>::iterator j = _props.begin();
-               j != _props.end();
-               j++) {
-            delete j->second;
-          }
-        
+        }
       }
 
       Set::~Set()
       {
-        std::map<std::string, Property *>::iterator i = _props.begin();
-        while (i != _props.end()) {
-          delete i->second;
-          i++;
+        const std::vector<PropertyIndex::Slot> &slots = _props.getSlots();
+        for(std::vector<PropertyIndex::Slot>::const_iterator i = slots.begin(); i != slots.end(); ++i) {
+          if(i->atom)
+            destroyProperty(i->prop);
+        }
+        while(_slabs) {
+          Slab *next = _slabs->next;
+          ::operator delete(_slabs);
+          _slabs = next;
         }
       }
 
       /// set a particular property
-      template<class T> void Set::setProperty(const std::string &property, int index, const typename T::Type &value) 
+      template<class T> void Set::setProperty(const char *property, int index, const typename T::Type &value) 
       {
         try {
           PropertyTemplate<T> *prop = 0;
@@ -585,7 +836,7 @@ namespace OFX {
       }
       
       /// set a particular property
-      template<class T> void Set::setPropertyN(const std::string &property, int count, const typename T::APIType *value) 
+      template<class T> void Set::setPropertyN(const char *property, int count, const typename T::APIType *value) 
       {
         try {
           PropertyTemplate<T> *prop = 0;
@@ -597,7 +848,7 @@ namespace OFX {
       }
       
       /// get a particular property
-      template<class T> typename T::ReturnType Set::getProperty(const std::string &property, int index)  const
+      template<class T> typename T::ReturnType Set::getProperty(const char *property, int index)  const
       {
         try {
           PropertyTemplate<T> *prop;
@@ -610,7 +861,7 @@ namespace OFX {
       }
 
       /// get a particular property
-      template<class T> void Set::getPropertyN(const std::string &property, int count,  typename T::APIType *value)  const
+      template<class T> void Set::getPropertyN(const char *property, int count,  typename T::APIType *value)  const
       {
         try {
           PropertyTemplate<T> *prop;
@@ -622,7 +873,7 @@ namespace OFX {
       }
       
       /// get a particular property
-      template<class T> typename T::ReturnType Set::getPropertyRaw(const std::string &property, int index)  const
+      template<class T> typename T::ReturnType Set::getPropertyRaw(const char *property, int index)  const
       {
         try {
           PropertyTemplate<T> *prop;
@@ -635,7 +886,7 @@ namespace OFX {
       }
       
       /// get a particular property
-      template<class T> void Set::getPropertyRawN(const std::string &property, int count,  typename T::APIType *value)  const
+      template<class T> void Set::getPropertyRawN(const char *property, int count,  typename T::APIType *value)  const
       {
         try {
           PropertyTemplate<T> *prop;
@@ -647,25 +898,25 @@ namespace OFX {
       }
       
       /// get a particular int property
-      int Set::getIntPropertyRaw(const std::string &property, int index) const
+      int Set::getIntPropertyRaw(const char *property, int index) const
       {
         return getPropertyRaw<OFX::Host::Property::IntValue>(property, index);
       }
         
       /// get a particular double property
-      double Set::getDoublePropertyRaw(const std::string &property, int index)  const
+      double Set::getDoublePropertyRaw(const char *property, int index)  const
       {
         return getPropertyRaw<OFX::Host::Property::DoubleValue>(property, index);
       }
 
       /// get a particular double property
-      void *Set::getPointerPropertyRaw(const std::string &property, int index)  const
+      void *Set::getPointerPropertyRaw(const char *property, int index)  const
       {
         return getPropertyRaw<OFX::Host::Property::PointerValue>(property, index);
       }
         
       /// get a particular double property
-      const std::string &Set::getStringPropertyRaw(const std::string &property, int index)  const
+      const std::string &Set::getStringPropertyRaw(const char *property, int index)  const
       {
         String *prop;
         if(fetchTypedProperty(property, prop, true)) {
@@ -675,79 +926,79 @@ namespace OFX {
       }
 
       /// get a particular int property
-      int Set::getIntProperty(const std::string &property, int index)  const
+      int Set::getIntProperty(const char *property, int index)  const
       {
         return getProperty<OFX::Host::Property::IntValue>(property, index);
       }
         
       /// get the value of a particular double property
-      void Set::getIntPropertyN(const std::string &property,  int *v, int N) const
+      void Set::getIntPropertyN(const char *property,  int *v, int N) const
       {
         return getPropertyN<OFX::Host::Property::IntValue>(property, N, v);
       }
 
       /// get a particular double property
-      double Set::getDoubleProperty(const std::string &property, int index)  const
+      double Set::getDoubleProperty(const char *property, int index)  const
       {
         return getProperty<OFX::Host::Property::DoubleValue>(property, index);
       }
 
       /// get the value of a particular double property
-      void Set::getDoublePropertyN(const std::string &property,  double *v, int N) const
+      void Set::getDoublePropertyN(const char *property,  double *v, int N) const
       {
         return getPropertyN<OFX::Host::Property::DoubleValue>(property, N, v);
       }
 
       /// get a particular double property
-      void *Set::getPointerProperty(const std::string &property, int index)  const
+      void *Set::getPointerProperty(const char *property, int index)  const
       {
         return getProperty<OFX::Host::Property::PointerValue>(property, index);
       }
         
       /// get a particular double property
-      const std::string &Set::getStringProperty(const std::string &property, int index)  const
+      const std::string &Set::getStringProperty(const char *property, int index)  const
       {
         return getProperty<OFX::Host::Property::StringValue>(property, index);
       }
       
       /// set a particular string property
-      void Set::setStringProperty(const std::string &property, const std::string &value, int index)
+      void Set::setStringProperty(const char *property, const std::string &value, int index)
       {
         setProperty<OFX::Host::Property::StringValue>(property, index, value);
       }
       
       /// get a particular int property
-      void Set::setIntProperty(const std::string &property, int v, int index)
+      void Set::setIntProperty(const char *property, int v, int index)
       {
         setProperty<OFX::Host::Property::IntValue>(property, index, v);
       }
       
       /// get a particular double property
-      void Set::setIntPropertyN(const std::string &property, const int *v, int N)
+      void Set::setIntPropertyN(const char *property, const int *v, int N)
       {
         setPropertyN<OFX::Host::Property::IntValue>(property, N, v);
       }
 
       /// get a particular double property
-      void Set::setDoubleProperty(const std::string &property, double v, int index)
+      void Set::setDoubleProperty(const char *property, double v, int index)
       {
         setProperty<OFX::Host::Property::DoubleValue>(property, index, v);
       }
       
       /// get a particular double property
-      void Set::setDoublePropertyN(const std::string &property, const double *v, int N)
+      void Set::setDoublePropertyN(const char *property, const double *v, int N)
       {
         setPropertyN<OFX::Host::Property::DoubleValue>(property, N, v);
       }
 
       /// get a particular double property
-      void Set::setPointerProperty(const std::string &property,  void *v, int index)
+      void Set::setPointerProperty(const char *property,  void *v, int index)
       {
         setProperty<OFX::Host::Property::PointerValue>(property, index, v);
       }
         
       /// get the dimension of a particular property
-      int Set::getDimension(const std::string &property) const
+      int Set::getDimension(const char *property) const
       {
         Property *prop = 0;
         if(fetchTypedProperty(property, prop, true)) {
@@ -756,6 +1007,25 @@ namespace OFX {
         return 0;
       }
 
+      /// the std::string flavours of the above
+      int Set::getIntPropertyRaw(const std::string &property, int index) const { return getIntPropertyRaw(property.c_str(), index); }
+      double Set::getDoublePropertyRaw(const std::string &property, int index) const { return getDoublePropertyRaw(property.c_str(), index); }
+      void *Set::getPointerPropertyRaw(const std::string &property, int index) const { return getPointerPropertyRaw(property.c_str(), index); }
+      const std::string &Set::getStringPropertyRaw(const std::string &property, int index) const { return getStringPropertyRaw(property.c_str(), index); }
+      int Set::getIntProperty(const std::string &property, int index) const { return getIntProperty(property.c_str(), index); }
+      void Set::getIntPropertyN(const std::string &property, int *v, int N) const { getIntPropertyN(property.c_str(), v, N); }
+      double Set::getDoubleProperty(const std::string &property, int index) const { return getDoubleProperty(property.c_str(), index); }
+      void Set::getDoublePropertyN(const std::string &property, double *v, int N) const { getDoublePropertyN(property.c_str(), v, N); }
+      void *Set::getPointerProperty(const std::string &property, int index) const { return getPointerProperty(property.c_str(), index); }
+      const std::string &Set::getStringProperty(const std::string &property, int index) const { return getStringProperty(property.c_str(), index); }
+      void Set::setStringProperty(const std::string &property, const std::string &value, int index) { setStringProperty(property.c_str(), value, index); }
+      void Set::setIntProperty(const std::string &property, int v, int index) { setIntProperty(property.c_str(), v, index); }
+      void Set::setIntPropertyN(const std::string &property, const int *v, int N) { setIntPropertyN(property.c_str(), v, N); }
+      void Set::setDoubleProperty(const std::string &property, double v, int index) { setDoubleProperty(property.c_str(), v, index); }
+      void Set::setDoublePropertyN(const std::string &property, const double *v, int N) { setDoublePropertyN(property.c_str(), v, N); }
+      void Set::setPointerProperty(const std::string &property, void *v, int index) { setPointerProperty(property.c_str(), v, index); }
+      int Set::getDimension(const std::string &property) const { return getDimension(property.c_str()); }
+
       /// is the given string one of the values of a multi-dimensional string prop
       /// this returns a non negative index if it is found, otherwise, -1
       int Set::findStringPropValueIndex(const std::string &propName,
@@ -764,10 +1034,10 @@ namespace OFX {
         String *prop = fetchStringProperty(propName, true);
         
         if(prop) {
-          const std::vector<std::string> &values = prop->getValues();
-          std::vector<std::string>::const_iterator i = find(values.begin(), values.end(), propValue);
-          if(i != values.end()) {
-            return int(i - values.begin());
+          const PropertyValues<std::string> &values = prop->getValuesRaw();
+          for(size_t i = 0; i < values.size(); ++i) {
+            if(values[i] == propValue) 
+              return int(i);
           }
         }
         return -1;
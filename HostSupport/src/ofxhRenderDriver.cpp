@@ -0,0 +1,228 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <map>
+
+// ofx
+#include "ofxCore.h"
+#include "ofxImageEffect.h"
+
+// ofx host
+#include "ofxhBinary.h"
+#include "ofxhPropertySuite.h"
+#include "ofxhClip.h"
+#include "ofxhParam.h"
+#include "ofxhImageEffect.h"
+#include "ofxhPluginAPICache.h"
+#include "ofxhPluginCache.h"
+#include "ofxhHost.h"
+#include "ofxhImageEffectAPI.h"
+#include "ofxhThread.h"
+#include "ofxhRenderDriver.h"
+
+namespace OFX {
+
+  namespace Host {
+
+    namespace ImageEffect {
+
+      /// The lock that keeps renders of an unsafe plugin one at a time. These live as
+      /// long as the program, as plugins are never unloaded while renders could happen.
+      static Thread::Mutex &getUnsafeRenderLock(ImageEffectPlugin *plugin)
+      {
+        static Thread::Mutex registryLock;
+        static std::map<ImageEffectPlugin *, Thread::Mutex *> locks;
+
+        Thread::AutoMutex lock(registryLock);
+        Thread::Mutex *&m = locks[plugin];
+        if(!m)
+          m = new Thread::Mutex;
+        return *m;
+      }
+
+      /// is a status one that means an action went OK
+      static bool succeeded(OfxStatus st)
+      {
+        return st == kOfxStatOK || st == kOfxStatReplyDefault;
+      }
+
+      /// a call to RenderDriver::render in progress
+      struct RenderDriver::Job {
+        Client                  *client;
+        std::vector<Instance *>  instances;   ///< the instance each thread renders on
+        OfxTime                  first;
+        OfxTime                  step;
+        unsigned int             nFrames;
+        bool                     sequential;
+        bool                     interactive;
+
+        Thread::AtomicCount      framesTaken; ///< frames handed out, the next one to hand out is this one
+        Thread::AtomicCount      failures;    ///< frames that failed, no more are started once there is one
+        Thread::Mutex            lock;        ///< guards status
+        OfxStatus                status;      ///< the first failure, or kOfxStatOK
+      };
+
+      RenderDriver::RenderDriver(Instance &instance, Client &client)
+        : _instance(instance)
+        , _client(client)
+        , _maxThreads(0)
+      {
+      }
+
+      RenderDriver::~RenderDriver()
+      {
+        for(std::vector<Instance *>::iterator i = _clones.begin(); i != _clones.end(); ++i)
+          delete *i;
+      }
+
+      void RenderDriver::renderThread(unsigned int threadIndex, unsigned int /*threadMax*/, void *arg)
+      {
+        Job &job = *static_cast<Job *>(arg);
+        Instance &instance = *job.instances[threadIndex];
+
+        for(;;) {
+          if(job.failures.get() != 0)
+            return;
+          unsigned long frame = (unsigned long)(job.framesTaken.increment() - 1);
+          if(frame >= job.nFrames)
+            return;
+
+          OfxStatus st;
+          try {
+            // the frame's region of interest and render actions see the same param values
+            Param::SetInstance::RenderPin pin(instance);
+            st = job.client->renderFrame(instance, job.first + frame * job.step, job.sequential, job.interactive);
+          }
+          catch(...) {
+            st = kOfxStatFailed;
+          }
+
+          if(!succeeded(st)) {
+            Thread::AutoMutex lock(job.lock);
+            if(job.status == kOfxStatOK)
+              job.status = st;
+            job.failures.increment();
+          }
+        }
+      }
+
+      OfxStatus RenderDriver::render(OfxTime first, OfxTime last, OfxTime step, OfxPointD renderScale, bool interactive)
+      {
+        if(step <= 0)
+          step = 1;
+        if(last < first)
+          return kOfxStatOK;
+
+        Job job;
+        job.client = &_client;
+        job.first = first;
+        job.step = step;
+        job.nFrames = (unsigned int)((last - first) / step + 1e-6) + 1;
+        job.interactive = interactive;
+        job.status = kOfxStatOK;
+
+        // how many threads can we use
+        const std::string &safety = _instance.getRenderThreadSafety();
+        bool unsafe = safety == kOfxImageEffectRenderUnsafe;
+        bool instanceSafe = safety == kOfxImageEffectRenderInstanceSafe;
+
+        unsigned int nThreads = _maxThreads ? _maxThreads : Thread::WorkerPool::numCPUs();
+        if(nThreads > job.nFrames)
+          nThreads = job.nFrames;
+        if(unsafe)
+          nThreads = 1;
+
+        // set up the instance each thread renders on
+        if(instanceSafe) {
+          // clones kept from the last render may have stale params
+          for(std::vector<Instance *>::iterator i = _clones.begin(); i != _clones.end(); ) {
+            if(_client.syncInstance(**i, _instance))
+              ++i;
+            else {
+              delete *i;
+              i = _clones.erase(i);
+            }
+          }
+
+          while(_clones.size() + 1 < nThreads) {
+            Instance *clone = _client.cloneInstance(_instance);
+            if(!clone)
+              break;
+            _clones.push_back(clone);
+          }
+          if(nThreads > _clones.size() + 1)
+            nThreads = (unsigned int)_clones.size() + 1;
+
+          job.instances.push_back(&_instance);
+          job.instances.insert(job.instances.end(), _clones.begin(), _clones.begin() + (nThreads - 1));
+        }
+        else {
+          job.instances.assign(nThreads, &_instance);
+        }
+        job.sequential = nThreads == 1;
+
+        // only the instances we will render on need bracketing
+        std::vector<Instance *> used(job.instances.begin(), instanceSafe ? job.instances.end() : job.instances.begin() + 1);
+
+        // begin the render on all of them
+        OfxStatus st = kOfxStatOK;
+        std::vector<Instance *>::iterator begun = used.begin();
+        for(; begun != used.end(); ++begun) {
+          st = (*begun)->beginRenderAction(first, last, step, interactive, renderScale, job.sequential, interactive);
+          if(!succeeded(st))
+            break;
+        }
+
+        if(succeeded(st)) {
+          if(nThreads == 1) {
+            if(unsafe) {
+              Thread::AutoMutex lock(getUnsafeRenderLock(_instance.getPlugin()));
+              renderThread(0, 1, &job);
+            }
+            else
+              renderThread(0, 1, &job);
+          }
+          else 
+            Thread::WorkerPool::get().multiThread(renderThread, nThreads, &job);
+          st = job.status;
+        }
+
+        // end the render on every one we began
+        for(std::vector<Instance *>::iterator i = used.begin(); i != begun; ++i)
+          (*i)->endRenderAction(first, last, step, interactive, renderScale, job.sequential, interactive);
+
+        return st;
+      }
+
+    } // ImageEffect
+
+  } // Host
+
+} // OFX
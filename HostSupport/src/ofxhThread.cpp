@@ -0,0 +1,436 @@
+
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+* Neither the name The Open Effects Association Ltd, nor the names of its 
+contributors may be used to endorse or promote products derived from this
+software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#if defined(WINDOWS)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+// ofx host
+#include "ofxhThread.h"
+
+#if defined(WINDOWS)
+#define OFX_THREAD_LOCAL __declspec(thread)
+#else
+#define OFX_THREAD_LOCAL __thread
+#endif
+
+namespace OFX {
+
+  namespace Host {
+
+    namespace Thread {
+
+      ////////////////////////////////////////////////////////////////////////////////
+      // Mutex
+
+#if defined(WINDOWS)
+
+      Mutex::Mutex()
+      {
+        InitializeCriticalSection(&_handle);
+      }
+
+      Mutex::~Mutex()
+      {
+        DeleteCriticalSection(&_handle);
+      }
+
+      void Mutex::lock()
+      {
+        EnterCriticalSection(&_handle);
+      }
+
+      void Mutex::unlock()
+      {
+        LeaveCriticalSection(&_handle);
+      }
+
+      bool Mutex::tryLock()
+      {
+        return TryEnterCriticalSection(&_handle) != 0;
+      }
+
+#else
+
+      Mutex::Mutex()
+      {
+        pthread_mutex_init(&_handle, 0);
+      }
+
+      Mutex::~Mutex()
+      {
+        pthread_mutex_destroy(&_handle);
+      }
+
+      void Mutex::lock()
+      {
+        pthread_mutex_lock(&_handle);
+      }
+
+      void Mutex::unlock()
+      {
+        pthread_mutex_unlock(&_handle);
+      }
+
+      bool Mutex::tryLock()
+      {
+        return pthread_mutex_trylock(&_handle) == 0;
+      }
+
+#endif
+
+      ////////////////////////////////////////////////////////////////////////////////
+      // RecursiveMutex and Condition
+
+#if defined(WINDOWS)
+
+      // critical sections are recursive already
+      RecursiveMutex::RecursiveMutex()
+      {
+        InitializeCriticalSection(&_handle);
+      }
+
+      RecursiveMutex::~RecursiveMutex()
+      {
+        DeleteCriticalSection(&_handle);
+      }
+
+      void RecursiveMutex::lock()
+      {
+        EnterCriticalSection(&_handle);
+      }
+
+      void RecursiveMutex::unlock()
+      {
+        LeaveCriticalSection(&_handle);
+      }
+
+      bool RecursiveMutex::tryLock()
+      {
+        return TryEnterCriticalSection(&_handle) != 0;
+      }
+
+      Condition::Condition()
+      {
+        InitializeConditionVariable(&_handle);
+      }
+
+      Condition::~Condition()
+      {
+      }
+
+      void Condition::wait(Mutex &mutex)
+      {
+        SleepConditionVariableCS(&_handle, &mutex._handle, INFINITE);
+      }
+
+      void Condition::signal()
+      {
+        WakeConditionVariable(&_handle);
+      }
+
+      void Condition::broadcast()
+      {
+        WakeAllConditionVariable(&_handle);
+      }
+
+#else
+
+      RecursiveMutex::RecursiveMutex()
+      {
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+        pthread_mutex_init(&_handle, &attr);
+        pthread_mutexattr_destroy(&attr);
+      }
+
+      RecursiveMutex::~RecursiveMutex()
+      {
+        pthread_mutex_destroy(&_handle);
+      }
+
+      void RecursiveMutex::lock()
+      {
+        pthread_mutex_lock(&_handle);
+      }
+
+      void RecursiveMutex::unlock()
+      {
+        pthread_mutex_unlock(&_handle);
+      }
+
+      bool RecursiveMutex::tryLock()
+      {
+        return pthread_mutex_trylock(&_handle) == 0;
+      }
+
+      Condition::Condition()
+      {
+        pthread_cond_init(&_handle, 0);
+      }
+
+      Condition::~Condition()
+      {
+        pthread_cond_destroy(&_handle);
+      }
+
+      void Condition::wait(Mutex &mutex)
+      {
+        pthread_cond_wait(&_handle, &mutex._handle);
+      }
+
+      void Condition::signal()
+      {
+        pthread_cond_signal(&_handle);
+      }
+
+      void Condition::broadcast()
+      {
+        pthread_cond_broadcast(&_handle);
+      }
+
+#endif
+
+      ////////////////////////////////////////////////////////////////////////////////
+      // WorkerPool
+
+      /// index of the function this thread is running for multiThread
+      static OFX_THREAD_LOCAL unsigned int tlsThreadIndex = 0;
+
+      /// is this thread running a function for multiThread
+      static OFX_THREAD_LOCAL int tlsIsSpawned = 0;
+
+      /// what the render this thread is working for set, see WorkerPool::renderContext
+      static OFX_THREAD_LOCAL void *tlsRenderContext = 0;
+
+      WorkerPool::WorkerPool()
+        : _started(false)
+        , _stopping(false)
+      {
+      }
+
+      WorkerPool::~WorkerPool()
+      {
+        {
+          AutoMutex lock(_lock);
+          _stopping = true;
+          _work.broadcast();
+        }
+        for(std::vector<ThreadHandle>::iterator i = _threads.begin(); i != _threads.end(); ++i) {
+#if defined(WINDOWS)
+          WaitForSingleObject(*i, INFINITE);
+          CloseHandle(*i);
+#else
+          pthread_join(*i, 0);
+#endif
+        }
+      }
+
+      WorkerPool &WorkerPool::get()
+      {
+        static WorkerPool pool;
+        return pool;
+      }
+
+      unsigned int WorkerPool::numCPUs()
+      {
+#if defined(WINDOWS)
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwNumberOfProcessors > 0 ? (unsigned int) info.dwNumberOfProcessors : 1;
+#else
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        return n > 0 ? (unsigned int) n : 1;
+#endif
+      }
+
+      OfxStatus WorkerPool::threadIndex(unsigned int *threadIndex)
+      {
+        if(!threadIndex)
+          return kOfxStatFailed;
+        // the spec has threads multiThread did not spawn get index 0
+        *threadIndex = tlsIsSpawned ? tlsThreadIndex : 0;
+        return kOfxStatOK;
+      }
+
+      bool WorkerPool::isSpawnedThread()
+      {
+        return tlsIsSpawned != 0;
+      }
+
+      void *WorkerPool::renderContext()
+      {
+        return tlsRenderContext;
+      }
+
+      void WorkerPool::setRenderContext(void *context)
+      {
+        tlsRenderContext = context;
+      }
+
+#if defined(WINDOWS)
+      unsigned int __stdcall WorkerPool::workerEntry(void *pool)
+      {
+        static_cast<WorkerPool *>(pool)->workerLoop();
+        return 0;
+      }
+#else
+      void *WorkerPool::workerEntry(void *pool)
+      {
+        static_cast<WorkerPool *>(pool)->workerLoop();
+        return 0;
+      }
+#endif
+
+      void WorkerPool::startLocked()
+      {
+        if(_started)
+          return;
+        _started = true;
+
+        unsigned int nWorkers = numCPUs() - 1;
+        for(unsigned int i = 0; i < nWorkers; ++i) {
+#if defined(WINDOWS)
+          ThreadHandle thread = (HANDLE) _beginthreadex(0, 0, workerEntry, this, 0, 0);
+          if(!thread)
+            break;
+#else
+          ThreadHandle thread;
+          if(pthread_create(&thread, 0, workerEntry, this) != 0)
+            break;
+#endif
+          _threads.push_back(thread);
+        }
+      }
+
+      void WorkerPool::runIndex(Job &job, unsigned int index)
+      {
+        unsigned int oldIndex = tlsThreadIndex;
+        int oldIsSpawned = tlsIsSpawned;
+        void *oldContext = tlsRenderContext;
+
+        tlsThreadIndex = index;
+        tlsIsSpawned = 1;
+        tlsRenderContext = job.renderContext;
+        job.func(index, job.nThreads, job.customArg);
+
+        tlsThreadIndex = oldIndex;
+        tlsIsSpawned = oldIsSpawned;
+        tlsRenderContext = oldContext;
+      }
+
+      unsigned int WorkerPool::takeIndexLocked(Job &job)
+      {
+        unsigned int index = job.next++;
+        if(job.next == job.nThreads) {
+          for(std::list<Job *>::iterator i = _jobs.begin(); i != _jobs.end(); ++i) {
+            if(*i == &job) {
+              _jobs.erase(i);
+              break;
+            }
+          }
+        }
+        return index;
+      }
+
+      void WorkerPool::workerLoop()
+      {
+        AutoMutex lock(_lock);
+        for(;;) {
+          while(!_stopping && _jobs.empty())
+            _work.wait(_lock);
+          if(_stopping)
+            break;
+
+          Job &job = *_jobs.front();
+          unsigned int index = takeIndexLocked(job);
+
+          _lock.unlock();
+          runIndex(job, index);
+          _lock.lock();
+
+          if(--job.outstanding == 0)
+            _done.broadcast();
+        }
+      }
+
+      OfxStatus WorkerPool::multiThread(OfxThreadFunctionV1 func, unsigned int nThreads, void *customArg)
+      {
+        if(!func)
+          return kOfxStatFailed;
+        if(nThreads == 0)
+          return kOfxStatOK;
+
+        Job job;
+        job.func = func;
+        job.nThreads = nThreads;
+        job.customArg = customArg;
+        job.renderContext = tlsRenderContext;
+        job.next = 0;
+        job.outstanding = nThreads;
+
+        // nested, or nothing to share, so run it all here
+        if(isSpawnedThread() || nThreads == 1) {
+          for(unsigned int i = 0; i < nThreads; ++i)
+            runIndex(job, i);
+          return kOfxStatOK;
+        }
+
+        AutoMutex lock(_lock);
+        startLocked();
+        _jobs.push_back(&job);
+        _work.broadcast();
+
+        // do our share
+        while(job.next < job.nThreads) {
+          unsigned int index = takeIndexLocked(job);
+
+          _lock.unlock();
+          runIndex(job, index);
+          _lock.lock();
+
+          --job.outstanding;
+        }
+
+        // and wait for the workers to finish theirs
+        while(job.outstanding > 0)
+          _done.wait(_lock);
+
+        return kOfxStatOK;
+      }
+
+    } // Thread
+
+  } // Host
+
+} // OFX
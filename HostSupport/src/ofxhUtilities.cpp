@@ -32,33 +32,33 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace OFX {
 
+  /// the bit depths by rank, half goes above 1 and below 0, which short can't, so counts as deeper
+  const std::string &GetBitDepthOfRank(int rank)
+  {
+    static const std::string depths[] = {
+      kOfxBitDepthNone, kOfxBitDepthByte, kOfxBitDepthShort, kOfxBitDepthHalf, kOfxBitDepthFloat
+    };
+    static const int nDepths = sizeof(depths) / sizeof(depths[0]);
+    return rank > 0 && rank < nDepths ? depths[rank] : depths[0];
+  }
+
+  /// how deep a bit depth is
+  int GetBitDepthRank(const std::string &depth)
+  {
+    for(int rank = 1; GetBitDepthOfRank(rank) != kOfxBitDepthNone; ++rank) {
+      if(GetBitDepthOfRank(rank) == depth)
+        return rank;
+    }
+    return 0;
+  }
+
   /// get me deepest bit depth 
   std::string FindDeepestBitDepth(const std::string &s1, const std::string &s2)
   {
-    if(s1 == kOfxBitDepthNone) {
-      return s2;
-    }
-    else if(s1 == kOfxBitDepthByte) {
-      if(s2 == kOfxBitDepthShort || s2 == kOfxBitDepthFloat)
-        return s2;
-      return s1;
-    }
-    else if(s1 == kOfxBitDepthShort) {
-      if(s2 == kOfxBitDepthFloat)
-        return s2;
-      return s1;
-    }
-    else if(s1 == kOfxBitDepthHalf) {
-      if(s2 == kOfxBitDepthFloat)
-        return s2;
-      return s1;
-    }
-    else if(s1 == kOfxBitDepthFloat) {
-      return s1;
-    }
-    else {
-      return s2; // oooh this might be bad dad.
-    }
+    int rank1 = GetBitDepthRank(s1);
+    if(rank1 == 0)
+      return s2; // none, or oooh this might be bad dad.
+    return GetBitDepthRank(s2) > rank1 ? s2 : s1;
   }
 
 }
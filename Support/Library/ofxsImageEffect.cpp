@@ -38,6 +38,7 @@ England
 
 #include "ofxsSupportPrivate.h"
 #include <algorithm> // for find
+#include <iomanip> // for setw
 #include <cstring> // for strlen
 #ifdef DEBUG
 #include <iostream>
@@ -48,6 +49,14 @@ England
 #endif
 #include "ofxsCore.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <mach/mach_time.h>
+#else
+#include <time.h>
+#endif
+
 #if defined __APPLE__ || defined linux || defined __FreeBSD__
 # if __GNUC__ >= 4
 #  define EXPORT __attribute__((visibility("default")))
@@ -156,6 +165,7 @@ namespace OFX {
     OfxProgressSuiteV2    *gProgressSuiteV2 = 0;
     OfxTimeLineSuiteV1    *gTimeLineSuite = 0;
     OfxParametricParameterSuiteV1 *gParametricParameterSuite = 0;
+    NetSfOfxParameterBatchSuiteV1 *gParamBatchSuite = 0;
 #ifdef OFX_SUPPORTS_OPENGLRENDER
     OfxImageEffectOpenGLRenderSuiteV1 *gOpenGLRenderSuite = 0;
 #endif
@@ -763,12 +773,23 @@ namespace OFX {
   {
     OFX::Validation::validateImageBaseProperties(props);
 
-    // and fetch all the properties
-    _rowBytes         = _imageProps.propGetInt(kOfxImagePropRowBytes);
-    _pixelAspectRatio = _imageProps.propGetDouble(kOfxImagePropPixelAspectRatio);;
-      
-    std::string str  = _imageProps.propGetString(kOfxImageEffectPropComponents);
-    _pixelComponents = mapStrToPixelComponentEnum(str);
+    // and fetch all the properties in one go, the rects and points are fetched straight into ours
+    const char *components = 0, *depth = 0, *preMultiplication = 0, *field = 0, *uniqueID = 0;
+    const PropertySet::SnapshotEntry entries[] = {
+      {kOfxImagePropRowBytes,                eInt,    1, &_rowBytes,           false},
+      {kOfxImagePropPixelAspectRatio,        eDouble, 1, &_pixelAspectRatio,   false},
+      {kOfxImageEffectPropComponents,        eString, 1, &components,          false},
+      {kOfxImageEffectPropPixelDepth,        eString, 1, &depth,               false},
+      {kOfxImageEffectPropPreMultiplication, eString, 1, &preMultiplication,   false},
+      {kOfxImagePropRegionOfDefinition,      eInt,    4, &_regionOfDefinition, false},
+      {kOfxImagePropBounds,                  eInt,    4, &_bounds,             false},
+      {kOfxImagePropField,                   eString, 1, &field,               false},
+      {kOfxImagePropUniqueIdentifier,        eString, 1, &uniqueID,            false},
+      {kOfxImageEffectPropRenderScale,       eDouble, 2, &_renderScale,        false},
+    };
+    _imageProps.propGetSnapshot(entries, sizeof(entries) / sizeof(entries[0]));
+
+    _pixelComponents = mapStrToPixelComponentEnum(components ? components : "");
 
     switch (_pixelComponents) {
       case ePixelComponentAlpha:
@@ -789,8 +810,7 @@ namespace OFX {
         break;
     }
 
-    str = _imageProps.propGetString(kOfxImageEffectPropPixelDepth);
-    _pixelDepth = mapStrToBitDepthEnum(str);
+    _pixelDepth = mapStrToBitDepthEnum(depth ? depth : "");
 
     // compute bytes per pixel
     _pixelBytes = _pixelComponentCount;
@@ -805,20 +825,9 @@ namespace OFX {
     case eBitDepthCustom : _pixelBytes *= 0; break;
     }
 
-    str = _imageProps.propGetString(kOfxImageEffectPropPreMultiplication);
-    _preMultiplication =  mapStrToPreMultiplicationEnum(str);
+    _preMultiplication =  mapStrToPreMultiplicationEnum(preMultiplication ? preMultiplication : "");
 
-    _regionOfDefinition.x1 = _imageProps.propGetInt(kOfxImagePropRegionOfDefinition, 0);
-    _regionOfDefinition.y1 = _imageProps.propGetInt(kOfxImagePropRegionOfDefinition, 1);
-    _regionOfDefinition.x2 = _imageProps.propGetInt(kOfxImagePropRegionOfDefinition, 2);
-    _regionOfDefinition.y2 = _imageProps.propGetInt(kOfxImagePropRegionOfDefinition, 3);
-
-    _bounds.x1 = _imageProps.propGetInt(kOfxImagePropBounds, 0);
-    _bounds.y1 = _imageProps.propGetInt(kOfxImagePropBounds, 1);
-    _bounds.x2 = _imageProps.propGetInt(kOfxImagePropBounds, 2);
-    _bounds.y2 = _imageProps.propGetInt(kOfxImagePropBounds, 3);
-
-    str = _imageProps.propGetString(kOfxImagePropField);
+    std::string str(field ? field : "");
     if(str == kOfxImageFieldNone) {
       _field = eFieldNone;
     }
@@ -836,10 +845,7 @@ namespace OFX {
       _field = eFieldNone;
     }
 
-    _uniqueID = _imageProps.propGetString(kOfxImagePropUniqueIdentifier);
-
-    _renderScale.x = _imageProps.propGetDouble(kOfxImageEffectPropRenderScale, 0);
-    _renderScale.y = _imageProps.propGetDouble(kOfxImageEffectPropRenderScale, 1);
+    _uniqueID = uniqueID ? uniqueID : "";
   }
 
   ImageBase::~ImageBase()
@@ -855,7 +861,10 @@ namespace OFX {
 
     // and fetch all the properties
     // should throw if it is not an image
-    _pixelData = _imageProps.propGetPointer(kOfxImagePropData);
+    const PropertySet::SnapshotEntry entries[] = {
+      {kOfxImagePropData, ePointer, 1, &_pixelData, false},
+    };
+    _imageProps.propGetSnapshot(entries, 1);
   }
 
   Image::~Image()
@@ -872,8 +881,11 @@ namespace OFX {
     OFX::Validation::validateTextureProperties(props);
 
     // should throw if it is not a texture
-    _index = _imageProps.propGetInt(kOfxImageEffectPropOpenGLTextureIndex);
-    _target = _imageProps.propGetInt(kOfxImageEffectPropOpenGLTextureTarget);
+    const PropertySet::SnapshotEntry entries[] = {
+      {kOfxImageEffectPropOpenGLTextureIndex,  eInt, 1, &_index,  false},
+      {kOfxImageEffectPropOpenGLTextureTarget, eInt, 1, &_target, false},
+    };
+    _imageProps.propGetSnapshot(entries, 2);
   }
 
   Texture::~Texture()
@@ -1934,6 +1946,7 @@ namespace OFX {
         gProgressSuiteV2 = (OfxProgressSuiteV2 *)     fetchSuite(kOfxProgressSuite, 2, true);
         gTimeLineSuite   = (OfxTimeLineSuiteV1 *)     fetchSuite(kOfxTimeLineSuite, 1, true);
         gParametricParameterSuite = (OfxParametricParameterSuiteV1*) fetchSuite(kOfxParametricParameterSuite, 1, true);
+        gParamBatchSuite = (NetSfOfxParameterBatchSuiteV1 *) fetchSuite(kNetSfOfxParameterBatchSuite, 1, true);
 #ifdef OFX_SUPPORTS_OPENGLRENDER
         gOpenGLRenderSuite = (OfxImageEffectOpenGLRenderSuiteV1*) fetchSuite(kOfxOpenGLRenderSuite, 1, true);
 #endif
@@ -1981,6 +1994,7 @@ namespace OFX {
         gMessageSuiteV2 = 0;
         gInteractSuite = 0;
         gParametricParameterSuite = 0;
+        gParamBatchSuite = 0;
       }
 
       {
@@ -2065,32 +2079,39 @@ namespace OFX {
     static void
       getRenderActionArguments(RenderArguments &args,  OFX::PropertySet inArgs)
     {
-      args.time = inArgs.propGetDouble(kOfxPropTime);
-
-      args.renderScale.x = inArgs.propGetDouble(kOfxImageEffectPropRenderScale, 0);
-      args.renderScale.y = inArgs.propGetDouble(kOfxImageEffectPropRenderScale, 1);
-
-      args.renderWindow.x1 = inArgs.propGetInt(kOfxImageEffectPropRenderWindow, 0);
-      args.renderWindow.y1 = inArgs.propGetInt(kOfxImageEffectPropRenderWindow, 1);
-      args.renderWindow.x2 = inArgs.propGetInt(kOfxImageEffectPropRenderWindow, 2);
-      args.renderWindow.y2 = inArgs.propGetInt(kOfxImageEffectPropRenderWindow, 3);
-
+      // the optional arguments default to off if the host does not give them
+      int sequentialRenderStatus = 0, interactiveRenderStatus = 0, renderQualityDraft = 0;
 #ifdef OFX_SUPPORTS_OPENGLRENDER
-      // Don't throw an exception if the following inArgs are not present.
-      // OpenGL rendering appeared in OFX 1.3
-      args.openGLEnabled = inArgs.propGetInt(kOfxImageEffectPropOpenGLEnabled, false) != 0;
+      int openGLEnabled = 0;
+#endif
+      const char *fieldToRender = 0;
+      const PropertySet::SnapshotEntry entries[] = {
+        {kOfxPropTime,                               eDouble, 1, &args.time,                false},
+        {kOfxImageEffectPropRenderScale,             eDouble, 2, &args.renderScale,         false},
+        {kOfxImageEffectPropRenderWindow,            eInt,    4, &args.renderWindow,        false},
+        {kOfxImageEffectPropFieldToRender,           eString, 1, &fieldToRender,            false},
+        // the render statuses appeared in OFX 1.2
+        {kOfxImageEffectPropSequentialRenderStatus,  eInt,    1, &sequentialRenderStatus,   true},
+        {kOfxImageEffectPropInteractiveRenderStatus, eInt,    1, &interactiveRenderStatus,  true},
+        // kOfxImageEffectPropRenderQualityDraft appeared in OFX 1.4
+        {kOfxImageEffectPropRenderQualityDraft,      eInt,    1, &renderQualityDraft,       true},
+#ifdef OFX_SUPPORTS_OPENGLRENDER
+        // OpenGL rendering appeared in OFX 1.3
+        {kOfxImageEffectPropOpenGLEnabled,           eInt,    1, &openGLEnabled,            true},
 #endif
+      };
+      inArgs.propGetSnapshot(entries, sizeof(entries) / sizeof(entries[0]));
 
-      // Don't throw an exception if the following inArgs are not present:
-      // They appeared in OFX 1.2.
-      args.sequentialRenderStatus = inArgs.propGetInt(kOfxImageEffectPropSequentialRenderStatus, false) != 0;
-      args.interactiveRenderStatus = inArgs.propGetInt(kOfxImageEffectPropInteractiveRenderStatus, false) != 0;
+#ifdef OFX_SUPPORTS_OPENGLRENDER
+      args.openGLEnabled = openGLEnabled != 0;
+#endif
 
-      // kOfxImageEffectPropRenderQualityDraft appeared in OFX 1.4
-      args.renderQualityDraft = inArgs.propGetInt(kOfxImageEffectPropRenderQualityDraft, false) != 0;
+      args.sequentialRenderStatus = sequentialRenderStatus != 0;
+      args.interactiveRenderStatus = interactiveRenderStatus != 0;
+      args.renderQualityDraft = renderQualityDraft != 0;
 
       args.fieldToRender = eFieldNone;
-      std::string str = inArgs.propGetString(kOfxImageEffectPropFieldToRender);
+      std::string str(fieldToRender ? fieldToRender : "");
       try {
         args.fieldToRender = mapStrToFieldEnum(str);
       }
@@ -2508,6 +2529,174 @@ namespace OFX {
     }
 
 
+    /** @brief the actions the main entry handles */
+    enum ActionEnum {
+      eActionLoad,
+      eActionUnload,
+      eActionDescribe,
+      eActionDescribeInContext,
+      eActionCreateInstance,
+      eActionDestroyInstance,
+      eActionRender,
+      eActionBeginSequenceRender,
+      eActionEndSequenceRender,
+      eActionIsIdentity,
+      eActionGetRegionOfDefinition,
+      eActionGetRegionsOfInterest,
+      eActionGetFramesNeeded,
+      eActionGetClipPreferences,
+      eActionPurgeCaches,
+      eActionSyncPrivateData,
+      eActionGetTimeDomain,
+      eActionBeginInstanceChanged,
+      eActionInstanceChanged,
+      eActionEndInstanceChanged,
+      eActionBeginInstanceEdit,
+      eActionEndInstanceEdit,
+#ifdef OFX_SUPPORTS_OPENGLRENDER
+      eActionOpenGLContextAttached,
+      eActionOpenGLContextDetached,
+#endif
+      eActionCount,
+      eActionUnknown = eActionCount
+    };
+
+    /** @brief how many buckets there are in an action's histogram of times, bucket i counts calls of under 2^i microseconds, the last counts the rest */
+    static const int kActionHistogramSize = 24;
+
+    /** @brief the statistics recorded about an action */
+    struct ActionStats {
+      volatile unsigned long long calls;
+      volatile unsigned long long microseconds;
+      volatile unsigned long long histogram[kActionHistogramSize];
+    };
+
+    /** @brief the names of the actions, in the order of ActionEnum */
+    static const char *const gActionNames[eActionCount] = {
+      kOfxActionLoad,
+      kOfxActionUnload,
+      kOfxActionDescribe,
+      kOfxImageEffectActionDescribeInContext,
+      kOfxActionCreateInstance,
+      kOfxActionDestroyInstance,
+      kOfxImageEffectActionRender,
+      kOfxImageEffectActionBeginSequenceRender,
+      kOfxImageEffectActionEndSequenceRender,
+      kOfxImageEffectActionIsIdentity,
+      kOfxImageEffectActionGetRegionOfDefinition,
+      kOfxImageEffectActionGetRegionsOfInterest,
+      kOfxImageEffectActionGetFramesNeeded,
+      kOfxImageEffectActionGetClipPreferences,
+      kOfxActionPurgeCaches,
+      kOfxActionSyncPrivateData,
+      kOfxImageEffectActionGetTimeDomain,
+      kOfxActionBeginInstanceChanged,
+      kOfxActionInstanceChanged,
+      kOfxActionEndInstanceChanged,
+      kOfxActionBeginInstanceEdit,
+      kOfxActionEndInstanceEdit,
+#ifdef OFX_SUPPORTS_OPENGLRENDER
+      kOfxActionOpenGLContextAttached,
+      kOfxActionOpenGLContextDetached,
+#endif
+    };
+
+    /** @brief the statistics of each action */
+    static ActionStats gActionStats[eActionCount];
+
+    /** @brief size of the hash table actions are looked up in, a power of two with plenty of room so chains stay short */
+    static const unsigned int kActionHashSize = 64;
+
+    /** @brief the actions by the hash of their names, each slot holds an ActionEnum plus one, 0 if it is empty */
+    static unsigned char gActionHash[kActionHashSize];
+
+    /** @brief FNV-1a hash of an action name */
+    static unsigned int hashAction(const char *action)
+    {
+      unsigned int h = 2166136261u;
+      for(; *action; ++action) {
+        h = (h ^ (unsigned char) *action) * 16777619u;
+      }
+      return h;
+    }
+
+    /** @brief fills in gActionHash as the library is loaded, before any action can arrive */
+    static struct ActionHashBuilder {
+      ActionHashBuilder()
+      {
+        for(int i = 0; i < eActionCount; ++i) {
+          unsigned int slot = hashAction(gActionNames[i]) & (kActionHashSize - 1);
+          while(gActionHash[slot]) {
+            slot = (slot + 1) & (kActionHashSize - 1);
+          }
+          gActionHash[slot] = (unsigned char) (i + 1);
+        }
+      }
+    } gActionHashBuilder;
+
+    /** @brief Map an action to an enum, by hashing it and comparing it with the name in its slot. The
+    strings hosts pass are not guaranteed to be constants, so they are never matched by pointer alone. */
+    static ActionEnum mapToActionEnum(const char *action)
+    {
+      if(!action) {
+        return eActionUnknown;
+      }
+      for(unsigned int slot = hashAction(action) & (kActionHashSize - 1); gActionHash[slot]; slot = (slot + 1) & (kActionHashSize - 1)) {
+        int i = gActionHash[slot] - 1;
+        if(strcmp(gActionNames[i], action) == 0) {
+          return (ActionEnum) i;
+        }
+      }
+      return eActionUnknown;
+    }
+
+    /** @brief whether the main entry is recording statistics */
+    static volatile bool gActionStatisticsEnabled = false;
+
+    /** @brief a monotonic clock in microseconds, so wall clock adjustments do not skew the times */
+    static unsigned long long microsecondsNow(void)
+    {
+#ifdef _WIN32
+      LARGE_INTEGER count, frequency;
+      QueryPerformanceCounter(&count);
+      QueryPerformanceFrequency(&frequency);
+      return (unsigned long long) (count.QuadPart / (frequency.QuadPart / 1000000.0));
+#elif defined(__APPLE__)
+      static mach_timebase_info_data_t timebase;
+      if(timebase.denom == 0) {
+        mach_timebase_info(&timebase);
+      }
+      return mach_absolute_time() * timebase.numer / timebase.denom / 1000;
+#else
+      struct timespec now;
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      return (unsigned long long) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+#endif
+    }
+
+    /** @brief add to a counter that several render threads may be adding to at once */
+    static void atomicAdd(volatile unsigned long long *counter, unsigned long long value)
+    {
+#ifdef _WIN32
+      InterlockedExchangeAdd64((volatile LONGLONG *) counter, (LONGLONG) value);
+#else
+      __sync_fetch_and_add(counter, value);
+#endif
+    }
+
+    /** @brief record a call of an action */
+    static void recordAction(ActionEnum action, unsigned long long microseconds)
+    {
+      int bucket = 0;
+      while(bucket < kActionHistogramSize - 1 && (1ULL << bucket) <= microseconds) {
+        ++bucket;
+      }
+      ActionStats &stats = gActionStats[action];
+      atomicAdd(&stats.calls, 1);
+      atomicAdd(&stats.microseconds, microseconds);
+      atomicAdd(&stats.histogram[bucket], 1);
+    }
+
     /** @brief The main entry point for the plugin
     */
     OfxStatus mainEntryStr(const char    *actionRaw,
@@ -2520,6 +2709,9 @@ namespace OFX {
       OFX::Log::print("START mainEntry (%s)", actionRaw);
       OFX::Log::indent();
       OfxStatus stat = kOfxStatReplyDefault;
+      ActionEnum action = mapToActionEnum(actionRaw);
+      bool recording = gActionStatisticsEnabled && action != eActionUnknown;
+      unsigned long long start = recording ? microsecondsNow() : 0;
       try {
 
         OfxPlugInfoMap::iterator it = plugInfoMap.find(plugname);
@@ -2535,11 +2727,9 @@ namespace OFX {
         OFX::PropertySet inArgs(inArgsRaw);
         OFX::PropertySet outArgs(outArgsRaw);
 
-        // turn the action into a std::string
-        std::string action(actionRaw);
-
         // figure the actions
-        if (action == kOfxActionLoad) {
+        switch(action) {
+        case eActionLoad : {
           // call the support load function, param-less
           OFX::Private::loadAction(); 
 
@@ -2548,10 +2738,9 @@ namespace OFX {
 
           // got here, must be good
           stat = kOfxStatOK;
+          break;
         }
-
-        // figure the actions
-        else if (action == kOfxActionUnload) {
+        case eActionUnload : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, true, true, true);
 
           // call the plugin side unload action, param-less, should be called, eve if the stat above failed!
@@ -2562,9 +2751,9 @@ namespace OFX {
 
           // got here, must be good
           stat = kOfxStatOK;
+          break;
         }
-
-        else if(action == kOfxActionDescribe) {
+        case eActionDescribe : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, true, true);
 
           // make the plugin descriptor
@@ -2582,8 +2771,9 @@ namespace OFX {
 
           // got here, must be good
           stat = kOfxStatOK;
+          break;
         }
-        else if(action == kOfxImageEffectActionDescribeInContext) {
+        case eActionDescribeInContext : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, false, true);
 
           // make the plugin descriptor and pass it to the plugin to do something with it
@@ -2604,8 +2794,9 @@ namespace OFX {
 
           // got here, must be good
           stat = kOfxStatOK;
+          break;
         }
-        else if(action == kOfxActionCreateInstance) {
+        case eActionCreateInstance : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, true, true);
 
           // fetch the effect props to figure the context
@@ -2624,8 +2815,9 @@ namespace OFX {
 
           // got here, must be good
           stat = kOfxStatOK;
+          break;
         }
-        else if(action == kOfxActionDestroyInstance) {
+        case eActionDestroyInstance : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, true, true);
 
           // fetch our pointer out of the props on the handle
@@ -2636,8 +2828,9 @@ namespace OFX {
 
           // got here, must be good
           stat = kOfxStatOK;
+          break;
         }
-        else if(action == kOfxImageEffectActionRender) {
+        case eActionRender : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, false, true);
 
           // call the render action skin
@@ -2645,55 +2838,63 @@ namespace OFX {
 
           // got here, must be good
           stat = kOfxStatOK;
+          break;
         }
-        else if(action == kOfxImageEffectActionBeginSequenceRender) {
+        case eActionBeginSequenceRender : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, false, true);
 
           // call the begin render action skin
           beginSequenceRenderAction(handle, inArgs);
+          break;
         }
-        else if(action == kOfxImageEffectActionEndSequenceRender) {
+        case eActionEndSequenceRender : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, false, true);
 
           // call the begin render action skin
           endSequenceRenderAction(handle, inArgs);
+          break;
         }
-        else if(action == kOfxImageEffectActionIsIdentity) {
+        case eActionIsIdentity : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, false, false);
 
           // call the identity action, if it is, return OK
           if(isIdentityAction(handle, inArgs, outArgs))
             stat = kOfxStatOK;
+          break;
         }
-        else if(action == kOfxImageEffectActionGetRegionOfDefinition) {
+        case eActionGetRegionOfDefinition : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, false, false);
 
           // call the rod action, return OK if it does something
           if(regionOfDefinitionAction(handle, inArgs, outArgs))
             stat = kOfxStatOK;
+          break;
         }
-        else if(action == kOfxImageEffectActionGetRegionsOfInterest) {
+        case eActionGetRegionsOfInterest : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, false, false);
 
           // call the RoI action, return OK if it does something
           if(regionsOfInterestAction(handle, inArgs, outArgs, plugname))
             stat = kOfxStatOK;
+          break;
         }
-        else if(action == kOfxImageEffectActionGetFramesNeeded) {
+        case eActionGetFramesNeeded : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, false, false);
 
           // call the frames needed action, return OK if it does something
           if(framesNeededAction(handle, inArgs, outArgs, plugname))
             stat = kOfxStatOK;
+          break;
         }
-        else if(action == kOfxImageEffectActionGetClipPreferences) {
+        case eActionGetClipPreferences : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, true, false);
 
           // call the frames needed action, return OK if it does something
           if(clipPreferencesAction(handle, outArgs, plugname))
             stat = kOfxStatOK;
+          break;
         }
-        else if(action == kOfxActionPurgeCaches) {
+        case eActionPurgeCaches : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, true, true);
 
           // fetch our pointer out of the props on the handle
@@ -2701,8 +2902,9 @@ namespace OFX {
 
           // purge 'em
           instance->purgeCaches();
+          break;
         }
-        else if(action == kOfxActionSyncPrivateData) {
+        case eActionSyncPrivateData : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, true, true);
 
           // fetch our pointer out of the props on the handle
@@ -2710,33 +2912,38 @@ namespace OFX {
 
           // and sync it
           instance->syncPrivateData();
+          break;
         }
-        else if(action == kOfxImageEffectActionGetTimeDomain) {
+        case eActionGetTimeDomain : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, true, false);
 
           // call the instance changed action
           if(getTimeDomainAction(handle, outArgs))
             stat = kOfxStatOK;
+          break;
         }
-        else if(action == kOfxActionBeginInstanceChanged) {
+        case eActionBeginInstanceChanged : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, false, true);
 
           // call the instance changed action
           beginInstanceChangedAction(handle, inArgs);
+          break;
         }
-        else if(action == kOfxActionInstanceChanged) {
+        case eActionInstanceChanged : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, false, true);
 
           // call the instance changed action
           instanceChangedAction(handle, inArgs);
+          break;
         }
-        else if(action == kOfxActionEndInstanceChanged) {
+        case eActionEndInstanceChanged : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, false, true);
 
           // call the instance changed action
           endInstanceChangedAction(handle, inArgs);
+          break;
         }
-        else if(action == kOfxActionBeginInstanceEdit) {
+        case eActionBeginInstanceEdit : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, true, true);
 
           // fetch our pointer out of the props on the handle
@@ -2744,8 +2951,9 @@ namespace OFX {
 
           // call the begin edit function
           instance->beginEdit();
+          break;
         }
-        else if(action == kOfxActionEndInstanceEdit) {
+        case eActionEndInstanceEdit : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, true, true);
 
           // fetch our pointer out of the props on the handle
@@ -2753,9 +2961,10 @@ namespace OFX {
 
           // call the end edit function
           instance->endEdit();
+          break;
         }
 #ifdef OFX_SUPPORTS_OPENGLRENDER
-        else if(action == kOfxActionOpenGLContextAttached) {
+        case eActionOpenGLContextAttached : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, true, true);
 
           // fetch our pointer out of the props on the handle
@@ -2763,8 +2972,9 @@ namespace OFX {
 
           // call the context attached function
           instance->contextAttached();
+          break;
         }
-        else if(action == kOfxActionOpenGLContextDetached) {
+        case eActionOpenGLContextDetached : {
           checkMainHandles(actionRaw, handleRaw, inArgsRaw, outArgsRaw, false, true, true);
 
           // fetch our pointer out of the props on the handle
@@ -2772,13 +2982,17 @@ namespace OFX {
 
           // call the context detached function
           instance->contextDetached();
+          break;
         }
 #endif
-        else if(actionRaw) {
-          OFX::Log::error(true, "Unknown action '%s'.", actionRaw);
-        }
-        else {
-          OFX::Log::error(true, "Requested action was a null pointer.");
+        default :
+          if(actionRaw) {
+            OFX::Log::error(true, "Unknown action '%s'.", actionRaw);
+          }
+          else {
+            OFX::Log::error(true, "Requested action was a null pointer.");
+          }
+          break;
         }
       }
 
@@ -2838,6 +3052,10 @@ namespace OFX {
         stat = kOfxStatFailed;
       }
 
+      if(recording) {
+        recordAction(action, microsecondsNow() - start);
+      }
+
       OFX::Log::outdent();
       OFX::Log::print("STOP mainEntry (%s)\n", actionRaw);
       return stat;
@@ -2942,6 +3160,68 @@ namespace OFX {
 
   }; // namespace Private
 
+  namespace ActionStatistics {
+    /** @brief turn recording on or off */
+    void setEnabled(bool enabled)
+    {
+      OFX::Private::gActionStatisticsEnabled = enabled;
+    }
+
+    /** @brief is recording on */
+    bool getEnabled(void)
+    {
+      return OFX::Private::gActionStatisticsEnabled;
+    }
+
+    /** @brief zero all the counts */
+    void reset(void)
+    {
+      for(int i = 0; i < OFX::Private::eActionCount; ++i) {
+        OFX::Private::ActionStats &stats = OFX::Private::gActionStats[i];
+        stats.calls = 0;
+        stats.microseconds = 0;
+        for(int b = 0; b < OFX::Private::kActionHistogramSize; ++b) {
+          stats.histogram[b] = 0;
+        }
+      }
+    }
+
+    /** @brief write a table of the actions that have been called */
+    void dump(std::ostream &out)
+    {
+      std::ios::fmtflags flags = out.flags();
+      std::streamsize precision = out.precision();
+
+      out << "action                                          calls      total ms     mean us  histogram, calls under N us" << std::endl;
+      for(int i = 0; i < OFX::Private::eActionCount; ++i) {
+        const OFX::Private::ActionStats &stats = OFX::Private::gActionStats[i];
+        if(stats.calls == 0) {
+          continue;
+        }
+
+        out << std::left << std::setw(44) << OFX::Private::gActionNames[i] << std::right
+            << std::setw(10) << stats.calls
+            << std::fixed << std::setprecision(3) << std::setw(14) << stats.microseconds / 1000.0
+            << std::setprecision(1) << std::setw(12) << (double) stats.microseconds / stats.calls << " ";
+        for(int b = 0; b < OFX::Private::kActionHistogramSize; ++b) {
+          if(stats.histogram[b] == 0) {
+            continue;
+          }
+          if(b < OFX::Private::kActionHistogramSize - 1) {
+            out << " <" << (1ULL << b) << ":" << stats.histogram[b];
+          }
+          else {
+            out << " more:" << stats.histogram[b];
+          }
+        }
+        out << std::endl;
+      }
+
+      out.flags(flags);
+      out.precision(precision);
+    }
+  };
+
   /** @brief Fetch's a suite from the host and logs errors */
   const void * fetchSuite(const char *suiteName, int suiteVersion, bool optional)
   {
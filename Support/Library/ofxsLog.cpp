@@ -38,21 +38,41 @@ England
 
 The log file is written to using printf style functions, rather than via c++ iostreams.
 
+Each thread formats its lines into a ring buffer of its own, which a background thread
+empties into the log file. A ring has one producer, its thread, and one consumer, the
+writer, so neither side takes a lock. The writer waits on a condition when there is
+nothing to write, which loggers only signal when it is waiting, and frees the rings of
+threads that have gone once they are empty. It runs until close is called or the library
+is unloaded.
+
 */
 
 #include <cassert>
 #include <cstdio>
 #include <cstdarg>
 #include <cstdlib>
+#include <cstring>
+#include <cstddef>
 #include <string>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #include "ofxsLog.h"
 
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define vsnprintf _vsnprintf
+#endif
+
 namespace OFX {
   namespace Log {
 
-    /** @brief log file */
-    static FILE *gLogFP = 0;
+    /** @brief log file, only written to by whichever thread is the writer */
+    static FILE * volatile gLogFP = 0;
 
     /// environment variable for the log file
 #define kLogFileEnvVar "OFX_PLUGIN_LOGFILE"
@@ -60,8 +80,516 @@ namespace OFX {
     /** @brief the global logfile name */
     static std::string gLogFileName(getenv(kLogFileEnvVar) ? getenv(kLogFileEnvVar) : "ofxTestLog.txt");
 
-    /** @brief global indent level, not MP sane */
-    static int gIndent = 0;
+    /** @brief the level logged at */
+#ifdef DEBUG
+    int gLevel = eLevelPrint;
+#else
+    int gLevel = eLevelNone;
+#endif
+
+    /** @brief bytes in each thread's buffer, a power of two */
+    static const unsigned int kBufferSize = 1 << 16;
+
+    /** @brief longest line kept, longer ones are cut short */
+    static const unsigned int kMaxLine = 4096;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // the few atomic operations the buffers need, the support library has no threading of its own
+
+#ifdef _WIN32
+    template <class T> static inline T loadAcquire(T volatile *p)
+    {
+      T v = *p;
+      MemoryBarrier();
+      return v;
+    }
+
+    template <class T> static inline void storeRelease(T volatile *p, T v)
+    {
+      MemoryBarrier();
+      *p = v;
+    }
+
+    static inline bool compareAndSwap(long volatile *p, long oldValue, long newValue)
+    {
+      return InterlockedCompareExchange(p, newValue, oldValue) == oldValue;
+    }
+
+    template <class T> static inline bool compareAndSwap(T * volatile *p, T *oldValue, T *newValue)
+    {
+      return InterlockedCompareExchangePointer((PVOID volatile *) p, newValue, oldValue) == oldValue;
+    }
+
+    static inline void fullBarrier(void) { MemoryBarrier(); }
+
+    static void yieldThread(void) { SwitchToThread(); }
+#else
+    template <class T> static inline T loadAcquire(T volatile *p)
+    {
+#  ifdef __ATOMIC_ACQUIRE
+      return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#  else
+      T v = *p;
+      __sync_synchronize();
+      return v;
+#  endif
+    }
+
+    template <class T> static inline void storeRelease(T volatile *p, T v)
+    {
+#  ifdef __ATOMIC_RELEASE
+      __atomic_store_n(p, v, __ATOMIC_RELEASE);
+#  else
+      __sync_synchronize();
+      *p = v;
+#  endif
+    }
+
+    template <class T> static inline bool compareAndSwap(T volatile *p, T oldValue, T newValue)
+    {
+      return __sync_bool_compare_and_swap(p, oldValue, newValue);
+    }
+
+    static inline void fullBarrier(void) { __sync_synchronize(); }
+
+    static void yieldThread(void) { sched_yield(); }
+#endif
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // per thread buffers
+
+    /** @brief what each line in a buffer starts with, its text follows */
+    struct LineHeader {
+      unsigned int length;  /**< @brief of the text */
+      int indent;
+      int level;            /**< @brief a LevelEnum */
+    };
+
+    /** @brief A thread's lines on their way to the writer. Once its thread has gone the writer
+    takes it out of gBuffers and deletes it, after writing any lines left in it. */
+    struct ThreadBuffer {
+      char data[kBufferSize];
+      volatile unsigned int head;  /**< @brief bytes ever put in, only moved by the owning thread */
+      volatile unsigned int tail;  /**< @brief bytes ever taken out, only moved by the writer */
+      volatile long orphaned;      /**< @brief set as the owning thread exits, after its last line */
+      ThreadBuffer *next;          /**< @brief the next in gBuffers */
+    };
+
+    /** @brief All the buffers there are. Threads push theirs onto the front, only the writer
+    takes them out. */
+    static ThreadBuffer * volatile gBuffers = 0;
+
+    /** @brief copy into a buffer at a position, which may wrap */
+    static void copyIn(ThreadBuffer &buf, unsigned int at, const void *src, unsigned int n)
+    {
+      unsigned int i = at & (kBufferSize - 1);
+      unsigned int first = n < kBufferSize - i ? n : kBufferSize - i;
+      memcpy(buf.data + i, src, first);
+      memcpy(buf.data, (const char *) src + first, n - first);
+    }
+
+    /** @brief copy out of a buffer from a position, which may wrap */
+    static void copyOut(const ThreadBuffer &buf, unsigned int at, void *dst, unsigned int n)
+    {
+      unsigned int i = at & (kBufferSize - 1);
+      unsigned int first = n < kBufferSize - i ? n : kBufferSize - i;
+      memcpy(dst, buf.data + i, first);
+      memcpy((char *) dst + first, buf.data, n - first);
+    }
+
+    static void wakeWriter(void);
+
+    /** @brief a thread with a buffer has gone, leave the buffer to the writer */
+#ifdef _WIN32
+    static void WINAPI releaseBuffer(void *b)
+#else
+    static void releaseBuffer(void *b)
+#endif
+    {
+      if(b) {
+        storeRelease(&((ThreadBuffer *) b)->orphaned, 1L);
+        wakeWriter();
+      }
+    }
+
+    /** @brief The thread specific slots each thread's buffer and indent are kept in. The indent
+    is kept apart so threads that indent but do not log get no buffer. */
+#ifdef _WIN32
+    static DWORD gBufferKey = FLS_OUT_OF_INDEXES;
+    static DWORD gIndentKey = FLS_OUT_OF_INDEXES;
+    static INIT_ONCE gKeysOnce = INIT_ONCE_STATIC_INIT;
+
+    static BOOL CALLBACK makeKeys(PINIT_ONCE, PVOID, PVOID *)
+    {
+      gBufferKey = FlsAlloc(releaseBuffer);
+      gIndentKey = FlsAlloc(0);
+      return TRUE;
+    }
+
+    static void initKeys(void) { InitOnceExecuteOnce(&gKeysOnce, makeKeys, 0, 0); }
+    static ThreadBuffer *getBuffer(void) { return (ThreadBuffer *) FlsGetValue(gBufferKey); }
+    static void setBuffer(ThreadBuffer *buf) { FlsSetValue(gBufferKey, buf); }
+    static int getIndent(void) { return (int) (std::ptrdiff_t) FlsGetValue(gIndentKey); }
+    static void setIndent(int indent) { FlsSetValue(gIndentKey, (void *) (std::ptrdiff_t) indent); }
+#else
+    static pthread_key_t gBufferKey;
+    static pthread_key_t gIndentKey;
+    static pthread_once_t gKeysOnce = PTHREAD_ONCE_INIT;
+
+    static void makeKeys(void)
+    {
+      pthread_key_create(&gBufferKey, releaseBuffer);
+      pthread_key_create(&gIndentKey, 0);
+    }
+
+    static void initKeys(void) { pthread_once(&gKeysOnce, makeKeys); }
+    static ThreadBuffer *getBuffer(void) { return (ThreadBuffer *) pthread_getspecific(gBufferKey); }
+    static void setBuffer(ThreadBuffer *buf) { pthread_setspecific(gBufferKey, buf); }
+    static int getIndent(void) { return (int) (std::ptrdiff_t) pthread_getspecific(gIndentKey); }
+    static void setIndent(int indent) { pthread_setspecific(gIndentKey, (void *) (std::ptrdiff_t) indent); }
+#endif
+
+    /** @brief the calling thread's buffer, making one if it has none */
+    static ThreadBuffer &threadBuffer(void)
+    {
+      initKeys();
+      ThreadBuffer *buf = getBuffer();
+      if(buf) {
+        return *buf;
+      }
+
+      buf = new ThreadBuffer;
+      buf->head = buf->tail = 0;
+      buf->orphaned = 0;
+      do {
+        buf->next = gBuffers;
+      } while(!compareAndSwap(&gBuffers, buf->next, buf));
+      setBuffer(buf);
+      return *buf;
+    }
+
+    /** @brief take an emptied orphaned buffer out of gBuffers, prev is the buffer before it or null */
+    static void unlinkBuffer(ThreadBuffer *prev, ThreadBuffer *buf)
+    {
+      if(!prev && !compareAndSwap(&gBuffers, buf, buf->next)) {
+        // threads pushed theirs in front of it meanwhile
+        for(prev = loadAcquire(&gBuffers); prev->next != buf; prev = prev->next) {
+        }
+      }
+      if(prev) {
+        prev->next = buf->next;
+      }
+      delete buf;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // the writer
+
+    /** @brief guards starting and stopping the writer, which are rare, and the file opening */
+    static volatile long gWriterLock = 0;
+
+    /** @brief whether the writer thread is running, checked by every line logged */
+    static volatile long gWriterRunning = 0;
+
+    /** @brief set while close stops the writer, so no other is started */
+    static volatile long gWriterStopping = 0;
+
+    /** @brief set once the library is being unloaded, after which lines are dropped */
+    static volatile long gUnloaded = 0;
+
+    /** @brief set while the writer waits on gWriterWake, so only then do loggers signal it */
+    static volatile long gWriterWaiting = 0;
+
+#ifdef _WIN32
+    static HANDLE gWriterThread = 0;
+    static SRWLOCK gWriterWakeLock = SRWLOCK_INIT;
+    static CONDITION_VARIABLE gWriterWake = CONDITION_VARIABLE_INIT;
+
+    static void lockWake(void) { AcquireSRWLockExclusive(&gWriterWakeLock); }
+    static void unlockWake(void) { ReleaseSRWLockExclusive(&gWriterWakeLock); }
+    static void waitWake(void) { SleepConditionVariableSRW(&gWriterWake, &gWriterWakeLock, INFINITE, 0); }
+    static void signalWake(void) { WakeConditionVariable(&gWriterWake); }
+#else
+    static pthread_t gWriterThread;
+    static pthread_mutex_t gWriterWakeLock = PTHREAD_MUTEX_INITIALIZER;
+    static pthread_cond_t gWriterWake = PTHREAD_COND_INITIALIZER;
+
+    static void lockWake(void) { pthread_mutex_lock(&gWriterWakeLock); }
+    static void unlockWake(void) { pthread_mutex_unlock(&gWriterWakeLock); }
+    static void waitWake(void) { pthread_cond_wait(&gWriterWake, &gWriterWakeLock); }
+    static void signalWake(void) { pthread_cond_signal(&gWriterWake); }
+#endif
+
+    /** @brief Wake the writer if it is waiting, called once a line or an orphaned buffer is in
+    place. The barrier pairs with the one in writerLoop, either we see it waiting or it sees
+    what we did. */
+    static void wakeWriter(void)
+    {
+      fullBarrier();
+      if(gWriterWaiting) {
+        lockWake();
+        signalWake();
+        unlockWake();
+      }
+    }
+
+    static void lockWriter(void)
+    {
+      while(!compareAndSwap(&gWriterLock, 0L, 1L)) {
+        yieldThread();
+      }
+    }
+
+    static void unlockWriter(void)
+    {
+      storeRelease(&gWriterLock, 0L);
+    }
+
+    /** @brief open the log file if need be, with gWriterLock held */
+    static bool openLocked(void)
+    {
+      if(!gLogFP && gLevel > eLevelNone) {
+        storeRelease(&gLogFP, fopen(gLogFileName.c_str(), "w"));
+      }
+      return gLogFP != 0;
+    }
+
+    /** @brief put together a line as it goes in the log file, returns its length */
+    static unsigned int formatLine(const LineHeader &h, const char *text, char *line)
+    {
+      unsigned int n = 0;
+      for(int i = 0; i < h.indent && n + 4 < kMaxLine; i++, n += 4) {
+        memcpy(line + n, "    ", 4);
+      }
+      if(h.level == eLevelWarning) {
+        memcpy(line + n, "WARNING : ", 10);
+        n += 10;
+      }
+      else if(h.level == eLevelError) {
+        memcpy(line + n, "ERROR : ", 8);
+        n += 8;
+      }
+      memcpy(line + n, text, h.length);
+      n += h.length;
+      line[n++] = '\n';
+      return n;
+    }
+
+    /** @brief Write out every line in the buffers, returns whether there were any, and delete
+    the buffers of threads that have gone. Only the writer thread calls this, or a thread
+    holding gWriterLock when there is no writer thread, lines are dropped if the log file
+    cannot be opened. */
+    static bool drain(bool locked)
+    {
+      bool wrote = false;
+      ThreadBuffer *prev = 0;
+      ThreadBuffer *buf = loadAcquire(&gBuffers);
+      while(buf) {
+        ThreadBuffer *next = buf->next;
+        // a buffer's last line is in before it is orphaned
+        bool orphaned = loadAcquire(&buf->orphaned) != 0;
+        unsigned int tail = buf->tail;
+        unsigned int head = loadAcquire(&buf->head);
+        if(tail != head && !gLogFP) {
+          // the writer thread must not wait on the lock, as close holds it while joining the thread
+          if(locked) {
+            openLocked();
+          }
+          else if(compareAndSwap(&gWriterLock, 0L, 1L)) {
+            openLocked();
+            unlockWriter();
+          }
+          else {
+            prev = buf;
+            buf = next;
+            continue;
+          }
+        }
+        while(gLogFP && tail != head) {
+          LineHeader h;
+          char text[kMaxLine];
+          char line[2 * kMaxLine + 16];
+          copyOut(*buf, tail, &h, sizeof(h));
+          copyOut(*buf, tail + sizeof(h), text, h.length);
+          fwrite(line, 1, formatLine(h, text, line), gLogFP);
+          tail += sizeof(h) + h.length;
+          wrote = true;
+        }
+        storeRelease(&buf->tail, head);
+        if(orphaned) {
+          unlinkBuffer(prev, buf);
+        }
+        else {
+          prev = buf;
+        }
+        buf = next;
+      }
+      if(wrote && gLogFP) {
+        fflush(gLogFP);
+      }
+      return wrote;
+    }
+
+    /** @brief whether the writer has anything to do, a line to write or a buffer to delete */
+    static bool writerHasWork(void)
+    {
+      for(ThreadBuffer *buf = loadAcquire(&gBuffers); buf; buf = buf->next) {
+        if(loadAcquire(&buf->orphaned) || buf->tail != loadAcquire(&buf->head)) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    /** @brief the writer thread's loop, it waits on gWriterWake whenever it finds nothing to do */
+    static void writerLoop(void)
+    {
+      while(!loadAcquire(&gWriterStopping)) {
+        if(drain(false)) {
+          continue;
+        }
+        lockWake();
+        storeRelease(&gWriterWaiting, 1L);
+        fullBarrier();
+        while(!loadAcquire(&gWriterStopping) && !writerHasWork()) {
+          waitWake();
+        }
+        storeRelease(&gWriterWaiting, 0L);
+        unlockWake();
+      }
+    }
+
+#ifdef _WIN32
+    /** @brief the writer thread, which holds a reference on our module so we cannot be unloaded under it */
+    static DWORD WINAPI writerThread(LPVOID)
+    {
+      HMODULE module = 0;
+      GetModuleHandleEx(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, (LPCTSTR) &writerThread, &module);
+      writerLoop();
+      FreeLibraryAndExitThread(module, 0);
+      return 0;
+    }
+
+    static bool spawnWriter(void)
+    {
+      gWriterThread = CreateThread(0, 0, writerThread, 0, 0, 0);
+      return gWriterThread != 0;
+    }
+
+    static void joinWriter(void)
+    {
+      WaitForSingleObject(gWriterThread, INFINITE);
+      CloseHandle(gWriterThread);
+      gWriterThread = 0;
+    }
+#else
+    /** @brief the writer thread, joined by close, which is called as the library is unloaded */
+    static void *writerThread(void *)
+    {
+      writerLoop();
+      return 0;
+    }
+
+    static bool spawnWriter(void)
+    {
+      return pthread_create(&gWriterThread, 0, writerThread, 0) == 0;
+    }
+
+    static void joinWriter(void)
+    {
+      pthread_join(gWriterThread, 0);
+    }
+#endif
+
+    /** @brief make sure there is a writer to take the lines just logged */
+    static void startWriter(void)
+    {
+      if(loadAcquire(&gWriterRunning) || loadAcquire(&gWriterStopping)) {
+        return;
+      }
+
+      lockWriter();
+      if(!gWriterRunning && !gWriterStopping) {
+        if(spawnWriter()) {
+          storeRelease(&gWriterRunning, 1L);
+        }
+        else {
+          // no thread to be had, so write the lines out here
+          drain(true);
+        }
+      }
+      unlockWriter();
+    }
+
+    /** @brief put a line in the calling thread's buffer, waiting for the writer if it is full */
+    static void putLine(LevelEnum level, const char *format, va_list args)
+    {
+      if(loadAcquire(&gUnloaded)) {
+        return;
+      }
+      ThreadBuffer &buf = threadBuffer();
+
+      char text[kMaxLine];
+      int n = vsnprintf(text, sizeof(text), format, args);
+      if(n < 0 || n >= (int) sizeof(text)) {
+        n = sizeof(text) - 1;
+      }
+
+      LineHeader h;
+      h.length = n;
+      h.indent = getIndent();
+      h.level = level;
+
+      unsigned int head = buf.head;
+      unsigned int size = sizeof(h) + h.length;
+      while(size > kBufferSize - (head - loadAcquire(&buf.tail))) {
+        startWriter();
+        wakeWriter();
+        yieldThread();
+      }
+      copyIn(buf, head, &h, sizeof(h));
+      copyIn(buf, head + sizeof(h), text, h.length);
+      storeRelease(&buf.head, head + size);
+
+      startWriter();
+      wakeWriter();
+    }
+
+    /** @brief closes the log as the library is unloaded, so the writer thread is gone before its code */
+    static struct Closer {
+      ~Closer()
+      {
+        storeRelease(&gUnloaded, 1L);
+        close();
+#ifdef _WIN32
+        if(gBufferKey != FLS_OUT_OF_INDEXES) {
+          FlsFree(gBufferKey);
+        }
+        if(gIndentKey != FLS_OUT_OF_INDEXES) {
+          FlsFree(gIndentKey);
+        }
+#else
+        initKeys();
+        pthread_key_delete(gBufferKey);
+        pthread_key_delete(gIndentKey);
+#endif
+      }
+    } gCloser;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // the API
+
+    /** @brief Sets the level logged at. */
+    void setLevel(LevelEnum level)
+    {
+      gLevel = level;
+    }
+
+    /** @brief Gets the level logged at. */
+    LevelEnum getLevel(void)
+    {
+      return (LevelEnum) gLevel;
+    }
 
     /** @brief Sets the name of the log file. */
     void setFileName(const std::string &value)
@@ -72,56 +600,57 @@ namespace OFX {
     /** @brief Opens the log file, returns whether this was sucessful or not. */
     bool open(void)
     {
-#ifdef DEBUG
-      if(!gLogFP) {
-        gLogFP = fopen(gLogFileName.c_str(), "w");
-        return gLogFP != 0;
+      if(!loadAcquire(&gLogFP) && gLevel > eLevelNone) {
+        lockWriter();
+        openLocked();
+        unlockWriter();
       }
-#endif
       return gLogFP != 0;
     }
 
     /** @brief Closes the log file. */
     void close(void)
     {
+      lockWriter();
+      storeRelease(&gWriterStopping, 1L);
+      if(gWriterRunning) {
+        lockWake();
+        signalWake();
+        unlockWake();
+        joinWriter();
+        storeRelease(&gWriterRunning, 0L);
+      }
+      drain(true);
       if(gLogFP) {
         fclose(gLogFP);
       }
       gLogFP = 0;
+      storeRelease(&gWriterStopping, 0L);
+      unlockWriter();
     }
 
-    /** @brief Indent it, not MP sane at the moment */
+    /** @brief Indent the calling thread's lines, whatever the level, so the depth is right
+    should logging be turned on between an indent and its outdent */
     void indent(void)
     {
-      ++gIndent;
+      initKeys();
+      setIndent(getIndent() + 1);
     }
 
-    /** @brief Outdent it, not MP sane at the moment */
+    /** @brief Outdent the calling thread's lines */
     void outdent(void)
     {
-      --gIndent;
-    }
-
-    /** @brief do the indenting */
-    static void doIndent(void)
-    {
-      if(open()) {
-        for(int i = 0; i < gIndent; i++) {
-          fputs("    ", gLogFP);
-        }
-      }
+      initKeys();
+      setIndent(getIndent() - 1);
     }
 
     /** @brief Prints to the log file. */
     void print(const char *format, ...)
     {
-      if(open()) {
-        doIndent();
+      if(enabled(eLevelPrint)) {
         va_list args;
         va_start(args, format);
-        vfprintf(gLogFP, format, args);
-        fputc('\n', gLogFP);
-        fflush(gLogFP);
+        putLine(eLevelPrint, format, args);
         va_end(args);
       }  
     }
@@ -129,34 +658,22 @@ namespace OFX {
     /** @brief Prints to the log file only if the condition is true and prepends a warning notice. */
     void warning(bool condition, const char *format, ...)
     {
-      if(condition && open()) {
-        doIndent();
-        fputs("WARNING : ", gLogFP);
-
+      if(condition && enabled(eLevelWarning)) {
         va_list args;
         va_start(args, format);
-        vfprintf(gLogFP, format, args);
-        fputc('\n', gLogFP);
+        putLine(eLevelWarning, format, args);
         va_end(args);
-
-        fflush(gLogFP);
       }  
     }
 
     /** @brief Prints to the log file only if the condition is true and prepends an error notice. */
     void error(bool condition, const char *format, ...)
     {
-      if(condition && open()) {
-        doIndent();
-        fputs("ERROR : ", gLogFP);
-
+      if(condition && enabled(eLevelError)) {
         va_list args;
         va_start(args, format);
-        vfprintf(gLogFP, format, args);
-        fputc('\n', gLogFP);
+        putLine(eLevelError, format, args);
         va_end(args);
-
-        fflush(gLogFP);
       }  
     }
   };
@@ -1896,6 +1896,20 @@ namespace OFX {
     throwSuiteStatusException(stat);
   }
 
+  /** @brief get the values at n times */
+  void DoubleParam::getValuesAtTimes(const double *times, double *values, int n)
+  {
+    if(n <= 0)
+      return;
+    if(!OFX::Private::gParamBatchSuite) {
+      for(int i = 0; i < n; i++)
+        getValueAtTime(times[i], values[i]);
+      return;
+    }
+    OfxStatus stat = OFX::Private::gParamBatchSuite->paramGetValuesAtTimes(_paramHandle, times, n, values);
+    throwSuiteStatusException(stat);
+  }
+
   /** @brief set value */
   void DoubleParam::setValue(double v)
   {
@@ -2009,6 +2023,22 @@ namespace OFX {
     throwSuiteStatusException(stat);
   }
 
+  /** @brief get the values at n times */
+  void Double2DParam::getValuesAtTimes(const double *times, OfxPointD *values, int n)
+  {
+    // nothing to do, and values[0] need not exist
+    if(n <= 0)
+      return;
+    if(!OFX::Private::gParamBatchSuite) {
+      for(int i = 0; i < n; i++)
+        getValueAtTime(times[i], values[i].x, values[i].y);
+      return;
+    }
+    // an OfxPointD is two doubles, laid out as the suite returns them
+    OfxStatus stat = OFX::Private::gParamBatchSuite->paramGetValuesAtTimes(_paramHandle, times, n, &values[0].x);
+    throwSuiteStatusException(stat);
+  }
+
   /** @brief set value */
   void Double2DParam::setValue(double x, double y)
   {
@@ -100,7 +100,7 @@ namespace OFX {
     if(throwOnFailure)
       throwPropertyException(stat, property); 
 
-    if(_gPropLogging > 0) 
+    if(Log::enabled(Log::eLevelPrint) && _gPropLogging > 0) 
       Log::print("Fetched dimension of property %s, returned %d.",  property, dimension);
 
     return dimension;
@@ -117,7 +117,7 @@ namespace OFX {
     Log::error(stat != kOfxStatOK, "Failed on reseting property %s to its defaults, host returned status %s.", property, mapStatusToString(stat));
     throwPropertyException(stat, property); 
 
-    if(_gPropLogging > 0) Log::print("Reset property %s.",  property);
+    if(Log::enabled(Log::eLevelPrint) && _gPropLogging > 0) Log::print("Reset property %s.",  property);
   }
 
   /** @brief, Set a single dimension pointer property */
@@ -133,7 +133,7 @@ namespace OFX {
     if(throwOnFailure)
       throwPropertyException(stat, property);  
 
-    if(_gPropLogging > 0) Log::print("Set pointer property %s[%d] to be %p.",  property, idx, value);
+    if(Log::enabled(Log::eLevelPrint) && _gPropLogging > 0) Log::print("Set pointer property %s[%d] to be %p.",  property, idx, value);
   }
 
   /** @brief, Set a single dimension string property */
@@ -149,7 +149,7 @@ namespace OFX {
     if(throwOnFailure)
       throwPropertyException(stat, property); 
 
-    if(_gPropLogging > 0) Log::print("Set string property %s[%d] to be %s.",  property, idx, value.c_str());
+    if(Log::enabled(Log::eLevelPrint) && _gPropLogging > 0) Log::print("Set string property %s[%d] to be %s.",  property, idx, value.c_str());
   }
 
   /** @brief, Set a single dimension double property */
@@ -165,7 +165,7 @@ namespace OFX {
     if(throwOnFailure)
       throwPropertyException(stat, property); 
 
-    if(_gPropLogging > 0) Log::print("Set double property %s[%d] to be %lf.",  property, idx, value);
+    if(Log::enabled(Log::eLevelPrint) && _gPropLogging > 0) Log::print("Set double property %s[%d] to be %lf.",  property, idx, value);
   }
 
   /** @brief, Set a single dimension int property */
@@ -181,7 +181,7 @@ namespace OFX {
     if(throwOnFailure)
       throwPropertyException(stat, property); 
 
-    if(_gPropLogging > 0) Log::print("Set int property %s[%d] to be %d.",  property, idx, value);
+    if(Log::enabled(Log::eLevelPrint) && _gPropLogging > 0) Log::print("Set int property %s[%d] to be %d.",  property, idx, value);
   }
 
   /** @brief, Set a multiple dimension double property */
@@ -197,7 +197,7 @@ namespace OFX {
     if(throwOnFailure)
       throwPropertyException(stat, property); 
 
-    if(_gPropLogging > 0) Log::print("Set double property %s[0..%d].",  property, count-1);
+    if(Log::enabled(Log::eLevelPrint) && _gPropLogging > 0) Log::print("Set double property %s[0..%d].",  property, count-1);
   }
 
   /** @brief Get single pointer property */
@@ -214,7 +214,7 @@ namespace OFX {
     if(throwOnFailure)
       throwPropertyException(stat, property); 
 
-    if(_gPropLogging > 0) Log::print("Retrieved pointer property %s[%d], was given %p.",  property, idx, value);
+    if(Log::enabled(Log::eLevelPrint) && _gPropLogging > 0) Log::print("Retrieved pointer property %s[%d], was given %p.",  property, idx, value);
 
     return value;
   }
@@ -233,7 +233,7 @@ namespace OFX {
     if(throwOnFailure)
       throwPropertyException(stat, property);
 
-    if(_gPropLogging > 0) Log::print("Retrieved string property %s[%d], was given %s.",  property, idx, value);
+    if(Log::enabled(Log::eLevelPrint) && _gPropLogging > 0) Log::print("Retrieved string property %s[%d], was given %s.",  property, idx, value);
     return value != NULL ?  std::string(value) : std::string();
   }
 
@@ -251,7 +251,7 @@ namespace OFX {
     if(throwOnFailure)
       throwPropertyException(stat, property); 
 
-    if(_gPropLogging > 0) Log::print("Retrieved double property %s[%d], was given %lf.",  property, idx, value);
+    if(Log::enabled(Log::eLevelPrint) && _gPropLogging > 0) Log::print("Retrieved double property %s[%d], was given %lf.",  property, idx, value);
     return value;
   }
 
@@ -269,7 +269,7 @@ namespace OFX {
     if(throwOnFailure)
       throwPropertyException(stat, property); 
 
-    if(_gPropLogging > 0) Log::print("Retrieved int property %s[%d], was given %d.",  property, idx, value);
+    if(Log::enabled(Log::eLevelPrint) && _gPropLogging > 0) Log::print("Retrieved int property %s[%d], was given %d.",  property, idx, value);
     return value;
   }
     
@@ -291,7 +291,7 @@ namespace OFX {
     if(throwOnFailure)
       throwPropertyException(stat, property);
       
-    if(_gPropLogging > 0) Log::print("Retrieved string property %s, was given %s.",  property,rawValue.data());
+    if(Log::enabled(Log::eLevelPrint) && _gPropLogging > 0) Log::print("Retrieved string property %s, was given %s.",  property,rawValue.data());
       
     for (int i = 0; i < dimension; ++i) {
       ret.push_back(std::string(rawValue[i]));
@@ -300,4 +300,33 @@ namespace OFX {
 
   }
 
+  /** @brief Fetch a list of properties in one pass */
+  void PropertySet::propGetSnapshot(const SnapshotEntry *entries, int nEntries) const throw(std::bad_alloc,
+    OFX::Exception::PropertyUnknownToHost,
+    OFX::Exception::PropertyValueIllegalToHost,
+    OFX::Exception::Suite)
+  {
+    assert(_propHandle != 0);
+    for(int i = 0; i < nEntries; ++i) {
+      const SnapshotEntry &e = entries[i];
+      OfxStatus stat = kOfxStatErrUnknown;
+      switch(e.type) {
+        case ePointer : stat = gPropSuite->propGetPointerN(_propHandle, e.property, e.count, (void **) e.values); break;
+        case eInt     : stat = gPropSuite->propGetIntN(_propHandle, e.property, e.count, (int *) e.values); break;
+        case eString  : stat = gPropSuite->propGetStringN(_propHandle, e.property, e.count, (char **) e.values); break;
+        case eDouble  : stat = gPropSuite->propGetDoubleN(_propHandle, e.property, e.count, (double *) e.values); break;
+      }
+
+      if(stat != kOfxStatOK) {
+        OFX::Log::error(true, "Failed on getting property %s[0..%d], host returned status %s;",
+          e.property, e.count - 1, mapStatusToString(stat));
+        if(!e.optional)
+          throwPropertyException(stat, e.property);
+      }
+      else if(Log::enabled(Log::eLevelPrint) && _gPropLogging > 0) {
+        Log::print("Retrieved property %s[0..%d].", e.property, e.count - 1);
+      }
+    }
+  }
+
 };
@@ -50,6 +50,7 @@ England
 #include "ofxsMultiThread.h"
 
 #include "../include/ofxsProcessing.H"
+#include "ofxsPixelKernels.H"
 
 ////////////////////////////////////////////////////////////////////////////////
 // a dumb interact that just draw's a square you can drag
@@ -166,6 +167,15 @@ public :
 
       PIX *dstPix = (PIX *) _dstImg->getPixelAddress(procWindow.x1, y);
 
+      // without a mask every pixel is scaled the same way, so do the row in one go
+      if(!_doMasking || !_maskImg) {
+        int x1, x2;
+        const PIX *srcPix = OFX::clipRowToImage<PIX, nComponents>(_srcImg, y, procWindow.x1, procWindow.x2, dstPix, x1, x2);
+        if(srcPix)
+          OFX::Kernels::gainRow(srcPix, dstPix + (x1 - procWindow.x1) * nComponents, x2 - x1, nComponents, scales);
+        continue;
+      }
+
       for(int x = procWindow.x1; x < procWindow.x2; x++) {
 
         PIX *srcPix = (PIX *)  (_srcImg ? _srcImg->getPixelAddress(x, y) : 0);
@@ -399,6 +409,12 @@ case OFX::eBitDepthUShort : {
                             }                          
                             break;
 
+case OFX::eBitDepthHalf : {
+  ImageScaler<OFX::Half, 4, 1> fred(*this);
+  setupAndProcess(fred, args);
+                           }
+                           break;
+
 case OFX::eBitDepthFloat : {
   ImageScaler<float, 4, 1> fred(*this);
   setupAndProcess(fred, args);
@@ -422,6 +438,12 @@ case OFX::eBitDepthUShort : {
                             }                          
                             break;
 
+case OFX::eBitDepthHalf : {
+  ImageScaler<OFX::Half, 1, 1> fred(*this);
+  setupAndProcess(fred, args);
+                           }                          
+                           break;
+
 case OFX::eBitDepthFloat : {
   ImageScaler<float, 1, 1> fred(*this);
   setupAndProcess(fred, args);
@@ -649,6 +671,7 @@ void BasicExamplePluginFactory::describe(OFX::ImageEffectDescriptor& desc)
   // add supported pixel depths
   desc.addSupportedBitDepth(eBitDepthUByte);
   desc.addSupportedBitDepth(eBitDepthUShort);
+  desc.addSupportedBitDepth(eBitDepthHalf);
   desc.addSupportedBitDepth(eBitDepthFloat);
 
   // set a few flags
@@ -45,6 +45,7 @@ England
 #include "ofxsMultiThread.h"
 
 #include "../include/ofxsProcessing.H"
+#include "ofxsPixelKernels.H"
 
 
 // Base class for the RGBA and the Alpha processor
@@ -84,35 +85,23 @@ public :
 
       PIX *dstPix = (PIX *) _dstImg->getPixelAddress(procWindow.x1, y);
 
-      for(int x = procWindow.x1; x < procWindow.x2; x++) {
-
-        PIX *srcPix = (PIX *)  (_srcImg ? _srcImg->getPixelAddress(x, y) : 0);
-
-        // do we have a source image to scale up
-        if(srcPix) {
-          for(int c = 0; c < nComponents; c++) {
-            if((_field == OFX::eFieldLower) && (c==0))
-              dstPix[c] = max;
-            else if((_field == OFX::eFieldUpper) && (c==2))
-              dstPix[c] = max;
-            else
-              dstPix[c] = max - srcPix[c];
-          }
+      // invert the part of the row we have a source image for, the rest is black and transparent
+      int x1, x2;
+      const PIX *srcPix = OFX::clipRowToImage<PIX, nComponents>(_srcImg, y, procWindow.x1, procWindow.x2, dstPix, x1, x2);
+      if(srcPix)
+        OFX::Kernels::invertRow(srcPix, dstPix + (x1 - procWindow.x1) * nComponents, (x2 - x1) * nComponents);
+
+      // then flag which field we were given in a component of every pixel
+      int flagged = -1;
+      if(_field == OFX::eFieldLower)
+        flagged = 0;
+      else if(_field == OFX::eFieldUpper && nComponents > 2)
+        flagged = 2;
+      if(flagged >= 0) {
+        for(int x = procWindow.x1; x < procWindow.x2; x++) {
+          dstPix[flagged] = max;
+          dstPix += nComponents;
         }
-        else {
-          // no src pixel here, be black and transparent
-          for(int c = 0; c < nComponents; c++) {
-            if((_field == OFX::eFieldLower) && (c==0))
-              dstPix[c] = max;
-            else if((_field == OFX::eFieldUpper) && (c==2))
-              dstPix[c] = max;
-            else
-              dstPix[c] = 0;
-          }
-        }
-
-        // increment the dst pixel
-        dstPix += nComponents;
       }
     }
   }
@@ -216,6 +205,13 @@ FieldPlugin::render(const OFX::RenderArguments &args)
     }                          
     break;
     
+    case OFX::eBitDepthHalf : 
+    {
+      ImageFielder<OFX::Half, 4, 1> fred(*this, field);
+      setupAndProcess(fred, args);
+    }
+    break;
+
     case OFX::eBitDepthFloat : 
     {
       ImageFielder<float, 4, 1> fred(*this, field);
@@ -244,6 +240,13 @@ FieldPlugin::render(const OFX::RenderArguments &args)
     }                          
     break;
       
+    case OFX::eBitDepthHalf : 
+    {
+      ImageFielder<OFX::Half, 1, 1> fred(*this, field);
+      setupAndProcess(fred, args);
+    }                          
+    break;
+
     case OFX::eBitDepthFloat : 
     {
       ImageFielder<float, 1, 1> fred(*this, field);
@@ -271,6 +274,7 @@ void FieldExamplePluginFactory::describe(OFX::ImageEffectDescriptor &desc)
   // add supported pixel depths
   desc.addSupportedBitDepth(eBitDepthUByte);
   desc.addSupportedBitDepth(eBitDepthUShort);
+  desc.addSupportedBitDepth(eBitDepthHalf);
   desc.addSupportedBitDepth(eBitDepthFloat);
 
   // set a few flags
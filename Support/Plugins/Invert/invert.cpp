@@ -44,6 +44,7 @@ England
 #include "ofxsMultiThread.h"
 
 #include "../include/ofxsProcessing.H"
+#include "ofxsPixelKernels.H"
 
 
 // Base class for the RGBA and the Alpha processor
@@ -79,26 +80,11 @@ public :
 
       PIX *dstPix = (PIX *) _dstImg->getPixelAddress(procWindow.x1, y);
 
-      for(int x = procWindow.x1; x < procWindow.x2; x++) {
-
-        PIX *srcPix = (PIX *)  (_srcImg ? _srcImg->getPixelAddress(x, y) : 0);
-
-        // do we have a source image to scale up
-        if(srcPix) {
-          for(int c = 0; c < nComponents; c++) {
-            dstPix[c] = max - srcPix[c];
-          }
-        }
-        else {
-          // no src pixel here, be black and transparent
-          for(int c = 0; c < nComponents; c++) {
-            dstPix[c] = 0;
-          }
-        }
-
-        // increment the dst pixel
-        dstPix += nComponents;
-      }
+      // invert the part of the row we have a source image for, the rest is black and transparent
+      int x1, x2;
+      const PIX *srcPix = OFX::clipRowToImage<PIX, nComponents>(_srcImg, y, procWindow.x1, procWindow.x2, dstPix, x1, x2);
+      if(srcPix)
+        OFX::Kernels::invertRow(srcPix, dstPix + (x1 - procWindow.x1) * nComponents, (x2 - x1) * nComponents);
     }
   }
 };
@@ -166,6 +152,9 @@ InvertPlugin::setupAndProcess(InvertBase &processor, const OFX::RenderArguments
   // set the render window
   processor.setRenderWindow(args.renderWindow);
 
+  // share the window out in tiles, so no thread sits idle waiting on a slow one
+  processor.setScheduling(OFX::ImageProcessor::eSchedulingTiles);
+
   // Call the base class process member, this will call the derived templated process code
   processor.process();
 }
@@ -193,6 +182,12 @@ case OFX::eBitDepthUShort : {
                             }                          
                             break;
 
+case OFX::eBitDepthHalf : {
+  ImageInverter<OFX::Half, 4, 1> fred(*this);
+  setupAndProcess(fred, args);
+                           }
+                           break;
+
 case OFX::eBitDepthFloat : {
   ImageInverter<float, 4, 1> fred(*this);
   setupAndProcess(fred, args);
@@ -216,6 +211,12 @@ case OFX::eBitDepthUShort : {
                             }                          
                             break;
 
+case OFX::eBitDepthHalf : {
+  ImageInverter<OFX::Half, 1, 1> fred(*this);
+  setupAndProcess(fred, args);
+                           }                          
+                           break;
+
 case OFX::eBitDepthFloat : {
   ImageInverter<float, 1, 1> fred(*this);
   setupAndProcess(fred, args);
@@ -242,6 +243,7 @@ void InvertExamplePluginFactory::describe(OFX::ImageEffectDescriptor &desc)
   // add supported pixel depths
   desc.addSupportedBitDepth(eBitDepthUByte);
   desc.addSupportedBitDepth(eBitDepthUShort);
+  desc.addSupportedBitDepth(eBitDepthHalf);
   desc.addSupportedBitDepth(eBitDepthFloat);
 
   // set a few flags
@@ -265,6 +265,12 @@ RetimerPlugin::render(const OFX::RenderArguments &args)
         }                          
         break;
 
+        case OFX::eBitDepthHalf : {
+            OFX::ImageBlender<OFX::Half, 4> fred(*this);
+            setupAndProcess(fred, args);
+        }
+        break;
+
         case OFX::eBitDepthFloat : {
             OFX::ImageBlender<float, 4> fred(*this);
             setupAndProcess(fred, args);
@@ -288,6 +294,12 @@ RetimerPlugin::render(const OFX::RenderArguments &args)
         }                          
         break;
 
+        case OFX::eBitDepthHalf : {
+            OFX::ImageBlender<OFX::Half, 1> fred(*this);
+            setupAndProcess(fred, args);
+        }                          
+        break;
+
         case OFX::eBitDepthFloat : {
             OFX::ImageBlender<float, 1> fred(*this);
             setupAndProcess(fred, args);
@@ -337,6 +349,7 @@ void RetimerExamplePluginFactory::describe(OFX::ImageEffectDescriptor &desc)
   // Add supported pixel depths
   desc.addSupportedBitDepth(eBitDepthUByte);
   desc.addSupportedBitDepth(eBitDepthUShort);
+  desc.addSupportedBitDepth(eBitDepthHalf);
   desc.addSupportedBitDepth(eBitDepthFloat);
 
   // set a few flags
@@ -158,6 +158,12 @@ case OFX::eBitDepthUShort : {
                             }                          
                             break;
 
+case OFX::eBitDepthHalf : {
+  OFX::ImageBlender<OFX::Half, 4> fred(*this);
+  setupAndProcess(fred, args);
+                           }
+                           break;
+
 case OFX::eBitDepthFloat : {
   OFX::ImageBlender<float, 4> fred(*this);
   setupAndProcess(fred, args);
@@ -181,6 +187,12 @@ case OFX::eBitDepthUShort : {
                             }                          
                             break;
 
+case OFX::eBitDepthHalf : {
+  OFX::ImageBlender<OFX::Half, 1> fred(*this);
+  setupAndProcess(fred, args);
+                           }                          
+                           break;
+
 case OFX::eBitDepthFloat : {
   OFX::ImageBlender<float, 1> fred(*this);
   setupAndProcess(fred, args);
@@ -235,6 +247,7 @@ void CrossFadeExamplePluginFactory::describe(OFX::ImageEffectDescriptor &desc)
   // Add supported pixel depths
   desc.addSupportedBitDepth(eBitDepthUByte);
   desc.addSupportedBitDepth(eBitDepthUShort);
+  desc.addSupportedBitDepth(eBitDepthHalf);
   desc.addSupportedBitDepth(eBitDepthFloat);
 
   // set a few flags
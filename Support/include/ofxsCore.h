@@ -416,6 +416,26 @@ namespace OFX {
     OFX::Exception::PropertyValueIllegalToHost,
     OFX::Exception::Suite);
 
+    /** @brief A property for propGetSnapshot to fetch, and where to put its values */
+    struct SnapshotEntry {
+      const char       *property;  /**< @brief the property's name */
+      PropertyTypeEnum  type;      /**< @brief its type */
+      int               count;     /**< @brief how many values to fetch, from index 0 */
+      void             *values;    /**< @brief an array of count void *, int, const char * or double, by type */
+      bool              optional;  /**< @brief if the host fails to return it, leave the values alone rather than throw */
+    };
+
+    /** @brief Fetch a list of properties in one pass, with one suite call per property whatever its dimension.
+
+    This is for the likes of images and action arguments, which have a fixed set of properties
+    that are all wanted at once, typically declared as a static array of entries pointing into
+    a plain struct. Strings are left as the host's own, which stay valid while the property set
+    is unchanged, so no std::string is made for them.
+    */
+    void propGetSnapshot(const SnapshotEntry *entries, int nEntries) const throw(std::bad_alloc,
+      OFX::Exception::PropertyUnknownToHost,
+      OFX::Exception::PropertyValueIllegalToHost,
+      OFX::Exception::Suite);
   };
 
   // forward decl of the image effect
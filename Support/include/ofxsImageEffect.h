@@ -52,6 +52,7 @@ of the direct OFX objects and any library side only functions.
 #include "ofxProgress.h"
 #include "ofxTimeLine.h"
 #include "ofxParametricParam.h"
+#include "ofxsParamBatchSuite.h"
 
 /** @brief Nasty macro used to define empty protected copy ctors and assign ops */
 #define mDeclareProtectedAssignAndCC(CLASS) \
@@ -1188,6 +1189,25 @@ namespace OFX {
   };  
 
 
+  ////////////////////////////////////////////////////////////////////////////////
+  /** @brief Counts and times the actions the support library's main entry is called with, to see
+  where time goes inside the support layer. Nothing is recorded until it is turned on.
+  */
+  namespace ActionStatistics {
+    /** @brief turn recording on or off */
+    void setEnabled(bool enabled);
+
+    /** @brief is recording on */
+    bool getEnabled(void);
+
+    /** @brief zero all the counts */
+    void reset(void);
+
+    /** @brief write a table of the calls, total and mean times and a histogram of times of each action that has been called */
+    void dump(std::ostream &out);
+  };
+
+
   ////////////////////////////////////////////////////////////////////////////////
   /** @brief The OFX::Plugin namespace. All the functions in here needs to be defined by each plugin that uses the support libs.
   */  
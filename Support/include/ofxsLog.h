@@ -40,25 +40,60 @@ England
 /** @file This file contains OFX logging header code
 */
 
+/** @brief The most verbose level of logging compiled in, see OFX::Log::LevelEnum. Define it lower
+before including this to compile out the checks of OFX::Log::enabled for the levels above it.
+*/
+#ifndef OFX_LOG_MAX_LEVEL
+#define OFX_LOG_MAX_LEVEL 3
+#endif
+
 /** @brief The core 'OFX Support' namespace, used by plugin implementations. All code for these are defined in the common support libraries.
 */
 namespace OFX {
 
-  /** @brief this namespace wraps up logging functionality */
+  /** @brief this namespace wraps up logging functionality
+
+  Lines are formatted on the thread logging them and put in a buffer of that thread's, a
+  background thread takes them from there and writes them to the log file, so logging
+  does not take locks or wait on the file. Lines from one thread are written in order.
+  */
   namespace Log {
-    /** @brief Indent it, not MP sane at the moment */
+    /** @brief how much is logged, each level includes those below it */
+    enum LevelEnum {
+      eLevelNone = 0,     /**< @brief nothing is logged */
+      eLevelError = 1,    /**< @brief only errors */
+      eLevelWarning = 2,  /**< @brief errors and warnings */
+      eLevelPrint = 3     /**< @brief everything */
+    };
+
+    /** @brief the level set by setLevel, use enabled to check it */
+    extern int gLevel;
+
+    /** @brief Is logging at a level on. A check against a constant level costs one branch, or nothing if the level is above OFX_LOG_MAX_LEVEL. */
+    inline bool enabled(LevelEnum level)
+    {
+      return level <= OFX_LOG_MAX_LEVEL && level <= gLevel;
+    }
+
+    /** @brief Sets the level logged at, by default eLevelPrint if DEBUG is defined, else eLevelNone. */
+    void setLevel(LevelEnum level);
+
+    /** @brief Gets the level logged at. */
+    LevelEnum getLevel(void);
+
+    /** @brief Indent the calling thread's lines */
     void indent(void);
 
-    /** @brief Outdent it, not MP sane at the moment */
+    /** @brief Outdent the calling thread's lines */
     void outdent(void);
 
     /** @brief Sets the name of the log file. */
     void setFileName(const std::string &value);
 
-    /** @brief Opens the log file, returns whether this was sucessful or not. */
+    /** @brief Opens the log file, returns whether this was sucessful or not. Logging opens it as need be. */
     bool open(void);
 
-    /** @brief Closes the log file. */
+    /** @brief Writes out any lines still buffered and closes the log file, stopping the background thread. */
     void close(void);
 
     /** @brief Prints to the log file. */
@@ -1237,6 +1237,10 @@ namespace OFX {
         /** @brief get value */
         double getValueAtTime(double t) {double v; getValueAtTime(t, v); return v;}
 
+        /** @brief get the values at n times in one go, as motion blur samples need, falls back to a
+        getValueAtTime per time if the host does not have the batched parameter suite */
+        void getValuesAtTimes(const double *times, double *values, int n);
+
         /** @brief set value */
         void setValue(double v);
 
@@ -1297,6 +1301,9 @@ namespace OFX {
         /** @brief get the value at a time */
         void getValueAtTime(double t, double &x, double &y);
 
+        /** @brief get the values at n times in one go, see DoubleParam::getValuesAtTimes */
+        void getValuesAtTimes(const double *times, OfxPointD *values, int n);
+
         /** @brief set value */
         void setValue(double x, double y);
 
@@ -0,0 +1,89 @@
+/*
+Software License :
+
+Copyright (c) 2007-2009, The Open Effects Association Ltd. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice,
+      this list of conditions and the following disclaimer in the documentation
+      and/or other materials provided with the distribution.
+    * Neither the name The Open Effects Association Ltd, nor the names of its 
+      contributors may be used to endorse or promote products derived from this
+      software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _ofxsParamBatchSuite_h_
+#define _ofxsParamBatchSuite_h_
+
+#include "ofxParam.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @file ofxsParamBatchSuite.h
+
+This file contains an optional suite which evaluates a parameter at many times in one call.
+
+It is not part of the OFX standard, it is an extension offered by hosts built on the HostSupport
+library and used by plugins built on the C++ support library, so it is named by reverse domain as
+vendor suites are. Other hosts will not have it, and plugins must fall back to
+OfxParameterSuiteV1::paramGetValueAtTime, as the support library does.
+
+Effects that sample their parameters across a frame, such as motion blur, or across many
+frames, such as retimers, would otherwise make one OfxParameterSuiteV1::paramGetValueAtTime
+call per sample, each one going through the var args decoding of the host. With this suite
+the host can evaluate all the samples in one go.
+*/
+
+/** @brief Name of the batched parameter suite */
+#define kNetSfOfxParameterBatchSuite "net.sf.openfx.OfxParameterBatchSuite"
+
+/** @brief Suite to get the values of a parameter at many times at once
+
+    This is an optional suite, see above.
+*/
+typedef struct NetSfOfxParameterBatchSuiteV1 {
+  /** @brief Gets the values of a double valued parameter at many times.
+
+      \arg paramHandle - parameter handle to fetch values from
+      \arg times - the times to evaluate the parameter at, in any order
+      \arg nTimes - how many times there are
+      \arg values - receives the values, all the dimensions of the first time, then those
+                    of the second and so on, so it must hold nTimes times the parameter's
+                    dimension doubles
+
+      Only the double, 2D double, 3D double, RGB and RGBA parameter types can be evaluated.
+      Ordered times, as sampling a shutter interval gives, are the quickest.
+
+      @returns
+      - ::kOfxStatOK - all was OK
+      - ::kOfxStatErrBadHandle - if the parameter handle was invalid
+      - ::kOfxStatErrUnsupported - if the parameter is not one of the double valued types
+  */
+  OfxStatus (*paramGetValuesAtTimes)(OfxParamHandle paramHandle,
+                                     const OfxTime *times,
+                                     int nTimes,
+                                     double *values);
+} NetSfOfxParameterBatchSuiteV1;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif